@@ -0,0 +1,38 @@
+#ifndef BL_BENCH_H
+#define BL_BENCH_H
+
+#include "bl/primitives.h" // const_cstr, usize, f64
+
+#include <chrono>
+#include <cstdio>
+
+/// Minimal helpers shared by the benchmarks.
+namespace bench {
+using namespace bl::primitives;
+
+/// Keeps the compiler from optimizing away the computation of `val`.
+template <typename T> inline void doNotOptimize(const T& val) {
+  asm volatile("" : : "r,m"(val) : "memory");
+}
+
+/// Runs `fn` `iters` times (after a warm-up run) and prints the average time
+/// per iteration.
+///
+/// Returns the average time per iteration in nanoseconds.
+template <typename Fn> f64 run(const_cstr name, usize iters, Fn fn) {
+  fn();
+
+  auto start = std::chrono::steady_clock::now();
+  for (usize i = 0; i < iters; i++) {
+    fn();
+  }
+  auto end = std::chrono::steady_clock::now();
+
+  f64  ns  = std::chrono::duration<f64, std::nano>(end - start).count() /
+          static_cast<f64>(iters);
+  printf("%-48s %14.1f ns/iter\n", name, ns);
+  return ns;
+}
+} // namespace bench
+
+#endif // !BL_BENCH_H
@@ -0,0 +1,153 @@
+#include "bench.h"
+
+#include "bl/ds/dynamic_array.h"
+#include "bl/ds/small_dynamic_array.h"
+#include "bl/mem/allocator.h"
+#include "bl/mem/c_allocator.h"
+#include "bl/primitives.h"
+
+#include <cstdio>
+
+using namespace bl;
+using namespace bl::ds;
+
+typedef DynamicArray<int>                                      RuntimeArray;
+typedef DynamicArray<int, alignof(int), mem::StaticCAllocator> StaticArray;
+
+const usize NUM_PUSHES = 1 << 16;
+
+/// Fills a presized array, so only the per-push overhead is measured.
+template <typename Array> void pushPresized(Array& arr) {
+  arr.clear();
+  for (usize i = 0; i < NUM_PUSHES; i++) {
+    arr.push((int)i);
+  }
+  bench::doNotOptimize(arr.getRaw());
+}
+
+/// Builds an array from scratch, growing it one `push` at a time.
+template <typename Array> void pushGrowing(void) {
+  Array arr = Array();
+  for (usize i = 0; i < NUM_PUSHES; i++) {
+    arr.push((int)i);
+  }
+  bench::doNotOptimize(arr.getRaw());
+}
+
+/// Appends a decoded batch one `push` at a time.
+void appendPushes(RuntimeArray& arr, const int* batch) {
+  arr.clear();
+  for (usize i = 0; i < NUM_PUSHES; i++) {
+    arr.push(batch[i]);
+  }
+  bench::doNotOptimize(arr.getRaw());
+}
+
+/// Appends a decoded batch with a single `extend`.
+void appendExtend(RuntimeArray& arr, const int* batch) {
+  arr.clear();
+  arr.extend(batch, NUM_PUSHES);
+  bench::doNotOptimize(arr.getRaw());
+}
+
+const usize NUM_SMALL = 4096;
+
+/// Builds an array of short (4 element) arrays and sums them up.
+template <typename Inner> void arrayOfArrays(void) {
+  DynamicArray<Inner> outer = DynamicArray<Inner>(NUM_SMALL);
+  for (usize i = 0; i < NUM_SMALL; i++) {
+    Inner& inner = outer.emplace();
+    for (int j = 0; j < 4; j++) {
+      inner.push(j);
+    }
+  }
+
+  int sum = 0;
+  for (usize i = 0; i < NUM_SMALL; i++) {
+    for (usize j = 0; j < 4; j++) {
+      sum += outer[i][j];
+    }
+  }
+  bench::doNotOptimize(sum);
+}
+
+const usize NUM_ENTRIES = 1 << 14;
+
+/// Removes every third entry ("expired") one `remove` at a time.
+void cleanupRemove(RuntimeArray& arr) {
+  for (usize i = arr.getLen(); i > 0; i--) {
+    if (arr[i - 1] % 3 == 0) {
+      arr.remove(i - 1);
+    }
+  }
+  bench::doNotOptimize(arr.getRaw());
+}
+
+/// Removes every third entry with a single `removeIf`.
+void cleanupRemoveIf(RuntimeArray& arr) {
+  arr.removeIf([](int val) { return val % 3 == 0; });
+  bench::doNotOptimize(arr.getRaw());
+}
+
+int main(void) {
+  printf("%-48s %14zu bytes\n", "sizeof(DynamicArray<int>) (runtime)",
+         sizeof(RuntimeArray));
+  printf("%-48s %14zu bytes\n", "sizeof(DynamicArray<int>) (static)",
+         sizeof(StaticArray));
+
+  RuntimeArray runtime_arr = RuntimeArray(NUM_PUSHES);
+  StaticArray  static_arr  = StaticArray(NUM_PUSHES);
+
+  f64 runtime_ns = bench::run("DynamicArray<int>::push x65536 (runtime)", 200,
+                              [&] { pushPresized(runtime_arr); });
+  f64 static_ns  = bench::run("DynamicArray<int>::push x65536 (static)", 200,
+                              [&] { pushPresized(static_arr); });
+  printf("%-48s %14.2f ns\n", "per-push difference",
+         (runtime_ns - static_ns) / NUM_PUSHES);
+
+  runtime_ns = bench::run("growing push x65536 (runtime)", 200,
+                          [&] { pushGrowing<RuntimeArray>(); });
+  static_ns  = bench::run("growing push x65536 (static)", 200,
+                          [&] { pushGrowing<StaticArray>(); });
+  printf("%-48s %14.2f ns\n", "per-push difference",
+         (runtime_ns - static_ns) / NUM_PUSHES);
+
+  RuntimeArray batch = RuntimeArray(NUM_PUSHES);
+  for (usize i = 0; i < NUM_PUSHES; i++) {
+    batch.push((int)i);
+  }
+  RuntimeArray dst       = RuntimeArray(NUM_PUSHES);
+
+  f64          push_ns   = bench::run("append x65536 (push loop)", 200, [&] {
+    appendPushes(dst, batch.getRaw());
+  });
+  f64          extend_ns = bench::run("append x65536 (extend)", 200, [&] {
+    appendExtend(dst, batch.getRaw());
+  });
+  printf("%-48s %14.2fx\n", "extend speedup", push_ns / extend_ns);
+
+  f64 heap_ns   = bench::run("4096 x 4 ints (DynamicArray)", 200,
+                             [] { arrayOfArrays<DynamicArray<int>>(); });
+  f64 inline_ns = bench::run("4096 x 4 ints (SmallDynamicArray)", 200, [] {
+    arrayOfArrays<SmallDynamicArray<int, 8>>();
+  });
+  printf("%-48s %14.2fx\n", "inline speedup", heap_ns / inline_ns);
+
+  RuntimeArray entries   = RuntimeArray(NUM_ENTRIES);
+  auto         fill      = [&] {
+    entries.clear();
+    entries.extend(batch.getRaw(), NUM_ENTRIES);
+  };
+
+  f64          loop_ns   = bench::run("cleanup 16Ki entries (remove loop)", 50,
+                                      [&] {
+                                        fill();
+                                        cleanupRemove(entries);
+                                      });
+  f64          retain_ns = bench::run("cleanup 16Ki entries (removeIf)", 50,
+                                      [&] {
+                                        fill();
+                                        cleanupRemoveIf(entries);
+                                      });
+  printf("%-48s %14.2fx\n", "removeIf speedup", loop_ns / retain_ns);
+}
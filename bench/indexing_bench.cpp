@@ -0,0 +1,100 @@
+#include "bench.h"
+
+#include "bl/config.h"
+#include "bl/ds/dynamic_array.h"
+#include "bl/error.h"
+#include "bl/primitives.h"
+
+#include <cstdio>
+
+using namespace bl;
+using namespace bl::ds;
+
+const usize NUM_ELEMS  = 100 * 1000 * 1000;
+const usize NUM_CACHED = 16 * 1024;
+
+/// Sums the array the way `operator[]` used to check every access (resetting
+/// the error state each time).
+i64 sumResetting(DynamicArray<int>& arr) {
+  i64 sum = 0;
+  for (usize i = 0; i < arr.getLen(); i++) {
+    Error::resetError();
+    sum += arr.at(i);
+  }
+  return sum;
+}
+
+/// Sums the array with the always checked `at`.
+i64         sumChecked(DynamicArray<int>& arr) {
+  i64 sum = 0;
+  for (usize i = 0; i < arr.getLen(); i++) {
+    sum += arr.at(i);
+  }
+  return sum;
+}
+
+/// Sums the array with `operator[]` (checked depending on `BL_BOUNDS_CHECKS`).
+i64 sumIndexed(DynamicArray<int>& arr) {
+  i64 sum = 0;
+  for (usize i = 0; i < arr.getLen(); i++) {
+    sum += arr[i];
+  }
+  return sum;
+}
+
+/// Sums the array with `getUnchecked`.
+i64 sumUnchecked(DynamicArray<int>& arr) {
+  i64 sum = 0;
+  for (usize i = 0; i < arr.getLen(); i++) {
+    sum += arr.getUnchecked(i);
+  }
+  return sum;
+}
+
+/// Sums the array through its contiguous iterators.
+i64 sumIterators(DynamicArray<int>& arr) {
+  i64 sum = 0;
+  for (int val : arr) {
+    sum += val;
+  }
+  return sum;
+}
+
+/// Runs every variant over the given array.
+void sumAll(DynamicArray<int>& arr, const_cstr label, usize iters) {
+  char name[64];
+
+  snprintf(name, sizeof(name), "sum %s ints (resetError + at)", label);
+  f64 resetting_ns = bench::run(
+      name, iters, [&] { bench::doNotOptimize(sumResetting(arr)); });
+
+  snprintf(name, sizeof(name), "sum %s ints (at)", label);
+  f64 checked_ns = bench::run(
+      name, iters, [&] { bench::doNotOptimize(sumChecked(arr)); });
+  snprintf(name, sizeof(name), "sum %s ints (operator[])", label);
+  bench::run(name, iters, [&] { bench::doNotOptimize(sumIndexed(arr)); });
+  snprintf(name, sizeof(name), "sum %s ints (getUnchecked)", label);
+  f64 unchecked_ns = bench::run(
+      name, iters, [&] { bench::doNotOptimize(sumUnchecked(arr)); });
+  snprintf(name, sizeof(name), "sum %s ints (iterators)", label);
+  bench::run(name, iters, [&] { bench::doNotOptimize(sumIterators(arr)); });
+  printf("%-48s %14.2fx\n", "at speedup (vs. resetting)",
+         resetting_ns / checked_ns);
+  printf("%-48s %14.2fx\n", "unchecked speedup (vs. at)",
+         checked_ns / unchecked_ns);
+}
+
+int main(void) {
+  printf("operator[] is %s (BL_BOUNDS_CHECKS = %d)\n",
+         BL_BOUNDS_CHECKS ? "checked" : "unchecked", BL_BOUNDS_CHECKS);
+
+  // Big enough to be bound by memory bandwidth...
+  DynamicArray<int> big = DynamicArray<int>();
+  big.resizeTo(NUM_ELEMS, 1);
+  sumAll(big, "100M", 5);
+
+  // ...and small enough to stay in the cache
+  DynamicArray<int> small = DynamicArray<int>();
+  small.resizeTo(NUM_CACHED, 1);
+  sumAll(small, "16K", 20000);
+}
@@ -0,0 +1,77 @@
+#include "bench.h"
+
+#include "bl/ds/dynamic_array.h"
+#include "bl/par/algorithms.h"
+#include "bl/par/thread_pool.h"
+#include "bl/primitives.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <thread>
+
+using namespace bl;
+using namespace bl::primitives;
+
+const usize LEN = 4 * 1024 * 1024;
+
+int         main(void) {
+  ds::DynamicArray<int> src = ds::DynamicArray<int>(LEN);
+  u32                   seed = 12345;
+  for (usize i = 0; i < LEN; i++) {
+    seed = seed * 1664525 + 1013904223;
+    src.push((int)(seed >> 8));
+  }
+
+  ds::DynamicArray<int> arr = ds::DynamicArray<int>();
+  ds::DynamicArray<f32> out = ds::DynamicArray<f32>();
+  arr.resizeTo(LEN);
+  out.resizeTo(LEN);
+
+  // Scale from 1 thread up to the number of hardware threads (and at least 4,
+  // to show the overhead of oversubscription on small machines)
+  usize max_threads = std::thread::hardware_concurrency();
+  max_threads       = max_threads < 4 ? 4 : max_threads;
+
+  char  name[64];
+  for (usize threads = 1; threads <= max_threads; threads *= 2) {
+    par::ThreadPool pool = par::ThreadPool(threads);
+    printf("-- %zu thread(s)\n", threads);
+
+    snprintf(name, sizeof(name), "parallelSort (%zu ints)", LEN);
+    bench::run(name, 5, [&] {
+      memcpy(arr.begin(), src.begin(), LEN * sizeof(int));
+      par::parallelSort(arr, std::less<int>(), &pool);
+      bench::doNotOptimize(arr[0]);
+    });
+
+    snprintf(name, sizeof(name), "parallelReduce (%zu ints)", LEN);
+    bench::run(name, 20, [&] {
+      i64 sum = par::parallelReduce(
+          src, (i64)0, [](i64 a, i64 b) { return a + b; }, &pool);
+      bench::doNotOptimize(sum);
+    });
+
+    snprintf(name, sizeof(name), "parallelTransform (%zu ints)", LEN);
+    bench::run(name, 20, [&] {
+      par::parallelTransform(
+          src, out, [](int val) { return std::sqrt((f32)val); }, &pool);
+      bench::doNotOptimize(out[0]);
+    });
+
+    snprintf(name, sizeof(name), "parallelForEach (%zu ints)", LEN);
+    bench::run(name, 20, [&] {
+      par::parallelForEach(arr, [](int& val) { val = val * 3 + 1; }, &pool);
+      bench::doNotOptimize(arr[0]);
+    });
+
+    snprintf(name, sizeof(name), "parallelPartition (%zu ints)", LEN);
+    bench::run(name, 5, [&] {
+      memcpy(arr.begin(), src.begin(), LEN * sizeof(int));
+      usize num =
+          par::parallelPartition(arr, [](int val) { return val < 0; }, &pool);
+      bench::doNotOptimize(num);
+    });
+  }
+}
@@ -0,0 +1,52 @@
+#include "bench.h"
+
+#include "bl/ds/dynamic_array.h"
+#include "bl/mem/allocator.h"
+#include "bl/mem/c_allocator.h"
+#include "bl/mem/pool_allocator.h"
+#include "bl/primitives.h"
+#include "bl/string.h"
+
+using namespace bl;
+using namespace bl::ds;
+
+const usize NUM_CONTAINERS = 1000;
+
+/// Builds many small arrays, one `push` at a time.
+void        pushArrays(mem::Allocator* allocator) {
+  for (usize n = 0; n < NUM_CONTAINERS; n++) {
+    DynamicArray<int> arr = DynamicArray<int>(allocator);
+    for (int i = 0; i < 16; i++) {
+      arr.push(i);
+    }
+    bench::doNotOptimize(arr.getRaw());
+  }
+}
+
+/// Builds many short strings, one `push` at a time.
+void pushStrings(mem::Allocator* allocator) {
+  for (usize n = 0; n < NUM_CONTAINERS; n++) {
+    String str = String(allocator, "x");
+    for (int i = 0; i < 32; i++) {
+      str.push('a');
+    }
+    bench::doNotOptimize(str.getRaw());
+  }
+}
+
+int main(void) {
+  mem::CAllocator    c_allocator = mem::CAllocator();
+  mem::PoolAllocator pool        = mem::PoolAllocator();
+
+  f64 c_ns = bench::run("DynamicArray<int>::push x16 (CAllocator)", 200,
+                        [&] { pushArrays(&c_allocator); });
+  f64 pool_ns = bench::run("DynamicArray<int>::push x16 (PoolAllocator)", 200,
+                           [&] { pushArrays(&pool); });
+  printf("%-48s %14.2fx\n", "speedup", c_ns / pool_ns);
+
+  c_ns    = bench::run("String::push x32 (CAllocator)", 200,
+                       [&] { pushStrings(&c_allocator); });
+  pool_ns = bench::run("String::push x32 (PoolAllocator)", 200,
+                       [&] { pushStrings(&pool); });
+  printf("%-48s %14.2fx\n", "speedup", c_ns / pool_ns);
+}
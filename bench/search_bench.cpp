@@ -0,0 +1,81 @@
+#include "bench.h"
+
+#include "bl/ds/dynamic_array.h"
+#include "bl/ds/search.h"
+#include "bl/primitives.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <numeric>
+
+using namespace bl;
+using namespace bl::primitives;
+using ds::search_internal::Isa;
+
+/// Total number of elements scanned per configuration (so every size does
+/// the same amount of work).
+const usize WORK = usize(1) << 24;
+
+const usize SIZES[] = {64, 4 * 1024, 256 * 1024, 4 * 1024 * 1024};
+
+/// Runs the search kernels on `len` elements, with every instruction set.
+template <typename T> void benchType(const_cstr type, usize len) {
+  ds::DynamicArray<T> arr = ds::DynamicArray<T>();
+  arr.resizeTo(len, T(1));
+  // Searching for a missing value scans the whole array
+  T     missing = T(2);
+  usize iters   = WORK / len;
+  char  name[64];
+
+  printf("-- %s, %zu elements\n", type, len);
+  snprintf(name, sizeof(name), "naive indexOf loop");
+  bench::run(name, iters, [&] {
+    usize idx = ds::NOT_FOUND;
+    for (usize i = 0; i < arr.getLen(); i++) {
+      if (arr[i] == missing) {
+        idx = i;
+        break;
+      }
+    }
+    bench::doNotOptimize(idx);
+  });
+  bench::run("std::find", iters, [&] {
+    bench::doNotOptimize(std::find(arr.begin(), arr.end(), missing));
+  });
+  bench::run("std::accumulate", iters, [&] {
+    bench::doNotOptimize(std::accumulate(
+        arr.begin(), arr.end(), ds::search_internal::SumType<T>(0)));
+  });
+  bench::run("std::min_element", iters, [&] {
+    bench::doNotOptimize(*std::min_element(arr.begin(), arr.end()));
+  });
+
+  const Isa        ISAS[]      = {Isa::Scalar, Isa::Sse2, Isa::Avx2};
+  const const_cstr ISA_NAMES[] = {"scalar", "sse2", "avx2"};
+  Isa              detected    = ds::search_internal::getIsa();
+  for (usize isa = 0; isa < 3; isa++) {
+    if (!ds::search_internal::setIsa(ISAS[isa])) {
+      continue;
+    }
+
+    snprintf(name, sizeof(name), "ds::indexOf (%s)", ISA_NAMES[isa]);
+    bench::run(name, iters,
+               [&] { bench::doNotOptimize(ds::indexOf(arr, missing)); });
+    snprintf(name, sizeof(name), "ds::count (%s)", ISA_NAMES[isa]);
+    bench::run(name, iters,
+               [&] { bench::doNotOptimize(ds::count(arr, T(1))); });
+    snprintf(name, sizeof(name), "ds::min (%s)", ISA_NAMES[isa]);
+    bench::run(name, iters, [&] { bench::doNotOptimize(ds::min(arr)); });
+    snprintf(name, sizeof(name), "ds::sum (%s)", ISA_NAMES[isa]);
+    bench::run(name, iters, [&] { bench::doNotOptimize(ds::sum(arr)); });
+  }
+  ds::search_internal::setIsa(detected);
+}
+
+int main(void) {
+  for (usize len : SIZES) {
+    benchType<u8>("u8", len);
+    benchType<u32>("u32", len);
+    benchType<f32>("f32", len);
+  }
+}
@@ -0,0 +1,87 @@
+#include "bench.h"
+
+#include "bl/ds/dynamic_array.h"
+#include "bl/ds/soa_array.h"
+#include "bl/primitives.h"
+
+#include <cstdio>
+
+using namespace bl;
+using namespace bl::primitives;
+
+/// Total number of rows scanned per configuration.
+const usize WORK    = usize(1) << 26;
+
+const usize SIZES[] = {4 * 1024, 256 * 1024, 4 * 1024 * 1024};
+
+struct Record {
+  u64 id;
+  f32 score;
+  u32 flags;
+};
+
+typedef ds::SoaArray<u64, f32, u32> Records;
+
+/// Scans a single field of `len` rows, stored as an array of structs and as
+/// a structure of arrays.
+void benchScans(usize len) {
+  ds::DynamicArray<Record> aos = ds::DynamicArray<Record>(len);
+  Records                  soa = Records(len);
+  for (usize i = 0; i < len; i++) {
+    f32 score = static_cast<f32>(i % 100) / 100.0f;
+    u32 flags = static_cast<u32>(i * 2654435761u);
+    aos.push(Record{i, score, flags});
+    soa.push(i, score, flags);
+  }
+  usize iters = WORK / len;
+
+  printf("-- %zu rows\n", len);
+  bench::run("sum scores (DynamicArray<Record>)", iters, [&] {
+    f32 total = 0.0f;
+    for (const Record& record : aos) {
+      total += record.score;
+    }
+    bench::doNotOptimize(total);
+  });
+  bench::run("sum scores (SoaArray column)", iters, [&] {
+    f32 total = 0.0f;
+    for (f32 score : soa.getColumn<1>()) {
+      total += score;
+    }
+    bench::doNotOptimize(total);
+  });
+
+  bench::run("count flags (DynamicArray<Record>)", iters, [&] {
+    usize n = 0;
+    for (const Record& record : aos) {
+      n += (record.flags & 0x10) != 0;
+    }
+    bench::doNotOptimize(n);
+  });
+  bench::run("count flags (SoaArray column)", iters, [&] {
+    usize n = 0;
+    for (u32 flags : soa.getColumn<2>()) {
+      n += (flags & 0x10) != 0;
+    }
+    bench::doNotOptimize(n);
+  });
+
+  bench::run("scale scores (DynamicArray<Record>)", iters, [&] {
+    for (Record& record : aos) {
+      record.score *= 1.0001f;
+    }
+    bench::doNotOptimize(aos[0]);
+  });
+  bench::run("scale scores (SoaArray column)", iters, [&] {
+    for (f32& score : soa.getColumn<1>()) {
+      score *= 1.0001f;
+    }
+    bench::doNotOptimize(soa.get<1>(0));
+  });
+}
+
+int main(void) {
+  for (usize len : SIZES) {
+    benchScans(len);
+  }
+}
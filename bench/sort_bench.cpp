@@ -0,0 +1,126 @@
+#include "bench.h"
+
+#include "bl/ds/dynamic_array.h"
+#include "bl/ds/sort.h"
+#include "bl/primitives.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+using namespace bl;
+using namespace bl::primitives;
+
+/// Total number of elements sorted per configuration (so every size does
+/// roughly the same amount of work).
+const usize      WORK          = usize(1) << 24;
+
+const usize      SIZES[]       = {1000, 100 * 1000, 10 * 1000 * 1000};
+
+/// Only run with `--large` (it needs about 2.4 GB of memory).
+const usize      LARGE_SIZE    = 100 * 1000 * 1000;
+
+const const_cstr INPUT_NAMES[] = {"random", "sorted", "duplicates"};
+
+/// Fills `arr` with `len` elements of the given input kind.
+template <typename T>
+void fillInput(ds::DynamicArray<T>& arr, usize len, usize kind) {
+  u64 seed = 42;
+  arr.clear();
+  for (usize i = 0; i < len; i++) {
+    seed = seed * 6364136223846793005ull + 1442695040888963407ull;
+    switch (kind) {
+    case 0:
+      arr.push(T(seed >> 11));
+      break;
+    case 1:
+      arr.push(T(i));
+      break;
+    default:
+      arr.push(T((seed >> 33) % 16));
+      break;
+    }
+  }
+}
+
+/// Sorts copies of every input kind with radix sort, pdqsort (through a
+/// comparison function) and `std::sort`.
+///
+/// Every iteration copies the input first; the copy alone is timed too.
+template <typename T> void benchType(const_cstr type, usize len) {
+  ds::DynamicArray<T> input = ds::DynamicArray<T>();
+  ds::DynamicArray<T> arr   = ds::DynamicArray<T>();
+  arr.resizeTo(len, T(0));
+  usize iters = std::max<usize>(WORK / len, 1);
+
+  for (usize kind = 0; kind < 3; kind++) {
+    fillInput(input, len, kind);
+    printf("-- %s, %s, %zu elements\n", type, INPUT_NAMES[kind], len);
+
+    auto copy = [&] { memcpy(arr.begin(), input.begin(), len * sizeof(T)); };
+    bench::run("copy only", iters, [&] {
+      copy();
+      bench::doNotOptimize(arr[0]);
+    });
+    bench::run("std::sort", iters, [&] {
+      copy();
+      std::sort(arr.begin(), arr.end());
+      bench::doNotOptimize(arr[0]);
+    });
+    bench::run("ds::sort (pdqsort)", iters, [&] {
+      copy();
+      ds::sort(arr, [](T a, T b) { return a < b; });
+      bench::doNotOptimize(arr[0]);
+    });
+    bench::run("ds::sort (radix)", iters, [&] {
+      copy();
+      ds::sort(arr);
+      bench::doNotOptimize(arr[0]);
+    });
+  }
+}
+
+/// Sorts key/value pairs by key.
+void benchPairs(usize len) {
+  struct Pair {
+    u32 key;
+    u32 value;
+  };
+
+  ds::DynamicArray<Pair> input = ds::DynamicArray<Pair>();
+  ds::DynamicArray<Pair> arr   = ds::DynamicArray<Pair>();
+  u64                    seed  = 42;
+  for (usize i = 0; i < len; i++) {
+    seed = seed * 6364136223846793005ull + 1442695040888963407ull;
+    input.push(Pair{u32(seed >> 32), u32(i)});
+  }
+  arr.resizeTo(len, Pair{0, 0});
+  usize iters = std::max<usize>(WORK / len, 1);
+
+  printf("-- u32 key/value pairs, random, %zu elements\n", len);
+  auto copy = [&] { memcpy(arr.begin(), input.begin(), len * sizeof(Pair)); };
+  bench::run("std::stable_sort", iters, [&] {
+    copy();
+    std::stable_sort(arr.begin(), arr.end(),
+                     [](Pair a, Pair b) { return a.key < b.key; });
+    bench::doNotOptimize(arr[0]);
+  });
+  bench::run("ds::sortByKey (radix)", iters, [&] {
+    copy();
+    ds::sortByKey(arr, [](Pair pair) { return pair.key; });
+    bench::doNotOptimize(arr[0]);
+  });
+}
+
+int main(int argc, char** argv) {
+  bool large = argc > 1 && strcmp(argv[1], "--large") == 0;
+  for (usize len : SIZES) {
+    benchType<u32>("u32", len);
+    benchType<u64>("u64", len);
+    benchType<f32>("f32", len);
+    benchPairs(len);
+  }
+  if (large) {
+    benchType<u64>("u64", LARGE_SIZE);
+  }
+}
@@ -0,0 +1,177 @@
+#include "bench.h"
+
+#include "bl/ds/dynamic_array.h"
+#include "bl/mem/allocator.h"
+#include "bl/mem/c_allocator.h"
+#include "bl/mem/tracking_allocator.h"
+#include "bl/primitives.h"
+#include "bl/string.h"
+#include "bl/string_view.h"
+
+#include <cstdio>
+#include <cstring>
+
+using namespace bl;
+using namespace bl::primitives;
+
+const usize NUM_STRINGS = 100000;
+
+/// The string lengths to benchmark (the inline capacity is 23).
+const usize LENS[]      = {3, 12, 23, 40};
+
+/// The amount of data appended by the append benchmarks.
+const usize APPEND_LEN  = 1024 * 1024;
+
+/// The size of the chunks appended by the append benchmarks.
+const usize CHUNK_LEN   = 4096;
+
+/// The layout `String` had before the small string optimization: every
+/// non-empty string owns an allocation of `len + 1` bytes.
+struct HeapString {
+  mem::Allocator* allocator;
+  char*           data;
+  usize           cap;
+  usize           len;
+
+  HeapString(mem::Allocator* allocator, const_cstr str)
+      : allocator(allocator), cap(strlen(str)), len(cap) {
+    this->data = static_cast<char*>(allocator->allocRaw(this->len + 1));
+    memcpy(this->data, str, this->len + 1);
+  }
+
+  HeapString(HeapString&& other)
+      : allocator(other.allocator), data(other.data), cap(other.cap),
+        len(other.len) {
+    other.data = nullptr;
+    other.cap  = 0;
+  }
+
+  ~HeapString() {
+    if (this->data != nullptr) {
+      this->allocator->deallocSizedRaw(this->data, this->cap + 1);
+    }
+  }
+};
+
+/// Creates `NUM_STRINGS` strings of length `len` in an array, and prints the
+/// allocations and bytes they took.
+template <typename Str> void measure(const_cstr name, usize len) {
+  char src[64];
+  memset(src, 'x', len);
+  src[len]                       = '\0';
+
+  mem::TrackingAllocator tracker = mem::TrackingAllocator();
+  {
+    ds::DynamicArray<Str> strs = ds::DynamicArray<Str>(NUM_STRINGS);
+    tracker.resetStats();
+    for (usize i = 0; i < NUM_STRINGS; i++) {
+      strs.push(Str(&tracker, src));
+    }
+
+    mem::TrackingAllocator::Stats stats = tracker.getStats();
+    printf("%-24s %2zu chars: %3zu B/object, %6zu allocs, %8zu heap bytes, "
+           "%4.1f B/string total\n",
+           name, len, sizeof(Str), stats.allocs, stats.live_bytes,
+           static_cast<f64>(sizeof(Str)) +
+               static_cast<f64>(stats.live_bytes) / NUM_STRINGS);
+  }
+}
+
+/// Appends `APPEND_LEN` characters to strings in `CHUNK_LEN` chunks, one
+/// character at a time (how `String::push(const_cstr)` used to work) and in
+/// bulk.
+void benchAppend(mem::Allocator* allocator) {
+  char chunk[CHUNK_LEN];
+  memset(chunk, 'x', CHUNK_LEN);
+
+  bench::run("append 1 MiB (per character)", 20, [&] {
+    String str = String(allocator);
+    for (usize i = 0; i < APPEND_LEN; i += CHUNK_LEN) {
+      for (usize j = 0; j < CHUNK_LEN; j++) {
+        str.push(chunk[j]);
+      }
+    }
+    bench::doNotOptimize(str.getRaw());
+  });
+  bench::run("append 1 MiB (String::append)", 20, [&] {
+    String str = String(allocator);
+    for (usize i = 0; i < APPEND_LEN; i += CHUNK_LEN) {
+      str.append(chunk, CHUNK_LEN);
+    }
+    bench::doNotOptimize(str.getRaw());
+  });
+  bench::run("append 1 MiB (String::reserve + append)", 20, [&] {
+    String str = String(allocator);
+    str.reserve(APPEND_LEN);
+    for (usize i = 0; i < APPEND_LEN; i += CHUNK_LEN) {
+      str.append(chunk, CHUNK_LEN);
+    }
+    bench::doNotOptimize(str.getRaw());
+  });
+}
+
+/// Renders a template with 1000 placeholders, one edit at a time and with a
+/// single `String::replaceAll`.
+void benchReplace(mem::Allocator* allocator) {
+  String tmpl = String(allocator);
+  for (usize i = 0; i < 1000; i++) {
+    tmpl.append(StringView("<li>{{name}}</li>\n"));
+  }
+
+  bench::run("render 1000 placeholders (replaceRange each)", 100, [&] {
+    String     out    = tmpl;
+    StringView needle = StringView("{{name}}");
+    usize      from   = 0;
+    while (true) {
+      usize idx = out.findFrom(needle, from);
+      if (idx == StringView::NOT_FOUND) {
+        break;
+      }
+      out.replaceRange(idx, idx + needle.getLen(), "Ferris");
+      from = idx + 6;
+    }
+    bench::doNotOptimize(out.getRaw());
+  });
+  bench::run("render 1000 placeholders (replaceAll)", 100, [&] {
+    String out = tmpl;
+    out.replaceAll("{{name}}", "Ferris");
+    bench::doNotOptimize(out.getRaw());
+  });
+}
+
+int main(void) {
+  // Heap bytes are the requested sizes; the C allocator rounds every
+  // allocation up (e.g. to 32 bytes with glibc) and adds its own header
+  for (usize len : LENS) {
+    measure<HeapString>("heap-only layout", len);
+    measure<String>("String", len);
+  }
+
+  mem::CAllocator c_allocator = mem::CAllocator();
+  for (usize len : LENS) {
+    char src[64];
+    memset(src, 'x', len);
+    src[len] = '\0';
+    char name[64];
+
+    snprintf(name, sizeof(name), "create/destroy x%zu (heap-only, %zu chars)",
+             NUM_STRINGS, len);
+    bench::run(name, 10, [&] {
+      for (usize i = 0; i < NUM_STRINGS; i++) {
+        HeapString str = HeapString(&c_allocator, src);
+        bench::doNotOptimize(str.data);
+      }
+    });
+    snprintf(name, sizeof(name), "create/destroy x%zu (String, %zu chars)",
+             NUM_STRINGS, len);
+    bench::run(name, 10, [&] {
+      for (usize i = 0; i < NUM_STRINGS; i++) {
+        String str = String(&c_allocator, src);
+        bench::doNotOptimize(str.getRaw());
+      }
+    });
+  }
+
+  benchAppend(&c_allocator);
+  benchReplace(&c_allocator);
+}
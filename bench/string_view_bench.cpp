@@ -0,0 +1,147 @@
+#include "bench.h"
+
+#include "bl/ds/search.h"
+#include "bl/mem/c_allocator.h"
+#include "bl/mem/tracking_allocator.h"
+#include "bl/primitives.h"
+#include "bl/string.h"
+#include "bl/string_view.h"
+
+#include <cstdio>
+#include <cstring>
+#include <string_view>
+#include <utility>
+
+using namespace bl;
+using namespace bl::primitives;
+
+const usize      ITERS = 100000;
+
+const_cstr const LINE =
+    "GET /api/v1/users/12345/profile?fields=name,email,avatar&expand=teams "
+    "HTTP/1.1 Host: service.internal.example.com User-Agent: bench/1.0 "
+    "Accept: application/json Accept-Encoding: gzip,deflate,br";
+
+/// Tokenizes the line on spaces with `String::split`, copying each tail.
+///
+/// Returns the total length of the tokens.
+usize tokenizeStrings(mem::Allocator* allocator) {
+  usize  total = 0;
+  String rest  = String(allocator, LINE);
+  while (!rest.isEmpty()) {
+    usize idx = rest.find(" ");
+    if (idx == StringView::NOT_FOUND) {
+      total += rest.getLen();
+      break;
+    }
+
+    // `rest` keeps the token and its space, `tail` gets a copy of the rest
+    String tail = rest.split(idx + 1);
+    rest.pop();
+    total += rest.getLen();
+    rest = std::move(tail);
+  }
+  return total;
+}
+
+/// Tokenizes the line on spaces with `StringView::splitOn`.
+///
+/// Returns the total length of the tokens.
+usize tokenizeViews(mem::Allocator* allocator) {
+  usize      total = 0;
+  String     line  = String(allocator, LINE);
+  StringView rest  = line;
+  while (!rest.isEmpty()) {
+    total += rest.splitOn(' ').getLen();
+  }
+  return total;
+}
+
+/// Searches an 8 MiB log-like haystack for needles that only occur at its
+/// end, with `strstr`, `std::string_view::find` and `StringView::find` (with
+/// every instruction set).
+void benchSearch(mem::Allocator* allocator) {
+  using ds::search_internal::Isa;
+
+  const usize      HAY_LEN   = usize(8) << 20;
+  const const_cstr NEEDLES[] = {
+      "ERROR",
+      "request_id=7f3a9c timeout",
+      "upstream connect error or disconnect/reset before headers. reset "
+      "reason: connection termination (retrying)",
+  };
+  const_cstr const WORDS[] = {"GET ", "/api/v1/", "users ", "200 ", "INFO ",
+                              "latency_ms=", "42 ", "request_id=", "\n"};
+
+  // Pseudo-random words (deterministic), with every needle at the end
+  String hay = String(allocator);
+  hay.reserve(HAY_LEN);
+  u64 state = 1;
+  while (hay.getLen() < HAY_LEN - 256) {
+    state = state * 6364136223846793005ull + 1442695040888963407ull;
+    hay.append(StringView(WORDS[(state >> 33) % 9]));
+  }
+  for (const_cstr needle : NEEDLES) {
+    hay.append(StringView(needle));
+  }
+
+  const Isa        ISAS[]      = {Isa::Scalar, Isa::Sse2, Isa::Avx2};
+  const const_cstr ISA_NAMES[] = {"scalar", "sse2", "avx2"};
+  Isa              detected    = ds::search_internal::getIsa();
+  char             name[64];
+  for (const_cstr needle : NEEDLES) {
+    usize needle_len = strlen(needle);
+    printf("-- %zu MiB haystack, %zu byte needle\n", HAY_LEN >> 20,
+           needle_len);
+    bench::run("strstr", 20, [&] {
+      bench::doNotOptimize(strstr(hay.getRaw(), needle));
+    });
+    std::string_view std_hay = std::string_view(hay.getRaw(), hay.getLen());
+    bench::run("std::string_view::find", 20, [&] {
+      bench::doNotOptimize(std_hay.find(needle, 0, needle_len));
+    });
+
+    for (usize isa = 0; isa < 3; isa++) {
+      if (!ds::search_internal::setIsa(ISAS[isa])) {
+        continue;
+      }
+      snprintf(name, sizeof(name), "StringView::find (%s)", ISA_NAMES[isa]);
+      bench::run(name, 20,
+                 [&] { bench::doNotOptimize(hay.getView().find(needle)); });
+    }
+    ds::search_internal::setIsa(detected);
+  }
+
+  printf("-- %zu MiB haystack, counting a common 3 byte needle\n",
+         HAY_LEN >> 20);
+  std::string_view std_hay = std::string_view(hay.getRaw(), hay.getLen());
+  bench::run("std::string_view::find loop", 20, [&] {
+    usize n = 0;
+    for (usize pos = std_hay.find("42 "); pos != std::string_view::npos;
+         pos       = std_hay.find("42 ", pos + 3)) {
+      n++;
+    }
+    bench::doNotOptimize(n);
+  });
+  bench::run("StringView::count", 20,
+             [&] { bench::doNotOptimize(hay.count("42 ")); });
+}
+
+int main(void) {
+  mem::TrackingAllocator tracker = mem::TrackingAllocator();
+  usize                  total   = tokenizeStrings(&tracker);
+  printf("String::split:       %zu token chars, %zu allocs per line\n", total,
+         tracker.getStats().allocs);
+  tracker.resetStats();
+  total = tokenizeViews(&tracker);
+  printf("StringView::splitOn: %zu token chars, %zu allocs per line\n", total,
+         tracker.getStats().allocs);
+
+  mem::CAllocator c_allocator = mem::CAllocator();
+  bench::run("tokenize request line (String::split)", ITERS,
+             [&] { bench::doNotOptimize(tokenizeStrings(&c_allocator)); });
+  bench::run("tokenize request line (StringView::splitOn)", ITERS,
+             [&] { bench::doNotOptimize(tokenizeViews(&c_allocator)); });
+
+  benchSearch(&c_allocator);
+}
@@ -0,0 +1,85 @@
+#include "bench.h"
+
+#include "bl/ds/dynamic_array.h"
+#include "bl/par/thread_pool.h"
+#include "bl/primitives.h"
+#include "bl/task/scheduler.h"
+
+#include <cmath>
+#include <cstdio>
+#include <thread>
+
+using namespace bl;
+using namespace bl::primitives;
+
+const usize LEN = 4 * 1024 * 1024;
+
+/// Computes the `n`th Fibonacci number with one task per call (measures the
+/// overhead of spawning and stealing tiny tasks).
+u64         fib(task::Scheduler& scheduler, u64 n) {
+  if (n < 2) {
+    return n;
+  }
+
+  u64             a = 0;
+  task::TaskGroup group;
+  scheduler.spawn(group, [&] { a = fib(scheduler, n - 1); });
+  u64 b = fib(scheduler, n - 2);
+  scheduler.wait(group);
+  return a + b;
+}
+
+int main(void) {
+  ds::DynamicArray<f32> arr = ds::DynamicArray<f32>();
+  arr.resizeTo(LEN, 2.0f);
+
+  usize max_workers = std::thread::hardware_concurrency();
+  max_workers       = max_workers < 4 ? 4 : max_workers;
+
+  char  name[64];
+  for (usize workers = 1; workers <= max_workers; workers *= 2) {
+    task::Scheduler scheduler = task::Scheduler(workers);
+    par::ThreadPool pool      = par::ThreadPool(workers);
+    printf("-- %zu worker(s)\n", workers);
+
+    // Spawn from a worker, so the tasks go through the deques
+    bench::run("fib(25) (one task per call)", 5, [&] {
+      task::TaskGroup group;
+      u64             result = 0;
+      scheduler.spawn(group, [&] { result = fib(scheduler, 25); });
+      scheduler.wait(group);
+      bench::doNotOptimize(result);
+    });
+
+    snprintf(name, sizeof(name), "Scheduler::parallelFor (%zu floats)", LEN);
+    bench::run(name, 20, [&] {
+      f32* data = arr.begin();
+      scheduler.parallelFor(0, LEN, [&](usize start, usize end) {
+        for (usize i = start; i < end; i++) {
+          data[i] = std::sqrt(data[i] + 1.0f);
+        }
+      });
+      bench::doNotOptimize(arr[0]);
+    });
+
+    snprintf(name, sizeof(name), "ThreadPool::run (%zu floats)", LEN);
+    bench::run(name, 20, [&] {
+      f32*  data  = arr.begin();
+      usize chunk = 16 * 1024;
+      pool.run(LEN / chunk, [&](usize task) {
+        for (usize i = task * chunk; i < (task + 1) * chunk; i++) {
+          data[i] = std::sqrt(data[i] + 1.0f);
+        }
+      });
+      bench::doNotOptimize(arr[0]);
+    });
+
+    task::Scheduler::Stats stats = scheduler.getStats();
+    printf("   tasks run: %llu, steals: %llu, failed steals: %llu, "
+           "sleeps: %llu, idle: %.1f ms\n",
+           (unsigned long long)stats.tasks_run,
+           (unsigned long long)stats.steals,
+           (unsigned long long)stats.failed_steals,
+           (unsigned long long)stats.sleeps, (f64)stats.idle_ns / 1e6);
+  }
+}
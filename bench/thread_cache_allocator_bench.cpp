@@ -0,0 +1,81 @@
+#include "bench.h"
+
+#include "bl/mem/allocator.h"
+#include "bl/mem/c_allocator.h"
+#include "bl/mem/thread_cache_allocator.h"
+#include "bl/primitives.h"
+
+#include <cstdio>
+#include <thread>
+
+using namespace bl;
+using namespace bl::primitives;
+
+const usize NUM_ROUNDS = 100;
+const usize BATCH_SIZE = 256;
+
+/// Allocates batches of blocks of mixed sizes and frees them again.
+void        churn(mem::Allocator* allocator) {
+  void* ptrs[BATCH_SIZE];
+  for (usize round = 0; round < NUM_ROUNDS; round++) {
+    for (usize i = 0; i < BATCH_SIZE; i++) {
+      ptrs[i] = allocator->allocRaw(16 + (i * 40) % 1024);
+    }
+    bench::doNotOptimize(ptrs);
+    for (usize i = 0; i < BATCH_SIZE; i++) {
+      allocator->deallocRaw(ptrs[i]);
+    }
+  }
+}
+
+/// Passes blocks to another thread, which frees them (remote frees).
+void handoff(mem::Allocator* allocator) {
+  static void* ptrs[BATCH_SIZE * NUM_ROUNDS];
+  for (usize i = 0; i < BATCH_SIZE * NUM_ROUNDS; i++) {
+    ptrs[i] = allocator->allocRaw(64);
+  }
+  std::thread consumer([&] {
+    for (usize i = 0; i < BATCH_SIZE * NUM_ROUNDS; i++) {
+      allocator->deallocRaw(ptrs[i]);
+    }
+  });
+  consumer.join();
+}
+
+/// Runs `churn` on `num_threads` threads at once.
+void churnThreads(mem::Allocator* allocator, usize num_threads) {
+  std::thread threads[16];
+  for (usize t = 0; t < num_threads; t++) {
+    threads[t] = std::thread([=] { churn(allocator); });
+  }
+  for (usize t = 0; t < num_threads; t++) {
+    threads[t].join();
+  }
+}
+
+int main(void) {
+  mem::CAllocator           c_allocator = mem::CAllocator();
+  mem::ThreadCacheAllocator tc          = mem::ThreadCacheAllocator();
+
+  char                      name[64];
+  for (usize num_threads = 1; num_threads <= 16; num_threads *= 2) {
+    f64 ops = (f64)(num_threads * NUM_ROUNDS * BATCH_SIZE * 2);
+
+    snprintf(name, sizeof(name), "alloc/free x%zu threads (malloc)",
+             num_threads);
+    f64 c_ns = bench::run(name, 20, [&] {
+      churnThreads(&c_allocator, num_threads);
+    });
+    snprintf(name, sizeof(name), "alloc/free x%zu threads (ThreadCache)",
+             num_threads);
+    f64 tc_ns = bench::run(name, 20, [&] { churnThreads(&tc, num_threads); });
+    printf("%-48s %14.2f / %.2f ns/op\n", "malloc / ThreadCache", c_ns / ops,
+           tc_ns / ops);
+  }
+
+  f64 c_ns  = bench::run("cross-thread free (malloc)", 20,
+                         [&] { handoff(&c_allocator); });
+  f64 tc_ns = bench::run("cross-thread free (ThreadCache)", 20,
+                         [&] { handoff(&tc); });
+  printf("%-48s %14.2fx\n", "speedup", c_ns / tc_ns);
+}
@@ -1,5 +1,11 @@
 #include "bl/mem/allocator.h"
+#include "bl/mem/arena_allocator.h"
 #include "bl/mem/c_allocator.h"
+#include "bl/mem/page_allocator.h"
+#include "bl/mem/pool_allocator.h"
+#include "bl/mem/thread_cache_allocator.h"
+#include "bl/mem/threshold_allocator.h"
+#include "bl/mem/tracking_allocator.h"
 
 namespace bl {
 /// @mainpage A base layer for C++ containing useful constructs.
@@ -7,6 +13,17 @@ namespace bl {
 /// ## Allocators
 /// - `mem::Allocator`: An interface for allocators.
 /// - `mem::CAllocator`: An allocator backed by `libc`'s allocation functions.
+/// - `mem::RuntimeAllocator`, `mem::StaticCAllocator`: Allocator policies for
+///   containers (runtime dispatch vs. resolved at compile time).
+/// - `mem::ArenaAllocator`: A bump allocator that frees everything at once.
+/// - `mem::PoolAllocator`: A size-class allocator for small, fixed-size blocks.
+/// - `mem::PageAllocator`: An `mmap`-backed allocator for very large buffers.
+/// - `mem::ThresholdAllocator`: Routes large allocations to a
+///   `mem::PageAllocator`.
+/// - `mem::ThreadCacheAllocator`: A general-purpose allocator with per-thread
+///   heaps.
+/// - `mem::TrackingAllocator`: Collects allocation statistics for a parent
+///   allocator.
 ///
 /// ## String
 /// - `String`: A dynamic string buffer.
@@ -0,0 +1,22 @@
+#ifndef BL_CONFIG_H
+#define BL_CONFIG_H
+
+/// Compile-time configuration of the library.
+///
+/// `BL_BOUNDS_CHECKS` is `1` if the index operators of containers (and
+/// `String`) check their bounds, and `0` if they don't; `at()` is always
+/// checked and `getUnchecked()` never is.
+///
+/// ## Note
+/// Defining `BL_UNCHECKED_INDEXING` turns the checks off; the meson option
+/// `bounds_checks` does that for release builds by default (`auto`), or for
+/// every build (`never`). The define has to be the same for the library and
+/// everything including its headers, so it's exported through `bl_dep` (use
+/// that instead of linking against the library directly).
+#if defined(BL_UNCHECKED_INDEXING)
+#define BL_BOUNDS_CHECKS 0
+#else
+#define BL_BOUNDS_CHECKS 1
+#endif
+
+#endif // !BL_CONFIG_H
@@ -1,16 +1,22 @@
 #ifndef BL_DYNAMIC_ARRAY_H
 #define BL_DYNAMIC_ARRAY_H
 
-#include "bl/error.h"           // resetError, BL_THROW
-#include "bl/mem/allocator.h"   // Allocator
-#include "bl/mem/c_allocator.h" // CAllocator
-#include "bl/primitives.h"      // const_cstr, usize, u8
+#include "bl/config.h"            // BL_BOUNDS_CHECKS
+#include "bl/ds/growth_policy.h" // GeometricGrowth, DoublingGrowth
+#include "bl/ds/span.h"          // Span
+#include "bl/error.h"             // resetError, BL_THROW
+#include "bl/mem/allocator.h"     // Allocator, RuntimeAllocator
+#include "bl/mem/c_allocator.h"   // CAllocator
+#include "bl/primitives.h"        // const_cstr, usize, u8
 
 #include <cstdio>
 #include <cstdlib> // abort
-#include <cstring> // memcpy
+#include <cstring> // memcpy, memmove
 #include <initializer_list>
-#include <type_traits>
+#include <iterator>    // distance, iterator_traits, forward_iterator_tag
+#include <new>         // placement new
+#include <type_traits> // is_trivially_copyable, is_trivially_destructible
+#include <utility>     // forward, move
 
 namespace bl::ds {
 using namespace primitives;
@@ -29,42 +35,130 @@ enum class DynamicArrayError {
   MemcpyFailed,
   ResizeFailed,
   IndexOutOfBounds,
+  InvalidRange,
   InvalidPop,
 };
 
 const_cstr            errMsg(DynamicArrayError err);
 extern mem::Allocator DEFAULT_C_ALLOCATOR;
-extern const u8       RESIZE_FACTOR;
+
+/// Returns the allocator used by runtime-dispatched arrays that weren't given
+/// one (see `String` for how it's chosen).
+mem::Allocator*       getDefaultAllocator(void);
+
+/// Returns the allocator used by arrays that weren't given one.
+template <typename Alloc> inline Alloc defaultAllocator(void) {
+  return Alloc();
+}
+
+template <>
+inline mem::RuntimeAllocator defaultAllocator<mem::RuntimeAllocator>(void) {
+  return mem::RuntimeAllocator(getDefaultAllocator());
+}
+
+// The element moves shared by `DynamicArray` and `SmallDynamicArray`.
+
+/// Moves `n` elements from `src` to the uninitialized `dst`, destroying the
+/// originals.
+template <typename T> inline void relocate(T* dst, T* src, usize n) {
+  if constexpr (std::is_trivially_copyable<T>::value) {
+    if (n != 0) {
+      memcpy(dst, src, n * sizeof(T));
+    }
+  } else {
+    for (usize i = 0; i < n; i++) {
+      new (dst + i) T(std::move(src[i]));
+      src[i].~T();
+    }
+  }
+}
+
+/// Copies `n` elements from `src` to the uninitialized `dst`.
+template <typename T> inline void copyInto(T* dst, const T* src, usize n) {
+  if constexpr (std::is_trivially_copyable<T>::value) {
+    if (n != 0) {
+      memcpy(dst, src, n * sizeof(T));
+    }
+  } else {
+    for (usize i = 0; i < n; i++) {
+      new (dst + i) T(src[i]);
+    }
+  }
+}
+
+/// Shifts the elements of `data` (with length `len`) after `idx` to the right
+/// and moves `val` into the gap; there must be space for one more element.
+template <typename T>
+inline void insertAt(T* data, usize len, usize idx, T&& val) {
+  if constexpr (std::is_trivially_copyable<T>::value) {
+    memmove(data + idx + 1, data + idx, (len - idx) * sizeof(T));
+    new (data + idx) T(std::move(val));
+  } else if (idx == len) {
+    new (data + idx) T(std::move(val));
+  } else {
+    new (data + len) T(std::move(data[len - 1]));
+    for (usize i = len - 1; i > idx; i--) {
+      data[i] = std::move(data[i - 1]);
+    }
+    data[idx] = std::move(val);
+  }
+}
 } // namespace dynamic_array_internal
 
-template <typename T> struct DynamicArray {
+/// A dynamic array.
+///
+/// The element buffer is aligned to `Alignment` bytes, which defaults to the
+/// alignment of `T`; pass a bigger alignment (e.g. `32` or `64`) to get buffers
+/// suitable for SIMD loads or that start on a cache line.
+///
+/// Allocations go through the `Alloc` allocator policy. The default
+/// (`mem::RuntimeAllocator`) dispatches through any `mem::Allocator*`; a
+/// policy known at compile time like `mem::StaticCAllocator` gets inlined and
+/// takes no space in the array.
+///
+/// Arrays created without an allocator use `mem::CAllocator`, or
+/// `mem::ThreadCacheAllocator::getGlobal()` if the library was built with
+/// `-Ddefault_allocator=thread_cache`.
+///
+/// Elements are constructed in place and destroyed when they're removed. If
+/// `T` is trivially copyable, elements are moved around with `memcpy`/`memmove`
+/// and the buffer is grown with the allocator's `resizeAligned` (`realloc`);
+/// otherwise they're moved one at a time into a freshly allocated buffer.
+///
+/// How much the capacity grows by is decided by the `Growth` policy (see
+/// `GeometricGrowth`); the default doubles it, starting from a single element.
+template <typename T, usize Alignment = alignof(T),
+          typename Alloc = mem::RuntimeAllocator,
+          typename Growth = DoublingGrowth>
+struct DynamicArray : private Alloc {
+  static_assert((Alignment & (Alignment - 1)) == 0,
+                "DynamicArray: The alignment must be a power of two");
+  static_assert(Alignment >= alignof(T),
+                "DynamicArray: The alignment must be at least `alignof(T)`");
+
 public:
   /// Creates an empty dynamic array with `mem::CAllocator` as its backing
   /// allocator.
   ///
   /// ## Note
   /// Nothing is allocated until the first push.
-  DynamicArray() {
-    this->allocator = &dynamic_array_internal::DEFAULT_C_ALLOCATOR;
-  }
+  DynamicArray() : Alloc(dynamic_array_internal::defaultAllocator<Alloc>()) {}
 
   /// Creates an empty dynamic array backed by the given allocator.
   ///
   /// ## Note
   /// Nothing is allocated until the first push.
-  DynamicArray(mem::Allocator* allocator) {
+  DynamicArray(Alloc allocator) : Alloc(allocator) {
     // Input validation
     {
       Error::resetError();
 
-      if (allocator == nullptr) {
+      if (!allocator.isValid()) {
         BL_THROW(dynamic_array_internal::errMsg(
             dynamic_array_internal::DynamicArrayError::InvalidAllocator));
         return;
       }
     }
-
-    this->allocator = allocator;
   }
 
   /// Creates an empty dynamic array with the specified capacity, backed by the
@@ -72,13 +166,13 @@ public:
   ///
   /// ## Note
   /// If the capacity is `0`, then this just calls the
-  /// `DynamicArray(mem::Allocator*)` constructor (nothing gets allocated).
-  DynamicArray(mem::Allocator* allocator, usize capacity) {
+  /// `DynamicArray(Alloc)` constructor (nothing gets allocated).
+  DynamicArray(Alloc allocator, usize capacity) : Alloc(allocator) {
     // Input validation
     {
       Error::resetError();
 
-      if (allocator == nullptr) {
+      if (!allocator.isValid()) {
         BL_THROW(dynamic_array_internal::errMsg(
             dynamic_array_internal::DynamicArrayError::InvalidAllocator));
         return;
@@ -86,7 +180,7 @@ public:
     }
 
     if (capacity != 0) {
-      T* data = (T*)allocator->allocRaw(capacity * sizeof(T));
+      T* data = (T*)this->allocAligned(capacity * sizeof(T), Alignment);
       if (data == nullptr) {
         BL_THROW(dynamic_array_internal::errMsg(
             dynamic_array_internal::DynamicArrayError::BufferAllocationFailed));
@@ -102,14 +196,13 @@ public:
   ///
   /// ## Note
   /// If the capacity is `0`, then this just calls the
-  /// `DynamicArray(mem::Allocator*)` constructor (nothing gets allocated).
-  DynamicArray(usize capacity) {
+  /// `DynamicArray()` constructor (nothing gets allocated).
+  DynamicArray(usize capacity)
+      : Alloc(dynamic_array_internal::defaultAllocator<Alloc>()) {
     Error::resetError();
 
-    this->allocator = &dynamic_array_internal::DEFAULT_C_ALLOCATOR;
-
     if (capacity != 0) {
-      T* data = (T*)this->allocator->allocRaw(capacity * sizeof(T));
+      T* data = (T*)this->allocAligned(capacity * sizeof(T), Alignment);
       if (data == nullptr) {
         BL_THROW(dynamic_array_internal::errMsg(
             dynamic_array_internal::DynamicArrayError::BufferAllocationFailed));
@@ -122,23 +215,22 @@ public:
 
   /// Creates a dynamic array backed by the given allocator with data from the
   /// initializer list.
-  DynamicArray<T>(mem::Allocator* allocator, std::initializer_list<T> list) {
+  DynamicArray(Alloc allocator, std::initializer_list<T> list)
+      : Alloc(allocator) {
     // Input validation
     {
       Error::resetError();
 
-      if (allocator == nullptr) {
+      if (!allocator.isValid()) {
         BL_THROW(dynamic_array_internal::errMsg(
             dynamic_array_internal::DynamicArrayError::InvalidAllocator));
         return;
       }
     }
 
-    this->allocator       = allocator;
-
     // Allocate buffer for dynamic array
     const usize list_size = list.size();
-    T*          data = (T*)this->allocator->allocRaw(sizeof(T) * list_size);
+    T* data = (T*)this->allocAligned(sizeof(T) * list_size, Alignment);
     if (data == nullptr) {
       BL_THROW(dynamic_array_internal::errMsg(
           dynamic_array_internal::DynamicArrayError::BufferAllocationFailed));
@@ -148,7 +240,7 @@ public:
     // Copy data from given array
     usize idx = 0;
     for (auto& val : list) {
-      data[idx] = val;
+      new (data + idx) T(val);
       ++idx;
     }
 
@@ -159,15 +251,14 @@ public:
 
   /// Creates a dynamic array backed by the `mem::CAllocator` with data from the
   /// initializer list.
-  DynamicArray<T>(std::initializer_list<T> list) {
+  DynamicArray(std::initializer_list<T> list)
+      : Alloc(dynamic_array_internal::defaultAllocator<Alloc>()) {
     // Input validation
     Error::resetError();
 
-    this->allocator       = &dynamic_array_internal::DEFAULT_C_ALLOCATOR;
-
     // Allocate buffer for dynamic array
     const usize list_size = list.size();
-    T*          data = (T*)this->allocator->allocRaw(sizeof(T) * list_size);
+    T* data = (T*)this->allocAligned(sizeof(T) * list_size, Alignment);
     if (data == nullptr) {
       BL_THROW(dynamic_array_internal::errMsg(
           dynamic_array_internal::DynamicArrayError::BufferAllocationFailed));
@@ -177,7 +268,7 @@ public:
     // Copy data from given array
     usize idx = 0;
     for (auto& val : list) {
-      data[idx] = val;
+      new (data + idx) T(val);
       ++idx;
     }
 
@@ -190,15 +281,19 @@ public:
   ///
   /// ## Note
   /// The capacity of the cloned array will not be the same as the orininal's,
-  /// but the length and elements will be the same.
-  DynamicArray(const DynamicArray& other) {
+  /// but the length and elements will be the same. Cloning an empty array
+  /// doesn't allocate anything.
+  DynamicArray(const DynamicArray& other) : Alloc(other) {
     Error::resetError();
 
-    this->allocator = other.allocator;
-    this->len       = other.len;
-    this->cap       = other.len;
+    if (other.len == 0) {
+      return;
+    }
 
-    T* data         = (T*)this->allocator->allocRaw(this->len * sizeof(T));
+    this->len = other.len;
+    this->cap = other.len;
+
+    T* data   = (T*)this->allocAligned(this->len * sizeof(T), Alignment);
     if (data == nullptr) {
       BL_THROW(dynamic_array_internal::errMsg(
           dynamic_array_internal::DynamicArrayError::BufferAllocationFailed));
@@ -206,43 +301,118 @@ public:
     }
     this->data = data;
 
-    T* copied  = memcpy(this->data, other.data, this->len * sizeof(T));
-    if (copied == nullptr) {
-      BL_THROW(dynamic_array_internal::errMsg(
-          dynamic_array_internal::DynamicArrayError::MemcpyFailed));
-      return;
+    if constexpr (std::is_trivially_copyable<T>::value) {
+      T* copied = (T*)memcpy(this->data, other.data, this->len * sizeof(T));
+      if (copied == nullptr) {
+        BL_THROW(dynamic_array_internal::errMsg(
+            dynamic_array_internal::DynamicArrayError::MemcpyFailed));
+        return;
+      }
+      this->data = copied;
+    } else {
+      for (usize i = 0; i < this->len; i++) {
+        new (this->data + i) T(other.data[i]);
+      }
     }
-    this->data = copied;
   }
 
-  /// Deallocates memory used by the array.
-  ~DynamicArray() {
-    if (this->cap != 0) {
-      this->allocator->deallocRaw(this->data);
+  /// Moves the elements of `other` into a new array.
+  ///
+  /// ## Note
+  /// Nothing is allocated or copied; `other` is left empty (with no capacity)
+  /// and can still be used.
+  DynamicArray(DynamicArray&& other)
+      : Alloc(static_cast<Alloc&>(other)), data(other.data), len(other.len),
+        cap(other.cap) {
+    other.data = nullptr;
+    other.len  = 0;
+    other.cap  = 0;
+  }
+
+  /// Destroys the elements and deallocates memory used by the array.
+  ~DynamicArray() { this->release(); }
+
+  /// Replaces the array's elements with clones of the elements of `other`.
+  ///
+  /// ## Error
+  /// - Throws an error if allocator is unable to allocate space for the buffer.
+  DynamicArray& operator=(const DynamicArray& other) {
+    if (this != &other) {
+      DynamicArray copy = DynamicArray(other);
+      *this             = std::move(copy);
     }
+    return *this;
   }
 
-  DynamicArray& operator=(const DynamicArray&) = default;
+  /// Replaces the array's elements with the elements of `other`.
+  ///
+  /// ## Note
+  /// The array's old elements are destroyed and its buffer is deallocated;
+  /// `other` is left empty (with no capacity) and can still be used.
+  DynamicArray& operator=(DynamicArray&& other) {
+    if (this != &other) {
+      this->release();
+      static_cast<Alloc&>(*this) = static_cast<Alloc&>(other);
+      this->data                 = other.data;
+      this->len                  = other.len;
+      this->cap                  = other.cap;
+      other.data                 = nullptr;
+      other.len                  = 0;
+      other.cap                  = 0;
+    }
+    return *this;
+  }
 
   /// Operator overload for index operator.
   ///
+  /// ## Note
+  /// This is only bounds-checked if `BL_BOUNDS_CHECKS` is enabled (see
+  /// `bl/config.h`); use `DynamicArray::at` for an access that is always
+  /// checked.
+  ///
   /// ## Error
   /// - Throws an error if the index is out of the array's bounds.
-  T&            operator[](usize idx) {
-    // Input validation
-    {
-      Error::resetError();
-      if (idx > this->len - 1) {
-        BL_THROW(dynamic_array_internal::errMsg(
-            dynamic_array_internal::DynamicArrayError::IndexOutOfBounds));
-        Error::printErrorTrace();
-        abort();
-      }
-    }
+  T&       operator[](usize idx) {
+#if BL_BOUNDS_CHECKS
+    return this->at(idx);
+#else
+    return this->data[idx];
+#endif
+  }
+
+  const T& operator[](usize idx) const {
+#if BL_BOUNDS_CHECKS
+    return this->at(idx);
+#else
+    return this->data[idx];
+#endif
+  }
 
+  /// Returns the element at the specified index.
+  ///
+  /// ## Note
+  /// The error state is only touched if the index is out of bounds.
+  ///
+  /// ## Error
+  /// - Throws an error if the index is out of the array's bounds.
+  T&       at(usize idx) {
+    this->checkIndex(idx);
     return this->data[idx];
   }
 
+  const T& at(usize idx) const {
+    this->checkIndex(idx);
+    return this->data[idx];
+  }
+
+  /// Returns the element at the specified index without checking the bounds.
+  ///
+  /// ## Note
+  /// The index must be less than the length of the array.
+  T&       getUnchecked(usize idx) { return this->data[idx]; }
+
+  const T& getUnchecked(usize idx) const { return this->data[idx]; }
+
   /// Returns the underlying element buffer.
   const T* getRaw(void) const { return this->data; }
 
@@ -255,44 +425,270 @@ public:
   /// Checks if the array is empty.
   bool     isEmpty(void) const { return this->len == 0; }
 
+  /// Returns the array's allocator policy (e.g. to allocate scratch buffers
+  /// from the same allocator).
+  const Alloc& getAllocator(void) const { return *this; }
+
+  T*       begin(void) { return this->data; }
+
+  T*       end(void) { return this->data + this->len; }
+
+  const T* begin(void) const { return this->data; }
+
+  const T* end(void) const { return this->data + this->len; }
+
+  /// Returns a span of the array's elements.
+  ///
+  /// ## Note
+  /// The span is invalidated when the array is resized or destroyed.
+  Span<T> getSpan(void) { return Span<T>(this->data, this->len); }
+
+  /// Returns a read-only span of the array's elements.
+  Span<const T> getSpan(void) const {
+    return Span<const T>(this->data, this->len);
+  }
+
   /// Removes all of the array's contents, but leaves the capacity unchanged.
   void     clear(void) {
-    // TODO: Call destructor for elements?
+    if constexpr (!std::is_trivially_destructible<T>::value) {
+      for (usize i = 0; i < this->len; i++) {
+        this->data[i].~T();
+      }
+    }
     this->len = 0;
   }
 
-  /// Appends the given value to the end of the array.
-  void push(T val) {
+  /// Appends a copy of the given value to the end of the array.
+  ///
+  /// ## Note
+  /// This can cause a resize if the array does not have enough capacity.
+  ///
+  /// ## Error
+  /// - Throws an error if the array failed to resize.
+  void push(const T& val) {
+    // Copy first, since `val` could be an element of this array
+    if (this->len == this->cap) {
+      this->emplace(T(val));
+      return;
+    }
+    this->emplace(val);
+  }
+
+  /// Moves the given value to the end of the array.
+  ///
+  /// ## Note
+  /// This can cause a resize if the array does not have enough capacity.
+  ///
+  /// ## Error
+  /// - Throws an error if the array failed to resize.
+  void push(T&& val) { this->emplace(std::move(val)); }
+
+  /// Constructs a new element at the end of the array from the given arguments,
+  /// and returns a reference to it.
+  ///
+  /// ## Note
+  /// This can cause a resize if the array does not have enough capacity, so the
+  /// arguments must not refer to elements of the array.
+  ///
+  /// ## Error
+  /// - Throws an error if the array failed to resize (the returned reference
+  /// is invalid in that case).
+  template <typename... Args> T& emplace(Args&&... args) {
     Error::resetError();
 
-    // Allocate on first push
-    if (this->cap == 0) {
-      T* data = (T*)this->allocator->allocRaw(sizeof(T));
-      if (data == nullptr) {
+    // Resize if necessary
+    if (this->len == this->cap) {
+      this->grow(1);
+      if (Error::isError()) {
         BL_THROW(dynamic_array_internal::errMsg(
-            dynamic_array_internal::DynamicArrayError::BufferAllocationFailed));
+            dynamic_array_internal::DynamicArrayError::ResizeFailed));
+        return *this->data;
+      }
+    }
+
+    T* elem    = new (this->data + this->len) T(std::forward<Args>(args)...);
+    this->len += 1;
+    return *elem;
+  }
+
+  /// Appends copies of the `n` elements starting at `src` to the end of the
+  /// array.
+  ///
+  /// ## Note
+  /// The array grows (at most) once; trivially copyable elements are copied
+  /// with a single `memcpy`. `src` may point into the array itself.
+  ///
+  /// ## Error
+  /// - Throws an error if `src` is null (and `n` isn't `0`).
+  /// - Throws an error if the array failed to resize.
+  void extend(const T* src, usize n) {
+    // Input validation
+    {
+      Error::resetError();
+      if (n == 0) {
+        return;
+      }
+      if (src == nullptr) {
+        BL_THROW(dynamic_array_internal::errMsg(
+            dynamic_array_internal::DynamicArrayError::InvalidArray));
         return;
       }
-      this->data = data;
-      this->cap  = 1;
     }
 
-    // Resize if necessary
-    usize new_len = this->len + 1;
-    if (new_len > this->cap) {
-      this->resize();
+    // Resize if necessary (keeping track of `src` if it's in the buffer)
+    if (this->len + n > this->cap) {
+      bool  aliased = src >= this->data && src < this->data + this->len;
+      usize offset  = aliased ? static_cast<usize>(src - this->data) : 0;
+      this->grow(n);
       if (Error::isError()) {
         BL_THROW(dynamic_array_internal::errMsg(
             dynamic_array_internal::DynamicArrayError::ResizeFailed));
         return;
       }
+      if (aliased) {
+        src = this->data + offset;
+      }
+    }
+
+    dynamic_array_internal::copyInto(this->data + this->len, src, n);
+    this->len += n;
+  }
+
+  /// Appends copies of the elements of `other` to the end of the array.
+  ///
+  /// ## Note
+  /// See `DynamicArray::extend(const T*, usize)`.
+  ///
+  /// ## Error
+  /// - Throws an error if the array failed to resize.
+  void extend(const DynamicArray& other) {
+    this->extend(other.data, other.len);
+  }
+
+  /// Appends copies of the elements in the range `[first, last)` to the end of
+  /// the array.
+  ///
+  /// ## Note
+  /// For forward iterators (and pointers), the length of the range is computed
+  /// up front so the array grows (at most) once; input iterators are pushed
+  /// one element at a time. Unlike `DynamicArray::extend(const T*, usize)`,
+  /// the range must not point into the array.
+  ///
+  /// ## Error
+  /// - Throws an error if the array failed to resize.
+  template <typename Iter> void extend(Iter first, Iter last) {
+    typedef typename std::iterator_traits<Iter>::iterator_category Category;
+
+    if constexpr (std::is_base_of<std::forward_iterator_tag, Category>::value) {
+      Error::resetError();
+
+      usize n = static_cast<usize>(std::distance(first, last));
+      if (this->len + n > this->cap) {
+        this->grow(n);
+        if (Error::isError()) {
+          BL_THROW(dynamic_array_internal::errMsg(
+              dynamic_array_internal::DynamicArrayError::ResizeFailed));
+          return;
+        }
+      }
+
+      for (; first != last; ++first) {
+        new (this->data + this->len) T(*first);
+        this->len += 1;
+      }
+    } else {
+      for (; first != last; ++first) {
+        this->push(*first);
+        if (Error::isError()) {
+          return;
+        }
+      }
     }
+  }
+
+  /// Resizes the array to contain `n` elements.
+  ///
+  /// If `n` is smaller than the length, the extra elements are destroyed;
+  /// otherwise copies of `value` are appended.
+  ///
+  /// ## Note
+  /// The capacity grows to exactly `n` if it's too small, and never shrinks.
+  ///
+  /// ## Error
+  /// - Throws an error if the array failed to resize.
+  void resizeTo(usize n, const T& value = T()) {
+    Error::resetError();
 
-    this->data[this->len]  = val;
-    this->len             += 1;
+    if (this->len > n) {
+      this->truncate(n);
+    }
+
+    if (n > this->cap) {
+      // Copy first, since `value` could be an element of this array
+      T copy = value;
+      this->resize(n);
+      if (Error::isError()) {
+        BL_THROW(dynamic_array_internal::errMsg(
+            dynamic_array_internal::DynamicArrayError::ResizeFailed));
+        return;
+      }
+      this->fill(n, copy);
+      return;
+    }
+    this->fill(n, value);
+  }
+
+  /// Makes sure the array has space for at least `capacity` elements in total.
+  ///
+  /// ## Note
+  /// The capacity grows to exactly `capacity` if it's too small, and never
+  /// shrinks; use this before a known number of pushes to avoid repeated
+  /// resizing.
+  ///
+  /// ## Error
+  /// - Throws an error if the array failed to resize.
+  void reserve(usize capacity) {
+    Error::resetError();
+
+    if (capacity > this->cap) {
+      this->resize(capacity);
+      if (Error::isError()) {
+        BL_THROW(dynamic_array_internal::errMsg(
+            dynamic_array_internal::DynamicArrayError::ResizeFailed));
+        return;
+      }
+    }
+  }
+
+  /// Shrinks the capacity of the array to match its length.
+  ///
+  /// ## Note
+  /// The buffer is deallocated if the array is empty.
+  ///
+  /// ## Error
+  /// - Throws an error if the array failed to resize.
+  void shrinkToFit(void) {
+    Error::resetError();
+
+    if (this->cap > this->len) {
+      if (this->len == 0) {
+        this->release();
+        return;
+      }
+
+      this->resize(this->len);
+      if (Error::isError()) {
+        BL_THROW(dynamic_array_internal::errMsg(
+            dynamic_array_internal::DynamicArrayError::ResizeFailed));
+        return;
+      }
+    }
   }
 
   /// Removes and returns the last element in the array.
+  ///
+  /// ## Error
+  /// - Throws an error if the array is empty (and returns `T()`).
   T pop(void) {
     Error::resetError();
 
@@ -302,39 +698,52 @@ public:
       return T();
     }
 
-    T popped   = this->data[this->len - 1];
-    this->len -= 1;
+    T popped = std::move(this->data[this->len - 1]);
+    this->destroyLast();
     return popped;
   }
 
-  // TODO: Update `String`'s `insert` and `remove` functions to shift like these
-  // instead of extra allocations
+  /// Removes the last element in the array, moving it into `out`.
+  ///
+  /// ## Note
+  /// Unlike `DynamicArray::pop(void)`, this doesn't require `T` to be default
+  /// constructible.
+  ///
+  /// ## Error
+  /// - Throws an error if the array is empty (`out` is left unchanged).
+  void pop(T& out) {
+    Error::resetError();
+
+    if (this->len == 0) {
+      BL_THROW(dynamic_array_internal::errMsg(
+          dynamic_array_internal::DynamicArrayError::InvalidPop));
+      return;
+    }
+
+    out = std::move(this->data[this->len - 1]);
+    this->destroyLast();
+  }
 
   /// Inserts the given value at the specified index, shifting all elements
   /// after it to the right.
   ///
   /// ## Note
-  /// This is **O(n)** in the worst case due to the shifting of elements.
+  /// This is **O(n)** in the worst case due to the shifting of elements. An
+  /// index equal to the length appends the value.
   void insert(usize idx, T val) {
     // Input validation
     {
       Error::resetError();
-      if (idx > this->len - 1) {
+      if (idx > this->len) {
         BL_THROW(dynamic_array_internal::errMsg(
             dynamic_array_internal::DynamicArrayError::IndexOutOfBounds));
         return;
       }
     }
 
-    // Just call `push` if index is the last element
-    if (idx == this->len - 1) {
-      this->push(val);
-      return;
-    }
-
     // Resize original buffer if necessary
     if (this->len + 1 > this->cap) {
-      this->resize();
+      this->grow(1);
       if (Error::isError()) {
         BL_THROW(dynamic_array_internal::errMsg(
             dynamic_array_internal::DynamicArrayError::ResizeFailed));
@@ -343,13 +752,78 @@ public:
     }
 
     // Shift all elements after `idx` to the right
-    for (usize i = this->len; i > idx; i--) {
-      this->data[i] = this->data[i - 1];
+    dynamic_array_internal::insertAt(this->data, this->len, idx,
+                                     std::move(val));
+    this->len += 1;
+  }
+
+  /// Inserts copies of the `n` elements starting at `src` at the specified
+  /// index, shifting all elements after it to the right.
+  ///
+  /// ## Note
+  /// The elements are shifted once (with `memmove` for trivially copyable
+  /// types), so this is **O(len + n)**. An index equal to the length appends
+  /// the elements; `src` must not point into the array.
+  ///
+  /// ## Error
+  /// - Throws an error if the index is out of the array's bounds.
+  /// - Throws an error if `src` is null (and `n` isn't `0`).
+  /// - Throws an error if the array failed to resize.
+  void insertRange(usize idx, const T* src, usize n) {
+    // Input validation
+    {
+      Error::resetError();
+      if (idx > this->len) {
+        BL_THROW(dynamic_array_internal::errMsg(
+            dynamic_array_internal::DynamicArrayError::IndexOutOfBounds));
+        return;
+      }
+      if (n == 0) {
+        return;
+      }
+      if (src == nullptr) {
+        BL_THROW(dynamic_array_internal::errMsg(
+            dynamic_array_internal::DynamicArrayError::InvalidArray));
+        return;
+      }
     }
 
-    // Insert value to specified index
-    this->data[idx]  = val;
-    this->len       += 1;
+    // Resize original buffer if necessary
+    if (this->len + n > this->cap) {
+      this->grow(n);
+      if (Error::isError()) {
+        BL_THROW(dynamic_array_internal::errMsg(
+            dynamic_array_internal::DynamicArrayError::ResizeFailed));
+        return;
+      }
+    }
+
+    if constexpr (std::is_trivially_copyable<T>::value) {
+      memmove(this->data + idx + n, this->data + idx,
+              (this->len - idx) * sizeof(T));
+      memcpy(this->data + idx, src, n * sizeof(T));
+    } else {
+      // Shift the tail to the right (slots past the end are uninitialized)
+      for (usize i = this->len; i > idx; i--) {
+        usize to = i - 1 + n;
+        if (to >= this->len) {
+          new (this->data + to) T(std::move(this->data[i - 1]));
+        } else {
+          this->data[to] = std::move(this->data[i - 1]);
+        }
+      }
+
+      // Copy the new elements into the gap
+      for (usize i = 0; i < n; i++) {
+        usize to = idx + i;
+        if (to >= this->len) {
+          new (this->data + to) T(src[i]);
+        } else {
+          this->data[to] = src[i];
+        }
+      }
+    }
+    this->len += n;
   }
 
   /// Removes and returns the element at the specified index, shifting all
@@ -360,29 +834,134 @@ public:
   /// order does not need to be preserved, then `DynamicArray::swapRemove`
   /// should be used instead.
   T remove(usize idx) {
+    T removed = T();
+    this->remove(idx, removed);
+    return removed;
+  }
+
+  /// Removes the element at the specified index, moving it into `out` and
+  /// shifting all elements after it to the left.
+  ///
+  /// ## Note
+  /// This is **O(n)** in the worst case due to the shifting of elements.
+  void remove(usize idx, T& out) {
     // Input validation
     {
       Error::resetError();
-      if (idx > this->len - 1) {
+      if (idx >= this->len) {
         BL_THROW(dynamic_array_internal::errMsg(
             dynamic_array_internal::DynamicArrayError::IndexOutOfBounds));
         abort();
       }
     }
 
-    // Just call `pop` if index is the last element
-    if (idx == this->len - 1) {
-      return this->pop();
+    out = std::move(this->data[idx]);
+
+    // Shift all elements after `idx` to the left
+    if constexpr (std::is_trivially_copyable<T>::value) {
+      memmove(this->data + idx, this->data + idx + 1,
+              (this->len - idx - 1) * sizeof(T));
+      this->len -= 1;
+    } else {
+      for (usize i = idx; i < this->len - 1; i++) {
+        this->data[i] = std::move(this->data[i + 1]);
+      }
+      this->destroyLast();
     }
+  }
 
-    T removed = this->data[idx];
+  /// Removes the elements in the range `[first, last)`, shifting all elements
+  /// after it to the left.
+  ///
+  /// ## Note
+  /// The elements are shifted once (with `memmove` for trivially copyable
+  /// types), so this is **O(len)** regardless of the size of the range.
+  ///
+  /// ## Error
+  /// - Throws an error if the range is out of the array's bounds.
+  void removeRange(usize first, usize last) {
+    // Input validation
+    {
+      Error::resetError();
+      if (first > last || last > this->len) {
+        BL_THROW(dynamic_array_internal::errMsg(
+            dynamic_array_internal::DynamicArrayError::InvalidRange));
+        return;
+      }
+    }
 
-    // Shift all elements after `idx` to the left
-    for (usize i = idx; i < this->len - 1; i++) {
-      this->data[i] = this->data[i + 1];
+    usize n = last - first;
+    if constexpr (std::is_trivially_copyable<T>::value) {
+      memmove(this->data + first, this->data + last,
+              (this->len - last) * sizeof(T));
+      this->len -= n;
+    } else {
+      for (usize i = last; i < this->len; i++) {
+        this->data[i - n] = std::move(this->data[i]);
+      }
+      this->truncate(this->len - n);
+    }
+  }
+
+  /// Keeps only the elements for which `pred(elem)` returns `true`, preserving
+  /// their order.
+  ///
+  /// Returns the number of removed elements.
+  ///
+  /// ## Note
+  /// This compacts the array in a single pass (**O(n)**), instead of removing
+  /// the elements one at a time.
+  template <typename Pred> usize retain(Pred pred) {
+    usize kept = 0;
+    for (usize i = 0; i < this->len; i++) {
+      if (pred(this->data[i])) {
+        if (i != kept) {
+          this->data[kept] = std::move(this->data[i]);
+        }
+        kept++;
+      }
     }
-    this->len -= 1;
 
+    usize removed = this->len - kept;
+    this->truncate(kept);
+    return removed;
+  }
+
+  /// Removes the elements for which `pred(elem)` returns `true`, preserving
+  /// the order of the rest.
+  ///
+  /// Returns the number of removed elements.
+  ///
+  /// ## Note
+  /// See `DynamicArray::retain`.
+  template <typename Pred> usize removeIf(Pred pred) {
+    return this->retain([&](const T& elem) { return !pred(elem); });
+  }
+
+  /// Removes consecutive duplicate elements (compared with `==`), so a sorted
+  /// array ends up with unique elements.
+  ///
+  /// Returns the number of removed elements.
+  ///
+  /// ## Note
+  /// This compacts the array in a single pass (**O(n)**).
+  usize dedupSorted(void) {
+    if (this->len < 2) {
+      return 0;
+    }
+
+    usize kept = 1;
+    for (usize i = 1; i < this->len; i++) {
+      if (!(this->data[i] == this->data[kept - 1])) {
+        if (i != kept) {
+          this->data[kept] = std::move(this->data[i]);
+        }
+        kept++;
+      }
+    }
+
+    usize removed = this->len - kept;
+    this->truncate(kept);
     return removed;
   }
 
@@ -394,55 +973,146 @@ public:
   /// This does not preserve ordering, but is **O(1)**; if order needs to be
   /// preserved, use `DynamicArray::remove` instead;
   T swapRemove(usize idx) {
+    T removed = T();
+    this->swapRemove(idx, removed);
+    return removed;
+  }
+
+  /// Removes the element at the specified index, moving it into `out`.
+  ///
+  /// The removed element is replaced by the last element of the array.
+  ///
+  /// ## Note
+  /// This does not preserve ordering, but is **O(1)**.
+  void swapRemove(usize idx, T& out) {
     // Input validation
     {
       Error::resetError();
-      if (idx > this->len - 1) {
+      if (idx >= this->len) {
         BL_THROW(dynamic_array_internal::errMsg(
             dynamic_array_internal::DynamicArrayError::IndexOutOfBounds));
         abort();
       }
     }
 
-    // Just call `pop` if index is the last element
-    if (idx == this->len - 1) {
-      return this->pop();
-    }
-
-    T removed        = this->data[idx];
-
-    // Replace the indexc
-    this->data[idx]  = this->data[this->len - 1];
-    this->len       -= 1;
+    out = std::move(this->data[idx]);
 
-    return removed;
+    // Replace the removed element with the last one
+    if (idx != this->len - 1) {
+      this->data[idx] = std::move(this->data[this->len - 1]);
+    }
+    this->destroyLast();
   }
 
 private:
-  /// Backing allocator used for internal allocations.
-  mem::Allocator* allocator;
-
   /// The actual element buffer.
-  T*              data = nullptr;
+  T*    data = nullptr;
 
   /// The length of the array.
-  usize           len  = 0;
+  usize len  = 0;
 
   /// The capacity of the array.
-  usize           cap  = 0;
-
-  /// Function to resize the array.
-  void            resize(void) {
-    // Resize the buffer to new capacity
-    usize new_cap = this->cap * dynamic_array_internal::RESIZE_FACTOR;
-    T*    resized =
-        (T*)this->allocator->resizeRaw(this->data, new_cap * sizeof(T));
-    if (resized == nullptr) {
+  usize cap  = 0;
+
+  /// Aborts if the index is out of the array's bounds.
+  void checkIndex(usize idx) const {
+    if (idx >= this->len) {
+      Error::resetError();
       BL_THROW(dynamic_array_internal::errMsg(
-          dynamic_array_internal::DynamicArrayError::BufferResizeFailed));
+          dynamic_array_internal::DynamicArrayError::IndexOutOfBounds));
+      Error::printErrorTrace();
+      abort();
+    }
+  }
+
+  /// Destroys the last element and shrinks the length by one.
+  void  destroyLast(void) {
+    this->len -= 1;
+    if constexpr (!std::is_trivially_destructible<T>::value) {
+      this->data[this->len].~T();
+    }
+  }
+
+  /// Appends copies of `value` until the array has `n` elements (the capacity
+  /// must already be big enough).
+  void fill(usize n, const T& value) {
+    for (; this->len < n; this->len++) {
+      new (this->data + this->len) T(value);
+    }
+  }
+
+  /// Destroys the elements past `new_len`.
+  void truncate(usize new_len) {
+    if constexpr (!std::is_trivially_destructible<T>::value) {
+      for (usize i = new_len; i < this->len; i++) {
+        this->data[i].~T();
+      }
+    }
+    this->len = new_len;
+  }
+
+  /// Destroys the elements and deallocates the buffer.
+  void release(void) {
+    this->clear();
+    if (this->cap != 0) {
+      this->deallocSized(this->data, this->cap * sizeof(T), Alignment);
+    }
+    this->data = nullptr;
+    this->cap  = 0;
+  }
+
+  /// Makes space for at least `n` more elements, as decided by the `Growth`
+  /// policy.
+  void grow(usize n) {
+    this->resize(Growth::nextCapacity(this->cap, this->len + n, sizeof(T)));
+  }
+
+  /// Function to resize the array to the given capacity.
+  void resize(usize new_cap) {
+    // Allocate on first push
+    if (this->cap == 0) {
+      T* data = (T*)this->allocAligned(new_cap * sizeof(T), Alignment);
+      if (data == nullptr) {
+        BL_THROW(dynamic_array_internal::errMsg(
+            dynamic_array_internal::DynamicArrayError::BufferAllocationFailed));
+        return;
+      }
+      this->data = data;
+      this->cap  = new_cap;
       return;
     }
 
+    // Try to grow the buffer in place first (shrinking in place wouldn't give
+    // any memory back)
+    if (new_cap > this->cap &&
+        this->tryExpand(this->data, this->cap * sizeof(T),
+                        new_cap * sizeof(T))) {
+      this->cap = new_cap;
+      return;
+    }
+
+    // Otherwise resize the buffer to new capacity
+    T* resized = nullptr;
+    if constexpr (std::is_trivially_copyable<T>::value) {
+      resized = (T*)this->resizeAligned(this->data, this->cap * sizeof(T),
+                                        new_cap * sizeof(T), Alignment);
+      if (resized == nullptr) {
+        BL_THROW(dynamic_array_internal::errMsg(
+            dynamic_array_internal::DynamicArrayError::BufferResizeFailed));
+        return;
+      }
+    } else {
+      // Elements can't be relocated bytewise, so move them one at a time
+      resized = (T*)this->allocAligned(new_cap * sizeof(T), Alignment);
+      if (resized == nullptr) {
+        BL_THROW(dynamic_array_internal::errMsg(
+            dynamic_array_internal::DynamicArrayError::BufferResizeFailed));
+        return;
+      }
+      dynamic_array_internal::relocate(resized, this->data, this->len);
+      this->deallocSized(this->data, this->cap * sizeof(T), Alignment);
+    }
+
     // Set the buffer to the resized one
     this->data = resized;
     this->cap  = new_cap;
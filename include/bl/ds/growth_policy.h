@@ -0,0 +1,93 @@
+#ifndef BL_GROWTH_POLICY_H
+#define BL_GROWTH_POLICY_H
+
+#include "bl/primitives.h" // usize
+
+namespace bl::ds {
+using namespace primitives;
+
+/// Growth policies decide how much a container's capacity grows by when it
+/// runs out of space.
+///
+/// A growth policy is any type with a static function:
+/// - `usize nextCapacity(usize cap, usize required, usize elem_size)`
+///
+/// which returns the new capacity (in elements) for a buffer of `cap` elements
+/// of `elem_size` bytes that needs space for at least `required` elements; the
+/// returned capacity must be at least `required`.
+///
+/// Policies are resolved at compile time and take no space in the container.
+
+/// A geometric growth policy.
+///
+/// The capacity is multiplied by `FactorNum / FactorDen` (e.g. `3 / 2` for a
+/// factor of 1.5), and then adjusted:
+/// - The buffer is at least `MinBytes` bytes (e.g. `64` so the first
+///   allocation fills a cache line instead of holding a single element).
+/// - If `MaxStepBytes` isn't `0`, a single step grows the buffer by at most
+///   `MaxStepBytes` bytes, which bounds the memory wasted by big buffers.
+/// - If `RoundToPages` is set, buffers of a page or more are rounded up to a
+///   multiple of `PAGE_SIZE` bytes (allocators backed by `mmap` hand out whole
+///   pages anyway).
+///
+/// ## Note
+/// The capacity always grows to at least the required capacity, regardless of
+/// the settings above.
+template <usize FactorNum = 2, usize FactorDen = 1, usize MinBytes = 0,
+          usize MaxStepBytes = 0, bool RoundToPages = false>
+struct GeometricGrowth {
+  static_assert(FactorDen != 0 && FactorNum > FactorDen,
+                "GeometricGrowth: The growth factor must be bigger than one");
+
+public:
+  /// The page size used for rounding.
+  static const usize PAGE_SIZE = 4096;
+
+  static inline usize nextCapacity(usize cap, usize required, usize elem_size) {
+    usize new_cap = cap * FactorNum / FactorDen;
+
+    // Limit the additive step
+    if constexpr (MaxStepBytes != 0) {
+      usize max_step = MaxStepBytes / elem_size;
+      max_step       = max_step == 0 ? 1 : max_step;
+      if (new_cap - cap > max_step) {
+        new_cap = cap + max_step;
+      }
+    }
+
+    if (new_cap < required) {
+      new_cap = required;
+    }
+
+    // Start with (at least) `MinBytes`
+    if constexpr (MinBytes != 0) {
+      if (new_cap * elem_size < MinBytes) {
+        new_cap = (MinBytes + elem_size - 1) / elem_size;
+      }
+    }
+
+    // Round big buffers up to whole pages
+    if constexpr (RoundToPages) {
+      usize nbytes = new_cap * elem_size;
+      if (nbytes >= PAGE_SIZE) {
+        nbytes  = (nbytes + PAGE_SIZE - 1) & ~(PAGE_SIZE - 1);
+        new_cap = nbytes / elem_size;
+      }
+    }
+
+    return new_cap;
+  }
+};
+
+/// The default growth policy: doubles the capacity, starting from a single
+/// element.
+typedef GeometricGrowth<>                                     DoublingGrowth;
+
+/// A growth policy that favours memory over fewer reallocations: grows by 1.5x
+/// starting from a cache line, at most 64MiB at a time, and rounds big buffers
+/// to whole pages.
+typedef GeometricGrowth<3, 2, 64, usize(64) * 1024 * 1024, true> CompactGrowth;
+
+} // namespace bl::ds
+
+#endif // !BL_GROWTH_POLICY_H
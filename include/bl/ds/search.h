@@ -0,0 +1,285 @@
+#ifndef BL_SEARCH_H
+#define BL_SEARCH_H
+
+#include "bl/error.h"      // resetError, BL_THROW
+#include "bl/primitives.h" // const_cstr, usize, u8, u32, u64, i32, i64, f32
+
+#include <type_traits> // conditional, is_floating_point, is_signed, remove_cv
+#include <utility>     // declval
+
+/// Linear scans over contiguous ranges.
+///
+/// Every function takes a range: anything with `begin()`/`end()` returning
+/// pointers, like `ds::DynamicArray`, `ds::SmallDynamicArray` or `ds::Span`.
+///
+/// Ranges of `u8`, `u32`, `i32` and `f32` are scanned with vectorized kernels
+/// (AVX2 if the CPU supports it, SSE2 otherwise, chosen once at runtime);
+/// other element types, and non-x86 targets, use plain loops.
+namespace bl::ds {
+using namespace primitives;
+
+/// The index returned by `ds::indexOf` if the value wasn't found.
+const usize NOT_FOUND = ~usize(0);
+
+namespace search_internal {
+enum class SearchError {
+  EmptyRange,
+};
+
+const_cstr errMsg(SearchError err);
+
+/// The element type of a range (without `const`).
+template <typename Range>
+using Elem = typename std::remove_cv<typename std::remove_reference<
+    decltype(*std::declval<const Range&>().begin())>::type>::type;
+
+/// The type sums of `T`s are returned as: integers are widened to 64 bits,
+/// floating-point numbers keep their type.
+template <typename T>
+using SumType = typename std::conditional<
+    std::is_floating_point<T>::value, T,
+    typename std::conditional<std::is_signed<T>::value, i64, u64>::type>::type;
+
+/// Whether there are vectorized kernels for `T`.
+template <typename T> struct IsVectorized : std::false_type {};
+template <> struct IsVectorized<u8> : std::true_type {};
+template <> struct IsVectorized<u32> : std::true_type {};
+template <> struct IsVectorized<i32> : std::true_type {};
+template <> struct IsVectorized<f32> : std::true_type {};
+
+// Vectorized kernels
+usize indexOf(const u8* data, usize len, u8 val);
+usize indexOf(const u32* data, usize len, u32 val);
+usize indexOf(const i32* data, usize len, i32 val);
+usize indexOf(const f32* data, usize len, f32 val);
+
+usize count(const u8* data, usize len, u8 val);
+usize count(const u32* data, usize len, u32 val);
+usize count(const i32* data, usize len, i32 val);
+usize count(const f32* data, usize len, f32 val);
+
+u8    min(const u8* data, usize len);
+u32   min(const u32* data, usize len);
+i32   min(const i32* data, usize len);
+f32   min(const f32* data, usize len);
+
+u8    max(const u8* data, usize len);
+u32   max(const u32* data, usize len);
+i32   max(const i32* data, usize len);
+f32   max(const f32* data, usize len);
+
+u64   sum(const u8* data, usize len);
+u64   sum(const u32* data, usize len);
+i64   sum(const i32* data, usize len);
+f32   sum(const f32* data, usize len);
+
+/// Returns the position of the first occurrence of the `needle_len` bytes of
+/// `needle` in the `hay_len` bytes of `hay`, or `ds::NOT_FOUND` if there is
+/// none (an empty needle is found at `0`).
+///
+/// The haystack is scanned with a vectorized filter (only positions where the
+/// needle's first and last bytes both match are compared in full); once the
+/// comparisons cost too much (long needles with many candidates, periodic
+/// inputs), and on targets without vectorized kernels, the rest is searched
+/// with the Two-Way algorithm, so this is linear in the length of the
+/// haystack regardless of the needle.
+usize findBytes(const u8* hay, usize hay_len, const u8* needle,
+                usize needle_len);
+
+/// Returns the position of the last occurrence of the `needle_len` bytes of
+/// `needle` in the `hay_len` bytes of `hay`, or `ds::NOT_FOUND` if there is
+/// none (an empty needle is found at `hay_len`).
+usize rfindBytes(const u8* hay, usize hay_len, const u8* needle,
+                 usize needle_len);
+
+/// Returns the number of non-overlapping occurrences of the `needle_len`
+/// bytes of `needle` in the `hay_len` bytes of `hay` (`0` for an empty
+/// needle), in a single scan.
+usize countBytes(const u8* hay, usize hay_len, const u8* needle,
+                 usize needle_len);
+
+/// Selects the instruction set the vectorized kernels use.
+enum class Isa {
+  Scalar,
+  Sse2,
+  Avx2,
+};
+
+/// Returns the instruction set the vectorized kernels use (the best one the
+/// CPU supports, unless `setIsa` was called).
+Isa  getIsa(void);
+
+/// Makes the vectorized kernels use the given instruction set (to compare or
+/// test them); returns `false` (and changes nothing) if the CPU or target
+/// doesn't support it.
+///
+/// ## Note
+/// This must not be called while other threads use the kernels.
+bool setIsa(Isa isa);
+
+/// Throws an error if the range is empty.
+inline bool checkNotEmpty(usize len) {
+  Error::resetError();
+  if (len == 0) {
+    BL_THROW(errMsg(SearchError::EmptyRange));
+    return false;
+  }
+  return true;
+}
+
+// Plain loops, for types without vectorized kernels (and the tails of the
+// vectorized ones)
+template <typename T>
+inline usize scalarIndexOf(const T* data, usize len, const T& val) {
+  for (usize i = 0; i < len; i++) {
+    if (data[i] == val) {
+      return i;
+    }
+  }
+  return NOT_FOUND;
+}
+
+template <typename T>
+inline usize scalarCount(const T* data, usize len, const T& val) {
+  usize n = 0;
+  for (usize i = 0; i < len; i++) {
+    n += data[i] == val ? 1 : 0;
+  }
+  return n;
+}
+
+template <typename T> inline T scalarMin(const T* data, usize len) {
+  T smallest = data[0];
+  for (usize i = 1; i < len; i++) {
+    smallest = data[i] < smallest ? data[i] : smallest;
+  }
+  return smallest;
+}
+
+template <typename T> inline T scalarMax(const T* data, usize len) {
+  T biggest = data[0];
+  for (usize i = 1; i < len; i++) {
+    biggest = biggest < data[i] ? data[i] : biggest;
+  }
+  return biggest;
+}
+
+template <typename T> inline SumType<T> scalarSum(const T* data, usize len) {
+  SumType<T> total = 0;
+  for (usize i = 0; i < len; i++) {
+    total += data[i];
+  }
+  return total;
+}
+} // namespace search_internal
+
+/// Returns the index of the first element equal to `val`, or
+/// `ds::NOT_FOUND` if there is none.
+template <typename Range>
+usize indexOf(const Range& range, const search_internal::Elem<Range>& val) {
+  typedef search_internal::Elem<Range> T;
+
+  const T* data = range.begin();
+  usize    len  = static_cast<usize>(range.end() - data);
+  if constexpr (search_internal::IsVectorized<T>::value) {
+    return search_internal::indexOf(data, len, val);
+  } else {
+    return search_internal::scalarIndexOf(data, len, val);
+  }
+}
+
+/// Checks if the range contains an element equal to `val`.
+template <typename Range>
+bool contains(const Range& range, const search_internal::Elem<Range>& val) {
+  return indexOf(range, val) != NOT_FOUND;
+}
+
+/// Returns the number of elements equal to `val`.
+template <typename Range>
+usize count(const Range& range, const search_internal::Elem<Range>& val) {
+  typedef search_internal::Elem<Range> T;
+
+  const T* data = range.begin();
+  usize    len  = static_cast<usize>(range.end() - data);
+  if constexpr (search_internal::IsVectorized<T>::value) {
+    return search_internal::count(data, len, val);
+  } else {
+    return search_internal::scalarCount(data, len, val);
+  }
+}
+
+/// Returns the smallest element of the range.
+///
+/// ## Note
+/// The result is unspecified if the range contains a NaN.
+///
+/// ## Error
+/// - Throws an error if the range is empty (and returns `T()`).
+template <typename Range>
+search_internal::Elem<Range> min(const Range& range) {
+  typedef search_internal::Elem<Range> T;
+
+  const T* data = range.begin();
+  usize    len  = static_cast<usize>(range.end() - data);
+  if (!search_internal::checkNotEmpty(len)) {
+    return T();
+  }
+
+  if constexpr (search_internal::IsVectorized<T>::value) {
+    return search_internal::min(data, len);
+  } else {
+    return search_internal::scalarMin(data, len);
+  }
+}
+
+/// Returns the biggest element of the range.
+///
+/// ## Note
+/// The result is unspecified if the range contains a NaN.
+///
+/// ## Error
+/// - Throws an error if the range is empty (and returns `T()`).
+template <typename Range>
+search_internal::Elem<Range> max(const Range& range) {
+  typedef search_internal::Elem<Range> T;
+
+  const T* data = range.begin();
+  usize    len  = static_cast<usize>(range.end() - data);
+  if (!search_internal::checkNotEmpty(len)) {
+    return T();
+  }
+
+  if constexpr (search_internal::IsVectorized<T>::value) {
+    return search_internal::max(data, len);
+  } else {
+    return search_internal::scalarMax(data, len);
+  }
+}
+
+/// Returns the sum of the elements of an arithmetic range (`0` if it's
+/// empty).
+///
+/// Integers are summed as 64-bit integers.
+///
+/// ## Note
+/// Floating-point elements are summed in several interleaved partial sums,
+/// so the result can differ (in the last bits) from a sequential loop.
+template <typename Range>
+search_internal::SumType<search_internal::Elem<Range>>
+sum(const Range& range) {
+  typedef search_internal::Elem<Range> T;
+  static_assert(std::is_arithmetic<T>::value,
+                "sum is only defined for arithmetic types");
+
+  const T* data = range.begin();
+  usize    len  = static_cast<usize>(range.end() - data);
+  if constexpr (search_internal::IsVectorized<T>::value) {
+    return search_internal::sum(data, len);
+  } else {
+    return search_internal::scalarSum(data, len);
+  }
+}
+
+} // namespace bl::ds
+
+#endif // !BL_SEARCH_H
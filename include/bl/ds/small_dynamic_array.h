@@ -0,0 +1,628 @@
+#ifndef BL_SMALL_DYNAMIC_ARRAY_H
+#define BL_SMALL_DYNAMIC_ARRAY_H
+
+#include "bl/config.h"            // BL_BOUNDS_CHECKS
+#include "bl/ds/dynamic_array.h" // dynamic_array_internal
+#include "bl/ds/growth_policy.h" // DoublingGrowth
+#include "bl/ds/span.h"          // Span
+#include "bl/error.h"            // resetError, BL_THROW
+#include "bl/mem/allocator.h"    // RuntimeAllocator
+#include "bl/primitives.h"       // usize, u8
+
+#include <cstdlib> // abort
+#include <cstring> // memcpy, memmove
+#include <initializer_list>
+#include <new>         // placement new
+#include <type_traits> // is_trivially_copyable, is_trivially_destructible
+#include <utility>     // forward, move
+
+namespace bl::ds {
+using namespace primitives;
+
+/// A dynamic array that stores up to `N` elements inside the object itself.
+///
+/// Short arrays never touch the allocator; once the array outgrows its inline
+/// storage, the elements are moved to a buffer from the `Alloc` allocator
+/// policy (see `DynamicArray`) and it behaves like a regular dynamic array;
+/// the elements are shifted and copied with the same helpers, so insertion and
+/// extension (including from the array itself) work the same way.
+///
+/// ## Note
+/// Pointers and references to elements are invalidated when the array is
+/// moved, since inline elements move with it.
+template <typename T, usize N, typename Alloc = mem::RuntimeAllocator,
+          typename Growth = DoublingGrowth>
+struct SmallDynamicArray : private Alloc {
+  static_assert(N > 0, "SmallDynamicArray: The inline capacity can't be zero");
+
+public:
+  /// Creates an empty array with `mem::CAllocator` as its backing allocator
+  /// (for when it outgrows the inline storage).
+  SmallDynamicArray()
+      : Alloc(dynamic_array_internal::defaultAllocator<Alloc>()) {}
+
+  /// Creates an empty array backed by the given allocator.
+  ///
+  /// ## Note
+  /// Nothing is allocated until the array outgrows its inline storage.
+  ///
+  /// ## Error
+  /// - Throws an error if the provided allocator is invalid.
+  SmallDynamicArray(Alloc allocator) : Alloc(allocator) {
+    // Input validation
+    {
+      Error::resetError();
+
+      if (!allocator.isValid()) {
+        BL_THROW(dynamic_array_internal::errMsg(
+            dynamic_array_internal::DynamicArrayError::InvalidAllocator));
+        return;
+      }
+    }
+  }
+
+  /// Creates an array backed by the given allocator with data from the
+  /// initializer list.
+  ///
+  /// ## Error
+  /// - Throws an error if the provided allocator is invalid.
+  /// - Throws an error if allocator is unable to allocate space for the buffer.
+  SmallDynamicArray(Alloc allocator, std::initializer_list<T> list)
+      : SmallDynamicArray(allocator) {
+    if (Error::isError()) {
+      return;
+    }
+    this->extend(list.begin(), list.size());
+  }
+
+  /// Creates an array backed by the `mem::CAllocator` with data from the
+  /// initializer list.
+  ///
+  /// ## Error
+  /// - Throws an error if allocator is unable to allocate space for the buffer.
+  SmallDynamicArray(std::initializer_list<T> list) : SmallDynamicArray() {
+    this->extend(list.begin(), list.size());
+  }
+
+  /// Clones the array.
+  ///
+  /// ## Error
+  /// - Throws an error if allocator is unable to allocate space for the buffer.
+  SmallDynamicArray(const SmallDynamicArray& other) : Alloc(other) {
+    this->extend(other.data, other.len);
+  }
+
+  /// Moves the elements of `other` into a new array.
+  ///
+  /// ## Note
+  /// A spilled buffer is taken over as is, inline elements are moved one by
+  /// one; `other` is left empty and can still be used.
+  SmallDynamicArray(SmallDynamicArray&& other) : Alloc(other) {
+    this->take(other);
+  }
+
+  /// Destroys the elements and deallocates memory used by the array.
+  ~SmallDynamicArray() { this->release(); }
+
+  /// Replaces the array's elements with clones of the elements of `other`.
+  ///
+  /// ## Error
+  /// - Throws an error if allocator is unable to allocate space for the buffer.
+  SmallDynamicArray& operator=(const SmallDynamicArray& other) {
+    if (this != &other) {
+      SmallDynamicArray copy = SmallDynamicArray(other);
+      *this                  = std::move(copy);
+    }
+    return *this;
+  }
+
+  /// Replaces the array's elements with the elements of `other`.
+  SmallDynamicArray& operator=(SmallDynamicArray&& other) {
+    if (this != &other) {
+      this->release();
+      static_cast<Alloc&>(*this) = static_cast<Alloc&>(other);
+      this->take(other);
+    }
+    return *this;
+  }
+
+  /// Operator overload for index operator.
+  ///
+  /// ## Note
+  /// This is only bounds-checked if `BL_BOUNDS_CHECKS` is enabled (see
+  /// `bl/config.h`); use `SmallDynamicArray::at` for an access that is always
+  /// checked.
+  ///
+  /// ## Error
+  /// - Throws an error if the index is out of the array's bounds.
+  T&       operator[](usize idx) {
+#if BL_BOUNDS_CHECKS
+    return this->at(idx);
+#else
+    return this->data[idx];
+#endif
+  }
+
+  const T& operator[](usize idx) const {
+#if BL_BOUNDS_CHECKS
+    return this->at(idx);
+#else
+    return this->data[idx];
+#endif
+  }
+
+  /// Returns the element at the specified index.
+  ///
+  /// ## Note
+  /// The error state is only touched if the index is out of bounds.
+  ///
+  /// ## Error
+  /// - Throws an error if the index is out of the array's bounds.
+  T&       at(usize idx) {
+    this->checkIndex(idx);
+    return this->data[idx];
+  }
+
+  const T& at(usize idx) const {
+    this->checkIndex(idx);
+    return this->data[idx];
+  }
+
+  /// Returns the element at the specified index without checking the bounds.
+  ///
+  /// ## Note
+  /// The index must be less than the length of the array.
+  T&       getUnchecked(usize idx) { return this->data[idx]; }
+
+  const T& getUnchecked(usize idx) const { return this->data[idx]; }
+
+  /// Returns the underlying element buffer.
+  const T* getRaw(void) const { return this->data; }
+
+  /// Returns the length of the array.
+  usize    getLen(void) const { return this->len; }
+
+  /// Returns the capacity of the array (at least `N`).
+  usize    getCap(void) const { return this->cap; }
+
+  /// Checks if the array is empty.
+  bool     isEmpty(void) const { return this->len == 0; }
+
+  /// Returns the array's allocator policy (e.g. to allocate scratch buffers
+  /// from the same allocator).
+  const Alloc& getAllocator(void) const { return *this; }
+
+  T*       begin(void) { return this->data; }
+
+  T*       end(void) { return this->data + this->len; }
+
+  const T* begin(void) const { return this->data; }
+
+  const T* end(void) const { return this->data + this->len; }
+
+  /// Returns a span of the array's elements.
+  ///
+  /// ## Note
+  /// The span is invalidated when the array is resized or destroyed.
+  Span<T> getSpan(void) { return Span<T>(this->data, this->len); }
+
+  /// Returns a read-only span of the array's elements.
+  Span<const T> getSpan(void) const {
+    return Span<const T>(this->data, this->len);
+  }
+
+  /// Checks if the elements are stored inside the array itself.
+  bool     isInline(void) const { return this->data == this->inlineData(); }
+
+  /// Removes all of the array's contents, but leaves the capacity unchanged.
+  void     clear(void) {
+    if constexpr (!std::is_trivially_destructible<T>::value) {
+      for (usize i = 0; i < this->len; i++) {
+        this->data[i].~T();
+      }
+    }
+    this->len = 0;
+  }
+
+  /// Appends a copy of the given value to the end of the array.
+  ///
+  /// ## Note
+  /// This moves the elements to the allocator if the inline storage is full.
+  ///
+  /// ## Error
+  /// - Throws an error if the array failed to resize.
+  void push(const T& val) {
+    // Copy first, since `val` could be an element of this array
+    if (this->len == this->cap) {
+      this->emplace(T(val));
+      return;
+    }
+    this->emplace(val);
+  }
+
+  /// Moves the given value to the end of the array.
+  ///
+  /// ## Error
+  /// - Throws an error if the array failed to resize.
+  void push(T&& val) { this->emplace(std::move(val)); }
+
+  /// Constructs a new element at the end of the array from the given arguments,
+  /// and returns a reference to it.
+  ///
+  /// ## Note
+  /// The arguments must not refer to elements of the array.
+  ///
+  /// ## Error
+  /// - Throws an error if the array failed to resize (the returned reference
+  /// is invalid in that case).
+  template <typename... Args> T& emplace(Args&&... args) {
+    Error::resetError();
+
+    // Resize if necessary
+    if (this->len == this->cap) {
+      this->grow(1);
+      if (Error::isError()) {
+        BL_THROW(dynamic_array_internal::errMsg(
+            dynamic_array_internal::DynamicArrayError::ResizeFailed));
+        return *this->data;
+      }
+    }
+
+    T* elem    = new (this->data + this->len) T(std::forward<Args>(args)...);
+    this->len += 1;
+    return *elem;
+  }
+
+  /// Appends copies of the `n` elements starting at `src` to the end of the
+  /// array.
+  ///
+  /// ## Note
+  /// The array grows (at most) once. `src` may point into the array itself
+  /// (see `DynamicArray::extend(const T*, usize)`).
+  ///
+  /// ## Error
+  /// - Throws an error if `src` is null (and `n` isn't `0`).
+  /// - Throws an error if the array failed to resize.
+  void extend(const T* src, usize n) {
+    // Input validation
+    {
+      Error::resetError();
+      if (n == 0) {
+        return;
+      }
+      if (src == nullptr) {
+        BL_THROW(dynamic_array_internal::errMsg(
+            dynamic_array_internal::DynamicArrayError::InvalidArray));
+        return;
+      }
+    }
+
+    // Resize if necessary (keeping track of `src` if it's in the buffer)
+    if (this->len + n > this->cap) {
+      bool  aliased = src >= this->data && src < this->data + this->len;
+      usize offset  = aliased ? static_cast<usize>(src - this->data) : 0;
+      this->grow(n);
+      if (Error::isError()) {
+        BL_THROW(dynamic_array_internal::errMsg(
+            dynamic_array_internal::DynamicArrayError::ResizeFailed));
+        return;
+      }
+      if (aliased) {
+        src = this->data + offset;
+      }
+    }
+
+    dynamic_array_internal::copyInto(this->data + this->len, src, n);
+    this->len += n;
+  }
+
+  /// Makes sure the array has space for at least `capacity` elements in total.
+  ///
+  /// ## Error
+  /// - Throws an error if the array failed to resize.
+  void reserve(usize capacity) {
+    Error::resetError();
+
+    if (capacity > this->cap) {
+      this->resize(capacity);
+      if (Error::isError()) {
+        BL_THROW(dynamic_array_internal::errMsg(
+            dynamic_array_internal::DynamicArrayError::ResizeFailed));
+        return;
+      }
+    }
+  }
+
+  /// Shrinks the capacity of the array to match its length, moving the
+  /// elements back into the inline storage if they fit.
+  ///
+  /// ## Error
+  /// - Throws an error if the array failed to resize.
+  void shrinkToFit(void) {
+    Error::resetError();
+
+    if (this->isInline() || this->cap == this->len) {
+      return;
+    }
+
+    if (this->len <= N) {
+      T* heap = this->data;
+      dynamic_array_internal::relocate(this->inlineData(), heap, this->len);
+      this->deallocSized(heap, this->cap * sizeof(T), alignof(T));
+      this->data = this->inlineData();
+      this->cap  = N;
+      return;
+    }
+
+    this->resize(this->len);
+    if (Error::isError()) {
+      BL_THROW(dynamic_array_internal::errMsg(
+          dynamic_array_internal::DynamicArrayError::ResizeFailed));
+      return;
+    }
+  }
+
+  /// Removes and returns the last element in the array.
+  ///
+  /// ## Error
+  /// - Throws an error if the array is empty (and returns `T()`).
+  T pop(void) {
+    T popped = T();
+    this->pop(popped);
+    return popped;
+  }
+
+  /// Removes the last element in the array, moving it into `out`.
+  ///
+  /// ## Error
+  /// - Throws an error if the array is empty (`out` is left unchanged).
+  void pop(T& out) {
+    Error::resetError();
+
+    if (this->len == 0) {
+      BL_THROW(dynamic_array_internal::errMsg(
+          dynamic_array_internal::DynamicArrayError::InvalidPop));
+      return;
+    }
+
+    out = std::move(this->data[this->len - 1]);
+    this->destroyLast();
+  }
+
+  /// Inserts the given value at the specified index, shifting all elements
+  /// after it to the right.
+  ///
+  /// ## Note
+  /// This is **O(n)** in the worst case due to the shifting of elements; an
+  /// index equal to the length appends the value.
+  ///
+  /// ## Error
+  /// - Throws an error if the index is out of the array's bounds.
+  /// - Throws an error if the array failed to resize.
+  void insert(usize idx, T val) {
+    // Input validation
+    {
+      Error::resetError();
+      if (idx > this->len) {
+        BL_THROW(dynamic_array_internal::errMsg(
+            dynamic_array_internal::DynamicArrayError::IndexOutOfBounds));
+        return;
+      }
+    }
+
+    // Resize if necessary
+    if (this->len == this->cap) {
+      this->grow(1);
+      if (Error::isError()) {
+        BL_THROW(dynamic_array_internal::errMsg(
+            dynamic_array_internal::DynamicArrayError::ResizeFailed));
+        return;
+      }
+    }
+
+    // Shift all elements after `idx` to the right
+    dynamic_array_internal::insertAt(this->data, this->len, idx,
+                                     std::move(val));
+    this->len += 1;
+  }
+
+  /// Removes and returns the element at the specified index, shifting all
+  /// elements after it to the left.
+  ///
+  /// ## Error
+  /// - Throws an error if the index is out of the array's bounds.
+  T remove(usize idx) {
+    T removed = T();
+    this->remove(idx, removed);
+    return removed;
+  }
+
+  /// Removes the element at the specified index, moving it into `out` and
+  /// shifting all elements after it to the left.
+  ///
+  /// ## Error
+  /// - Throws an error if the index is out of the array's bounds.
+  void remove(usize idx, T& out) {
+    // Input validation
+    {
+      Error::resetError();
+      if (idx >= this->len) {
+        BL_THROW(dynamic_array_internal::errMsg(
+            dynamic_array_internal::DynamicArrayError::IndexOutOfBounds));
+        abort();
+      }
+    }
+
+    out = std::move(this->data[idx]);
+
+    // Shift all elements after `idx` to the left
+    if constexpr (std::is_trivially_copyable<T>::value) {
+      memmove(this->data + idx, this->data + idx + 1,
+              (this->len - idx - 1) * sizeof(T));
+      this->len -= 1;
+    } else {
+      for (usize i = idx; i < this->len - 1; i++) {
+        this->data[i] = std::move(this->data[i + 1]);
+      }
+      this->destroyLast();
+    }
+  }
+
+  /// Removes and returns the element at the specified index, replacing it with
+  /// the last element of the array.
+  ///
+  /// ## Error
+  /// - Throws an error if the index is out of the array's bounds.
+  T swapRemove(usize idx) {
+    T removed = T();
+    this->swapRemove(idx, removed);
+    return removed;
+  }
+
+  /// Removes the element at the specified index, moving it into `out` and
+  /// replacing it with the last element of the array.
+  ///
+  /// ## Error
+  /// - Throws an error if the index is out of the array's bounds.
+  void swapRemove(usize idx, T& out) {
+    // Input validation
+    {
+      Error::resetError();
+      if (idx >= this->len) {
+        BL_THROW(dynamic_array_internal::errMsg(
+            dynamic_array_internal::DynamicArrayError::IndexOutOfBounds));
+        abort();
+      }
+    }
+
+    out = std::move(this->data[idx]);
+    if (idx != this->len - 1) {
+      this->data[idx] = std::move(this->data[this->len - 1]);
+    }
+    this->destroyLast();
+  }
+
+private:
+  /// The element buffer (either the inline storage or an allocation).
+  T*    data = this->inlineData();
+
+  /// The length of the array.
+  usize len  = 0;
+
+  /// The capacity of the array.
+  usize cap  = N;
+
+  /// The inline storage.
+  alignas(T) u8 storage[N * sizeof(T)];
+
+  T*       inlineData(void) { return reinterpret_cast<T*>(this->storage); }
+
+  const T* inlineData(void) const {
+    return reinterpret_cast<const T*>(this->storage);
+  }
+
+  /// Takes over the elements of `other` (which must be empty afterwards).
+  void take(SmallDynamicArray& other) {
+    if (other.isInline()) {
+      this->data = this->inlineData();
+      this->cap  = N;
+      dynamic_array_internal::relocate(this->data, other.data, other.len);
+    } else {
+      this->data = other.data;
+      this->cap  = other.cap;
+    }
+    this->len  = other.len;
+
+    other.data = other.inlineData();
+    other.len  = 0;
+    other.cap  = N;
+  }
+
+  /// Aborts if the index is out of the array's bounds.
+  void checkIndex(usize idx) const {
+    if (idx >= this->len) {
+      Error::resetError();
+      BL_THROW(dynamic_array_internal::errMsg(
+          dynamic_array_internal::DynamicArrayError::IndexOutOfBounds));
+      Error::printErrorTrace();
+      abort();
+    }
+  }
+
+  /// Destroys the last element and shrinks the length by one.
+  void destroyLast(void) {
+    this->len -= 1;
+    if constexpr (!std::is_trivially_destructible<T>::value) {
+      this->data[this->len].~T();
+    }
+  }
+
+  /// Destroys the elements and deallocates a spilled buffer.
+  void release(void) {
+    this->clear();
+    if (!this->isInline()) {
+      this->deallocSized(this->data, this->cap * sizeof(T), alignof(T));
+    }
+    this->data = this->inlineData();
+    this->cap  = N;
+  }
+
+  /// Makes space for at least `n` more elements, as decided by the `Growth`
+  /// policy.
+  void grow(usize n) {
+    this->resize(Growth::nextCapacity(this->cap, this->len + n, sizeof(T)));
+  }
+
+  /// Function to resize the (spilled) buffer to the given capacity.
+  void resize(usize new_cap) {
+    // Spill the inline elements to the allocator
+    if (this->isInline()) {
+      T* data = (T*)this->allocAligned(new_cap * sizeof(T), alignof(T));
+      if (data == nullptr) {
+        BL_THROW(dynamic_array_internal::errMsg(
+            dynamic_array_internal::DynamicArrayError::BufferAllocationFailed));
+        return;
+      }
+      dynamic_array_internal::relocate(data, this->data, this->len);
+      this->data = data;
+      this->cap  = new_cap;
+      return;
+    }
+
+    // Try to grow the buffer in place first (shrinking in place wouldn't give
+    // any memory back)
+    if (new_cap > this->cap &&
+        this->tryExpand(this->data, this->cap * sizeof(T),
+                        new_cap * sizeof(T))) {
+      this->cap = new_cap;
+      return;
+    }
+
+    T* resized = nullptr;
+    if constexpr (std::is_trivially_copyable<T>::value) {
+      resized = (T*)this->resizeAligned(this->data, this->cap * sizeof(T),
+                                        new_cap * sizeof(T), alignof(T));
+      if (resized == nullptr) {
+        BL_THROW(dynamic_array_internal::errMsg(
+            dynamic_array_internal::DynamicArrayError::BufferResizeFailed));
+        return;
+      }
+    } else {
+      resized = (T*)this->allocAligned(new_cap * sizeof(T), alignof(T));
+      if (resized == nullptr) {
+        BL_THROW(dynamic_array_internal::errMsg(
+            dynamic_array_internal::DynamicArrayError::BufferResizeFailed));
+        return;
+      }
+      dynamic_array_internal::relocate(resized, this->data, this->len);
+      this->deallocSized(this->data, this->cap * sizeof(T), alignof(T));
+    }
+
+    this->data = resized;
+    this->cap  = new_cap;
+  }
+};
+
+} // namespace bl::ds
+
+#endif // !BL_SMALL_DYNAMIC_ARRAY_H
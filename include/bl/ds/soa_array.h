@@ -0,0 +1,443 @@
+#ifndef BL_SOA_ARRAY_H
+#define BL_SOA_ARRAY_H
+
+#include "bl/config.h"            // BL_BOUNDS_CHECKS
+#include "bl/ds/dynamic_array.h" // DynamicArrayError, errMsg, defaultAllocator
+#include "bl/ds/growth_policy.h" // DoublingGrowth
+#include "bl/ds/span.h"          // Span
+#include "bl/error.h"            // resetError, BL_THROW, printErrorTrace
+#include "bl/mem/allocator.h"    // RuntimeAllocator
+#include "bl/primitives.h"       // usize, u8
+
+#include <cstdlib>     // abort
+#include <cstring>     // memcpy, memset
+#include <tuple>       // tuple, tuple_element
+#include <type_traits> // is_trivially_copyable, is_trivially_destructible
+#include <utility>     // index_sequence
+
+namespace bl::ds {
+using namespace primitives;
+
+/// A dynamic array of rows stored as a structure of arrays: every field gets
+/// its own contiguous column buffer.
+///
+/// `SoaArray<u64, f32, u32>` stores the same rows as a
+/// `DynamicArray<Record>` of a `struct Record {u64 id; f32 score; u32 flags;}`,
+/// but a loop over one field only reads that field's column, and the columns
+/// can be handed to SIMD loops as spans (see `SoaArray::getColumn`).
+///
+/// All columns share a single length and capacity, and are allocated from the
+/// same `mem::Allocator` (through `mem::RuntimeAllocator`, see
+/// `DynamicArray`), each aligned to `COLUMN_ALIGNMENT` bytes. The capacity
+/// grows like `DynamicArray`'s default (`DoublingGrowth`).
+///
+/// ## Note
+/// Fields must be trivially copyable and destructible (rows are moved around
+/// with `memcpy`). Spans and references to fields are invalidated when the
+/// array grows.
+template <typename... Fields> struct SoaArray : private mem::RuntimeAllocator {
+  static_assert(sizeof...(Fields) > 0,
+                "SoaArray: There must be at least one field");
+  static_assert((std::is_trivially_copyable<Fields>::value && ...),
+                "SoaArray: The fields must be trivially copyable");
+  static_assert((std::is_trivially_destructible<Fields>::value && ...),
+                "SoaArray: The fields must be trivially destructible");
+
+public:
+  /// The number of fields (columns) of a row.
+  static const usize NUM_COLUMNS      = sizeof...(Fields);
+
+  /// The alignment of every column buffer (a cache line, which also suits
+  /// aligned SIMD loads).
+  static const usize COLUMN_ALIGNMENT = 64;
+
+  static_assert(((alignof(Fields) <= COLUMN_ALIGNMENT) && ...),
+                "SoaArray: The fields can't be aligned to more than "
+                "`COLUMN_ALIGNMENT` bytes");
+
+  /// A row, as returned by `SoaArray::getRow`.
+  typedef std::tuple<Fields...> Row;
+
+  /// The type of the `I`th field.
+  template <usize I> using Field = typename std::tuple_element<I, Row>::type;
+
+  /// Creates an empty array with `mem::CAllocator` as its backing allocator.
+  ///
+  /// ## Note
+  /// Nothing is allocated until the first push.
+  SoaArray()
+      : mem::RuntimeAllocator(
+            dynamic_array_internal::defaultAllocator<mem::RuntimeAllocator>()) {
+  }
+
+  /// Creates an empty array backed by the given allocator.
+  ///
+  /// ## Note
+  /// Nothing is allocated until the first push.
+  ///
+  /// ## Error
+  /// - Throws an error if the provided allocator is null.
+  SoaArray(mem::RuntimeAllocator allocator) : mem::RuntimeAllocator(allocator) {
+    // Input validation
+    {
+      Error::resetError();
+
+      if (!allocator.isValid()) {
+        BL_THROW(dynamic_array_internal::errMsg(
+            dynamic_array_internal::DynamicArrayError::InvalidAllocator));
+        return;
+      }
+    }
+  }
+
+  /// Creates an empty array with space for `capacity` rows, backed by the
+  /// given allocator.
+  ///
+  /// ## Error
+  /// - Throws an error if the provided allocator is null.
+  /// - Throws an error if allocator is unable to allocate the columns.
+  SoaArray(mem::RuntimeAllocator allocator, usize capacity)
+      : SoaArray(allocator) {
+    if (Error::isError()) {
+      return;
+    }
+    this->reserve(capacity);
+  }
+
+  /// Creates an empty array with space for `capacity` rows, backed by the
+  /// `mem::CAllocator`.
+  ///
+  /// ## Error
+  /// - Throws an error if allocator is unable to allocate the columns.
+  SoaArray(usize capacity) : SoaArray() { this->reserve(capacity); }
+
+  /// Clones the array.
+  ///
+  /// ## Note
+  /// The capacity of the clone is its length.
+  ///
+  /// ## Error
+  /// - Throws an error if allocator is unable to allocate the columns.
+  SoaArray(const SoaArray& other) : mem::RuntimeAllocator(other) {
+    Error::resetError();
+
+    if (other.len == 0) {
+      return;
+    }
+    this->reallocate(other.len);
+    if (Error::isError()) {
+      return;
+    }
+    for (usize col = 0; col < NUM_COLUMNS; col++) {
+      memcpy(this->columns[col], other.columns[col],
+             other.len * FIELD_SIZES[col]);
+    }
+    this->len = other.len;
+  }
+
+  /// Moves the rows of `other` into a new array.
+  ///
+  /// ## Note
+  /// Nothing is allocated or copied; `other` is left empty (with no capacity)
+  /// and can still be used.
+  SoaArray(SoaArray&& other)
+      : mem::RuntimeAllocator(other), len(other.len), cap(other.cap) {
+    for (usize col = 0; col < NUM_COLUMNS; col++) {
+      this->columns[col]  = other.columns[col];
+      other.columns[col] = nullptr;
+    }
+    other.len = 0;
+    other.cap = 0;
+  }
+
+  /// Deallocates the columns.
+  ~SoaArray() { this->release(); }
+
+  /// Replaces the array's rows with copies of the rows of `other`.
+  ///
+  /// ## Error
+  /// - Throws an error if allocator is unable to allocate the columns.
+  SoaArray& operator=(const SoaArray& other) {
+    if (this != &other) {
+      SoaArray copy = SoaArray(other);
+      *this         = std::move(copy);
+    }
+    return *this;
+  }
+
+  /// Replaces the array's rows with the rows of `other`.
+  ///
+  /// ## Note
+  /// The array's old columns are deallocated; `other` is left empty (with no
+  /// capacity) and can still be used.
+  SoaArray& operator=(SoaArray&& other) {
+    if (this != &other) {
+      this->release();
+      static_cast<mem::RuntimeAllocator&>(*this) = other;
+      for (usize col = 0; col < NUM_COLUMNS; col++) {
+        this->columns[col]  = other.columns[col];
+        other.columns[col] = nullptr;
+      }
+      this->len = other.len;
+      this->cap = other.cap;
+      other.len = 0;
+      other.cap = 0;
+    }
+    return *this;
+  }
+
+  /// Returns the number of rows.
+  usize getLen(void) const { return this->len; }
+
+  /// Returns the number of rows the columns have space for.
+  usize getCap(void) const { return this->cap; }
+
+  /// Checks if the array is empty.
+  bool  isEmpty(void) const { return this->len == 0; }
+
+  /// Returns the array's allocator policy.
+  const mem::RuntimeAllocator& getAllocator(void) const { return *this; }
+
+  /// Returns a span of the `I`th field of every row.
+  ///
+  /// ## Note
+  /// The span starts at a `COLUMN_ALIGNMENT`-byte boundary (unless the array
+  /// has no capacity), and is invalidated when the array grows or is
+  /// destroyed.
+  template <usize I> Span<Field<I>> getColumn(void) {
+    return Span<Field<I>>(this->column<I>(), this->len);
+  }
+
+  /// Returns a read-only span of the `I`th field of every row.
+  template <usize I> Span<const Field<I>> getColumn(void) const {
+    return Span<const Field<I>>(this->column<I>(), this->len);
+  }
+
+  /// Returns the `I`th field of the row at the specified index.
+  ///
+  /// ## Note
+  /// This is only bounds-checked if `BL_BOUNDS_CHECKS` is enabled (see
+  /// `bl/config.h`).
+  ///
+  /// ## Error
+  /// - Throws an error if the index is out of the array's bounds.
+  template <usize I> Field<I>& get(usize idx) {
+#if BL_BOUNDS_CHECKS
+    this->checkIndex(idx);
+#endif
+    return this->column<I>()[idx];
+  }
+
+  template <usize I> const Field<I>& get(usize idx) const {
+#if BL_BOUNDS_CHECKS
+    this->checkIndex(idx);
+#endif
+    return this->column<I>()[idx];
+  }
+
+  /// Returns a copy of the row at the specified index.
+  ///
+  /// ## Error
+  /// - Throws an error if the index is out of the array's bounds.
+  Row getRow(usize idx) const {
+    this->checkIndex(idx);
+    return this->rowAt(idx, std::index_sequence_for<Fields...>());
+  }
+
+  /// Removes all rows, but leaves the capacity unchanged.
+  void clear(void) { this->len = 0; }
+
+  /// Appends a row with the given fields to the end of the array.
+  ///
+  /// ## Note
+  /// This can cause a resize if the array does not have enough capacity.
+  ///
+  /// ## Error
+  /// - Throws an error if the array failed to resize.
+  void push(const Fields&... fields) {
+    Error::resetError();
+
+    // Copy first, since the fields could be elements of this array
+    const Row row = Row(fields...);
+    if (this->len == this->cap) {
+      this->grow(1);
+      if (Error::isError()) {
+        BL_THROW(dynamic_array_internal::errMsg(
+            dynamic_array_internal::DynamicArrayError::ResizeFailed));
+        return;
+      }
+    }
+
+    this->writeRow(this->len, row, std::index_sequence_for<Fields...>());
+    this->len += 1;
+  }
+
+  /// Removes the row at the specified index, replacing it with the last row.
+  ///
+  /// ## Note
+  /// This does not preserve ordering, but is **O(1)** (one copy per column).
+  ///
+  /// ## Error
+  /// - Throws an error if the index is out of the array's bounds.
+  void swapRemove(usize idx) {
+    this->checkIndex(idx);
+
+    usize last = this->len - 1;
+    if (idx != last) {
+      for (usize col = 0; col < NUM_COLUMNS; col++) {
+        u8*   column = static_cast<u8*>(this->columns[col]);
+        usize size   = FIELD_SIZES[col];
+        memcpy(column + idx * size, column + last * size, size);
+      }
+    }
+    this->len -= 1;
+  }
+
+  /// Resizes the array to contain `n` rows; new rows are zero-initialized.
+  ///
+  /// ## Note
+  /// The capacity grows to exactly `n` if it's too small, and never shrinks.
+  ///
+  /// ## Error
+  /// - Throws an error if the array failed to resize.
+  void resizeTo(usize n) {
+    Error::resetError();
+
+    if (n > this->cap) {
+      this->reallocate(n);
+      if (Error::isError()) {
+        BL_THROW(dynamic_array_internal::errMsg(
+            dynamic_array_internal::DynamicArrayError::ResizeFailed));
+        return;
+      }
+    }
+
+    if (n > this->len) {
+      for (usize col = 0; col < NUM_COLUMNS; col++) {
+        u8* column = static_cast<u8*>(this->columns[col]);
+        memset(column + this->len * FIELD_SIZES[col], 0,
+               (n - this->len) * FIELD_SIZES[col]);
+      }
+    }
+    this->len = n;
+  }
+
+  /// Makes sure the columns have space for at least `capacity` rows in total.
+  ///
+  /// ## Note
+  /// The capacity grows to exactly `capacity` if it's too small, and never
+  /// shrinks.
+  ///
+  /// ## Error
+  /// - Throws an error if the array failed to resize.
+  void reserve(usize capacity) {
+    Error::resetError();
+
+    if (capacity > this->cap) {
+      this->reallocate(capacity);
+      if (Error::isError()) {
+        BL_THROW(dynamic_array_internal::errMsg(
+            dynamic_array_internal::DynamicArrayError::ResizeFailed));
+        return;
+      }
+    }
+  }
+
+private:
+  /// The size of every field, by column.
+  static constexpr usize FIELD_SIZES[NUM_COLUMNS] = {sizeof(Fields)...};
+
+  /// The size of a whole row.
+  static constexpr usize ROW_SIZE                 = (sizeof(Fields) + ...);
+
+  /// The column buffers (all null if the capacity is `0`).
+  void*                  columns[NUM_COLUMNS]     = {};
+
+  /// The number of rows.
+  usize                  len                      = 0;
+
+  /// The number of rows the columns have space for.
+  usize                  cap                      = 0;
+
+  template <usize I> Field<I>* column(void) const {
+    return static_cast<Field<I>*>(this->columns[I]);
+  }
+
+  template <usize... Is>
+  Row rowAt(usize idx, std::index_sequence<Is...>) const {
+    return Row(this->column<Is>()[idx]...);
+  }
+
+  template <usize... Is>
+  void writeRow(usize idx, const Row& row, std::index_sequence<Is...>) {
+    ((this->column<Is>()[idx] = std::get<Is>(row)), ...);
+  }
+
+  /// Aborts if the index is out of the array's bounds.
+  void checkIndex(usize idx) const {
+    if (idx >= this->len) {
+      Error::resetError();
+      BL_THROW(dynamic_array_internal::errMsg(
+          dynamic_array_internal::DynamicArrayError::IndexOutOfBounds));
+      Error::printErrorTrace();
+      abort();
+    }
+  }
+
+  /// Deallocates the columns.
+  void release(void) {
+    if (this->cap != 0) {
+      for (usize col = 0; col < NUM_COLUMNS; col++) {
+        this->deallocSized(this->columns[col], this->cap * FIELD_SIZES[col],
+                           COLUMN_ALIGNMENT);
+        this->columns[col] = nullptr;
+      }
+    }
+    this->len = 0;
+    this->cap = 0;
+  }
+
+  /// Makes space for at least `n` more rows, as decided by `DoublingGrowth`.
+  void grow(usize n) {
+    this->reallocate(
+        DoublingGrowth::nextCapacity(this->cap, this->len + n, ROW_SIZE));
+  }
+
+  /// Moves the rows to new columns with space for `new_cap` rows.
+  ///
+  /// All columns are allocated before any is replaced, so the array is left
+  /// unchanged if an allocation fails.
+  void reallocate(usize new_cap) {
+    void* resized[NUM_COLUMNS] = {};
+    for (usize col = 0; col < NUM_COLUMNS; col++) {
+      resized[col] =
+          this->allocAligned(new_cap * FIELD_SIZES[col], COLUMN_ALIGNMENT);
+      if (resized[col] == nullptr) {
+        for (usize prev = 0; prev < col; prev++) {
+          this->deallocSized(resized[prev], new_cap * FIELD_SIZES[prev],
+                             COLUMN_ALIGNMENT);
+        }
+        BL_THROW(dynamic_array_internal::errMsg(
+            dynamic_array_internal::DynamicArrayError::BufferResizeFailed));
+        return;
+      }
+    }
+
+    usize len = this->len;
+    for (usize col = 0; col < NUM_COLUMNS; col++) {
+      if (len != 0) {
+        memcpy(resized[col], this->columns[col], len * FIELD_SIZES[col]);
+      }
+    }
+    this->release();
+    for (usize col = 0; col < NUM_COLUMNS; col++) {
+      this->columns[col] = resized[col];
+    }
+    this->len = len;
+    this->cap = new_cap;
+  }
+};
+
+} // namespace bl::ds
+
+#endif // !BL_SOA_ARRAY_H
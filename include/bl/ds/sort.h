@@ -0,0 +1,492 @@
+#ifndef BL_SORT_H
+#define BL_SORT_H
+
+#include "bl/ds/dynamic_array.h" // DynamicArray, defaultAllocator
+#include "bl/ds/span.h"          // Span
+#include "bl/mem/allocator.h"    // RuntimeAllocator
+#include "bl/primitives.h"       // usize, u8, u16, u32, u64
+
+#include <algorithm>   // iter_swap, make_heap, sort_heap, stable_sort
+#include <cstring>     // memcpy
+#include <functional>  // less
+#include <type_traits> // is_integral, is_floating_point, is_signed, decay
+#include <utility>     // move, pair
+
+/// Sorting for arrays and spans.
+///
+/// `ds::sort` uses an LSD radix sort for integer and floating-point elements
+/// (and `ds::sortByKey` for elements with such a key), and a pattern-defeating
+/// quicksort for everything else (or when a comparison function is given).
+namespace bl::ds {
+using namespace primitives;
+
+namespace sort_internal {
+/// Ranges shorter than this many elements per key byte are sorted by
+/// comparisons instead of radix sort (the passes over the histograms cost
+/// more than the comparisons).
+const usize RADIX_THRESHOLD_PER_BYTE     = 512;
+
+/// Ranges shorter than this are insertion sorted.
+const usize INSERTION_SORT_THRESHOLD     = 24;
+
+/// Ranges longer than this use the median of 3 medians of 3 as the pivot.
+const usize NINTHER_THRESHOLD            = 128;
+
+/// The number of moves after which a partial insertion sort gives up.
+const usize PARTIAL_INSERTION_SORT_LIMIT = 8;
+
+/// Whether `K` can be used as a radix sort key.
+template <typename K>
+struct IsRadixKey
+    : std::integral_constant<bool, (std::is_integral<K>::value ||
+                                    std::is_floating_point<K>::value) &&
+                                       !std::is_same<K, bool>::value> {};
+
+/// The unsigned integer type with the size of `K`.
+template <usize Size> struct UnsignedOfSize;
+template <> struct UnsignedOfSize<1> {
+  typedef u8 type;
+};
+template <> struct UnsignedOfSize<2> {
+  typedef u16 type;
+};
+template <> struct UnsignedOfSize<4> {
+  typedef u32 type;
+};
+template <> struct UnsignedOfSize<8> {
+  typedef u64 type;
+};
+
+/// Maps a key to an unsigned integer with the same order.
+///
+/// Signed integers get their sign bit flipped; floating-point numbers get
+/// their sign bit flipped if they're positive, and all bits flipped if
+/// they're negative (so `-0.0` sorts before `0.0`, and NaNs sort before
+/// `-inf` or after `inf`, depending on their sign).
+template <typename K>
+inline typename UnsignedOfSize<sizeof(K)>::type toRadix(K key) {
+  typedef typename UnsignedOfSize<sizeof(K)>::type Bits;
+  const Bits SIGN_BIT = Bits(1) << (sizeof(K) * 8 - 1);
+
+  Bits       bits;
+  memcpy(&bits, &key, sizeof(K));
+  if constexpr (std::is_floating_point<K>::value) {
+    return bits & SIGN_BIT ? Bits(~bits) : Bits(bits | SIGN_BIT);
+  } else if constexpr (std::is_signed<K>::value) {
+    return bits ^ SIGN_BIT;
+  } else {
+    return bits;
+  }
+}
+
+/// Sorts `data` by `key(elem)` with an LSD radix sort (8 bits per pass),
+/// using `scratch` (room for `len` elements) as the second buffer.
+///
+/// Passes where every key has the same digit are skipped, so keys that only
+/// use their low bits take fewer passes.
+template <typename T, typename KeyFn>
+void radixSort(T* data, T* scratch, usize len, KeyFn& key) {
+  typedef typename std::decay<decltype(key(*data))>::type K;
+  const usize                                             PASSES = sizeof(K);
+  if (len == 0) {
+    return;
+  }
+
+  // Histograms of all passes, in one read of the data
+  usize counts[PASSES][256] = {};
+  for (usize i = 0; i < len; i++) {
+    auto bits = toRadix(key(data[i]));
+    for (usize pass = 0; pass < PASSES; pass++) {
+      counts[pass][(bits >> (pass * 8)) & 0xFF]++;
+    }
+  }
+
+  T* src = data;
+  T* dst = scratch;
+  for (usize pass = 0; pass < PASSES; pass++) {
+    usize  shift = pass * 8;
+    usize* count = counts[pass];
+    if (count[(toRadix(key(src[0])) >> shift) & 0xFF] == len) {
+      continue;
+    }
+
+    usize offset = 0;
+    for (usize digit = 0; digit < 256; digit++) {
+      usize n       = count[digit];
+      count[digit]  = offset;
+      offset       += n;
+    }
+    for (usize i = 0; i < len; i++) {
+      usize digit = (toRadix(key(src[i])) >> shift) & 0xFF;
+      memcpy(dst + count[digit]++, src + i, sizeof(T));
+    }
+
+    T* tmp = src;
+    src    = dst;
+    dst    = tmp;
+  }
+
+  if (src != data) {
+    memcpy(data, src, len * sizeof(T));
+  }
+}
+
+/// Insertion sort; if `guarded` is `false`, the element before `begin` must
+/// not be greater than any element of the range.
+template <typename T, typename Cmp>
+void insertionSort(T* begin, T* end, Cmp& cmp, bool guarded) {
+  if (begin == end) {
+    return;
+  }
+
+  for (T* cur = begin + 1; cur != end; cur++) {
+    if (!cmp(*cur, *(cur - 1))) {
+      continue;
+    }
+
+    T  tmp  = std::move(*cur);
+    T* sift = cur;
+    do {
+      *sift = std::move(*(sift - 1));
+      sift--;
+    } while ((!guarded || sift != begin) && cmp(tmp, *(sift - 1)));
+    *sift = std::move(tmp);
+  }
+}
+
+/// Insertion sort that gives up (returning `false`) after
+/// `PARTIAL_INSERTION_SORT_LIMIT` moves.
+template <typename T, typename Cmp>
+bool partialInsertionSort(T* begin, T* end, Cmp& cmp) {
+  if (begin == end) {
+    return true;
+  }
+
+  usize moves = 0;
+  for (T* cur = begin + 1; cur != end; cur++) {
+    if (!cmp(*cur, *(cur - 1))) {
+      continue;
+    }
+
+    T  tmp  = std::move(*cur);
+    T* sift = cur;
+    do {
+      *sift = std::move(*(sift - 1));
+      sift--;
+    } while (sift != begin && cmp(tmp, *(sift - 1)));
+    *sift  = std::move(tmp);
+
+    moves += static_cast<usize>(cur - sift);
+    if (moves > PARTIAL_INSERTION_SORT_LIMIT) {
+      return false;
+    }
+  }
+  return true;
+}
+
+template <typename T, typename Cmp> void sort2(T* a, T* b, Cmp& cmp) {
+  if (cmp(*b, *a)) {
+    std::iter_swap(a, b);
+  }
+}
+
+template <typename T, typename Cmp> void sort3(T* a, T* b, T* c, Cmp& cmp) {
+  sort2(a, b, cmp);
+  sort2(b, c, cmp);
+  sort2(a, b, cmp);
+}
+
+/// Partitions the range around the pivot `*begin`, putting elements equal to
+/// the pivot on the right. Returns the pivot's final position, and whether
+/// the range was already partitioned.
+template <typename T, typename Cmp>
+std::pair<T*, bool> partitionRight(T* begin, T* end, Cmp& cmp) {
+  T  pivot = std::move(*begin);
+  T* first = begin;
+  T* last  = end;
+
+  // The median-of-3 pivot selection guarantees there's an element that
+  // isn't less than the pivot (and one that is, unless it's the first one)
+  while (cmp(*++first, pivot)) {
+  }
+  if (first - 1 == begin) {
+    while (first < last && !cmp(*--last, pivot)) {
+    }
+  } else {
+    while (!cmp(*--last, pivot)) {
+    }
+  }
+
+  bool already_partitioned = first >= last;
+  while (first < last) {
+    std::iter_swap(first, last);
+    while (cmp(*++first, pivot)) {
+    }
+    while (!cmp(*--last, pivot)) {
+    }
+  }
+
+  T* pivot_pos = first - 1;
+  *begin       = std::move(*pivot_pos);
+  *pivot_pos   = std::move(pivot);
+  return std::pair<T*, bool>(pivot_pos, already_partitioned);
+}
+
+/// Partitions the range around the pivot `*begin`, putting elements equal to
+/// the pivot on the left (used when there are many equal elements). Returns
+/// the pivot's final position.
+template <typename T, typename Cmp>
+T* partitionLeft(T* begin, T* end, Cmp& cmp) {
+  T  pivot = std::move(*begin);
+  T* first = begin;
+  T* last  = end;
+
+  while (cmp(pivot, *--last)) {
+  }
+  if (last + 1 == end) {
+    while (first < last && !cmp(pivot, *++first)) {
+    }
+  } else {
+    while (!cmp(pivot, *++first)) {
+    }
+  }
+
+  while (first < last) {
+    std::iter_swap(first, last);
+    while (cmp(pivot, *--last)) {
+    }
+    while (!cmp(pivot, *++first)) {
+    }
+  }
+
+  T* pivot_pos = last;
+  *begin       = std::move(*pivot_pos);
+  *pivot_pos   = std::move(pivot);
+  return pivot_pos;
+}
+
+/// Pattern-defeating quicksort (after Orson Peters' pdqsort).
+///
+/// `bad_allowed` is the number of highly unbalanced partitions left before
+/// falling back to heapsort; `leftmost` is `false` if the element before
+/// `begin` is a pivot (so not greater than any element of the range).
+template <typename T, typename Cmp>
+void pdqsort(T* begin, T* end, Cmp& cmp, usize bad_allowed, bool leftmost) {
+  while (true) {
+    usize size = static_cast<usize>(end - begin);
+    if (size < INSERTION_SORT_THRESHOLD) {
+      insertionSort(begin, end, cmp, leftmost);
+      return;
+    }
+
+    // Move the pivot to the start
+    usize half = size / 2;
+    if (size > NINTHER_THRESHOLD) {
+      sort3(begin, begin + half, end - 1, cmp);
+      sort3(begin + 1, begin + (half - 1), end - 2, cmp);
+      sort3(begin + 2, begin + (half + 1), end - 3, cmp);
+      sort3(begin + (half - 1), begin + half, begin + (half + 1), cmp);
+      std::iter_swap(begin, begin + half);
+    } else {
+      sort3(begin + half, begin, end - 1, cmp);
+    }
+
+    // If the pivot equals the previous pivot, all elements equal to it are
+    // in place: put them on the left and skip them
+    if (!leftmost && !cmp(*(begin - 1), *begin)) {
+      begin = partitionLeft(begin, end, cmp) + 1;
+      continue;
+    }
+
+    std::pair<T*, bool> partition = partitionRight(begin, end, cmp);
+    T*                  pivot_pos = partition.first;
+    usize               l_size    = static_cast<usize>(pivot_pos - begin);
+    usize               r_size    = static_cast<usize>(end - (pivot_pos + 1));
+
+    if (l_size < size / 8 || r_size < size / 8) {
+      // Bad pivot: fall back to heapsort once there were too many of them,
+      // otherwise shuffle some elements to break patterns
+      if (--bad_allowed == 0) {
+        std::make_heap(begin, end, cmp);
+        std::sort_heap(begin, end, cmp);
+        return;
+      }
+
+      if (l_size >= INSERTION_SORT_THRESHOLD) {
+        std::iter_swap(begin, begin + l_size / 4);
+        std::iter_swap(pivot_pos - 1, pivot_pos - l_size / 4);
+        if (l_size > NINTHER_THRESHOLD) {
+          std::iter_swap(begin + 1, begin + (l_size / 4 + 1));
+          std::iter_swap(begin + 2, begin + (l_size / 4 + 2));
+          std::iter_swap(pivot_pos - 2, pivot_pos - (l_size / 4 + 1));
+          std::iter_swap(pivot_pos - 3, pivot_pos - (l_size / 4 + 2));
+        }
+      }
+      if (r_size >= INSERTION_SORT_THRESHOLD) {
+        std::iter_swap(pivot_pos + 1, pivot_pos + (1 + r_size / 4));
+        std::iter_swap(end - 1, end - r_size / 4);
+        if (r_size > NINTHER_THRESHOLD) {
+          std::iter_swap(pivot_pos + 2, pivot_pos + (2 + r_size / 4));
+          std::iter_swap(pivot_pos + 3, pivot_pos + (3 + r_size / 4));
+          std::iter_swap(end - 2, end - (1 + r_size / 4));
+          std::iter_swap(end - 3, end - (2 + r_size / 4));
+        }
+      }
+    } else if (partition.second &&
+               partialInsertionSort(begin, pivot_pos, cmp) &&
+               partialInsertionSort(pivot_pos + 1, end, cmp)) {
+      // The range was already partitioned, and both sides (almost) sorted
+      return;
+    }
+
+    // Recurse into the left side, loop on the right side
+    pdqsort(begin, pivot_pos, cmp, bad_allowed, leftmost);
+    begin    = pivot_pos + 1;
+    leftmost = false;
+  }
+}
+
+/// Sorts the range with pdqsort.
+template <typename T, typename Cmp> void comparisonSort(T* data, usize len,
+                                                        Cmp& cmp) {
+  if (len < 2) {
+    return;
+  }
+
+  usize log2 = 0;
+  while ((len >> log2) > 1) {
+    log2++;
+  }
+  pdqsort(data, data + len, cmp, log2, true);
+}
+
+/// Checks if the range is already sorted by `key(elem)` (stopping at the
+/// first element that's out of order).
+template <typename T, typename KeyFn>
+bool isSortedByKey(const T* data, usize len, KeyFn& key) {
+  for (usize i = 1; i < len; i++) {
+    if (toRadix(key(data[i])) < toRadix(key(data[i - 1]))) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/// Sorts the range by `key(elem)` with radix sort, with a scratch buffer from
+/// `alloc`.
+///
+/// Sorted ranges are detected up front and left alone. Short ranges (and
+/// ranges the buffer couldn't be allocated for) are sorted by comparing the
+/// keys instead: with `std::stable_sort` if `Stable` is set, with pdqsort
+/// otherwise.
+template <bool Stable, typename T, typename Alloc, typename KeyFn>
+void keySort(T* data, usize len, Alloc alloc, KeyFn& key) {
+  static_assert(std::is_trivially_copyable<T>::value,
+                "Radix sort needs trivially copyable elements");
+
+  typedef typename std::decay<decltype(key(*data))>::type K;
+  if (isSortedByKey(data, len, key)) {
+    return;
+  }
+
+  T* scratch = nullptr;
+  if (len >= RADIX_THRESHOLD_PER_BYTE * sizeof(K)) {
+    scratch = (T*)alloc.allocAligned(len * sizeof(T), alignof(T));
+  }
+
+  if (scratch == nullptr) {
+    auto cmp = [&](const T& a, const T& b) {
+      return toRadix(key(a)) < toRadix(key(b));
+    };
+    if constexpr (Stable) {
+      std::stable_sort(data, data + len, cmp);
+    } else {
+      comparisonSort(data, len, cmp);
+    }
+    return;
+  }
+
+  radixSort(data, scratch, len, key);
+  alloc.deallocSized(scratch, len * sizeof(T), alignof(T));
+}
+
+/// Sorts the range in ascending order (see `ds::sort`).
+template <typename T, typename Alloc>
+void defaultSort(T* data, usize len, Alloc alloc) {
+  if constexpr (IsRadixKey<T>::value) {
+    // Equal keys are identical, so stability doesn't matter
+    auto key = [](T elem) { return elem; };
+    keySort<false>(data, len, alloc, key);
+  } else {
+    std::less<T> cmp;
+    comparisonSort(data, len, cmp);
+  }
+}
+
+/// The allocator policy used for the scratch buffers of spans.
+inline mem::RuntimeAllocator spanAllocator(void) {
+  return dynamic_array_internal::defaultAllocator<mem::RuntimeAllocator>();
+}
+} // namespace sort_internal
+
+/// Sorts the array in ascending order.
+///
+/// Integer and floating-point elements are radix sorted (unless the array is
+/// short or already sorted), with a scratch buffer as big as the array from
+/// the array's allocator; other elements are sorted with a pattern-defeating
+/// quicksort using `<` (which isn't stable).
+///
+/// ## Note
+/// `-0.0` sorts before `0.0`, and NaNs go to the start or the end depending
+/// on their sign bit. If the scratch buffer can't be allocated, the array is
+/// sorted with pdqsort instead.
+template <typename T, usize Alignment, typename Alloc, typename Growth>
+void sort(DynamicArray<T, Alignment, Alloc, Growth>& arr) {
+  sort_internal::defaultSort(arr.begin(), arr.getLen(), arr.getAllocator());
+}
+
+/// Sorts the span in ascending order (like `ds::sort` for arrays, with the
+/// scratch buffer coming from the default allocator).
+template <typename T> void sort(Span<T> span) {
+  sort_internal::defaultSort(span.begin(), span.getLen(),
+                             sort_internal::spanAllocator());
+}
+
+/// Sorts the array with the comparison function `cmp` (which returns `true`
+/// if its first argument goes before its second one) using a
+/// pattern-defeating quicksort.
+///
+/// ## Note
+/// The sort isn't stable.
+template <typename T, usize Alignment, typename Alloc, typename Growth,
+          typename Cmp>
+void sort(DynamicArray<T, Alignment, Alloc, Growth>& arr, Cmp cmp) {
+  sort_internal::comparisonSort(arr.begin(), arr.getLen(), cmp);
+}
+
+/// Sorts the span with the comparison function `cmp` (see `ds::sort`).
+template <typename T, typename Cmp> void sort(Span<T> span, Cmp cmp) {
+  sort_internal::comparisonSort(span.begin(), span.getLen(), cmp);
+}
+
+/// Sorts the array by the integer or floating-point key `key(elem)` with a
+/// radix sort (e.g. arrays of key/value pairs).
+///
+/// The sort is stable; elements must be trivially copyable, and the scratch
+/// buffer comes from the array's allocator.
+template <typename T, usize Alignment, typename Alloc, typename Growth,
+          typename KeyFn>
+void sortByKey(DynamicArray<T, Alignment, Alloc, Growth>& arr, KeyFn key) {
+  sort_internal::keySort<true>(arr.begin(), arr.getLen(), arr.getAllocator(),
+                              key);
+}
+
+/// Sorts the span by the key `key(elem)` (see `ds::sortByKey`).
+template <typename T, typename KeyFn> void sortByKey(Span<T> span, KeyFn key) {
+  sort_internal::keySort<true>(span.begin(), span.getLen(),
+                               sort_internal::spanAllocator(), key);
+}
+
+} // namespace bl::ds
+
+#endif // !BL_SORT_H
@@ -0,0 +1,174 @@
+#ifndef BL_SPAN_H
+#define BL_SPAN_H
+
+#include "bl/config.h"     // BL_BOUNDS_CHECKS
+#include "bl/error.h"      // resetError, BL_THROW, printErrorTrace
+#include "bl/primitives.h" // const_cstr, usize
+
+#include <cstdlib>     // abort
+#include <type_traits> // enable_if, is_convertible
+
+namespace bl::ds {
+using namespace primitives;
+
+namespace span_internal {
+enum class SpanError {
+  IndexOutOfBounds,
+  InvalidRange,
+};
+
+const_cstr errMsg(SpanError err);
+} // namespace span_internal
+
+/// A non-owning view of a contiguous range of elements.
+///
+/// Spans are cheap to copy (a pointer and a length), so they can be used to
+/// hand (sub-ranges of) arrays to functions without copying the elements; use
+/// `Span<const T>` for read-only views.
+///
+/// The iterators are raw pointers, so spans work with range-based for loops,
+/// `<algorithm>`, and loops the compiler can vectorize.
+///
+/// ## Note
+/// The span doesn't keep the elements alive; it is invalidated when the
+/// underlying buffer is reallocated or freed (e.g. by pushing to the array it
+/// was created from).
+template <typename T> struct Span {
+public:
+  /// Creates an empty span.
+  Span() = default;
+
+  /// Creates a span of the `len` elements starting at `data`.
+  Span(T* data, usize len) : data(data), len(len) {}
+
+  /// Creates a span of the elements of the given C array.
+  template <usize N> Span(T (&array)[N]) : data(array), len(N) {}
+
+  /// Converts a span of `U`s to a span of `T`s (e.g. `Span<int>` to
+  /// `Span<const int>`).
+  template <typename U, typename = typename std::enable_if<
+                            std::is_convertible<U (*)[], T (*)[]>::value>::type>
+  Span(const Span<U>& other) : data(other.begin()), len(other.getLen()) {}
+
+  /// Operator overload for index operator.
+  ///
+  /// ## Note
+  /// This is only bounds-checked if `BL_BOUNDS_CHECKS` is enabled (see
+  /// `bl/config.h`); use `Span::at` for an access that is always checked.
+  ///
+  /// ## Error
+  /// - Throws an error if the index is out of the span's bounds.
+  T& operator[](usize idx) const {
+#if BL_BOUNDS_CHECKS
+    return this->at(idx);
+#else
+    return this->data[idx];
+#endif
+  }
+
+  /// Returns the element at the specified index.
+  ///
+  /// ## Error
+  /// - Throws an error if the index is out of the span's bounds.
+  T& at(usize idx) const {
+    if (idx >= this->len) {
+      Error::resetError();
+      BL_THROW(
+          span_internal::errMsg(span_internal::SpanError::IndexOutOfBounds));
+      Error::printErrorTrace();
+      abort();
+    }
+
+    return this->data[idx];
+  }
+
+  /// Returns the element at the specified index without checking the bounds.
+  ///
+  /// ## Note
+  /// The index must be less than the length of the span.
+  T&    getUnchecked(usize idx) const { return this->data[idx]; }
+
+  /// Returns the first element of the span.
+  T*    getRaw(void) const { return this->data; }
+
+  /// Returns the length of the span.
+  usize getLen(void) const { return this->len; }
+
+  /// Returns the size of the span in bytes.
+  usize getSizeBytes(void) const { return this->len * sizeof(T); }
+
+  /// Checks if the span is empty.
+  bool  isEmpty(void) const { return this->len == 0; }
+
+  T*    begin(void) const { return this->data; }
+
+  T*    end(void) const { return this->data + this->len; }
+
+  /// Returns a span of the elements in the range `[start, end)`.
+  ///
+  /// ## Error
+  /// - Throws an error if the range is out of the span's bounds (and returns
+  /// an empty span).
+  Span  slice(usize start, usize end) const {
+    // Input validation
+    {
+      Error::resetError();
+      if (start > end || end > this->len) {
+        BL_THROW(
+            span_internal::errMsg(span_internal::SpanError::InvalidRange));
+        return Span();
+      }
+    }
+
+    return Span(this->data + start, end - start);
+  }
+
+  /// Returns a span of `count` elements starting at `offset`.
+  ///
+  /// ## Error
+  /// - Throws an error if the range is out of the span's bounds (and returns
+  /// an empty span).
+  Span subspan(usize offset, usize count) const {
+    // Input validation
+    {
+      Error::resetError();
+      if (offset > this->len || count > this->len - offset) {
+        BL_THROW(
+            span_internal::errMsg(span_internal::SpanError::InvalidRange));
+        return Span();
+      }
+    }
+
+    return Span(this->data + offset, count);
+  }
+
+  /// Returns a span of the elements from `offset` to the end of the span.
+  ///
+  /// ## Error
+  /// - Throws an error if the offset is out of the span's bounds (and returns
+  /// an empty span).
+  Span subspan(usize offset) const {
+    // Input validation
+    {
+      Error::resetError();
+      if (offset > this->len) {
+        BL_THROW(
+            span_internal::errMsg(span_internal::SpanError::InvalidRange));
+        return Span();
+      }
+    }
+
+    return Span(this->data + offset, this->len - offset);
+  }
+
+private:
+  /// The first element of the span.
+  T*    data = nullptr;
+
+  /// The number of elements in the span.
+  usize len  = 0;
+};
+
+} // namespace bl::ds
+
+#endif // !BL_SPAN_H
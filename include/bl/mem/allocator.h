@@ -2,44 +2,204 @@
 #define BL_ALLOCATOR_H
 
 #include "bl/primitives.h" // usize
+#include <cstddef>         // max_align_t
 #include <cstdio>
 
 namespace bl::mem {
 using namespace primitives;
 
-typedef void* (*AllocFn)(usize);
-typedef void (*DeallocFn)(void*);
-typedef void* (*ResizeFn)(void*, usize);
+typedef void* (*AllocFn)(void* ctx, usize nbytes);
+typedef void (*DeallocFn)(void* ctx, void* ptr);
+typedef void* (*ResizeFn)(void* ctx, void* ptr, usize nbytes);
+
+typedef void* (*AllocAlignedFn)(void* ctx, usize nbytes, usize align);
+typedef void (*DeallocAlignedFn)(void* ctx, void* ptr, usize align);
+typedef void* (*ResizeAlignedFn)(void* ctx, void* ptr, usize old_nbytes,
+                                 usize new_nbytes, usize align);
+
+typedef void (*DeallocSizedFn)(void* ctx, void* ptr, usize nbytes, usize align);
+typedef bool (*ExpandFn)(void* ctx, void* ptr, usize old_nbytes,
+                         usize new_nbytes);
 
 // TODO: Add type-safe versions of functions? (Replace all `raw` calls by those)
 
 /// An interface for allocators.
+///
+/// Every function is called with the allocator's `ctx`, so stateful allocators
+/// (arenas, pools, etc.) can find their state without relying on globals.
 struct Allocator {
 public:
+  /// The alignment of pointers returned by `Allocator::allocRaw` and
+  /// `Allocator::resizeRaw`.
+  static const usize DEFAULT_ALIGNMENT = alignof(std::max_align_t);
+
   /// Allocates the specified number of bytes.
-  inline void* allocRaw(usize nbytes) { return this->alloc(nbytes); }
+  inline void* allocRaw(usize nbytes) { return this->alloc(this->ctx, nbytes); }
 
   /// Deallocates the given pointer, freeing any allocated memory at that
   /// location.
-  inline void  deallocRaw(void* ptr) { this->dealloc(ptr); }
+  inline void  deallocRaw(void* ptr) { this->dealloc(this->ctx, ptr); }
 
   /// Resizes the given pointer to the specified size (in bytes).
   inline void* resizeRaw(void* ptr, usize nbytes) {
-    return this->resize(ptr, nbytes);
+    return this->resize(this->ctx, ptr, nbytes);
+  }
+
+  /// Allocates the specified number of bytes, aligned to `align` bytes.
+  ///
+  /// ## Note
+  /// The alignment must be a power of two. Allocators that don't support
+  /// over-aligned allocations return `nullptr` if `align` is bigger than
+  /// `DEFAULT_ALIGNMENT`.
+  inline void* allocAlignedRaw(usize nbytes, usize align) {
+    if (this->allocAligned == nullptr) {
+      return align <= DEFAULT_ALIGNMENT ? this->alloc(this->ctx, nbytes)
+                                        : nullptr;
+    }
+    return this->allocAligned(this->ctx, nbytes, align);
+  }
+
+  /// Deallocates a pointer returned by `Allocator::allocAlignedRaw` or
+  /// `Allocator::resizeAlignedRaw`.
+  ///
+  /// ## Note
+  /// The alignment must be the one the pointer was allocated with.
+  inline void deallocAlignedRaw(void* ptr, usize align) {
+    if (this->deallocAligned == nullptr) {
+      this->dealloc(this->ctx, ptr);
+      return;
+    }
+    this->deallocAligned(this->ctx, ptr, align);
+  }
+
+  /// Resizes a pointer returned by `Allocator::allocAlignedRaw` or
+  /// `Allocator::resizeAlignedRaw` from `old_nbytes` to `new_nbytes`, keeping
+  /// its alignment.
+  ///
+  /// ## Note
+  /// The alignment must be the one the pointer was allocated with.
+  inline void* resizeAlignedRaw(void* ptr, usize old_nbytes, usize new_nbytes,
+                                usize align) {
+    if (this->resizeAligned == nullptr) {
+      return align <= DEFAULT_ALIGNMENT
+                 ? this->resize(this->ctx, ptr, new_nbytes)
+                 : nullptr;
+    }
+    return this->resizeAligned(this->ctx, ptr, old_nbytes, new_nbytes, align);
+  }
+
+  /// Deallocates a pointer whose size (in bytes) and alignment are known.
+  ///
+  /// Allocators can use the size to skip looking it up (or to reclaim the
+  /// memory at all); allocators that don't care fall back to
+  /// `Allocator::deallocAlignedRaw`.
+  ///
+  /// ## Note
+  /// The size must be the one the pointer was last allocated/resized with, and
+  /// the alignment must be the one it was allocated with.
+  inline void deallocSizedRaw(void* ptr, usize nbytes,
+                              usize align = DEFAULT_ALIGNMENT) {
+    if (this->deallocSized == nullptr) {
+      this->deallocAlignedRaw(ptr, align);
+      return;
+    }
+    this->deallocSized(this->ctx, ptr, nbytes, align);
+  }
+
+  /// Tries to grow (or shrink) the given allocation from `old_nbytes` to
+  /// `new_nbytes` without moving it.
+  ///
+  /// Returns `true` if the allocation was resized in place; otherwise the
+  /// allocation is left untouched and the caller has to move it (e.g. with
+  /// `Allocator::resizeRaw`).
+  ///
+  /// ## Note
+  /// Allocators that couldn't give the memory back (like `mem::CAllocator` and
+  /// `mem::PoolAllocator`) refuse to shrink in place, so the caller moves the
+  /// allocation to actually release it.
+  inline bool tryExpandRaw(void* ptr, usize old_nbytes, usize new_nbytes) {
+    if (this->expand == nullptr || ptr == nullptr) {
+      return false;
+    }
+    return this->expand(this->ctx, ptr, old_nbytes, new_nbytes);
   }
 
 protected:
   /// %Allocator specific context (useful for non-global allocators).
-  void*     ctx;
+  void*            ctx;
 
   /// Function used to make allocations.
-  AllocFn   alloc;
+  AllocFn          alloc;
 
   /// Function used to free allocations.
-  DeallocFn dealloc;
+  DeallocFn        dealloc;
 
   /// Function used to resize allocations.
-  ResizeFn  resize;
+  ResizeFn         resize;
+
+  /// Function used to make aligned allocations (optional).
+  AllocAlignedFn   allocAligned   = nullptr;
+
+  /// Function used to free aligned allocations (optional).
+  DeallocAlignedFn deallocAligned = nullptr;
+
+  /// Function used to resize aligned allocations (optional).
+  ResizeAlignedFn  resizeAligned  = nullptr;
+
+  /// Function used to free allocations of a known size (optional).
+  DeallocSizedFn   deallocSized   = nullptr;
+
+  /// Function used to resize allocations in place (optional).
+  ExpandFn         expand         = nullptr;
+};
+
+/// An allocator policy that dispatches through a `mem::Allocator` at runtime.
+///
+/// Allocator policies are used by containers (e.g. `ds::DynamicArray`) that
+/// take their allocator as a template parameter. A policy provides the
+/// following members:
+/// - `bool  isValid(void) const`
+/// - `void* allocAligned(usize nbytes, usize align)`
+/// - `void* resizeAligned(void* ptr, usize old_nbytes, usize new_nbytes,
+///   usize align)`
+/// - `void  deallocSized(void* ptr, usize nbytes, usize align)`
+/// - `bool  tryExpand(void* ptr, usize old_nbytes, usize new_nbytes)`
+///
+/// These behave like their `Allocator::*Raw` counterparts.
+///
+/// ## Note
+/// This policy works with any allocator, but every call goes through a
+/// function pointer and containers store the allocator pointer; see
+/// `mem::StaticCAllocator` for a policy that is resolved at compile time.
+struct RuntimeAllocator {
+public:
+  /// Creates a policy that forwards to the given allocator.
+  RuntimeAllocator(Allocator* allocator) : allocator(allocator) {}
+
+  /// Checks if the policy has an allocator to forward to.
+  inline bool  isValid(void) const { return this->allocator != nullptr; }
+
+  inline void* allocAligned(usize nbytes, usize align) {
+    return this->allocator->allocAlignedRaw(nbytes, align);
+  }
+
+  inline void* resizeAligned(void* ptr, usize old_nbytes, usize new_nbytes,
+                             usize align) {
+    return this->allocator->resizeAlignedRaw(ptr, old_nbytes, new_nbytes,
+                                             align);
+  }
+
+  inline void deallocSized(void* ptr, usize nbytes, usize align) {
+    this->allocator->deallocSizedRaw(ptr, nbytes, align);
+  }
+
+  inline bool tryExpand(void* ptr, usize old_nbytes, usize new_nbytes) {
+    return this->allocator->tryExpandRaw(ptr, old_nbytes, new_nbytes);
+  }
+
+private:
+  /// The allocator to forward to.
+  Allocator* allocator;
 };
 
 } // namespace bl::mem
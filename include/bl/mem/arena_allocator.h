@@ -0,0 +1,133 @@
+#ifndef BL_ARENA_ALLOCATOR_H
+#define BL_ARENA_ALLOCATOR_H
+
+#include "bl/mem/allocator.h" // Allocator
+#include "bl/primitives.h"    // usize
+
+namespace bl::mem {
+using namespace primitives;
+
+/// A bump allocator that carves allocations out of large chunks obtained from
+/// a parent allocator.
+///
+/// Individual deallocations are no-ops (except that a sized deallocation of
+/// the most recent allocation gives its space back); memory is reclaimed all at
+/// once with `ArenaAllocator::rewind` or `ArenaAllocator::reset`, and chunks
+/// are only returned to the parent allocator when the arena is destroyed.
+///
+/// ## Note
+/// The arena's state is referenced through `ctx`, so it can't be copied or
+/// moved; pass it around as a `mem::Allocator*` instead.
+struct ArenaAllocator : Allocator {
+private:
+  struct Chunk;
+
+public:
+  /// The default number of bytes requested from the parent for each chunk.
+  static const usize DEFAULT_CHUNK_SIZE = 64 * 1024;
+
+  /// A saved position in the arena (see `ArenaAllocator::mark`).
+  struct Mark {
+  private:
+    friend ArenaAllocator;
+
+    Chunk* chunk = nullptr;
+    usize  used  = 0;
+  };
+
+  /// Creates an empty arena with `mem::CAllocator` as its parent allocator.
+  ///
+  /// ## Note
+  /// Nothing is allocated until the first allocation.
+  ArenaAllocator();
+
+  /// Creates an empty arena that requests chunks of (at least) `chunk_size`
+  /// bytes from the given parent allocator.
+  ///
+  /// ## Note
+  /// Nothing is allocated until the first allocation.
+  ///
+  /// ## Error
+  /// - Throws an error if the provided parent allocator is null.
+  /// - Throws an error if the chunk size is `0`.
+  ArenaAllocator(Allocator* parent, usize chunk_size = DEFAULT_CHUNK_SIZE);
+
+  ArenaAllocator(const ArenaAllocator&)            = delete;
+  ArenaAllocator& operator=(const ArenaAllocator&) = delete;
+
+  /// Returns all chunks to the parent allocator.
+  ~ArenaAllocator();
+
+  /// Returns the current position of the arena.
+  ///
+  /// Everything allocated after this call can be freed at once by passing the
+  /// returned mark to `ArenaAllocator::rewind`.
+  Mark  mark(void) const;
+
+  /// Frees everything allocated since the given mark was taken.
+  ///
+  /// ## Note
+  /// This is **O(1)**; the chunks are kept around and reused by later
+  /// allocations.
+  ///
+  /// ## Error
+  /// - Throws an error if the mark doesn't belong to this arena.
+  void  rewind(Mark mark);
+
+  /// Frees everything allocated by the arena.
+  ///
+  /// ## Note
+  /// This is **O(1)**; the chunks are kept around and reused by later
+  /// allocations.
+  void  reset(void);
+
+  /// Returns the number of bytes handed out since the last reset (including
+  /// alignment padding).
+  usize getUsed(void) const;
+
+  /// Returns the total number of bytes (excluding chunk headers) owned by the
+  /// arena.
+  usize getCap(void) const;
+
+private:
+  /// Allocator used to allocate the chunks.
+  Allocator* parent;
+
+  /// Minimum size of each chunk (not counting its header).
+  usize      chunk_size;
+
+  /// The first chunk of the arena.
+  Chunk*     head    = nullptr;
+
+  /// The chunk currently being bumped into.
+  Chunk*     current = nullptr;
+
+  /// The most recent allocation (this can be resized in place).
+  void*      last    = nullptr;
+
+  /// Makes a chunk that can hold at least `nbytes` the current chunk.
+  bool       advance(usize nbytes);
+
+  /// Bumps out an allocation of `nbytes` aligned to `align` bytes.
+  void*      bump(usize nbytes, usize align);
+
+  /// Resizes `ptr` in place if it's the most recent allocation, otherwise
+  /// moves it to a new allocation and copies `copy_nbytes` bytes over.
+  void*      grow(void* ptr, usize nbytes, usize copy_nbytes, usize align);
+
+  static void* arenaAlloc(void* ctx, usize nbytes);
+  static void  arenaDealloc(void* ctx, void* ptr);
+  static void* arenaResize(void* ctx, void* ptr, usize nbytes);
+  static void* arenaAllocAligned(void* ctx, usize nbytes, usize align);
+  static void  arenaDeallocAligned(void* ctx, void* ptr, usize align);
+  static void* arenaResizeAligned(void* ctx, void* ptr, usize old_nbytes,
+                                  usize new_nbytes, usize align);
+  static void  arenaDeallocSized(void* ctx, void* ptr, usize nbytes,
+                                 usize align);
+  static bool  arenaExpand(void* ctx, void* ptr, usize old_nbytes,
+                           usize new_nbytes);
+};
+
+} // namespace bl::mem
+
+#endif // !BL_ARENA_ALLOCATOR_H
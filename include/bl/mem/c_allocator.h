@@ -3,19 +3,117 @@
 
 #include "bl/mem/allocator.h" // Allocator
 
-#include <cstdlib> // malloc, realloc, free
+#include <cstdlib> // malloc, realloc, free, aligned_alloc
+#include <cstring> // memcpy
 
 namespace bl::mem {
 
 /// An allocator backed by `libc`'s allocation functions (malloc, free,
-/// realloc).
+/// realloc, aligned_alloc).
 struct CAllocator : Allocator {
 public:
   CAllocator() {
-    this->ctx     = nullptr;
-    this->alloc   = std::malloc;
-    this->dealloc = std::free;
-    this->resize  = std::realloc;
+    this->ctx            = nullptr;
+    this->alloc          = CAllocator::cAlloc;
+    this->dealloc        = CAllocator::cDealloc;
+    this->resize         = CAllocator::cResize;
+    this->allocAligned   = CAllocator::cAllocAligned;
+    this->deallocAligned = CAllocator::cDeallocAligned;
+    this->resizeAligned  = CAllocator::cResizeAligned;
+    this->deallocSized   = CAllocator::cDeallocSized;
+    this->expand         = CAllocator::cExpand;
+  }
+
+private:
+  friend struct StaticCAllocator;
+
+  static void* cAlloc(void* /*ctx*/, usize nbytes) {
+    return std::malloc(nbytes);
+  }
+
+  static void cDealloc(void* /*ctx*/, void* ptr) { std::free(ptr); }
+
+  static void* cResize(void* /*ctx*/, void* ptr, usize nbytes) {
+    return std::realloc(ptr, nbytes);
+  }
+
+  static void* cAllocAligned(void* /*ctx*/, usize nbytes, usize align) {
+    if (align <= DEFAULT_ALIGNMENT) {
+      return std::malloc(nbytes);
+    }
+
+    // `aligned_alloc` requires the size to be a multiple of the alignment
+    return std::aligned_alloc(align, (nbytes + align - 1) & ~(align - 1));
+  }
+
+  static void cDeallocAligned(void* /*ctx*/, void* ptr, usize /*align*/) {
+    std::free(ptr);
+  }
+
+  static void* cResizeAligned(void* ctx, void* ptr, usize old_nbytes,
+                              usize new_nbytes, usize align) {
+    if (align <= DEFAULT_ALIGNMENT) {
+      return std::realloc(ptr, new_nbytes);
+    }
+
+    // `realloc` doesn't preserve over-alignment, so allocate a new block and
+    // copy (leaving the old block untouched on failure)
+    void* resized = cAllocAligned(ctx, new_nbytes, align);
+    if (resized == nullptr) {
+      return nullptr;
+    }
+    if (ptr != nullptr) {
+      memcpy(resized, ptr, old_nbytes < new_nbytes ? old_nbytes : new_nbytes);
+      std::free(ptr);
+    }
+
+    return resized;
+  }
+
+  static void cDeallocSized(void* /*ctx*/, void* ptr, usize /*nbytes*/,
+                            usize /*align*/) {
+    std::free(ptr);
+  }
+
+  /// `libc` can't resize a block in place. The slack `malloc` rounds sizes up
+  /// with isn't handed out (it doesn't belong to the caller as far as object
+  /// size checks are concerned), and shrinks are refused so the caller moves
+  /// the block and actually frees the memory.
+  static bool cExpand(void* /*ctx*/, void* /*ptr*/, usize old_nbytes,
+                      usize new_nbytes) {
+    return new_nbytes == old_nbytes;
+  }
+};
+
+/// An allocator policy backed by `libc`'s allocation functions.
+///
+/// Unlike `mem::RuntimeAllocator`, the calls are resolved at compile time (so
+/// they can be inlined) and the policy is empty, so containers using it don't
+/// store an allocator at all.
+///
+/// ## Note
+/// See `mem::RuntimeAllocator` for the members an allocator policy provides.
+struct StaticCAllocator {
+public:
+  inline bool  isValid(void) const { return true; }
+
+  inline void* allocAligned(usize nbytes, usize align) {
+    return CAllocator::cAllocAligned(nullptr, nbytes, align);
+  }
+
+  inline void* resizeAligned(void* ptr, usize old_nbytes, usize new_nbytes,
+                             usize align) {
+    return CAllocator::cResizeAligned(nullptr, ptr, old_nbytes, new_nbytes,
+                                      align);
+  }
+
+  inline void deallocSized(void* ptr, usize /*nbytes*/, usize /*align*/) {
+    std::free(ptr);
+  }
+
+  inline bool tryExpand(void* ptr, usize old_nbytes, usize new_nbytes) {
+    return ptr != nullptr &&
+           CAllocator::cExpand(nullptr, ptr, old_nbytes, new_nbytes);
   }
 };
 
@@ -0,0 +1,103 @@
+#ifndef BL_PAGE_ALLOCATOR_H
+#define BL_PAGE_ALLOCATOR_H
+
+#include "bl/mem/allocator.h" // Allocator
+#include "bl/primitives.h"    // usize
+
+#include <mutex> // mutex
+
+namespace bl::mem {
+using namespace primitives;
+
+/// An allocator that maps every allocation directly from the OS with `mmap`.
+///
+/// Growing an allocation remaps its pages (`mremap` on Linux) instead of
+/// copying them, so resizing a multi-gigabyte buffer neither copies it nor
+/// briefly doubles the memory usage. Pointers returned by the allocator are
+/// page aligned.
+///
+/// ## Note
+/// Every allocation costs a system call and takes (at least) two pages: one
+/// for the bookkeeping header and one for the data. This is meant for very
+/// large buffers; see `mem::ThresholdAllocator` for routing only large
+/// allocations here.
+///
+/// The allocator is thread-safe. Its state is referenced through `ctx`, so it
+/// can't be copied or moved; pass it around as a `mem::Allocator*` instead.
+struct PageAllocator : Allocator {
+public:
+  /// Creates a page allocator.
+  ///
+  /// If `huge_pages` is set, the allocator asks the kernel to back allocations
+  /// with transparent huge pages (`MADV_HUGEPAGE`) where supported.
+  PageAllocator(bool huge_pages = false);
+
+  PageAllocator(const PageAllocator&)            = delete;
+  PageAllocator& operator=(const PageAllocator&) = delete;
+
+  /// Unmaps all allocations that are still mapped.
+  ~PageAllocator();
+
+  /// Checks if the given pointer was allocated by this allocator.
+  bool  owns(const void* ptr) const;
+
+  /// Returns the size of a page (in bytes).
+  usize getPageSize(void) const;
+
+  /// Returns the total number of bytes currently mapped by the allocator
+  /// (including headers).
+  usize getMappedBytes(void) const;
+
+private:
+  /// Header stored in the page right before every allocation.
+  struct Mapping {
+    Mapping* prev;
+    Mapping* next;
+
+    /// The length of the whole mapping (including the header page).
+    usize    len;
+  };
+
+  /// Protects `mappings` and `mapped_bytes`.
+  mutable std::mutex lock;
+
+  /// All live mappings.
+  Mapping*           mappings     = nullptr;
+
+  /// The total length of all live mappings.
+  usize              mapped_bytes = 0;
+
+  /// The size of a page.
+  usize              page_size;
+
+  /// Whether to advise the kernel to use huge pages.
+  bool               huge_pages;
+
+  /// Returns the mapping length needed for an allocation of `nbytes`.
+  usize              mappingLen(usize nbytes) const;
+
+  /// Returns the header of the given allocation.
+  Mapping*           getMapping(const void* ptr) const;
+
+  /// Adds a mapping to the list of live mappings.
+  void               link(Mapping* mapping);
+
+  /// Removes a mapping from the list of live mappings.
+  void               unlink(Mapping* mapping);
+
+  static void* pageAlloc(void* ctx, usize nbytes);
+  static void  pageDealloc(void* ctx, void* ptr);
+  static void* pageResize(void* ctx, void* ptr, usize nbytes);
+  static void* pageAllocAligned(void* ctx, usize nbytes, usize align);
+  static void  pageDeallocAligned(void* ctx, void* ptr, usize align);
+  static void* pageResizeAligned(void* ctx, void* ptr, usize old_nbytes,
+                                 usize new_nbytes, usize align);
+  static void  pageDeallocSized(void* ctx, void* ptr, usize nbytes,
+                                usize align);
+  static bool  pageExpand(void* ctx, void* ptr, usize old_nbytes,
+                          usize new_nbytes);
+};
+
+} // namespace bl::mem
+
+#endif // !BL_PAGE_ALLOCATOR_H
@@ -0,0 +1,147 @@
+#ifndef BL_POOL_ALLOCATOR_H
+#define BL_POOL_ALLOCATOR_H
+
+#include "bl/mem/allocator.h" // Allocator
+#include "bl/primitives.h"    // usize, u8
+
+namespace bl::mem {
+using namespace primitives;
+
+/// An allocator that serves small allocations from fixed-size blocks.
+///
+/// Each size class (16, 32, ..., 512 bytes) carves slabs obtained from a parent
+/// allocator into equally sized blocks; freed blocks are kept on an intrusive
+/// free list, so allocating and freeing them is **O(1)** and never touches the
+/// parent allocator. Allocations larger than the biggest size class are passed
+/// straight through to the parent allocator.
+///
+/// Blocks are naturally aligned to their size, so aligned allocations of up to
+/// `MAX_BLOCK_SIZE` bytes are served from the pool as well.
+///
+/// Every allocation of at most `MAX_BLOCK_SIZE` bytes (and alignment) lives in
+/// the pool, so sized deallocations find their size class without looking up
+/// the slab.
+///
+/// ## Note
+/// Slabs are only returned to the parent allocator when the pool is destroyed.
+/// They are requested with an alignment of `MAX_BLOCK_SIZE`, so the parent
+/// must support aligned allocations.
+///
+/// The pool's state is referenced through `ctx`, so it can't be copied or
+/// moved; pass it around as a `mem::Allocator*` instead.
+struct PoolAllocator : Allocator {
+public:
+  /// The number of size classes.
+  static const usize NUM_SIZE_CLASSES  = 6;
+
+  /// The smallest block size (in bytes).
+  static const usize MIN_BLOCK_SIZE    = 16;
+
+  /// The biggest block size (in bytes); larger allocations go to the parent.
+  static const usize MAX_BLOCK_SIZE    = MIN_BLOCK_SIZE
+                                      << (NUM_SIZE_CLASSES - 1);
+
+  /// The default number of bytes requested from the parent for each slab.
+  static const usize DEFAULT_SLAB_SIZE = 64 * 1024;
+
+  /// Creates an empty pool with `mem::CAllocator` as its parent allocator.
+  ///
+  /// ## Note
+  /// Nothing is allocated until the first allocation.
+  PoolAllocator();
+
+  /// Creates an empty pool that requests slabs of `slab_size` bytes from the
+  /// given parent allocator.
+  ///
+  /// ## Note
+  /// Nothing is allocated until the first allocation.
+  ///
+  /// ## Error
+  /// - Throws an error if the provided parent allocator is null.
+  /// - Throws an error if the slab size is smaller than `MAX_BLOCK_SIZE`.
+  PoolAllocator(Allocator* parent, usize slab_size = DEFAULT_SLAB_SIZE);
+
+  PoolAllocator(const PoolAllocator&)            = delete;
+  PoolAllocator& operator=(const PoolAllocator&) = delete;
+
+  /// Returns all slabs to the parent allocator.
+  ///
+  /// ## Note
+  /// Oversized allocations that were never freed are not released.
+  ~PoolAllocator();
+
+  /// Returns the number of slabs owned by the pool.
+  usize getSlabCount(void) const;
+
+private:
+  /// A free block; the link to the next free block is stored in the block
+  /// itself.
+  struct Block {
+    Block* next;
+  };
+
+  /// The blocks of a single size.
+  struct SizeClass {
+    /// Blocks that were freed and can be reused.
+    Block* free_list = nullptr;
+
+    /// Start of the part of the newest slab that hasn't been handed out yet.
+    u8*    bump      = nullptr;
+
+    /// End of the newest slab.
+    u8*    end       = nullptr;
+  };
+
+  /// A slab owned by one of the size classes.
+  struct Slab {
+    u8*   base;
+    usize class_idx;
+  };
+
+  /// Allocator used to allocate the slabs and oversized allocations.
+  Allocator* parent;
+
+  /// Size of each slab.
+  usize      slab_size;
+
+  /// Per size class state.
+  SizeClass  classes[NUM_SIZE_CLASSES];
+
+  /// Slabs owned by the pool, sorted by address.
+  Slab*      slabs     = nullptr;
+
+  /// The number of slabs owned by the pool.
+  usize      num_slabs = 0;
+
+  /// The capacity of the `slabs` buffer.
+  usize      cap_slabs = 0;
+
+  /// Gives the size class a new slab to carve blocks out of.
+  bool       addSlab(usize class_idx);
+
+  /// Finds the slab containing `ptr`, or returns `nullptr` if the pointer was
+  /// allocated by the parent allocator.
+  Slab*      findSlab(void* ptr) const;
+
+  /// Pops a block off the size class' free list (or carves a new one).
+  void*      allocBlock(usize class_idx);
+
+  /// Pushes a block back onto its size class' free list.
+  void       freeBlock(usize class_idx, void* ptr);
+
+  static void* poolAlloc(void* ctx, usize nbytes);
+  static void  poolDealloc(void* ctx, void* ptr);
+  static void* poolResize(void* ctx, void* ptr, usize nbytes);
+  static void* poolAllocAligned(void* ctx, usize nbytes, usize align);
+  static void  poolDeallocAligned(void* ctx, void* ptr, usize align);
+  static void* poolResizeAligned(void* ctx, void* ptr, usize old_nbytes,
+                                 usize new_nbytes, usize align);
+  static void  poolDeallocSized(void* ctx, void* ptr, usize nbytes,
+                                usize align);
+  static bool  poolExpand(void* ctx, void* ptr, usize old_nbytes,
+                          usize new_nbytes);
+};
+
+} // namespace bl::mem
+
+#endif // !BL_POOL_ALLOCATOR_H
@@ -0,0 +1,183 @@
+#ifndef BL_THREAD_CACHE_ALLOCATOR_H
+#define BL_THREAD_CACHE_ALLOCATOR_H
+
+#include "bl/mem/allocator.h" // Allocator
+#include "bl/primitives.h"    // usize, u64, u8
+
+#include <atomic> // atomic
+#include <mutex>  // mutex
+
+namespace bl::mem {
+using namespace primitives;
+
+/// A general-purpose allocator for multi-threaded programs.
+///
+/// Every thread gets its own heap with a cache of segments per size class (16,
+/// 32, ..., 4096 bytes), so small allocations and frees by the owning thread
+/// never take a lock. Heaps refill from a shared central heap one segment (a
+/// batch of blocks) at a time, and hand fully freed segments back to it.
+///
+/// Blocks freed by a thread other than the one that allocated them are pushed
+/// onto a lock-free remote-free list of their segment; the owning thread
+/// collects them the next time it runs out of blocks.
+///
+/// Allocations larger than `MAX_BLOCK_SIZE` bytes (or aligned to more than
+/// that) are passed straight through to the parent allocator.
+///
+/// ## Note
+/// Segments are carved out of a single range of reserved address space, which
+/// is what tells small blocks apart from the parent's allocations. The range
+/// is only reserved (not committed) up front; segments are committed as they
+/// are needed and are only released when the allocator is destroyed.
+///
+/// When a thread exits, its heap (and any blocks still allocated from it) is
+/// adopted by the next thread that needs one.
+///
+/// The allocator's state is referenced through `ctx`, so it can't be copied or
+/// moved; pass it around as a `mem::Allocator*` instead.
+struct ThreadCacheAllocator : Allocator {
+public:
+  /// The number of size classes.
+  static const usize NUM_SIZE_CLASSES = 9;
+
+  /// The smallest block size (in bytes).
+  static const usize MIN_BLOCK_SIZE   = 16;
+
+  /// The biggest block size (in bytes); larger allocations go to the parent.
+  static const usize MAX_BLOCK_SIZE   = MIN_BLOCK_SIZE
+                                     << (NUM_SIZE_CLASSES - 1);
+
+  /// The size of a segment (in bytes).
+  static const usize SEGMENT_SIZE     = 64 * 1024;
+
+  /// The default amount of address space reserved for segments.
+  static const usize DEFAULT_RESERVE  = usize(16) * 1024 * 1024 * 1024;
+
+  /// Creates a thread-caching allocator with `mem::CAllocator` as its parent
+  /// allocator.
+  ThreadCacheAllocator();
+
+  /// Creates a thread-caching allocator that reserves `reserve` bytes of
+  /// address space for segments and passes large allocations to the given
+  /// parent allocator.
+  ///
+  /// ## Error
+  /// - Throws an error if the provided parent allocator is null.
+  /// - Throws an error if the address space couldn't be reserved.
+  ThreadCacheAllocator(Allocator* parent, usize reserve = DEFAULT_RESERVE);
+
+  ThreadCacheAllocator(const ThreadCacheAllocator&)            = delete;
+  ThreadCacheAllocator& operator=(const ThreadCacheAllocator&) = delete;
+
+  /// Releases all segments and heaps.
+  ///
+  /// ## Note
+  /// No other thread may use the allocator while (or after) it's destroyed;
+  /// allocations that were passed to the parent allocator are not released.
+  ~ThreadCacheAllocator();
+
+  /// Returns the process-wide instance (backed by `mem::CAllocator`).
+  ///
+  /// ## Note
+  /// The instance is never destroyed, so it can be used from any thread at
+  /// any time (including during static destruction).
+  static ThreadCacheAllocator* getGlobal(void);
+
+  /// Checks if the given pointer is a block owned by this allocator (as
+  /// opposed to a large allocation passed to the parent allocator).
+  bool  owns(const void* ptr) const;
+
+  /// Returns the number of segments currently committed.
+  usize getSegmentCount(void) const;
+
+private:
+  /// A free block; the link to the next free block is stored in the block
+  /// itself.
+  struct Block {
+    Block* next;
+  };
+
+  struct Segment;
+  struct Heap;
+  struct ThreadHeaps;
+
+  /// The heaps used by the current thread (one per allocator).
+  static thread_local ThreadHeaps thread_heaps;
+
+  /// The id of the allocator the current thread used last.
+  static thread_local u64         last_id;
+
+  /// The heap the current thread used last (kept separately from
+  /// `thread_heaps` since it can be accessed without a TLS init guard).
+  static thread_local Heap*       last_heap;
+
+  /// Allocator used for large allocations and heaps.
+  Allocator*                      parent;
+
+  /// Unique id of the allocator (addresses can be reused, ids can't).
+  u64                             id;
+
+  /// The next allocator in the list of live allocators.
+  ThreadCacheAllocator*           next_live = nullptr;
+
+  /// The reserved address space.
+  u8*                             reserved  = nullptr;
+
+  /// The size of the reserved address space.
+  usize                           reserve   = 0;
+
+  /// Protects the central heap (`committed`, `free_segments`).
+  mutable std::mutex              central_lock;
+
+  /// The number of bytes of the reserved space handed out as segments.
+  usize                           committed     = 0;
+
+  /// Segments that were handed back by heaps.
+  Segment*                        free_segments = nullptr;
+
+  /// Protects `heaps`.
+  std::mutex                      heaps_lock;
+
+  /// All heaps created by the allocator.
+  Heap*                           heaps = nullptr;
+
+  /// Returns the heap of the current thread, creating one if necessary.
+  Heap*                           getHeap(void);
+
+  /// Returns the heap of the current thread, or `nullptr` if it doesn't have
+  /// one.
+  Heap*                           findHeap(void);
+
+  /// Adopts an abandoned heap or creates a new one.
+  Heap*                           acquireHeap(void);
+
+  /// Marks the given heap as abandoned (so another thread can adopt it).
+  void                            abandonHeap(Heap* heap);
+
+  /// Takes a segment from the central heap.
+  Segment*                        takeSegment(void);
+
+  /// Gives a segment back to the central heap.
+  void                            giveSegment(Segment* segment);
+
+  /// Allocates a block from the given size class.
+  void*                           allocBlock(usize class_idx);
+
+  /// Frees a block owned by the allocator.
+  void                            freeBlock(void* ptr);
+
+  static void* tcAlloc(void* ctx, usize nbytes);
+  static void  tcDealloc(void* ctx, void* ptr);
+  static void* tcResize(void* ctx, void* ptr, usize nbytes);
+  static void* tcAllocAligned(void* ctx, usize nbytes, usize align);
+  static void  tcDeallocAligned(void* ctx, void* ptr, usize align);
+  static void* tcResizeAligned(void* ctx, void* ptr, usize old_nbytes,
+                               usize new_nbytes, usize align);
+  static void  tcDeallocSized(void* ctx, void* ptr, usize nbytes, usize align);
+  static bool  tcExpand(void* ctx, void* ptr, usize old_nbytes,
+                        usize new_nbytes);
+};
+
+} // namespace bl::mem
+
+#endif // !BL_THREAD_CACHE_ALLOCATOR_H
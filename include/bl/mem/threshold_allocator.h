@@ -0,0 +1,82 @@
+#ifndef BL_THRESHOLD_ALLOCATOR_H
+#define BL_THRESHOLD_ALLOCATOR_H
+
+#include "bl/mem/allocator.h"      // Allocator
+#include "bl/mem/page_allocator.h" // PageAllocator
+#include "bl/primitives.h"         // usize
+
+namespace bl::mem {
+using namespace primitives;
+
+/// An allocator that routes allocations by size: small ones go to a parent
+/// allocator, and ones of at least `threshold` bytes go to a
+/// `mem::PageAllocator`.
+///
+/// Allocations that cross the threshold when resized are moved to the other
+/// allocator, so the size of an allocation always tells where it lives.
+///
+/// ## Note
+/// Over-aligned allocations (aligned to more than a page) always go to the
+/// parent allocator.
+///
+/// The allocator's state is referenced through `ctx`, so it can't be copied or
+/// moved; pass it around as a `mem::Allocator*` instead.
+struct ThresholdAllocator : Allocator {
+public:
+  /// The default size (in bytes) from which allocations are mapped directly.
+  static const usize DEFAULT_THRESHOLD = 1024 * 1024;
+
+  /// Creates a threshold allocator with `mem::CAllocator` as its parent
+  /// allocator and the default threshold.
+  ThresholdAllocator();
+
+  /// Creates a threshold allocator that routes allocations smaller than
+  /// `threshold` bytes to the given parent allocator.
+  ///
+  /// If `huge_pages` is set, large allocations are backed by transparent huge
+  /// pages where supported.
+  ///
+  /// ## Error
+  /// - Throws an error if the provided parent allocator is null.
+  /// - Throws an error if the threshold is `0`.
+  ThresholdAllocator(Allocator* parent, usize threshold = DEFAULT_THRESHOLD,
+                     bool huge_pages = false);
+
+  ThresholdAllocator(const ThresholdAllocator&)            = delete;
+  ThresholdAllocator& operator=(const ThresholdAllocator&) = delete;
+
+  /// Returns the page allocator used for large allocations.
+  PageAllocator* getPages(void);
+
+  /// Returns the size (in bytes) from which allocations are mapped directly.
+  usize          getThreshold(void) const;
+
+private:
+  /// Allocator used for small allocations.
+  Allocator*    parent;
+
+  /// Allocator used for large allocations.
+  PageAllocator pages;
+
+  /// The size from which allocations go to `pages`.
+  usize         threshold;
+
+  /// Checks if an allocation of the given size and alignment goes to `pages`.
+  bool          isLarge(usize nbytes, usize align) const;
+
+  static void*  thresholdAlloc(void* ctx, usize nbytes);
+  static void   thresholdDealloc(void* ctx, void* ptr);
+  static void*  thresholdResize(void* ctx, void* ptr, usize nbytes);
+  static void*  thresholdAllocAligned(void* ctx, usize nbytes, usize align);
+  static void   thresholdDeallocAligned(void* ctx, void* ptr, usize align);
+  static void*  thresholdResizeAligned(void* ctx, void* ptr, usize old_nbytes,
+                                       usize new_nbytes, usize align);
+  static void   thresholdDeallocSized(void* ctx, void* ptr, usize nbytes,
+                                      usize align);
+  static bool   thresholdExpand(void* ctx, void* ptr, usize old_nbytes,
+                                usize new_nbytes);
+};
+
+} // namespace bl::mem
+
+#endif // !BL_THRESHOLD_ALLOCATOR_H
@@ -0,0 +1,124 @@
+#ifndef BL_TRACKING_ALLOCATOR_H
+#define BL_TRACKING_ALLOCATOR_H
+
+#include "bl/mem/allocator.h" // Allocator
+#include "bl/primitives.h"    // usize
+
+#include <atomic> // atomic
+#include <cstdio> // FILE
+
+namespace bl::mem {
+using namespace primitives;
+
+/// An allocator that forwards to a parent allocator and keeps statistics
+/// about the allocations going through it.
+///
+/// The counters are relaxed atomics, so the allocator is cheap enough to leave
+/// on and can be shared between threads (if the parent allocator can be).
+///
+/// ## Note
+/// Every allocation carries a small header (at least
+/// `Allocator::DEFAULT_ALIGNMENT` bytes) with its size, so unsized
+/// deallocations and resizes can be accounted for.
+///
+/// The allocator's state is referenced through `ctx`, so it can't be copied or
+/// moved; pass it around as a `mem::Allocator*` instead.
+struct TrackingAllocator : Allocator {
+public:
+  /// The number of buckets in the size histogram.
+  static const usize NUM_BUCKETS = 64;
+
+  /// A snapshot of the allocator's statistics.
+  struct Stats {
+    /// The number of allocations.
+    usize allocs;
+
+    /// The number of deallocations.
+    usize frees;
+
+    /// The number of resizes (including ones that were done in place).
+    usize resizes;
+
+    /// The number of resizes that were done in place (see
+    /// `Allocator::tryExpandRaw`).
+    usize expands;
+
+    /// The number of bytes currently allocated.
+    usize live_bytes;
+
+    /// The highest number of bytes allocated at once.
+    usize peak_bytes;
+
+    /// The total number of bytes requested by allocations and resizes.
+    usize total_bytes;
+
+    /// Requested sizes by power of two: bucket `i` counts allocations and
+    /// resizes to sizes in `(2^(i-1), 2^i]` bytes.
+    usize histogram[NUM_BUCKETS];
+  };
+
+  /// Creates a tracking allocator with `mem::CAllocator` as its parent
+  /// allocator.
+  TrackingAllocator();
+
+  /// Creates a tracking allocator that forwards to the given parent allocator.
+  ///
+  /// ## Error
+  /// - Throws an error if the provided parent allocator is null.
+  TrackingAllocator(Allocator* parent);
+
+  TrackingAllocator(const TrackingAllocator&)            = delete;
+  TrackingAllocator& operator=(const TrackingAllocator&) = delete;
+
+  /// Returns a snapshot of the current statistics.
+  ///
+  /// ## Note
+  /// The counters are read one at a time, so a snapshot taken while other
+  /// threads are allocating may be slightly inconsistent.
+  Stats getStats(void) const;
+
+  /// Resets all counters, except for the live bytes (the peak is reset to the
+  /// live bytes).
+  void  resetStats(void);
+
+  /// Prints the current statistics to the given file.
+  void  dump(FILE* file = stdout) const;
+
+private:
+  /// Header placed right before every allocation.
+  struct Header;
+
+  /// Allocator the allocations are forwarded to.
+  Allocator*         parent;
+
+  std::atomic<usize> allocs{0};
+  std::atomic<usize> frees{0};
+  std::atomic<usize> resizes{0};
+  std::atomic<usize> expands{0};
+  std::atomic<usize> live_bytes{0};
+  std::atomic<usize> peak_bytes{0};
+  std::atomic<usize> total_bytes{0};
+  std::atomic<usize> histogram[NUM_BUCKETS] = {};
+
+  /// Records a new allocation (or the new size of a resized one).
+  void               recordAlloc(usize nbytes);
+
+  /// Records that `nbytes` bytes were freed.
+  void               recordFree(usize nbytes);
+
+  static void*       trackingAlloc(void* ctx, usize nbytes);
+  static void        trackingDealloc(void* ctx, void* ptr);
+  static void*       trackingResize(void* ctx, void* ptr, usize nbytes);
+  static void* trackingAllocAligned(void* ctx, usize nbytes, usize align);
+  static void  trackingDeallocAligned(void* ctx, void* ptr, usize align);
+  static void* trackingResizeAligned(void* ctx, void* ptr, usize old_nbytes,
+                                     usize new_nbytes, usize align);
+  static void  trackingDeallocSized(void* ctx, void* ptr, usize nbytes,
+                                    usize align);
+  static bool  trackingExpand(void* ctx, void* ptr, usize old_nbytes,
+                              usize new_nbytes);
+};
+
+} // namespace bl::mem
+
+#endif // !BL_TRACKING_ALLOCATOR_H
@@ -0,0 +1,270 @@
+#ifndef BL_PAR_ALGORITHMS_H
+#define BL_PAR_ALGORITHMS_H
+
+#include "bl/ds/dynamic_array.h" // DynamicArray, getDefaultAllocator
+#include "bl/error.h"            // resetError, BL_THROW
+#include "bl/mem/allocator.h"    // Allocator
+#include "bl/par/thread_pool.h"  // ThreadPool
+#include "bl/primitives.h"       // const_cstr, usize
+
+#include <algorithm>   // sort, inplace_merge, min
+#include <cstring>     // memcpy
+#include <functional>  // less
+#include <new>         // placement new
+#include <type_traits> // remove_reference, is_trivially_copyable
+#include <utility>     // declval, move
+
+/// Parallel algorithms over contiguous ranges.
+///
+/// Every algorithm takes a range: anything with `begin()`/`end()` returning
+/// pointers, like `ds::DynamicArray`, `ds::SmallDynamicArray` or `ds::Span`
+/// (to work on part of an array). The range is split into chunks of about
+/// `CHUNK_BYTES` bytes, which are handed out to the threads of a
+/// `ThreadPool` (the global one, unless another pool is given).
+namespace bl::par {
+using namespace primitives;
+
+/// The (approximate) size of the chunks ranges are split into; small enough
+/// for a chunk to stay in a core's L2 cache.
+const usize CHUNK_BYTES = 64 * 1024;
+
+namespace par_internal {
+enum class ParallelError {
+  LengthMismatch,
+  BufferAllocationFailed,
+};
+
+const_cstr errMsg(ParallelError err);
+
+/// The element type of a range.
+template <typename Range>
+using Elem = typename std::remove_reference<
+    decltype(*std::declval<Range&>().begin())>::type;
+
+/// Returns the number of elements per chunk.
+template <typename T> inline usize chunkLen(void) {
+  return sizeof(T) >= CHUNK_BYTES ? 1 : CHUNK_BYTES / sizeof(T);
+}
+
+/// Returns the number of chunks `len` elements are split into.
+template <typename T> inline usize numChunks(usize len) {
+  return (len + chunkLen<T>() - 1) / chunkLen<T>();
+}
+
+/// Runs `fn(start, end)` for every chunk of `len` elements.
+template <typename T, typename Fn>
+inline void forChunks(ThreadPool* pool, usize len, Fn&& fn) {
+  usize chunk = chunkLen<T>();
+  pool->run(numChunks<T>(len), [&](usize idx) {
+    usize start = idx * chunk;
+    fn(start, std::min(start + chunk, len));
+  });
+}
+} // namespace par_internal
+
+/// Calls `fn(elem)` for every element of the range.
+///
+/// ## Note
+/// The order the elements are visited in is unspecified, and `fn` is called
+/// from several threads at once.
+template <typename Range, typename Fn>
+void parallelForEach(Range&& range, Fn fn,
+                     ThreadPool* pool = ThreadPool::getGlobal()) {
+  typedef par_internal::Elem<Range> T;
+
+  T*    data = range.begin();
+  usize len  = static_cast<usize>(range.end() - data);
+  par_internal::forChunks<T>(pool, len, [&](usize start, usize end) {
+    for (usize i = start; i < end; i++) {
+      fn(data[i]);
+    }
+  });
+}
+
+/// Stores `fn(src[i])` in `dst[i]` for every element of `src`.
+///
+/// ## Error
+/// - Throws an error if the ranges have different lengths.
+template <typename Src, typename Dst, typename Fn>
+void parallelTransform(Src&& src, Dst&& dst, Fn fn,
+                       ThreadPool* pool = ThreadPool::getGlobal()) {
+  typedef par_internal::Elem<Src> T;
+
+  T*    in  = src.begin();
+  auto* out = dst.begin();
+  usize len = static_cast<usize>(src.end() - in);
+
+  // Input validation
+  {
+    Error::resetError();
+    if (static_cast<usize>(dst.end() - out) != len) {
+      BL_THROW(par_internal::errMsg(
+          par_internal::ParallelError::LengthMismatch));
+      return;
+    }
+  }
+
+  par_internal::forChunks<T>(pool, len, [&](usize start, usize end) {
+    for (usize i = start; i < end; i++) {
+      out[i] = fn(in[i]);
+    }
+  });
+}
+
+/// Combines the elements of the range with `op`, starting from `init`.
+///
+/// Every chunk is reduced on its own (starting from its first element), and
+/// the per-chunk results are then combined in order, so `op` has to be
+/// associative, but not commutative.
+///
+/// ## Note
+/// The chunks only depend on the length of the range (not on the number of
+/// threads), so the result is the same on every run and pool; even for
+/// floating-point sums.
+template <typename T, typename Range, typename Op>
+T parallelReduce(Range&& range, T init, Op op,
+                 ThreadPool* pool = ThreadPool::getGlobal()) {
+  typedef par_internal::Elem<Range> E;
+
+  E*    data = range.begin();
+  usize len  = static_cast<usize>(range.end() - data);
+  if (len == 0) {
+    return init;
+  }
+
+  usize               chunk    = par_internal::chunkLen<E>();
+  ds::DynamicArray<T> partials = ds::DynamicArray<T>();
+  partials.resizeTo(par_internal::numChunks<E>(len), init);
+
+  par_internal::forChunks<E>(pool, len, [&](usize start, usize end) {
+    T acc = data[start];
+    for (usize i = start + 1; i < end; i++) {
+      acc = op(acc, data[i]);
+    }
+    partials.getUnchecked(start / chunk) = acc;
+  });
+
+  T result = init;
+  for (const T& partial : partials) {
+    result = op(result, partial);
+  }
+  return result;
+}
+
+/// Sorts the range with the comparison function `cmp` (`<` by default).
+///
+/// Chunks are sorted in parallel and then merged pairwise (in parallel as
+/// well), doubling the length of the sorted runs every round.
+///
+/// ## Note
+/// The sort isn't stable. The last rounds merge only a few (long) runs, so
+/// they don't scale with the number of threads.
+template <typename Range,
+          typename Cmp = std::less<par_internal::Elem<Range>>>
+void parallelSort(Range&& range, Cmp cmp = Cmp(),
+                  ThreadPool* pool = ThreadPool::getGlobal()) {
+  typedef par_internal::Elem<Range> T;
+
+  T*    data = range.begin();
+  usize len  = static_cast<usize>(range.end() - data);
+
+  par_internal::forChunks<T>(pool, len, [&](usize start, usize end) {
+    std::sort(data + start, data + end, cmp);
+  });
+
+  for (usize width = par_internal::chunkLen<T>(); width < len; width *= 2) {
+    usize num_pairs = (len + 2 * width - 1) / (2 * width);
+    pool->run(num_pairs, [&](usize pair) {
+      usize lo  = pair * 2 * width;
+      usize mid = std::min(lo + width, len);
+      usize hi  = std::min(lo + 2 * width, len);
+      if (mid < hi) {
+        std::inplace_merge(data + lo, data + mid, data + hi, cmp);
+      }
+    });
+  }
+}
+
+/// Moves the elements for which `pred(elem)` returns `true` to the front of
+/// the range, and returns how many there are.
+///
+/// ## Note
+/// The partition is stable (both halves keep their order). `pred` is called
+/// twice for every element, so it must not have side effects; the elements
+/// are moved through a temporary buffer from the default allocator.
+///
+/// ## Error
+/// - Throws an error if the temporary buffer couldn't be allocated (the range
+/// is left unchanged and `0` is returned).
+template <typename Range, typename Pred>
+usize parallelPartition(Range&& range, Pred pred,
+                        ThreadPool* pool = ThreadPool::getGlobal()) {
+  typedef par_internal::Elem<Range> T;
+
+  Error::resetError();
+
+  T*    data = range.begin();
+  usize len  = static_cast<usize>(range.end() - data);
+  if (len == 0) {
+    return 0;
+  }
+
+  mem::Allocator* allocator =
+      ds::dynamic_array_internal::getDefaultAllocator();
+  T* tmp = (T*)allocator->allocAlignedRaw(len * sizeof(T), alignof(T));
+  if (tmp == nullptr) {
+    BL_THROW(par_internal::errMsg(
+        par_internal::ParallelError::BufferAllocationFailed));
+    return 0;
+  }
+
+  // Count the matching elements of every chunk...
+  usize                   chunk  = par_internal::chunkLen<T>();
+  usize                   chunks = par_internal::numChunks<T>(len);
+  ds::DynamicArray<usize> counts = ds::DynamicArray<usize>();
+  counts.resizeTo(chunks, 0);
+  par_internal::forChunks<T>(pool, len, [&](usize start, usize end) {
+    usize count = 0;
+    for (usize i = start; i < end; i++) {
+      count += pred(data[i]) ? 1 : 0;
+    }
+    counts.getUnchecked(start / chunk) = count;
+  });
+
+  // ...to find where each chunk's elements go...
+  usize num_true = 0;
+  for (usize& count : counts) {
+    usize offset  = num_true;
+    num_true     += count;
+    count         = offset;
+  }
+
+  // ...move them there...
+  par_internal::forChunks<T>(pool, len, [&](usize start, usize end) {
+    usize true_pos  = counts.getUnchecked(start / chunk);
+    usize false_pos = num_true + (start - true_pos);
+    for (usize i = start; i < end; i++) {
+      usize pos = pred(data[i]) ? true_pos++ : false_pos++;
+      new (tmp + pos) T(std::move(data[i]));
+    }
+  });
+
+  // ...and back
+  par_internal::forChunks<T>(pool, len, [&](usize start, usize end) {
+    if constexpr (std::is_trivially_copyable<T>::value) {
+      memcpy(data + start, tmp + start, (end - start) * sizeof(T));
+    } else {
+      for (usize i = start; i < end; i++) {
+        data[i] = std::move(tmp[i]);
+        tmp[i].~T();
+      }
+    }
+  });
+
+  allocator->deallocSizedRaw(tmp, len * sizeof(T), alignof(T));
+  return num_true;
+}
+
+} // namespace bl::par
+
+#endif // !BL_PAR_ALGORITHMS_H
@@ -0,0 +1,123 @@
+#ifndef BL_THREAD_POOL_H
+#define BL_THREAD_POOL_H
+
+#include "bl/ds/dynamic_array.h" // DynamicArray
+#include "bl/primitives.h"       // usize, u64
+
+#include <atomic>             // atomic
+#include <condition_variable> // condition_variable
+#include <mutex>              // mutex
+#include <thread>             // thread
+#include <type_traits>        // remove_reference
+
+namespace bl::par {
+using namespace primitives;
+
+/// A fixed set of worker threads that run batches of tasks.
+///
+/// A batch is a number of tasks (`0..num_tasks`) that all run the same
+/// function; the tasks are handed out one at a time through an atomic
+/// counter, so uneven tasks balance out across the threads. The thread that
+/// submits a batch works on it as well, and returns once every task of the
+/// batch has finished.
+///
+/// ## Note
+/// Batches submitted from several threads at once run one after another. A
+/// batch submitted from inside a task (a nested parallel algorithm) runs
+/// serially on the calling worker instead of deadlocking.
+struct ThreadPool {
+public:
+  /// The function run for every task of a batch.
+  typedef void (*TaskFn)(void* ctx, usize task);
+
+  /// Creates a pool with one thread per hardware thread (counting the thread
+  /// that submits batches).
+  ThreadPool();
+
+  /// Creates a pool where batches run on `num_threads` threads (counting the
+  /// thread that submits them, so `num_threads - 1` workers are started).
+  ///
+  /// ## Error
+  /// - Throws an error if the thread count is `0`.
+  ThreadPool(usize num_threads);
+
+  ThreadPool(const ThreadPool&)            = delete;
+  ThreadPool& operator=(const ThreadPool&) = delete;
+
+  /// Stops and joins the worker threads.
+  ~ThreadPool();
+
+  /// Returns the process-wide pool (with one thread per hardware thread).
+  ///
+  /// ## Note
+  /// The pool is created on first use and never destroyed.
+  static ThreadPool* getGlobal(void);
+
+  /// Returns the number of threads batches run on (including the thread that
+  /// submits them).
+  usize              getThreadCount(void) const;
+
+  /// Runs `fn(ctx, task)` for every task in `0..num_tasks`, and waits for all
+  /// of them to finish.
+  void               runRaw(usize num_tasks, TaskFn fn, void* ctx);
+
+  /// Runs `fn(task)` for every task in `0..num_tasks`, and waits for all of
+  /// them to finish.
+  template <typename Fn> void run(usize num_tasks, Fn&& fn) {
+    typedef typename std::remove_reference<Fn>::type Func;
+    this->runRaw(
+        num_tasks,
+        [](void* ctx, usize task) { (*static_cast<Func*>(ctx))(task); },
+        const_cast<void*>(static_cast<const void*>(&fn)));
+  }
+
+private:
+  /// The worker threads.
+  ds::DynamicArray<std::thread> workers;
+
+  /// Serializes batches submitted from different threads.
+  std::mutex                    submit_lock;
+
+  /// Protects the fields below.
+  std::mutex                    state_lock;
+
+  /// Signals workers that a new batch (or shutdown) is available.
+  std::condition_variable       wake;
+
+  /// Signals the submitting thread that workers left the batch.
+  std::condition_variable       done;
+
+  /// Incremented for every new batch.
+  u64                           generation = 0;
+
+  /// Set when the pool is destroyed.
+  bool                          stopping   = false;
+
+  /// The current batch.
+  TaskFn                        task_fn    = nullptr;
+  void*                         task_ctx   = nullptr;
+  usize                         num_tasks  = 0;
+
+  /// The next task to hand out.
+  std::atomic<usize>            next_task  = 0;
+
+  /// The number of finished tasks of the current batch.
+  usize                         finished   = 0;
+
+  /// The number of workers currently working on the batch.
+  usize                         active     = 0;
+
+  /// Starts `num_workers` worker threads.
+  void                          start(usize num_workers);
+
+  /// The loop run by every worker thread.
+  void                          workerLoop(void);
+
+  /// Runs tasks of the current batch until there are none left, and returns
+  /// how many it ran.
+  usize                         work(TaskFn fn, void* ctx, usize num_tasks);
+};
+
+} // namespace bl::par
+
+#endif // !BL_THREAD_POOL_H
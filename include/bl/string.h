@@ -1,26 +1,45 @@
 #ifndef BL_STRING_H
 #define BL_STRING_H
 
+#include "bl/config.h"        // BL_BOUNDS_CHECKS
 #include "bl/mem/allocator.h" // Allocator
 #include "bl/primitives.h"    // cstr, const_cstr, usize
+#include "bl/string_view.h"   // StringView
 
 namespace bl {
 using namespace primitives;
 
 /// A dynamic string buffer.
+///
+/// Strings of up to `String::INLINE_CAP` characters are stored inside the
+/// object itself (small string optimization), so short strings never touch
+/// the allocator; once the contents outgrow the inline buffer, they are moved
+/// to a buffer from the allocator. The buffer is always null-terminated.
+///
+/// Strings created without an allocator use `mem::CAllocator`, or
+/// `mem::ThreadCacheAllocator::getGlobal()` if the library was built with
+/// `-Ddefault_allocator=thread_cache`.
+///
+/// ## Note
+/// Pointers into the string (e.g. from `String::getRaw`) are invalidated when
+/// the string is moved, since inline contents move with it.
 struct String {
 public:
+  /// The number of characters stored without allocating (not counting the
+  /// null-terminator).
+  static const usize INLINE_CAP = 23;
+
   /// Creates an empty string with the `mem::CAllocator` as its backing
   /// allocator.
   ///
   /// ## Note
-  /// Nothing is allocated until the first push.
+  /// Nothing is allocated until the string outgrows its inline buffer.
   String();
 
   /// Creates an empty string backed by the given allocator.
   ///
   /// ## Note
-  /// Nothing is allocated until the first push.
+  /// Nothing is allocated until the string outgrows its inline buffer.
   ///
   /// ## Error
   /// - Throws an error if the provided allocator is null.
@@ -30,8 +49,8 @@ public:
   /// allocator.
   ///
   /// ## Note
-  /// If the capacity is `0`, then this just calls the `String(mem::Allocator*)`
-  /// constructor (nothing gets allocated).
+  /// If the capacity fits in the inline buffer, then this just calls the
+  /// `String(mem::Allocator*)` constructor (nothing gets allocated).
   ///
   /// ## Error
   /// - Throws an error if the provided allocator is null.
@@ -56,6 +75,14 @@ public:
   /// - Throws an error if allocator is unable to allocate space for the buffer.
   String(const_cstr str);
 
+  /// Creates a string containing a copy of the viewed characters, with the
+  /// given allocator as its backing allocator.
+  ///
+  /// ## Error
+  /// - Throws an error if the provided allocator is null.
+  /// - Throws an error if allocator is unable to allocate space for the buffer.
+  String(mem::Allocator* allocator, StringView view);
+
   /// Clones the string.
   ///
   /// ## Note
@@ -66,29 +93,99 @@ public:
   /// - Throws an error if allocator is unable to allocate space for the buffer.
   String(const String&);
 
+  /// Moves the contents of `other` into a new string.
+  ///
+  /// ## Note
+  /// A heap buffer is taken over as is, inline contents are copied; `other`
+  /// is left empty and can still be used.
+  String(String&& other);
+
   /// Deallocates memory used by the string.
   ~String();
 
-  String&    operator=(const String&) = default;
+  /// Replaces the string's contents with a clone of `other`'s.
+  ///
+  /// ## Error
+  /// - Throws an error if allocator is unable to allocate space for the buffer.
+  String&    operator=(const String& other);
+
+  /// Replaces the string's contents with `other`'s.
+  ///
+  /// ## Note
+  /// The string's old buffer is deallocated; `other` is left empty and can
+  /// still be used.
+  String&    operator=(String&& other);
 
   /// Operator overload for index operator.
   ///
+  /// ## Note
+  /// This is only bounds-checked if `BL_BOUNDS_CHECKS` is enabled (see
+  /// `bl/config.h`); use `String::at` for an access that is always checked.
+  ///
+  /// ## Error
+  /// - Throws an error if the index is out of the string's bounds.
+  char&      operator[](usize idx) {
+#if BL_BOUNDS_CHECKS
+    return this->at(idx);
+#else
+    return this->data[idx];
+#endif
+  }
+
+  /// Returns the character at the specified index.
+  ///
   /// ## Error
   /// - Throws an error if the index is out of the string's bounds.
-  char&      operator[](usize idx);
+  char&      at(usize idx);
+
+  /// Returns the character at the specified index without checking the
+  /// bounds.
+  ///
+  /// ## Note
+  /// The index must be less than the length of the string.
+  char&      getUnchecked(usize idx) { return this->data[idx]; }
 
   /// Returns the underyling string buffer.
   const_cstr getRaw(void) const;
 
+  /// Returns a view of the string's contents.
+  ///
+  /// ## Note
+  /// Nothing is copied; the view is invalidated when the string is changed,
+  /// moved or destroyed.
+  StringView getView(void) const { return StringView(this->data, this->len); }
+
+  /// Converts the string to a view of its contents (see `String::getView`).
+  operator StringView(void) const { return this->getView(); }
+
+  /// Returns a view of the characters in the range `[start, end)`.
+  ///
+  /// ## Note
+  /// This is the non-copying alternative to `String::split`; use
+  /// `StringView::split`, `StringView::splitOn` and `StringView::find` on the
+  /// view to keep parsing without allocating.
+  ///
+  /// ## Error
+  /// - Throws an error if the range is out of the string's bounds (and returns
+  /// an empty view).
+  StringView slice(usize start, usize end) const;
+
   /// Returns the length of the string (doesn't count the null-terminator).
   usize      getLen(void) const;
 
   /// Returns the capacity of the string (doesn't count the null-terminator).
+  ///
+  /// ## Note
+  /// This is `String::INLINE_CAP` while the contents are stored inline.
   usize      getCap(void) const;
 
   /// Checks if the string is empty.
   bool       isEmpty(void) const;
 
+  /// Checks if the contents are stored in the inline buffer (i.e. the string
+  /// doesn't own an allocation).
+  bool       isInline(void) const { return this->data == this->small; }
+
   /// Removes all of the string's contents, but leaves the capacity unchanged.
   void       clear(void);
 
@@ -111,6 +208,38 @@ public:
   /// - Throws an error if the string failed to resize.
   void       push(const_cstr str);
 
+  /// Appends `len` characters starting at `src` to the end of the string.
+  ///
+  /// ## Note
+  /// The string grows (at most) once, to fit all of the characters, and they
+  /// are copied in one go; `src` may point into the string itself.
+  ///
+  /// ## Error
+  /// - Throws an error if `src` is null (and `len` isn't `0`).
+  /// - Throws an error if the string failed to resize.
+  void       append(const char* src, usize len);
+
+  /// Appends the viewed characters to the end of the string.
+  ///
+  /// ## Note
+  /// Strings convert to views, so this also appends a `String`.
+  ///
+  /// ## Error
+  /// - Throws an error if the string failed to resize.
+  void       append(StringView view);
+
+  /// Makes sure the string has space for at least `capacity` characters in
+  /// total (not counting the null-terminator).
+  ///
+  /// ## Note
+  /// The capacity grows to exactly `capacity` if it's too small, and never
+  /// shrinks; use this before a known amount of appends to avoid repeated
+  /// resizing.
+  ///
+  /// ## Error
+  /// - Throws an error if the string failed to resize.
+  void       reserve(usize capacity);
+
   /// Removes and returns the last character in the string.
   ///
   /// ## Note
@@ -124,7 +253,7 @@ public:
   ///
   /// ## Note
   /// This is an **O(n)** operation since it requires copying every character in
-  /// the buffer.
+  /// the buffer. An index equal to the length appends the character.
   ///
   /// ## Error
   /// - Throws an error if the index is out of the string's bounds.
@@ -135,7 +264,7 @@ public:
   ///
   /// ##Note
   /// This is an **O(n)** operation since it requires copying every character in
-  /// the buffer.
+  /// the buffer. An index equal to the length appends the C-string.
   ///
   /// ## Error
   /// - Throws an error if the provided C-string is null.
@@ -153,17 +282,79 @@ public:
   /// - Throws an error if the index is out of the string's bounds.
   char       remove(usize idx);
 
-  /// Checks if the string contains the specified sub-string.
+  /// Replaces the characters in the range `[first, last)` with the viewed
+  /// characters.
+  ///
+  /// ## Note
+  /// The rest of the string is shifted in place, so this resizes (at most)
+  /// once, and only if the string grows past its capacity; `str` may point
+  /// into the string itself.
+  ///
+  /// ## Error
+  /// - Throws an error if the range is out of the string's bounds.
+  /// - Throws an error if the string failed to resize.
+  void       replaceRange(usize first, usize last, StringView str);
+
+  /// Removes the characters in the range `[first, last)` from the string.
+  ///
+  /// ## Note
+  /// This never resizes the string.
+  ///
+  /// ## Error
+  /// - Throws an error if the range is out of the string's bounds.
+  void       eraseRange(usize first, usize last);
+
+  /// Replaces every (non-overlapping) occurrence of `needle` with
+  /// `replacement`, and returns the number of occurrences replaced.
   ///
-  /// This will return the index where the sub-string was found, or `-1` if it
-  /// wasn't found.
+  /// ## Note
+  /// The occurrences are counted first, so the string resizes (at most) once
+  /// and every character is moved (at most) once. An empty needle doesn't
+  /// match anything; `needle` and `replacement` may point into the string
+  /// itself.
   ///
   /// ## Error
-  /// - Throws an error if the sub-string is null.
-  i32        find(const_cstr substr) const;
+  /// - Throws an error if the string failed to resize.
+  usize      replaceAll(StringView needle, StringView replacement);
+
+  /// Returns the index of the first occurrence of the sub-string, or
+  /// `StringView::NOT_FOUND` if there is none (see `StringView::find`).
+  usize      find(StringView substr) const {
+    return this->getView().find(substr);
+  }
+
+  /// Returns the index of the first occurrence of the sub-string that starts
+  /// at or after `pos`, or `StringView::NOT_FOUND` if there is none.
+  usize      findFrom(StringView substr, usize pos) const {
+    return this->getView().findFrom(substr, pos);
+  }
+
+  /// Returns the index of the last occurrence of the sub-string, or
+  /// `StringView::NOT_FOUND` if there is none.
+  usize      rfind(StringView substr) const {
+    return this->getView().rfind(substr);
+  }
+
+  /// Returns the number of (non-overlapping) occurrences of the sub-string.
+  usize      count(StringView substr) const {
+    return this->getView().count(substr);
+  }
+
+  /// Returns a lazy range over the indices of the (non-overlapping)
+  /// occurrences of the sub-string (see `StringView::findAll`).
+  ///
+  /// ## Note
+  /// The range is invalidated when the string is changed, moved or destroyed.
+  StringView::Matches findAll(StringView substr) const {
+    return this->getView().findAll(substr);
+  }
 
   /// Shrinks the capacity of the string to match its length.
   ///
+  /// ## Note
+  /// Contents that fit in the inline buffer are moved back into it (and the
+  /// heap buffer is deallocated).
+  ///
   /// ## Error
   /// - Throws an error if the string failed to resize.
   void       shrinkToFit(void);
@@ -197,19 +388,58 @@ public:
 
 private:
   /// Backing allocator used for internal allocations.
-  mem::Allocator* allocator;
-
-  /// The actual string buffer.
-  cstr            data = nullptr;
+  mem::Allocator* allocator = nullptr;
 
-  /// The number of bytes allocated by/for the string.
-  usize           cap  = 0;
+  /// The actual string buffer (either the inline buffer or an allocation).
+  cstr            data      = this->small;
 
   /// The length of the string.
-  usize           len  = 0;
+  usize           len       = 0;
+
+  union {
+    /// The capacity of the heap buffer (not counting the null-terminator).
+    usize heap_cap;
+
+    /// The inline buffer (including the null-terminator).
+    char  small[INLINE_CAP + 1] = {};
+  };
+
+  /// Function to resize the string so it can hold at least `required`
+  /// characters.
+  void            resize(usize required);
+
+  /// Moves the contents to a heap buffer with exactly `capacity` characters
+  /// (which must be more than the current capacity).
+  void            reallocate(usize capacity);
+
+  /// Checks if the `len` characters starting at `src` overlap the string's
+  /// contents.
+  bool            overlaps(const char* src, usize len) const;
+
+  /// Replaces the characters in the range `[first, last)` with `len`
+  /// characters from `src` (which may point into the string).
+  void            replaceChars(usize first, usize last, const char* src,
+                               usize len);
+
+  /// Copies `src` into `dst`, with every occurrence of `needle` replaced
+  /// (`dst` may overlap `src` as long as it never passes the read position).
+  static void     writeReplaced(char* dst, StringView src, StringView needle,
+                                StringView replacement);
+
+  /// Returns the capacity to resize to so the string can hold at least
+  /// `required` characters.
+  usize           grownCap(usize required) const;
+
+  /// Copies `len` characters from `src` into an empty inline string, moving
+  /// it to the allocator if they don't fit.
+  void            assign(const char* src, usize len);
+
+  /// Deallocates the heap buffer (if any) and makes the string an empty
+  /// inline string.
+  void            release(void);
 
-  /// Function to resize the string.
-  void            resize(void);
+  /// Takes over the contents of `other`, leaving it empty.
+  void            take(String& other);
 };
 
 } // namespace bl
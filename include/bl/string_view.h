@@ -0,0 +1,282 @@
+#ifndef BL_STRING_VIEW_H
+#define BL_STRING_VIEW_H
+
+#include "bl/config.h"     // BL_BOUNDS_CHECKS
+#include "bl/error.h"      // resetError, BL_THROW, printErrorTrace
+#include "bl/primitives.h" // const_cstr, usize, i32, u64
+
+#include <cstdlib>    // abort
+#include <functional> // hash
+
+namespace bl {
+using namespace primitives;
+
+namespace string_view_internal {
+enum class StringViewError {
+  InvalidCString,
+  IndexOutOfBounds,
+  InvalidRange,
+};
+
+const_cstr errMsg(StringViewError err);
+} // namespace string_view_internal
+
+/// A non-owning view of a sequence of characters (a pointer and a length).
+///
+/// Views are cheap to copy, and slicing, splitting or trimming one just
+/// returns another view into the same characters, so strings can be parsed
+/// without allocating. `String` converts to a view for free.
+///
+/// ## Note
+/// The characters aren't necessarily null-terminated, so `StringView::getRaw`
+/// must not be passed to functions expecting a C-string. The view doesn't keep
+/// the characters alive; it is invalidated when the underlying buffer is
+/// changed or freed (e.g. by pushing to the `String` it was created from).
+struct StringView {
+public:
+  /// The index returned by `StringView::find` if nothing was found.
+  static const usize NOT_FOUND = ~usize(0);
+
+  /// Creates an empty view.
+  StringView() = default;
+
+  /// Creates a view of the `len` characters starting at `data`.
+  StringView(const char* data, usize len) : data(data), len(len) {}
+
+  /// Creates a view of the given C-string (without its null-terminator).
+  ///
+  /// ## Error
+  /// - Throws an error if the C-string is null (and creates an empty view).
+  StringView(const_cstr str);
+
+  /// Operator overload for index operator.
+  ///
+  /// ## Note
+  /// This is only bounds-checked if `BL_BOUNDS_CHECKS` is enabled (see
+  /// `bl/config.h`); use `StringView::at` for an access that is always
+  /// checked.
+  ///
+  /// ## Error
+  /// - Throws an error if the index is out of the view's bounds.
+  char operator[](usize idx) const {
+#if BL_BOUNDS_CHECKS
+    return this->at(idx);
+#else
+    return this->data[idx];
+#endif
+  }
+
+  /// Returns the character at the specified index.
+  ///
+  /// ## Error
+  /// - Throws an error if the index is out of the view's bounds.
+  char at(usize idx) const {
+    if (idx >= this->len) {
+      Error::resetError();
+      BL_THROW(string_view_internal::errMsg(
+          string_view_internal::StringViewError::IndexOutOfBounds));
+      Error::printErrorTrace();
+      abort();
+    }
+
+    return this->data[idx];
+  }
+
+  /// Returns the character at the specified index without checking the
+  /// bounds.
+  ///
+  /// ## Note
+  /// The index must be less than the length of the view.
+  char        getUnchecked(usize idx) const { return this->data[idx]; }
+
+  /// Returns the first character of the view (not null-terminated).
+  const char* getRaw(void) const { return this->data; }
+
+  /// Returns the length of the view.
+  usize       getLen(void) const { return this->len; }
+
+  /// Checks if the view is empty.
+  bool        isEmpty(void) const { return this->len == 0; }
+
+  const char* begin(void) const { return this->data; }
+
+  const char* end(void) const { return this->data + this->len; }
+
+  /// Returns a view of the characters in the range `[start, end)`.
+  ///
+  /// ## Error
+  /// - Throws an error if the range is out of the view's bounds (and returns
+  /// an empty view).
+  StringView  slice(usize start, usize end) const;
+
+  /// Returns the index of the first occurrence of `needle`, or
+  /// `StringView::NOT_FOUND` if there is none.
+  ///
+  /// ## Note
+  /// An empty needle is found at index `0`. The search is vectorized, falls
+  /// back to the Two-Way algorithm when that gets expensive (see
+  /// `ds::search_internal::findBytes`), and doesn't stop at null characters.
+  usize       find(StringView needle) const;
+
+  /// Returns the index of the first occurrence of `chr`, or
+  /// `StringView::NOT_FOUND` if there is none.
+  usize       find(char chr) const;
+
+  /// Returns the index of the first occurrence of `needle` that starts at or
+  /// after `pos`, or `StringView::NOT_FOUND` if there is none (or `pos` is
+  /// past the end of the view).
+  usize       findFrom(StringView needle, usize pos) const;
+
+  /// Returns the index of the last occurrence of `needle`, or
+  /// `StringView::NOT_FOUND` if there is none.
+  ///
+  /// ## Note
+  /// An empty needle is found at the end of the view.
+  usize       rfind(StringView needle) const;
+
+  /// Returns the number of (non-overlapping) occurrences of `needle`.
+  ///
+  /// ## Note
+  /// An empty needle doesn't match anything.
+  usize       count(StringView needle) const;
+
+  /// A lazy range over the indices of the (non-overlapping) occurrences of a
+  /// needle, in order (see `StringView::findAll`).
+  struct Matches;
+
+  /// Returns a range over the indices of the (non-overlapping) occurrences of
+  /// `needle`, in order.
+  ///
+  /// ## Note
+  /// Each occurrence is only searched for when the iterator is advanced to
+  /// it, so stopping early doesn't scan the rest of the view. The range
+  /// doesn't own the views; it is invalidated with them. An empty needle
+  /// doesn't match anything.
+  Matches     findAll(StringView needle) const;
+
+  /// Checks if the view starts with `prefix`.
+  bool        startsWith(StringView prefix) const;
+
+  /// Checks if the view ends with `suffix`.
+  bool        endsWith(StringView suffix) const;
+
+  /// Returns the view without leading and trailing whitespace.
+  StringView  trim(void) const;
+
+  /// Returns the view without leading whitespace.
+  StringView  trimStart(void) const;
+
+  /// Returns the view without trailing whitespace.
+  StringView  trimEnd(void) const;
+
+  /// Splits the view into two at the given index.
+  ///
+  /// The view is left with the characters in the range `[0, idx)`, and the
+  /// returned view contains the characters in the range `[idx, len)` (like
+  /// `String::split`, but without copying).
+  ///
+  /// ## Error
+  /// - Throws an error if the index is past the end of the view (and returns
+  /// an empty view).
+  StringView  split(usize idx);
+
+  /// Splits off the characters before the first `delim`.
+  ///
+  /// Returns the characters before the delimiter, and leaves the view with
+  /// the characters after it; if there is no delimiter, the whole view is
+  /// returned and the view is left empty. Calling this until the view is
+  /// empty tokenizes it.
+  StringView  splitOn(char delim);
+
+  /// Compares the views lexicographically (by unsigned character values).
+  ///
+  /// Returns a negative number if this view goes first, `0` if they're equal,
+  /// and a positive number otherwise.
+  i32         compare(StringView other) const;
+
+  bool operator==(StringView other) const { return this->compare(other) == 0; }
+
+  bool operator!=(StringView other) const { return this->compare(other) != 0; }
+
+  bool operator<(StringView other) const { return this->compare(other) < 0; }
+
+  /// Returns a 64-bit FNV-1a hash of the characters.
+  u64  getHash(void) const;
+
+private:
+  /// The first character of the view.
+  const char* data = "";
+
+  /// The number of characters in the view.
+  usize       len  = 0;
+};
+
+struct StringView::Matches {
+public:
+  struct Iterator {
+  public:
+    usize operator*(void) const { return this->pos; }
+
+    Iterator& operator++(void) {
+      this->pos = this->matches->hay.findFrom(
+          this->matches->needle, this->pos + this->matches->needle.len);
+      return *this;
+    }
+
+    bool operator==(const Iterator& other) const {
+      return this->pos == other.pos;
+    }
+
+    bool operator!=(const Iterator& other) const {
+      return this->pos != other.pos;
+    }
+
+  private:
+    friend struct Matches;
+
+    Iterator(const Matches* matches, usize pos)
+        : matches(matches), pos(pos) {}
+
+    /// The range being iterated.
+    const Matches* matches;
+
+    /// The index of the current occurrence (`StringView::NOT_FOUND` at the
+    /// end).
+    usize          pos;
+  };
+
+  Iterator begin(void) const {
+    return Iterator(this, this->needle.isEmpty()
+                              ? NOT_FOUND
+                              : this->hay.find(this->needle));
+  }
+
+  Iterator end(void) const { return Iterator(this, NOT_FOUND); }
+
+private:
+  friend struct StringView;
+
+  Matches(StringView hay, StringView needle) : hay(hay), needle(needle) {}
+
+  /// The view being searched.
+  StringView hay;
+
+  /// The view being searched for.
+  StringView needle;
+};
+
+inline StringView::Matches StringView::findAll(StringView needle) const {
+  return Matches(*this, needle);
+}
+
+} // namespace bl
+
+namespace std {
+/// Hashes views by their characters (so they can be used as keys of
+/// `std::unordered_map`).
+template <> struct hash<bl::StringView> {
+  size_t operator()(bl::StringView view) const { return view.getHash(); }
+};
+} // namespace std
+
+#endif // !BL_STRING_VIEW_H
@@ -0,0 +1,348 @@
+#ifndef BL_SCHEDULER_H
+#define BL_SCHEDULER_H
+
+#include "bl/ds/dynamic_array.h" // DynamicArray
+#include "bl/mem/allocator.h"    // Allocator
+#include "bl/primitives.h"       // usize, u64
+
+#include <atomic>             // atomic
+#include <condition_variable> // condition_variable
+#include <cstddef>            // max_align_t
+#include <mutex>              // mutex
+#include <new>                // placement new
+#include <type_traits>        // decay
+#include <utility>            // forward
+
+namespace bl::task {
+using namespace primitives;
+
+struct Scheduler;
+
+/// A set of tasks that can be waited for together (see `Scheduler::spawn`
+/// and `Scheduler::wait`).
+///
+/// ## Note
+/// The group must outlive its tasks, so always wait for it before it goes out
+/// of scope.
+struct TaskGroup {
+public:
+  TaskGroup()                            = default;
+  TaskGroup(const TaskGroup&)            = delete;
+  TaskGroup& operator=(const TaskGroup&) = delete;
+
+  /// Checks if all tasks of the group have finished.
+  bool isDone(void) const;
+
+private:
+  friend Scheduler;
+
+  /// The number of tasks that haven't finished yet.
+  std::atomic<usize> pending = 0;
+};
+
+/// A work-stealing task scheduler.
+///
+/// Every worker thread has its own Chase-Lev deque (see `task::WorkDeque`):
+/// tasks spawned on a worker are pushed to and popped from the bottom of its
+/// deque (so it works depth-first on its own tasks), and idle workers steal
+/// the oldest tasks from the top of other workers' deques. Tasks spawned from
+/// threads that aren't workers go through a shared queue.
+///
+/// Task frames (the task and its captured state) of up to `FRAME_SIZE` bytes
+/// are carved out of a per-worker arena and recycled through per-worker free
+/// lists; frames freed by another worker are handed back to their owner
+/// through a lock-free remote-free list. Bigger frames (and frames of tasks
+/// spawned from outside the workers) come straight from the parent
+/// allocator.
+///
+/// Workers that can't find any work spin for a while and then go to sleep
+/// until a new task is spawned.
+///
+/// ## Note
+/// The parent allocator must be thread-safe.
+struct Scheduler {
+private:
+  struct Task;
+  struct Worker;
+
+public:
+  /// The size of the recycled task frames (in bytes).
+  static const usize FRAME_SIZE = 128;
+
+  /// Counters of the scheduler's activity (see `Scheduler::getStats`).
+  struct Stats {
+    /// The number of tasks that were run.
+    u64 tasks_run     = 0;
+
+    /// The number of tasks that were stolen from another worker's deque.
+    u64 steals        = 0;
+
+    /// The number of times a thread looked through every deque without
+    /// finding a task to steal.
+    u64 failed_steals = 0;
+
+    /// The number of times a worker went to sleep.
+    u64 sleeps        = 0;
+
+    /// The time workers spent idle (spinning or sleeping) in nanoseconds.
+    u64 idle_ns       = 0;
+  };
+
+  /// Creates a scheduler with one worker per hardware thread, backed by the
+  /// default allocator.
+  Scheduler();
+
+  /// Creates a scheduler with `num_workers` worker threads, backed by the
+  /// default allocator.
+  ///
+  /// ## Error
+  /// - Throws an error if the worker count is `0`.
+  Scheduler(usize num_workers);
+
+  /// Creates a scheduler with `num_workers` worker threads, backed by the
+  /// given allocator.
+  ///
+  /// ## Error
+  /// - Throws an error if the worker count is `0`.
+  /// - Throws an error if the provided allocator is null.
+  /// - Throws an error if the workers couldn't be allocated.
+  Scheduler(usize num_workers, mem::Allocator* allocator);
+
+  Scheduler(const Scheduler&)            = delete;
+  Scheduler& operator=(const Scheduler&) = delete;
+
+  /// Stops and joins the workers, and frees their task frames.
+  ///
+  /// ## Note
+  /// Every task group must have been waited for.
+  ~Scheduler();
+
+  /// Returns the process-wide scheduler (with one worker per hardware
+  /// thread).
+  ///
+  /// ## Note
+  /// The scheduler is created on first use and never destroyed.
+  static Scheduler* getGlobal(void);
+
+  /// Returns the number of worker threads.
+  usize             getWorkerCount(void) const;
+
+  /// Returns the sum of the counters of every worker (and of the threads
+  /// that waited for tasks without being workers).
+  ///
+  /// ## Note
+  /// This is only a snapshot while tasks are running.
+  Stats             getStats(void) const;
+
+  /// Resets the counters returned by `Scheduler::getStats`.
+  void              resetStats(void);
+
+  /// Runs `fn()` as a task of the given group.
+  ///
+  /// ## Note
+  /// `fn` is moved into the task frame, so anything it captures by reference
+  /// must outlive the task (waiting for the group guarantees that). If the
+  /// frame couldn't be allocated, `fn` is run right away on the calling
+  /// thread.
+  template <typename Fn> void spawn(TaskGroup& group, Fn&& fn) {
+    typedef typename std::decay<Fn>::type Func;
+    static_assert(alignof(Func) <= alignof(std::max_align_t),
+                  "Over-aligned tasks are not supported");
+
+    Task* task = this->allocTask(sizeof(Func));
+    if (task == nullptr) {
+      fn();
+      return;
+    }
+
+    new (task->getClosure()) Func(std::forward<Fn>(fn));
+    task->run = [](Task* task) {
+      Func* closure = static_cast<Func*>(task->getClosure());
+      (*closure)();
+      closure->~Func();
+    };
+    task->group = &group;
+    this->submit(task);
+  }
+
+  /// Waits for all tasks of the group to finish.
+  ///
+  /// ## Note
+  /// The calling thread runs (or steals) other tasks while it waits, so
+  /// waiting from inside a task doesn't block a worker.
+  void wait(TaskGroup& group);
+
+  /// Calls `fn(begin, end)` for disjoint ranges that cover `[start, end)`,
+  /// and waits for all of them to finish.
+  ///
+  /// The range is split in half (with the upper half spawned as a task) only
+  /// while the current worker's deque is empty, i.e. when other workers could
+  /// use more work; otherwise it's processed serially in pieces of `grain`
+  /// indices. This adapts the number of tasks to the load: an idle scheduler
+  /// splits the range across all workers, a busy one barely splits it at all.
+  ///
+  /// ## Note
+  /// A `grain` of `0` picks one based on the length of the range and the
+  /// number of workers.
+  template <typename Fn>
+  void parallelFor(usize start, usize end, Fn&& fn, usize grain = 0) {
+    if (start >= end) {
+      return;
+    }
+    if (grain == 0) {
+      grain = this->getGrain(end - start);
+    }
+
+    TaskGroup group;
+    if (this->isWorker()) {
+      this->forRange(group, start, end, grain, fn);
+    } else {
+      // Hand the whole range to the workers, which split it further
+      this->spawn(group, [this, &group, start, end, grain, &fn] {
+        this->forRange(group, start, end, grain, fn);
+      });
+    }
+    this->wait(group);
+  }
+
+private:
+  /// A task frame; the task's closure is stored right after it.
+  struct Task {
+    /// Runs and destroys the closure.
+    void (*run)(Task* task);
+
+    /// The group the task belongs to.
+    TaskGroup* group;
+
+    /// The worker whose arena the frame came from (`nullptr` if it came from
+    /// the parent allocator).
+    Worker*    owner;
+
+    /// The size of the frame (including the closure).
+    usize      nbytes;
+
+    /// The next frame in a free list.
+    Task*      next;
+
+    void*      getClosure(void) {
+      return reinterpret_cast<char*>(this) + TASK_HEADER_SIZE;
+    }
+  };
+
+  /// The size of a task frame's header (the closure is aligned like
+  /// `std::max_align_t`).
+  static const usize TASK_HEADER_SIZE =
+      (sizeof(Task) + alignof(std::max_align_t) - 1) &
+      ~(alignof(std::max_align_t) - 1);
+
+  /// Allocator used for the workers and large task frames.
+  mem::Allocator*          allocator;
+
+  /// The workers.
+  ds::DynamicArray<Worker*> workers;
+
+  /// Protects `injected` and `inject_head`.
+  std::mutex               inject_lock;
+
+  /// Tasks spawned from threads that aren't workers.
+  ds::DynamicArray<Task*>  injected;
+
+  /// The index of the oldest task in `injected`.
+  usize                    inject_head  = 0;
+
+  /// The number of tasks in `injected` (readable without the lock).
+  std::atomic<usize>       num_injected = 0;
+
+  /// Protects sleeping and waking workers.
+  std::mutex               sleep_lock;
+
+  /// Signals sleeping workers that a task was spawned (or that the scheduler
+  /// is stopping).
+  std::condition_variable  wake;
+
+  /// The number of workers that are (about to go) to sleep.
+  std::atomic<usize>       num_sleeping = 0;
+
+  /// Set when the scheduler is destroyed.
+  std::atomic<bool>        stopping     = false;
+
+  /// Counters of threads that aren't workers.
+  std::atomic<u64>         external_steals        = 0;
+  std::atomic<u64>         external_failed_steals = 0;
+  std::atomic<u64>         external_tasks_run     = 0;
+
+  /// Starts `num_workers` workers.
+  void                     start(usize num_workers);
+
+  /// Returns the current thread's worker, or `nullptr` if it isn't a worker
+  /// of this scheduler.
+  Worker*                  getCurrentWorker(void) const;
+
+  /// Checks if the current thread is a worker of this scheduler.
+  bool                     isWorker(void) const;
+
+  /// Returns a task frame with room for a closure of `closure_nbytes` bytes,
+  /// or `nullptr` if it couldn't be allocated.
+  Task*                    allocTask(usize closure_nbytes);
+
+  /// Gives the frame back to its owner (or the parent allocator).
+  void                     freeTask(Task* task, Worker* self);
+
+  /// Queues the task on the current worker's deque (or the shared queue).
+  void                     submit(Task* task);
+
+  /// Runs the task, frees its frame and marks it as finished.
+  void                     execute(Task* task, Worker* self);
+
+  /// Returns a task to run: from the worker's own deque, the shared queue, or
+  /// stolen from another worker. Returns `nullptr` if there are none.
+  Task*                    findTask(Worker* self);
+
+  /// Takes the oldest task from the shared queue.
+  Task*                    takeInjected(void);
+
+  /// Steals a task from another worker's deque.
+  Task*                    steal(Worker* self);
+
+  /// Checks if any task is queued anywhere.
+  bool                     hasQueuedTasks(void) const;
+
+  /// Wakes a sleeping worker (if there is one).
+  void                     wakeWorker(void);
+
+  /// Puts the worker to sleep until there's work.
+  void                     sleep(Worker* self);
+
+  /// The loop run by every worker thread.
+  void                     workerLoop(Worker* self);
+
+  /// Checks if the range `parallelFor` is working on should be split.
+  bool                     shouldSplit(void) const;
+
+  /// Returns the default grain size for a range of `len` indices.
+  usize                    getGrain(usize len) const;
+
+  /// Processes `[start, end)` for `parallelFor`.
+  template <typename Fn>
+  void forRange(TaskGroup& group, usize start, usize end, usize grain,
+                Fn& fn) {
+    while (start < end) {
+      if (end - start > grain && this->shouldSplit()) {
+        usize mid = start + (end - start) / 2;
+        this->spawn(group, [this, &group, mid, end, grain, &fn] {
+          this->forRange(group, mid, end, grain, fn);
+        });
+        end = mid;
+        continue;
+      }
+
+      usize stop = end - start > grain ? start + grain : end;
+      fn(start, stop);
+      start = stop;
+    }
+  }
+};
+
+} // namespace bl::task
+
+#endif // !BL_SCHEDULER_H
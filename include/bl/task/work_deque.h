@@ -0,0 +1,260 @@
+#ifndef BL_WORK_DEQUE_H
+#define BL_WORK_DEQUE_H
+
+#include "bl/ds/dynamic_array.h" // getDefaultAllocator
+#include "bl/error.h"            // resetError, BL_THROW
+#include "bl/mem/allocator.h"    // Allocator
+#include "bl/primitives.h"       // const_cstr, usize, i64
+
+#include <atomic>      // atomic, atomic_thread_fence, memory_order_*
+#include <new>         // placement new
+#include <type_traits> // is_pointer
+
+namespace bl::task {
+using namespace primitives;
+
+namespace work_deque_internal {
+enum class WorkDequeError {
+  InvalidAllocator,
+  BufferAllocationFailed,
+};
+
+const_cstr errMsg(WorkDequeError err);
+} // namespace work_deque_internal
+
+/// A Chase-Lev work-stealing deque of pointers.
+///
+/// The thread that owns the deque pushes and pops items at the bottom (like a
+/// stack), while any other thread can steal items from the top. Neither end
+/// takes a lock; the owner and thieves only contend (with a single CAS) when
+/// they go for the last item.
+///
+/// The buffer is a power-of-two ring that doubles when it fills up. Thieves
+/// may still be reading an old buffer while it's replaced, so old buffers are
+/// only freed when the deque is destroyed (their total size is bounded by the
+/// size of the current buffer).
+///
+/// ## Note
+/// `push` and `pop` must only be called by the owning thread; `steal`,
+/// `getLen` and `isEmpty` can be called from any thread.
+template <typename T> struct WorkDeque {
+  static_assert(std::is_pointer<T>::value, "WorkDeque only stores pointers");
+
+public:
+  /// The default initial capacity.
+  static const usize DEFAULT_CAP = 64;
+
+  /// Creates an empty deque backed by the default allocator.
+  WorkDeque() : WorkDeque(ds::dynamic_array_internal::getDefaultAllocator()) {}
+
+  /// Creates an empty deque with room for `capacity` items (rounded up to a
+  /// power of two), backed by the given allocator.
+  ///
+  /// ## Note
+  /// The allocator is only used by the owning thread.
+  ///
+  /// ## Error
+  /// - Throws an error if the provided allocator is null.
+  /// - Throws an error if the buffer couldn't be allocated.
+  WorkDeque(mem::Allocator* allocator, usize capacity = DEFAULT_CAP)
+      : allocator(allocator) {
+    // Input validation
+    {
+      Error::resetError();
+      if (allocator == nullptr) {
+        BL_THROW(work_deque_internal::errMsg(
+            work_deque_internal::WorkDequeError::InvalidAllocator));
+        return;
+      }
+    }
+
+    usize cap = 1;
+    while (cap < capacity) {
+      cap *= 2;
+    }
+
+    Buffer* buffer = this->allocBuffer(cap, nullptr);
+    if (buffer == nullptr) {
+      BL_THROW(work_deque_internal::errMsg(
+          work_deque_internal::WorkDequeError::BufferAllocationFailed));
+      return;
+    }
+    this->buffer.store(buffer, std::memory_order_relaxed);
+  }
+
+  WorkDeque(const WorkDeque&)            = delete;
+  WorkDeque& operator=(const WorkDeque&) = delete;
+
+  /// Frees the current and all old buffers.
+  ///
+  /// ## Note
+  /// Items left in the deque are not touched.
+  ~WorkDeque() {
+    Buffer* buffer = this->buffer.load(std::memory_order_relaxed);
+    while (buffer != nullptr) {
+      Buffer* prev = buffer->prev;
+      this->allocator->deallocSizedRaw(buffer, bufferSize(buffer->cap),
+                                       alignof(Buffer));
+      buffer = prev;
+    }
+  }
+
+  /// Pushes an item to the bottom of the deque.
+  ///
+  /// ## Error
+  /// - Throws an error if the buffer was full and couldn't be grown (the item
+  /// is not pushed).
+  void push(T item) {
+    Error::resetError();
+
+    i64     bottom = this->bottom.load(std::memory_order_relaxed);
+    i64     top    = this->top.load(std::memory_order_acquire);
+    Buffer* buffer = this->buffer.load(std::memory_order_relaxed);
+
+    if (bottom - top >= static_cast<i64>(buffer->cap)) {
+      buffer = this->grow(buffer, top, bottom);
+      if (buffer == nullptr) {
+        BL_THROW(work_deque_internal::errMsg(
+            work_deque_internal::WorkDequeError::BufferAllocationFailed));
+        return;
+      }
+    }
+
+    buffer->at(bottom).store(item, std::memory_order_relaxed);
+    this->bottom.store(bottom + 1, std::memory_order_release);
+  }
+
+  /// Pops the item at the bottom of the deque (the one pushed last).
+  ///
+  /// Returns `nullptr` if the deque is empty.
+  T pop(void) {
+    i64     bottom = this->bottom.load(std::memory_order_relaxed) - 1;
+    Buffer* buffer = this->buffer.load(std::memory_order_relaxed);
+    this->bottom.store(bottom, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    i64 top = this->top.load(std::memory_order_relaxed);
+
+    if (top > bottom) {
+      // Empty
+      this->bottom.store(bottom + 1, std::memory_order_relaxed);
+      return nullptr;
+    }
+
+    T item = buffer->at(bottom).load(std::memory_order_relaxed);
+    if (top == bottom) {
+      // Last item: race the thieves for it
+      if (!this->top.compare_exchange_strong(top, top + 1,
+                                             std::memory_order_seq_cst,
+                                             std::memory_order_relaxed)) {
+        item = nullptr;
+      }
+      this->bottom.store(bottom + 1, std::memory_order_relaxed);
+    }
+    return item;
+  }
+
+  /// Steals the item at the top of the deque (the oldest one).
+  ///
+  /// Returns `nullptr` if the deque is empty, or if another thread took the
+  /// item first.
+  T steal(void) {
+    i64 top = this->top.load(std::memory_order_acquire);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    i64 bottom = this->bottom.load(std::memory_order_acquire);
+
+    if (top >= bottom) {
+      return nullptr;
+    }
+
+    Buffer* buffer = this->buffer.load(std::memory_order_acquire);
+    T       item   = buffer->at(top).load(std::memory_order_relaxed);
+    if (!this->top.compare_exchange_strong(top, top + 1,
+                                           std::memory_order_seq_cst,
+                                           std::memory_order_relaxed)) {
+      return nullptr;
+    }
+    return item;
+  }
+
+  /// Returns the number of items in the deque.
+  ///
+  /// ## Note
+  /// This is only a snapshot when other threads use the deque.
+  usize getLen(void) const {
+    i64 bottom = this->bottom.load(std::memory_order_relaxed);
+    i64 top    = this->top.load(std::memory_order_relaxed);
+    return bottom > top ? static_cast<usize>(bottom - top) : 0;
+  }
+
+  /// Checks if the deque is empty.
+  ///
+  /// ## Note
+  /// This is only a snapshot when other threads use the deque.
+  bool isEmpty(void) const { return this->getLen() == 0; }
+
+private:
+  /// A ring of `cap` slots (stored right after the header).
+  struct Buffer {
+    usize           cap;
+
+    /// The buffer this one replaced.
+    Buffer*         prev;
+
+    std::atomic<T>& at(i64 idx) {
+      std::atomic<T>* slots = reinterpret_cast<std::atomic<T>*>(this + 1);
+      return slots[static_cast<usize>(idx) & (this->cap - 1)];
+    }
+  };
+
+  static usize bufferSize(usize cap) {
+    return sizeof(Buffer) + cap * sizeof(std::atomic<T>);
+  }
+
+  /// Allocator used for the buffers.
+  mem::Allocator*                 allocator;
+
+  /// The index of the oldest item (only ever incremented).
+  alignas(64) std::atomic<i64>    top    = 0;
+
+  /// The index one past the newest item.
+  alignas(64) std::atomic<i64>    bottom = 0;
+
+  /// The current buffer.
+  alignas(64) std::atomic<Buffer*> buffer = nullptr;
+
+  /// Allocates a buffer with `cap` slots.
+  Buffer* allocBuffer(usize cap, Buffer* prev) {
+    Buffer* buffer = (Buffer*)this->allocator->allocAlignedRaw(
+        bufferSize(cap), alignof(Buffer));
+    if (buffer == nullptr) {
+      return nullptr;
+    }
+
+    buffer->cap  = cap;
+    buffer->prev = prev;
+    for (usize i = 0; i < cap; i++) {
+      new (&buffer->at(static_cast<i64>(i))) std::atomic<T>(nullptr);
+    }
+    return buffer;
+  }
+
+  /// Replaces the buffer with one twice its size, copying the items in
+  /// `[top, bottom)` over.
+  Buffer* grow(Buffer* old, i64 top, i64 bottom) {
+    Buffer* buffer = this->allocBuffer(old->cap * 2, old);
+    if (buffer == nullptr) {
+      return nullptr;
+    }
+
+    for (i64 i = top; i < bottom; i++) {
+      buffer->at(i).store(old->at(i).load(std::memory_order_relaxed),
+                          std::memory_order_relaxed);
+    }
+    this->buffer.store(buffer, std::memory_order_release);
+    return buffer;
+  }
+};
+
+} // namespace bl::task
+
+#endif // !BL_WORK_DEQUE_H
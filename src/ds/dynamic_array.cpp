@@ -1,6 +1,9 @@
 #include "bl/ds/dynamic_array.h"
 
 #include "bl/mem/c_allocator.h" // CAllocator
+#if defined(BL_DEFAULT_THREAD_CACHE_ALLOCATOR)
+#include "bl/mem/thread_cache_allocator.h" // ThreadCacheAllocator
+#endif
 
 namespace bl::ds {
 
@@ -21,6 +24,9 @@ const_cstr errMsg(DynamicArrayError err) {
   case DynamicArrayError::IndexOutOfBounds:
     return "DynamicArrayError: The specified index was out of the array's "
            "bounds";
+  case DynamicArrayError::InvalidRange:
+    return "DynamicArrayError: The specified range was out of the array's "
+           "bounds";
   case DynamicArrayError::InvalidPop:
     return "DynamicArrayError: Tried `popping` from an empty array";
   case DynamicArrayError::MemcpyFailed:
@@ -35,7 +41,13 @@ const_cstr errMsg(DynamicArrayError err) {
 
 mem::Allocator DEFAULT_C_ALLOCATOR = mem::CAllocator();
 
-const u8       RESIZE_FACTOR       = 2;
+mem::Allocator* getDefaultAllocator(void) {
+#if defined(BL_DEFAULT_THREAD_CACHE_ALLOCATOR)
+  return mem::ThreadCacheAllocator::getGlobal();
+#else
+  return &DEFAULT_C_ALLOCATOR;
+#endif
+}
 } // namespace dynamic_array_internal
 
 } // namespace bl::ds
@@ -0,0 +1,760 @@
+#include "bl/ds/search.h"
+
+#include "bl/primitives.h" // const_cstr, usize, u8, u32, u64, i32, i64, f32
+
+#include <cstring> // memcmp
+
+// The vectorized kernels need GCC-style target pragmas and x86 intrinsics;
+// other compilers and targets use the plain loops
+#if defined(__GNUC__) && defined(__x86_64__)
+#define BL_SEARCH_X86 1
+#include <immintrin.h> // _mm_*, _mm256_*
+#else
+#define BL_SEARCH_X86 0
+#endif
+
+#if BL_SEARCH_X86 && defined(__clang__)
+#define BL_BEGIN_AVX2                                                          \
+  _Pragma("clang attribute push(__attribute__((target(\"avx2\"))), "          \
+          "apply_to = function)")
+#define BL_END_AVX2 _Pragma("clang attribute pop")
+#elif BL_SEARCH_X86
+#define BL_BEGIN_AVX2 _Pragma("GCC push_options") _Pragma("GCC target(\"avx2\")")
+#define BL_END_AVX2   _Pragma("GCC pop_options")
+#endif
+
+namespace bl::ds {
+
+namespace search_internal {
+const_cstr errMsg(SearchError err) {
+  switch (err) {
+  case SearchError::EmptyRange:
+    return "SearchError: The range was empty";
+  }
+
+  return nullptr;
+}
+} // namespace search_internal
+
+namespace {
+using search_internal::Isa;
+
+/// The bytes of candidate comparisons the sub-range kernels allow per
+/// position scanned (see `search_kernels.h`).
+const usize FILTER_CREDIT = 8;
+
+/// Returns the bytes of candidate comparisons the sub-range kernels allow
+/// before scanning anything.
+inline i64  filterBudget(usize needle_len) {
+  return static_cast<i64>(1024 + 4 * needle_len);
+}
+
+/// Checks if the needle matches at `hay`, given that its first and last bytes
+/// already do.
+inline bool matchesInner(const u8* hay, const u8* needle, usize needle_len) {
+  return needle_len <= 2 || memcmp(hay + 1, needle + 1, needle_len - 2) == 0;
+}
+
+#if BL_SEARCH_X86
+namespace sse2 {
+typedef __m128i IVec;
+
+inline IVec     zeroInt(void) { return _mm_setzero_si128(); }
+
+inline IVec     bitOr(IVec a, IVec b) { return _mm_or_si128(a, b); }
+
+inline IVec     bitAnd(IVec a, IVec b) { return _mm_and_si128(a, b); }
+
+inline u32 maskBits(IVec v) { return static_cast<u32>(_mm_movemask_epi8(v)); }
+
+/// Picks the lanes of `a` where `mask` is set, and those of `b` elsewhere.
+inline IVec select(IVec mask, IVec a, IVec b) {
+  return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+}
+
+/// Counting for types with 32-bit lanes.
+struct Lanes32 {
+  static const usize COUNT_BLOCK = usize(1) << 30;
+
+  static IVec        countAdd(IVec counts, IVec eq) {
+    return _mm_sub_epi32(counts, eq);
+  }
+
+  static usize countReduce(IVec counts) {
+    u32 lanes[4];
+    _mm_storeu_si128(reinterpret_cast<IVec*>(lanes), counts);
+    return usize(lanes[0]) + lanes[1] + lanes[2] + lanes[3];
+  }
+};
+
+template <typename T> struct Ops;
+
+template <> struct Ops<u8> {
+  typedef __m128i    Vec;
+  typedef __m128i    Acc;
+
+  static const usize LANES       = 16;
+  static const usize ACC_LANES   = 2;
+  static const usize COUNT_BLOCK = 255;
+
+  static Vec         load(const u8* src) {
+    return _mm_loadu_si128(reinterpret_cast<const Vec*>(src));
+  }
+  static void store(u8* dst, Vec v) {
+    _mm_storeu_si128(reinterpret_cast<Vec*>(dst), v);
+  }
+  static Vec   splat(u8 val) { return _mm_set1_epi8(static_cast<char>(val)); }
+  static IVec  eq(Vec a, Vec b) { return _mm_cmpeq_epi8(a, b); }
+  static Vec   min(Vec a, Vec b) { return _mm_min_epu8(a, b); }
+  static Vec   max(Vec a, Vec b) { return _mm_max_epu8(a, b); }
+
+  static IVec  countAdd(IVec counts, IVec eq) { return _mm_sub_epi8(counts, eq); }
+  static usize countReduce(IVec counts) {
+    u64 lanes[2];
+    _mm_storeu_si128(reinterpret_cast<IVec*>(lanes),
+                     _mm_sad_epu8(counts, _mm_setzero_si128()));
+    return lanes[0] + lanes[1];
+  }
+
+  static Acc zeroAcc(void) { return _mm_setzero_si128(); }
+  static Acc addSum(Acc acc, Vec v) {
+    return _mm_add_epi64(acc, _mm_sad_epu8(v, _mm_setzero_si128()));
+  }
+  static void storeAcc(u64* dst, Acc acc) {
+    _mm_storeu_si128(reinterpret_cast<Acc*>(dst), acc);
+  }
+};
+
+template <> struct Ops<u32> : Lanes32 {
+  typedef __m128i    Vec;
+  typedef __m128i    Acc;
+
+  static const usize LANES     = 4;
+  static const usize ACC_LANES = 2;
+
+  static Vec         load(const u32* src) {
+    return _mm_loadu_si128(reinterpret_cast<const Vec*>(src));
+  }
+  static void store(u32* dst, Vec v) {
+    _mm_storeu_si128(reinterpret_cast<Vec*>(dst), v);
+  }
+  static Vec  splat(u32 val) { return _mm_set1_epi32(static_cast<int>(val)); }
+  static IVec eq(Vec a, Vec b) { return _mm_cmpeq_epi32(a, b); }
+
+  // SSE2 only has signed comparisons, so flip the sign bits first
+  static IVec greater(Vec a, Vec b) {
+    Vec bias = _mm_set1_epi32(static_cast<int>(0x80000000u));
+    return _mm_cmpgt_epi32(_mm_xor_si128(a, bias), _mm_xor_si128(b, bias));
+  }
+  static Vec min(Vec a, Vec b) { return select(greater(a, b), b, a); }
+  static Vec max(Vec a, Vec b) { return select(greater(a, b), a, b); }
+
+  static Acc zeroAcc(void) { return _mm_setzero_si128(); }
+  static Acc addSum(Acc acc, Vec v) {
+    Vec zero = _mm_setzero_si128();
+    acc      = _mm_add_epi64(acc, _mm_unpacklo_epi32(v, zero));
+    return _mm_add_epi64(acc, _mm_unpackhi_epi32(v, zero));
+  }
+  static void storeAcc(u64* dst, Acc acc) {
+    _mm_storeu_si128(reinterpret_cast<Acc*>(dst), acc);
+  }
+};
+
+template <> struct Ops<i32> : Lanes32 {
+  typedef __m128i    Vec;
+  typedef __m128i    Acc;
+
+  static const usize LANES     = 4;
+  static const usize ACC_LANES = 2;
+
+  static Vec         load(const i32* src) {
+    return _mm_loadu_si128(reinterpret_cast<const Vec*>(src));
+  }
+  static void store(i32* dst, Vec v) {
+    _mm_storeu_si128(reinterpret_cast<Vec*>(dst), v);
+  }
+  static Vec  splat(i32 val) { return _mm_set1_epi32(val); }
+  static IVec eq(Vec a, Vec b) { return _mm_cmpeq_epi32(a, b); }
+  static Vec  min(Vec a, Vec b) { return select(_mm_cmpgt_epi32(a, b), b, a); }
+  static Vec  max(Vec a, Vec b) { return select(_mm_cmpgt_epi32(a, b), a, b); }
+
+  static Acc  zeroAcc(void) { return _mm_setzero_si128(); }
+  static Acc  addSum(Acc acc, Vec v) {
+    // Sign-extend to 64 bits by interleaving with the sign bits
+    Vec sign = _mm_srai_epi32(v, 31);
+    acc      = _mm_add_epi64(acc, _mm_unpacklo_epi32(v, sign));
+    return _mm_add_epi64(acc, _mm_unpackhi_epi32(v, sign));
+  }
+  static void storeAcc(i64* dst, Acc acc) {
+    _mm_storeu_si128(reinterpret_cast<Acc*>(dst), acc);
+  }
+};
+
+template <> struct Ops<f32> : Lanes32 {
+  typedef __m128     Vec;
+  typedef __m128     Acc;
+
+  static const usize LANES     = 4;
+  static const usize ACC_LANES = 4;
+
+  static Vec         load(const f32* src) { return _mm_loadu_ps(src); }
+  static void        store(f32* dst, Vec v) { _mm_storeu_ps(dst, v); }
+  static Vec         splat(f32 val) { return _mm_set1_ps(val); }
+  static IVec eq(Vec a, Vec b) { return _mm_castps_si128(_mm_cmpeq_ps(a, b)); }
+  static Vec  min(Vec a, Vec b) { return _mm_min_ps(a, b); }
+  static Vec  max(Vec a, Vec b) { return _mm_max_ps(a, b); }
+
+  static Acc  zeroAcc(void) { return _mm_setzero_ps(); }
+  static Acc  addSum(Acc acc, Vec v) { return _mm_add_ps(acc, v); }
+  static void storeAcc(f32* dst, Acc acc) { _mm_storeu_ps(dst, acc); }
+};
+
+#include "search_kernels.h"
+} // namespace sse2
+
+BL_BEGIN_AVX2
+namespace avx2 {
+typedef __m256i IVec;
+
+inline IVec     zeroInt(void) { return _mm256_setzero_si256(); }
+
+inline IVec     bitOr(IVec a, IVec b) { return _mm256_or_si256(a, b); }
+
+inline IVec     bitAnd(IVec a, IVec b) { return _mm256_and_si256(a, b); }
+
+inline u32      maskBits(IVec v) {
+  return static_cast<u32>(_mm256_movemask_epi8(v));
+}
+
+/// Counting for types with 32-bit lanes.
+struct Lanes32 {
+  static const usize COUNT_BLOCK = usize(1) << 30;
+
+  static IVec        countAdd(IVec counts, IVec eq) {
+    return _mm256_sub_epi32(counts, eq);
+  }
+
+  static usize countReduce(IVec counts) {
+    u32 lanes[8];
+    _mm256_storeu_si256(reinterpret_cast<IVec*>(lanes), counts);
+    usize n = 0;
+    for (u32 lane : lanes) {
+      n += lane;
+    }
+    return n;
+  }
+};
+
+template <typename T> struct Ops;
+
+template <> struct Ops<u8> {
+  typedef __m256i    Vec;
+  typedef __m256i    Acc;
+
+  static const usize LANES       = 32;
+  static const usize ACC_LANES   = 4;
+  static const usize COUNT_BLOCK = 255;
+
+  static Vec         load(const u8* src) {
+    return _mm256_loadu_si256(reinterpret_cast<const Vec*>(src));
+  }
+  static void store(u8* dst, Vec v) {
+    _mm256_storeu_si256(reinterpret_cast<Vec*>(dst), v);
+  }
+  static Vec splat(u8 val) {
+    return _mm256_set1_epi8(static_cast<char>(val));
+  }
+  static IVec eq(Vec a, Vec b) { return _mm256_cmpeq_epi8(a, b); }
+  static Vec  min(Vec a, Vec b) { return _mm256_min_epu8(a, b); }
+  static Vec  max(Vec a, Vec b) { return _mm256_max_epu8(a, b); }
+
+  static IVec countAdd(IVec counts, IVec eq) {
+    return _mm256_sub_epi8(counts, eq);
+  }
+  static usize countReduce(IVec counts) {
+    u64 lanes[4];
+    _mm256_storeu_si256(reinterpret_cast<IVec*>(lanes),
+                        _mm256_sad_epu8(counts, _mm256_setzero_si256()));
+    return lanes[0] + lanes[1] + lanes[2] + lanes[3];
+  }
+
+  static Acc zeroAcc(void) { return _mm256_setzero_si256(); }
+  static Acc addSum(Acc acc, Vec v) {
+    return _mm256_add_epi64(acc, _mm256_sad_epu8(v, _mm256_setzero_si256()));
+  }
+  static void storeAcc(u64* dst, Acc acc) {
+    _mm256_storeu_si256(reinterpret_cast<Acc*>(dst), acc);
+  }
+};
+
+template <> struct Ops<u32> : Lanes32 {
+  typedef __m256i    Vec;
+  typedef __m256i    Acc;
+
+  static const usize LANES     = 8;
+  static const usize ACC_LANES = 4;
+
+  static Vec         load(const u32* src) {
+    return _mm256_loadu_si256(reinterpret_cast<const Vec*>(src));
+  }
+  static void store(u32* dst, Vec v) {
+    _mm256_storeu_si256(reinterpret_cast<Vec*>(dst), v);
+  }
+  static Vec splat(u32 val) {
+    return _mm256_set1_epi32(static_cast<int>(val));
+  }
+  static IVec eq(Vec a, Vec b) { return _mm256_cmpeq_epi32(a, b); }
+  static Vec  min(Vec a, Vec b) { return _mm256_min_epu32(a, b); }
+  static Vec  max(Vec a, Vec b) { return _mm256_max_epu32(a, b); }
+
+  static Acc  zeroAcc(void) { return _mm256_setzero_si256(); }
+  static Acc  addSum(Acc acc, Vec v) {
+    acc = _mm256_add_epi64(acc,
+                           _mm256_cvtepu32_epi64(_mm256_castsi256_si128(v)));
+    return _mm256_add_epi64(
+        acc, _mm256_cvtepu32_epi64(_mm256_extracti128_si256(v, 1)));
+  }
+  static void storeAcc(u64* dst, Acc acc) {
+    _mm256_storeu_si256(reinterpret_cast<Acc*>(dst), acc);
+  }
+};
+
+template <> struct Ops<i32> : Lanes32 {
+  typedef __m256i    Vec;
+  typedef __m256i    Acc;
+
+  static const usize LANES     = 8;
+  static const usize ACC_LANES = 4;
+
+  static Vec         load(const i32* src) {
+    return _mm256_loadu_si256(reinterpret_cast<const Vec*>(src));
+  }
+  static void store(i32* dst, Vec v) {
+    _mm256_storeu_si256(reinterpret_cast<Vec*>(dst), v);
+  }
+  static Vec  splat(i32 val) { return _mm256_set1_epi32(val); }
+  static IVec eq(Vec a, Vec b) { return _mm256_cmpeq_epi32(a, b); }
+  static Vec  min(Vec a, Vec b) { return _mm256_min_epi32(a, b); }
+  static Vec  max(Vec a, Vec b) { return _mm256_max_epi32(a, b); }
+
+  static Acc  zeroAcc(void) { return _mm256_setzero_si256(); }
+  static Acc  addSum(Acc acc, Vec v) {
+    acc = _mm256_add_epi64(acc,
+                           _mm256_cvtepi32_epi64(_mm256_castsi256_si128(v)));
+    return _mm256_add_epi64(
+        acc, _mm256_cvtepi32_epi64(_mm256_extracti128_si256(v, 1)));
+  }
+  static void storeAcc(i64* dst, Acc acc) {
+    _mm256_storeu_si256(reinterpret_cast<Acc*>(dst), acc);
+  }
+};
+
+template <> struct Ops<f32> : Lanes32 {
+  typedef __m256     Vec;
+  typedef __m256     Acc;
+
+  static const usize LANES     = 8;
+  static const usize ACC_LANES = 8;
+
+  static Vec         load(const f32* src) { return _mm256_loadu_ps(src); }
+  static void        store(f32* dst, Vec v) { _mm256_storeu_ps(dst, v); }
+  static Vec         splat(f32 val) { return _mm256_set1_ps(val); }
+  static IVec        eq(Vec a, Vec b) {
+    return _mm256_castps_si256(_mm256_cmp_ps(a, b, _CMP_EQ_OQ));
+  }
+  static Vec  min(Vec a, Vec b) { return _mm256_min_ps(a, b); }
+  static Vec  max(Vec a, Vec b) { return _mm256_max_ps(a, b); }
+
+  static Acc  zeroAcc(void) { return _mm256_setzero_ps(); }
+  static Acc  addSum(Acc acc, Vec v) { return _mm256_add_ps(acc, v); }
+  static void storeAcc(f32* dst, Acc acc) { _mm256_storeu_ps(dst, acc); }
+};
+
+#include "search_kernels.h"
+} // namespace avx2
+BL_END_AVX2
+#endif
+
+/// Returns the best instruction set the CPU supports.
+Isa detectIsa(void) {
+#if BL_SEARCH_X86
+  __builtin_cpu_init();
+  return __builtin_cpu_supports("avx2") ? Isa::Avx2 : Isa::Sse2;
+#else
+  return Isa::Scalar;
+#endif
+}
+
+/// The instruction set the kernels use (`Isa::Scalar` until the static
+/// initializer ran, which is always safe).
+Isa active_isa = detectIsa();
+
+/// Reads the bytes of a string front to back, or back to front (so searching
+/// the reversed strings finds the last occurrence).
+template <bool REVERSED> struct Bytes {
+  const u8* data;
+  usize     len;
+
+  u8 operator[](usize idx) const {
+    return REVERSED ? this->data[this->len - 1 - idx] : this->data[idx];
+  }
+};
+
+/// Returns the start of the maximal suffix of the needle (under the normal
+/// byte order, or the inverted one), and sets `period` to that suffix's
+/// period.
+template <typename B>
+usize maximalSuffix(B needle, bool inverted, usize* period) {
+  // `start` is one before the suffix, so it begins at `-1` (wrapping)
+  usize start = ~usize(0);
+  usize j     = 0;
+  usize k     = 1;
+  usize p     = 1;
+  while (j + k < needle.len) {
+    u8 a = needle[j + k];
+    u8 b = needle[start + k];
+    if (inverted ? a > b : a < b) {
+      // The suffix at `start` continues, with a longer period
+      j += k;
+      k = 1;
+      p = j - start;
+    } else if (a == b) {
+      if (k != p) {
+        k++;
+      } else {
+        j += p;
+        k = 1;
+      }
+    } else {
+      // The suffix at `j` is bigger
+      start = j++;
+      k = p = 1;
+    }
+  }
+
+  *period = p;
+  return start + 1;
+}
+
+/// Returns the position of the first occurrence of the needle (at least 1
+/// byte, at most as long as the haystack), with the Two-Way algorithm.
+template <typename B> usize twoWay(B hay, B needle) {
+  // Critical factorization: the needle is split into `needle[0, suffix)` and
+  // `needle[suffix, len)`, the later of the two maximal suffixes
+  usize period     = 0;
+  usize inv_period = 0;
+  usize suffix     = maximalSuffix(needle, false, &period);
+  usize inv_suffix = maximalSuffix(needle, true, &inv_period);
+  if (inv_suffix > suffix) {
+    suffix = inv_suffix;
+    period = inv_period;
+  }
+
+  bool periodic = true;
+  for (usize i = 0; i < suffix; i++) {
+    if (needle[i] != needle[i + period]) {
+      periodic = false;
+      break;
+    }
+  }
+
+  usize last = hay.len - needle.len;
+  if (periodic) {
+    // The prefix repeats with the period, so whatever matched of it (before
+    // `memory`) doesn't need to be compared again after shifting by it
+    usize memory = 0;
+    for (usize j = 0; j <= last;) {
+      usize i = suffix > memory ? suffix : memory;
+      while (i < needle.len && needle[i] == hay[i + j]) {
+        i++;
+      }
+      if (i < needle.len) {
+        j += i - suffix + 1;
+        memory = 0;
+        continue;
+      }
+
+      i = suffix;
+      while (i > memory && needle[i - 1] == hay[i - 1 + j]) {
+        i--;
+      }
+      if (i <= memory) {
+        return j;
+      }
+      j += period;
+      memory = needle.len - period;
+    }
+    return NOT_FOUND;
+  }
+
+  // Otherwise a mismatch in the prefix shifts past the longer half
+  usize shift = (suffix > needle.len - suffix ? suffix : needle.len - suffix) + 1;
+  for (usize j = 0; j <= last;) {
+    usize i = suffix;
+    while (i < needle.len && needle[i] == hay[i + j]) {
+      i++;
+    }
+    if (i < needle.len) {
+      j += i - suffix + 1;
+      continue;
+    }
+
+    i = suffix;
+    while (i > 0 && needle[i - 1] == hay[i - 1 + j]) {
+      i--;
+    }
+    if (i == 0) {
+      return j;
+    }
+    j += shift;
+  }
+  return NOT_FOUND;
+}
+
+template <typename T> usize dispatchIndexOf(const T* data, usize len, T val) {
+  switch (active_isa) {
+#if BL_SEARCH_X86
+  case Isa::Avx2:
+    return avx2::indexOf(data, len, val);
+  case Isa::Sse2:
+    return sse2::indexOf(data, len, val);
+#endif
+  default:
+    return search_internal::scalarIndexOf(data, len, val);
+  }
+}
+
+template <typename T> usize dispatchCount(const T* data, usize len, T val) {
+  switch (active_isa) {
+#if BL_SEARCH_X86
+  case Isa::Avx2:
+    return avx2::count(data, len, val);
+  case Isa::Sse2:
+    return sse2::count(data, len, val);
+#endif
+  default:
+    return search_internal::scalarCount(data, len, val);
+  }
+}
+
+template <typename T> T dispatchMin(const T* data, usize len) {
+  switch (active_isa) {
+#if BL_SEARCH_X86
+  case Isa::Avx2:
+    return avx2::min(data, len);
+  case Isa::Sse2:
+    return sse2::min(data, len);
+#endif
+  default:
+    return search_internal::scalarMin(data, len);
+  }
+}
+
+template <typename T> T dispatchMax(const T* data, usize len) {
+  switch (active_isa) {
+#if BL_SEARCH_X86
+  case Isa::Avx2:
+    return avx2::max(data, len);
+  case Isa::Sse2:
+    return sse2::max(data, len);
+#endif
+  default:
+    return search_internal::scalarMax(data, len);
+  }
+}
+
+template <typename T>
+search_internal::SumType<T> dispatchSum(const T* data, usize len) {
+  switch (active_isa) {
+#if BL_SEARCH_X86
+  case Isa::Avx2:
+    return avx2::sum(data, len);
+  case Isa::Sse2:
+    return sse2::sum(data, len);
+#endif
+  default:
+    return search_internal::scalarSum(data, len);
+  }
+}
+} // namespace
+
+namespace search_internal {
+Isa getIsa(void) { return active_isa; }
+
+bool setIsa(Isa isa) {
+  if (isa == Isa::Avx2 && detectIsa() != Isa::Avx2) {
+    return false;
+  }
+  if (isa == Isa::Sse2 && detectIsa() == Isa::Scalar) {
+    return false;
+  }
+
+  active_isa = isa;
+  return true;
+}
+
+usize indexOf(const u8* data, usize len, u8 val) {
+  return dispatchIndexOf(data, len, val);
+}
+
+usize indexOf(const u32* data, usize len, u32 val) {
+  return dispatchIndexOf(data, len, val);
+}
+
+usize indexOf(const i32* data, usize len, i32 val) {
+  return dispatchIndexOf(data, len, val);
+}
+
+usize indexOf(const f32* data, usize len, f32 val) {
+  return dispatchIndexOf(data, len, val);
+}
+
+usize count(const u8* data, usize len, u8 val) {
+  return dispatchCount(data, len, val);
+}
+
+usize count(const u32* data, usize len, u32 val) {
+  return dispatchCount(data, len, val);
+}
+
+usize count(const i32* data, usize len, i32 val) {
+  return dispatchCount(data, len, val);
+}
+
+usize count(const f32* data, usize len, f32 val) {
+  return dispatchCount(data, len, val);
+}
+
+u8  min(const u8* data, usize len) { return dispatchMin(data, len); }
+
+u32 min(const u32* data, usize len) { return dispatchMin(data, len); }
+
+i32 min(const i32* data, usize len) { return dispatchMin(data, len); }
+
+f32 min(const f32* data, usize len) { return dispatchMin(data, len); }
+
+u8  max(const u8* data, usize len) { return dispatchMax(data, len); }
+
+u32 max(const u32* data, usize len) { return dispatchMax(data, len); }
+
+i32 max(const i32* data, usize len) { return dispatchMax(data, len); }
+
+f32 max(const f32* data, usize len) { return dispatchMax(data, len); }
+
+u64 sum(const u8* data, usize len) { return dispatchSum(data, len); }
+
+u64 sum(const u32* data, usize len) { return dispatchSum(data, len); }
+
+i64 sum(const i32* data, usize len) { return dispatchSum(data, len); }
+
+f32 sum(const f32* data, usize len) { return dispatchSum(data, len); }
+
+usize findBytes(const u8* hay, usize hay_len, const u8* needle,
+                usize needle_len) {
+  if (needle_len == 0) {
+    return 0;
+  }
+  if (needle_len > hay_len) {
+    return NOT_FOUND;
+  }
+  if (needle_len == 1) {
+    return dispatchIndexOf(hay, hay_len, needle[0]);
+  }
+
+  // Filter while it's cheap, then continue with Two-Way
+  usize checked = 0;
+  usize pos     = NOT_FOUND;
+  switch (active_isa) {
+#if BL_SEARCH_X86
+  case Isa::Avx2:
+    pos = avx2::findBytes(hay, hay_len, needle, needle_len, &checked);
+    break;
+  case Isa::Sse2:
+    pos = sse2::findBytes(hay, hay_len, needle, needle_len, &checked);
+    break;
+#endif
+  default:
+    break;
+  }
+  if (pos != NOT_FOUND || checked + needle_len > hay_len) {
+    return pos;
+  }
+
+  pos = twoWay(Bytes<false>{hay + checked, hay_len - checked},
+               Bytes<false>{needle, needle_len});
+  return pos == NOT_FOUND ? NOT_FOUND : checked + pos;
+}
+
+usize rfindBytes(const u8* hay, usize hay_len, const u8* needle,
+                 usize needle_len) {
+  if (needle_len == 0) {
+    return hay_len;
+  }
+  if (needle_len > hay_len) {
+    return NOT_FOUND;
+  }
+
+  // Filter while it's cheap, then continue with Two-Way (on the reversed
+  // strings, whose first occurrence is the last one)
+  usize unchecked = hay_len - needle_len + 1;
+  usize pos       = NOT_FOUND;
+  switch (active_isa) {
+#if BL_SEARCH_X86
+  case Isa::Avx2:
+    pos = avx2::rfindBytes(hay, hay_len, needle, needle_len, &unchecked);
+    break;
+  case Isa::Sse2:
+    pos = sse2::rfindBytes(hay, hay_len, needle, needle_len, &unchecked);
+    break;
+#endif
+  default:
+    break;
+  }
+  if (pos != NOT_FOUND || unchecked == 0) {
+    return pos;
+  }
+
+  usize len = unchecked + needle_len - 1;
+  pos = twoWay(Bytes<true>{hay, len}, Bytes<true>{needle, needle_len});
+  return pos == NOT_FOUND ? NOT_FOUND : len - needle_len - pos;
+}
+
+usize countBytes(const u8* hay, usize hay_len, const u8* needle,
+                 usize needle_len) {
+  if (needle_len == 0 || needle_len > hay_len) {
+    return 0;
+  }
+  if (needle_len == 1) {
+    return dispatchCount(hay, hay_len, needle[0]);
+  }
+
+  // Filter while it's cheap, then continue with Two-Way
+  usize checked = 0;
+  usize n       = 0;
+  switch (active_isa) {
+#if BL_SEARCH_X86
+  case Isa::Avx2:
+    n = avx2::countBytes(hay, hay_len, needle, needle_len, &checked);
+    break;
+  case Isa::Sse2:
+    n = sse2::countBytes(hay, hay_len, needle, needle_len, &checked);
+    break;
+#endif
+  default:
+    break;
+  }
+
+  while (checked + needle_len <= hay_len) {
+    usize pos = twoWay(Bytes<false>{hay + checked, hay_len - checked},
+                       Bytes<false>{needle, needle_len});
+    if (pos == NOT_FOUND) {
+      break;
+    }
+    n++;
+    checked += pos + needle_len;
+  }
+  return n;
+}
+} // namespace search_internal
+
+} // namespace bl::ds
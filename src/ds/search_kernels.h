@@ -0,0 +1,295 @@
+// The vectorized search kernels, written once against a small set of vector
+// operations.
+//
+// No include guard: `search.cpp` includes this once per instruction set,
+// inside that instruction set's namespace, after defining:
+// - `IVec` (an integer vector), `zeroInt()`, `bitOr(IVec, IVec)`,
+//   `bitAnd(IVec, IVec)`, and `maskBits(IVec)` (one bit per byte of the
+//   vector).
+// - `Ops<T>` for every vectorized type `T`, with `Vec` (a vector of `T`s),
+//   `LANES`, `load`, `store`, `splat`, `eq` (returning an `IVec` with all
+//   bits of matching lanes set), `min`, `max`, `countAdd`/`countReduce`
+//   (`COUNT_BLOCK` vectors at most), and `Acc`/`ACC_LANES`/`zeroAcc`/`addSum`/
+//   `storeAcc` for sums.
+
+template <typename T>
+usize indexOf(const T* data, usize len, T val) {
+  typedef Ops<T> O;
+  const usize    LANES  = O::LANES;
+  typename O::Vec needle = O::splat(val);
+
+  usize i = 0;
+  for (; i + 4 * LANES <= len; i += 4 * LANES) {
+    IVec eq0 = O::eq(O::load(data + i), needle);
+    IVec eq1 = O::eq(O::load(data + i + LANES), needle);
+    IVec eq2 = O::eq(O::load(data + i + 2 * LANES), needle);
+    IVec eq3 = O::eq(O::load(data + i + 3 * LANES), needle);
+
+    // Only look for the exact position once one of the vectors matched
+    if (maskBits(bitOr(bitOr(eq0, eq1), bitOr(eq2, eq3))) != 0) {
+      IVec eqs[4] = {eq0, eq1, eq2, eq3};
+      for (usize v = 0;; v++) {
+        u32 mask = maskBits(eqs[v]);
+        if (mask != 0) {
+          return i + v * LANES + __builtin_ctz(mask) / sizeof(T);
+        }
+      }
+    }
+  }
+
+  for (; i + LANES <= len; i += LANES) {
+    u32 mask = maskBits(O::eq(O::load(data + i), needle));
+    if (mask != 0) {
+      return i + __builtin_ctz(mask) / sizeof(T);
+    }
+  }
+
+  usize idx = search_internal::scalarIndexOf(data + i, len - i, val);
+  return idx == NOT_FOUND ? NOT_FOUND : i + idx;
+}
+
+template <typename T>
+usize count(const T* data, usize len, T val) {
+  typedef Ops<T> O;
+  const usize    LANES  = O::LANES;
+  typename O::Vec needle = O::splat(val);
+
+  // The per-lane counters are flushed before they can overflow
+  usize n = 0;
+  usize i = 0;
+  while (len - i >= LANES) {
+    usize vectors = (len - i) / LANES;
+    vectors       = vectors < O::COUNT_BLOCK ? vectors : O::COUNT_BLOCK;
+
+    IVec  counts  = zeroInt();
+    for (usize v = 0; v < vectors; v++, i += LANES) {
+      counts = O::countAdd(counts, O::eq(O::load(data + i), needle));
+    }
+    n += O::countReduce(counts);
+  }
+
+  return n + search_internal::scalarCount(data + i, len - i, val);
+}
+
+template <typename T> T min(const T* data, usize len) {
+  typedef Ops<T> O;
+  const usize LANES = O::LANES;
+  if (len < 2 * LANES) {
+    return search_internal::scalarMin(data, len);
+  }
+
+  typename O::Vec acc0 = O::load(data);
+  typename O::Vec acc1 = O::load(data + LANES);
+  usize           i    = 2 * LANES;
+  for (; i + 2 * LANES <= len; i += 2 * LANES) {
+    acc0 = O::min(acc0, O::load(data + i));
+    acc1 = O::min(acc1, O::load(data + i + LANES));
+  }
+  acc0 = O::min(acc0, acc1);
+
+  // The last (overlapping) vectors cover the tail
+  if (i < len) {
+    acc0 = O::min(acc0, O::load(data + len - 2 * LANES));
+    acc0 = O::min(acc0, O::load(data + len - LANES));
+  }
+
+  T lanes[LANES];
+  O::store(lanes, acc0);
+  return search_internal::scalarMin(lanes, LANES);
+}
+
+template <typename T> T max(const T* data, usize len) {
+  typedef Ops<T> O;
+  const usize LANES = O::LANES;
+  if (len < 2 * LANES) {
+    return search_internal::scalarMax(data, len);
+  }
+
+  typename O::Vec acc0 = O::load(data);
+  typename O::Vec acc1 = O::load(data + LANES);
+  usize           i    = 2 * LANES;
+  for (; i + 2 * LANES <= len; i += 2 * LANES) {
+    acc0 = O::max(acc0, O::load(data + i));
+    acc1 = O::max(acc1, O::load(data + i + LANES));
+  }
+  acc0 = O::max(acc0, acc1);
+
+  // The last (overlapping) vectors cover the tail
+  if (i < len) {
+    acc0 = O::max(acc0, O::load(data + len - 2 * LANES));
+    acc0 = O::max(acc0, O::load(data + len - LANES));
+  }
+
+  T lanes[LANES];
+  O::store(lanes, acc0);
+  return search_internal::scalarMax(lanes, LANES);
+}
+
+template <typename T>
+search_internal::SumType<T> sum(const T* data, usize len) {
+  typedef Ops<T> O;
+  typedef search_internal::SumType<T> Sum;
+  const usize                         LANES = O::LANES;
+
+  // Independent accumulators, so the additions can overlap
+  typename O::Acc                     accs[4] = {O::zeroAcc(), O::zeroAcc(),
+                                                 O::zeroAcc(), O::zeroAcc()};
+  usize                               i       = 0;
+  for (; i + 4 * LANES <= len; i += 4 * LANES) {
+    for (usize a = 0; a < 4; a++) {
+      accs[a] = O::addSum(accs[a], O::load(data + i + a * LANES));
+    }
+  }
+  for (; i + LANES <= len; i += LANES) {
+    accs[0] = O::addSum(accs[0], O::load(data + i));
+  }
+
+  Sum total = 0;
+  for (usize a = 0; a < 4; a++) {
+    Sum lanes[O::ACC_LANES];
+    O::storeAcc(lanes, accs[a]);
+    for (usize l = 0; l < O::ACC_LANES; l++) {
+      total += lanes[l];
+    }
+  }
+  return total + search_internal::scalarSum(data + i, len - i);
+}
+
+/// Returns the mask of the `LANES` positions starting at `hay` where the
+/// needle's first byte matches, and its last byte matches `last_off` bytes
+/// further.
+inline u32 candidates(const u8* hay, usize last_off, Ops<u8>::Vec first,
+                      Ops<u8>::Vec last) {
+  typedef Ops<u8> O;
+  return maskBits(bitAnd(O::eq(O::load(hay), first),
+                         O::eq(O::load(hay + last_off), last)));
+}
+
+// The sub-range kernels give up (for Two-Way to take over) once comparing
+// candidates costs too much: every position scanned earns `FILTER_CREDIT`
+// bytes, and every candidate compared costs the needle's length.
+
+usize findBytes(const u8* hay, usize hay_len, const u8* needle,
+                usize needle_len, usize* checked) {
+  typedef Ops<u8> O;
+  const usize LANES     = O::LANES;
+  usize       last_off  = needle_len - 1;
+  usize       positions = hay_len - last_off;
+  O::Vec      first     = O::splat(needle[0]);
+  O::Vec      last      = O::splat(needle[last_off]);
+  i64         budget    = filterBudget(needle_len);
+
+  usize       i         = 0;
+  for (; i + LANES <= positions; i += LANES) {
+    for (u32 mask = candidates(hay + i, last_off, first, last); mask != 0;
+         mask &= mask - 1) {
+      usize pos = i + __builtin_ctz(mask);
+      if (matchesInner(hay + pos, needle, needle_len)) {
+        return pos;
+      }
+      budget -= static_cast<i64>(needle_len);
+    }
+
+    budget += static_cast<i64>(FILTER_CREDIT * LANES);
+    if (budget < 0) {
+      *checked = i + LANES;
+      return NOT_FOUND;
+    }
+  }
+
+  for (; i < positions; i++) {
+    if (hay[i] == needle[0] && hay[i + last_off] == needle[last_off] &&
+        matchesInner(hay + i, needle, needle_len)) {
+      return i;
+    }
+  }
+  *checked = positions;
+  return NOT_FOUND;
+}
+
+usize rfindBytes(const u8* hay, usize hay_len, const u8* needle,
+                 usize needle_len, usize* unchecked) {
+  typedef Ops<u8> O;
+  const usize LANES    = O::LANES;
+  usize       last_off = needle_len - 1;
+  O::Vec      first    = O::splat(needle[0]);
+  O::Vec      last     = O::splat(needle[last_off]);
+  i64         budget   = filterBudget(needle_len);
+
+  // The positions in `[0, end)` are still unchecked
+  usize       end      = hay_len - last_off;
+  for (; end >= LANES; end -= LANES) {
+    usize i = end - LANES;
+    for (u32 mask = candidates(hay + i, last_off, first, last); mask != 0;) {
+      u32   bit = 31 - static_cast<u32>(__builtin_clz(mask));
+      usize pos = i + bit;
+      if (matchesInner(hay + pos, needle, needle_len)) {
+        return pos;
+      }
+      budget -= static_cast<i64>(needle_len);
+      mask &= ~(u32(1) << bit);
+    }
+
+    budget += static_cast<i64>(FILTER_CREDIT * LANES);
+    if (budget < 0) {
+      *unchecked = i;
+      return NOT_FOUND;
+    }
+  }
+
+  while (end > 0) {
+    end--;
+    if (hay[end] == needle[0] && hay[end + last_off] == needle[last_off] &&
+        matchesInner(hay + end, needle, needle_len)) {
+      return end;
+    }
+  }
+  *unchecked = 0;
+  return NOT_FOUND;
+}
+
+usize countBytes(const u8* hay, usize hay_len, const u8* needle,
+                 usize needle_len, usize* checked) {
+  typedef Ops<u8> O;
+  const usize LANES     = O::LANES;
+  usize       last_off  = needle_len - 1;
+  usize       positions = hay_len - last_off;
+  O::Vec      first     = O::splat(needle[0]);
+  O::Vec      last      = O::splat(needle[last_off]);
+  i64         budget    = filterBudget(needle_len);
+
+  // Occurrences don't overlap, so the next one starts at `next` or later
+  usize       n         = 0;
+  usize       next      = 0;
+  usize       i         = 0;
+  for (; i + LANES <= positions; i += LANES) {
+    for (u32 mask = candidates(hay + i, last_off, first, last); mask != 0;
+         mask &= mask - 1) {
+      usize pos = i + __builtin_ctz(mask);
+      if (pos < next) {
+        continue;
+      }
+      if (matchesInner(hay + pos, needle, needle_len)) {
+        n++;
+        next = pos + needle_len;
+      }
+      budget -= static_cast<i64>(needle_len);
+    }
+
+    budget += static_cast<i64>(FILTER_CREDIT * LANES);
+    if (budget < 0) {
+      *checked = next > i + LANES ? next : i + LANES;
+      return n;
+    }
+  }
+
+  for (i = next > i ? next : i; i < positions; i++) {
+    if (hay[i] == needle[0] && hay[i + last_off] == needle[last_off] &&
+        matchesInner(hay + i, needle, needle_len)) {
+      n++;
+      i += last_off;
+    }
+  }
+  *checked = hay_len;
+  return n;
+}
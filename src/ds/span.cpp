@@ -0,0 +1,19 @@
+#include "bl/ds/span.h"
+
+namespace bl::ds {
+
+namespace span_internal {
+
+const_cstr errMsg(SpanError err) {
+  switch (err) {
+  case SpanError::IndexOutOfBounds:
+    return "SpanError: The specified index was out of the span's bounds";
+  case SpanError::InvalidRange:
+    return "SpanError: The specified range was out of the span's bounds";
+  }
+
+  return nullptr;
+}
+} // namespace span_internal
+
+} // namespace bl::ds
@@ -0,0 +1,330 @@
+#include "bl/mem/arena_allocator.h"
+
+#include "bl/error.h"           // BL_THROW, resetError
+#include "bl/mem/allocator.h"   // Allocator
+#include "bl/mem/c_allocator.h" // CAllocator
+#include "bl/primitives.h"      // const_cstr, usize, u8
+
+#include <cstdint> // uintptr_t
+#include <cstring> // memcpy
+
+namespace bl::mem {
+
+namespace {
+enum class ArenaError {
+  InvalidAllocator,
+  InvalidChunkSize,
+  InvalidMark,
+};
+
+const_cstr errMsg(ArenaError err) {
+  switch (err) {
+  case ArenaError::InvalidAllocator:
+    return "ArenaError: Invalid Allocator (the parent allocator was null)";
+  case ArenaError::InvalidChunkSize:
+    return "ArenaError: Invalid chunk size (the chunk size must be non-zero)";
+  case ArenaError::InvalidMark:
+    return "ArenaError: Invalid mark (the mark is stale or belongs to another "
+           "arena)";
+  }
+
+  return nullptr;
+}
+
+Allocator   DEFAULT_C_ALLOCATOR = CAllocator();
+
+const usize ALIGNMENT           = Allocator::DEFAULT_ALIGNMENT;
+
+usize       alignUp(usize nbytes, usize align = ALIGNMENT) {
+  return (nbytes + align - 1) & ~(align - 1);
+}
+} // namespace
+
+/// Header placed at the start of every chunk; the usable bytes follow it.
+struct ArenaAllocator::Chunk {
+  Chunk* prev;
+  Chunk* next;
+  usize  cap;
+  usize  used;
+
+  u8*    getData(void) {
+    return reinterpret_cast<u8*>(this) + alignUp(sizeof(Chunk));
+  }
+};
+
+ArenaAllocator::ArenaAllocator()
+    : parent(&DEFAULT_C_ALLOCATOR), chunk_size(DEFAULT_CHUNK_SIZE) {
+  this->ctx            = this;
+  this->alloc          = ArenaAllocator::arenaAlloc;
+  this->dealloc        = ArenaAllocator::arenaDealloc;
+  this->resize         = ArenaAllocator::arenaResize;
+  this->allocAligned   = ArenaAllocator::arenaAllocAligned;
+  this->deallocAligned = ArenaAllocator::arenaDeallocAligned;
+  this->resizeAligned  = ArenaAllocator::arenaResizeAligned;
+  this->deallocSized   = ArenaAllocator::arenaDeallocSized;
+  this->expand         = ArenaAllocator::arenaExpand;
+}
+
+ArenaAllocator::ArenaAllocator(Allocator* parent, usize chunk_size)
+    : ArenaAllocator() {
+  // Input validation
+  {
+    Error::resetError();
+
+    if (parent == nullptr) {
+      BL_THROW(errMsg(ArenaError::InvalidAllocator));
+      return;
+    }
+
+    if (chunk_size == 0) {
+      BL_THROW(errMsg(ArenaError::InvalidChunkSize));
+      return;
+    }
+  }
+
+  this->parent     = parent;
+  this->chunk_size = alignUp(chunk_size);
+}
+
+ArenaAllocator::~ArenaAllocator() {
+  Chunk* chunk = this->head;
+  while (chunk != nullptr) {
+    Chunk* next = chunk->next;
+    this->parent->deallocRaw(chunk);
+    chunk = next;
+  }
+}
+
+ArenaAllocator::Mark ArenaAllocator::mark(void) const {
+  Mark mark;
+  if (this->current != nullptr) {
+    mark.chunk = this->current;
+    mark.used  = this->current->used;
+  }
+  return mark;
+}
+
+void ArenaAllocator::rewind(Mark mark) {
+  Error::resetError();
+
+  if (mark.chunk == nullptr) {
+    this->reset();
+    return;
+  }
+
+  // The mark must be at or before the current position
+  Chunk* chunk = this->current;
+  while (chunk != nullptr && chunk != mark.chunk) {
+    chunk = chunk->prev;
+  }
+  if (chunk == nullptr ||
+      (chunk == this->current && mark.used > chunk->used)) {
+    BL_THROW(errMsg(ArenaError::InvalidMark));
+    return;
+  }
+
+  this->current       = chunk;
+  this->current->used = mark.used;
+  this->last          = nullptr;
+}
+
+void ArenaAllocator::reset(void) {
+  this->current = this->head;
+  if (this->current != nullptr) {
+    this->current->used = 0;
+  }
+  this->last = nullptr;
+}
+
+usize ArenaAllocator::getUsed(void) const {
+  usize used = 0;
+  for (Chunk* chunk = this->current; chunk != nullptr; chunk = chunk->prev) {
+    used += chunk->used;
+  }
+  return used;
+}
+
+usize ArenaAllocator::getCap(void) const {
+  usize cap = 0;
+  for (Chunk* chunk = this->head; chunk != nullptr; chunk = chunk->next) {
+    cap += chunk->cap;
+  }
+  return cap;
+}
+
+bool ArenaAllocator::advance(usize nbytes) {
+  // Reuse the next chunk if it was left over from a rewind/reset
+  Chunk* next = this->current != nullptr ? this->current->next : this->head;
+  if (next != nullptr && next->cap >= nbytes) {
+    next->used    = 0;
+    this->current = next;
+    return true;
+  }
+
+  // Otherwise get a new chunk from the parent and link it in after `current`
+  usize  cap   = nbytes > this->chunk_size ? nbytes : this->chunk_size;
+  Chunk* chunk = static_cast<Chunk*>(
+      this->parent->allocRaw(alignUp(sizeof(Chunk)) + cap));
+  if (chunk == nullptr) {
+    return false;
+  }
+  chunk->prev = this->current;
+  chunk->next = next;
+  chunk->cap  = cap;
+  chunk->used = 0;
+
+  if (this->current != nullptr) {
+    this->current->next = chunk;
+  } else {
+    this->head = chunk;
+  }
+  if (next != nullptr) {
+    next->prev = chunk;
+  }
+  this->current = chunk;
+
+  return true;
+}
+
+void* ArenaAllocator::bump(usize nbytes, usize align) {
+  // Every allocation takes at least one aligned slot, so no two allocations
+  // share an address
+  usize size = alignUp(nbytes == 0 ? 1 : nbytes);
+
+  // Chunk data is only aligned to `ALIGNMENT`, so a fresh chunk needs room for
+  // the worst case padding
+  if (this->current == nullptr) {
+    if (!this->advance(size + (align > ALIGNMENT ? align - ALIGNMENT : 0))) {
+      return nullptr;
+    }
+  }
+
+  uintptr_t top     = reinterpret_cast<uintptr_t>(this->current->getData() +
+                                                  this->current->used);
+  usize     padding = alignUp(top, align) - top;
+  if (this->current->used + padding + size > this->current->cap) {
+    if (!this->advance(size + (align > ALIGNMENT ? align - ALIGNMENT : 0))) {
+      return nullptr;
+    }
+    top     = reinterpret_cast<uintptr_t>(this->current->getData());
+    padding = alignUp(top, align) - top;
+  }
+
+  void* ptr = this->current->getData() + this->current->used + padding;
+
+  this->current->used += padding + size;
+  this->last           = ptr;
+  return ptr;
+}
+
+void* ArenaAllocator::grow(void* ptr, usize nbytes, usize copy_nbytes,
+                           usize align) {
+  // Grow/shrink the most recent allocation in place
+  u8*   bytes = static_cast<u8*>(ptr);
+  usize size  = alignUp(nbytes == 0 ? 1 : nbytes);
+  if (ptr == this->last && reinterpret_cast<uintptr_t>(ptr) % align == 0) {
+    usize offset = bytes - this->current->getData();
+    if (offset + size <= this->current->cap) {
+      this->current->used = offset + size;
+      return ptr;
+    }
+  }
+
+  // The last allocation didn't fit in place, so give its space back first;
+  // the new allocation has to come from another chunk, leaving the old bytes
+  // untouched for the copy
+  usize old_used = this->current->used;
+  if (ptr == this->last) {
+    this->current->used = bytes - this->current->getData();
+  }
+
+  Chunk* old_chunk = this->current;
+  void*  resized   = this->bump(nbytes, align);
+  if (resized == nullptr) {
+    old_chunk->used = old_used;
+    return nullptr;
+  }
+  memcpy(resized, ptr, copy_nbytes < nbytes ? copy_nbytes : nbytes);
+
+  return resized;
+}
+
+void* ArenaAllocator::arenaAlloc(void* ctx, usize nbytes) {
+  return static_cast<ArenaAllocator*>(ctx)->bump(nbytes, ALIGNMENT);
+}
+
+void ArenaAllocator::arenaDealloc(void* /*ctx*/, void* /*ptr*/) {}
+
+void* ArenaAllocator::arenaResize(void* ctx, void* ptr, usize nbytes) {
+  ArenaAllocator* arena = static_cast<ArenaAllocator*>(ctx);
+  if (ptr == nullptr) {
+    return arena->bump(nbytes, ALIGNMENT);
+  }
+
+  // Find the chunk containing `ptr`
+  u8*    bytes = static_cast<u8*>(ptr);
+  Chunk* chunk = arena->current;
+  while (chunk != nullptr && !(bytes >= chunk->getData() &&
+                               bytes < chunk->getData() + chunk->used)) {
+    chunk = chunk->prev;
+  }
+  if (chunk == nullptr) {
+    return nullptr;
+  }
+
+  // The old allocation's size isn't known, but it lies entirely within the
+  // used part of its chunk, so copying up to the end of that is enough
+  usize available = chunk->getData() + chunk->used - bytes;
+  return arena->grow(ptr, nbytes, available, ALIGNMENT);
+}
+
+void* ArenaAllocator::arenaAllocAligned(void* ctx, usize nbytes, usize align) {
+  return static_cast<ArenaAllocator*>(ctx)->bump(nbytes, align);
+}
+
+void ArenaAllocator::arenaDeallocAligned(void* /*ctx*/, void* /*ptr*/,
+                                         usize /*align*/) {}
+
+void* ArenaAllocator::arenaResizeAligned(void* ctx, void* ptr,
+                                         usize old_nbytes, usize new_nbytes,
+                                         usize align) {
+  ArenaAllocator* arena = static_cast<ArenaAllocator*>(ctx);
+  if (ptr == nullptr) {
+    return arena->bump(new_nbytes, align);
+  }
+  return arena->grow(ptr, new_nbytes, old_nbytes, align);
+}
+
+void ArenaAllocator::arenaDeallocSized(void* ctx, void* ptr, usize nbytes,
+                                       usize /*align*/) {
+  ArenaAllocator* arena = static_cast<ArenaAllocator*>(ctx);
+
+  // Only the most recent allocation can be given back
+  if (ptr == nullptr || ptr != arena->last) {
+    return;
+  }
+  u8*   bytes  = static_cast<u8*>(ptr);
+  usize offset = bytes - arena->current->getData();
+  if (offset + alignUp(nbytes == 0 ? 1 : nbytes) == arena->current->used) {
+    arena->current->used = offset;
+    arena->last          = nullptr;
+  }
+}
+
+bool ArenaAllocator::arenaExpand(void* ctx, void* ptr, usize old_nbytes,
+                                 usize new_nbytes) {
+  ArenaAllocator* arena = static_cast<ArenaAllocator*>(ctx);
+  if (ptr != arena->last) {
+    return new_nbytes <= old_nbytes;
+  }
+
+  usize offset = static_cast<u8*>(ptr) - arena->current->getData();
+  usize size   = alignUp(new_nbytes == 0 ? 1 : new_nbytes);
+  if (offset + size > arena->current->cap) {
+    return false;
+  }
+  arena->current->used = offset + size;
+  return true;
+}
+
+} // namespace bl::mem
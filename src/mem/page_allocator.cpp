@@ -0,0 +1,232 @@
+#include "bl/mem/page_allocator.h"
+
+#include "bl/mem/allocator.h" // Allocator
+#include "bl/primitives.h"    // usize, u8
+
+#include <cstdint>    // uintptr_t
+#include <cstring>    // memcpy
+#include <mutex>      // lock_guard
+#include <sys/mman.h> // mmap, mremap, munmap, madvise
+#include <unistd.h>   // sysconf
+
+namespace bl::mem {
+
+PageAllocator::PageAllocator(bool huge_pages)
+    : page_size(static_cast<usize>(sysconf(_SC_PAGESIZE))),
+      huge_pages(huge_pages) {
+  this->ctx            = this;
+  this->alloc          = PageAllocator::pageAlloc;
+  this->dealloc        = PageAllocator::pageDealloc;
+  this->resize         = PageAllocator::pageResize;
+  this->allocAligned   = PageAllocator::pageAllocAligned;
+  this->deallocAligned = PageAllocator::pageDeallocAligned;
+  this->resizeAligned  = PageAllocator::pageResizeAligned;
+  this->deallocSized   = PageAllocator::pageDeallocSized;
+  this->expand         = PageAllocator::pageExpand;
+}
+
+PageAllocator::~PageAllocator() {
+  Mapping* mapping = this->mappings;
+  while (mapping != nullptr) {
+    Mapping* next = mapping->next;
+    munmap(mapping, mapping->len);
+    mapping = next;
+  }
+}
+
+bool PageAllocator::owns(const void* ptr) const {
+  // Every allocation is page aligned, which rules out most foreign pointers
+  // without taking the lock
+  if (ptr == nullptr ||
+      reinterpret_cast<uintptr_t>(ptr) % this->page_size != 0) {
+    return false;
+  }
+
+  std::lock_guard<std::mutex> guard(this->lock);
+  const Mapping*              target  = this->getMapping(ptr);
+  const Mapping*              mapping = this->mappings;
+  while (mapping != nullptr) {
+    if (mapping == target) {
+      return true;
+    }
+    mapping = mapping->next;
+  }
+  return false;
+}
+
+usize PageAllocator::getPageSize(void) const { return this->page_size; }
+
+usize PageAllocator::getMappedBytes(void) const {
+  std::lock_guard<std::mutex> guard(this->lock);
+  return this->mapped_bytes;
+}
+
+usize PageAllocator::mappingLen(usize nbytes) const {
+  usize data_len = (nbytes + this->page_size - 1) & ~(this->page_size - 1);
+  return this->page_size + (data_len == 0 ? this->page_size : data_len);
+}
+
+PageAllocator::Mapping* PageAllocator::getMapping(const void* ptr) const {
+  return reinterpret_cast<Mapping*>(
+      const_cast<u8*>(static_cast<const u8*>(ptr)) - this->page_size);
+}
+
+void PageAllocator::link(Mapping* mapping) {
+  std::lock_guard<std::mutex> guard(this->lock);
+  mapping->prev = nullptr;
+  mapping->next = this->mappings;
+  if (this->mappings != nullptr) {
+    this->mappings->prev = mapping;
+  }
+  this->mappings      = mapping;
+  this->mapped_bytes += mapping->len;
+}
+
+void PageAllocator::unlink(Mapping* mapping) {
+  std::lock_guard<std::mutex> guard(this->lock);
+  if (mapping->prev != nullptr) {
+    mapping->prev->next = mapping->next;
+  } else {
+    this->mappings = mapping->next;
+  }
+  if (mapping->next != nullptr) {
+    mapping->next->prev = mapping->prev;
+  }
+  this->mapped_bytes -= mapping->len;
+}
+
+void* PageAllocator::pageAlloc(void* ctx, usize nbytes) {
+  PageAllocator* pages = static_cast<PageAllocator*>(ctx);
+
+  usize          len   = pages->mappingLen(nbytes);
+  void*          base  = mmap(nullptr, len, PROT_READ | PROT_WRITE,
+                              MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (base == MAP_FAILED) {
+    return nullptr;
+  }
+
+  // The header page is advised along with the data so the mapping stays a
+  // single VMA (`mremap` can't move a range spanning several of them)
+#if defined(MADV_HUGEPAGE)
+  if (pages->huge_pages) {
+    madvise(base, len, MADV_HUGEPAGE);
+  }
+#endif
+
+  Mapping* mapping = static_cast<Mapping*>(base);
+  mapping->len     = len;
+  pages->link(mapping);
+
+  return static_cast<u8*>(base) + pages->page_size;
+}
+
+void PageAllocator::pageDealloc(void* ctx, void* ptr) {
+  PageAllocator* pages = static_cast<PageAllocator*>(ctx);
+  if (ptr == nullptr) {
+    return;
+  }
+
+  Mapping* mapping = pages->getMapping(ptr);
+  pages->unlink(mapping);
+  munmap(mapping, mapping->len);
+}
+
+void* PageAllocator::pageResize(void* ctx, void* ptr, usize nbytes) {
+  PageAllocator* pages = static_cast<PageAllocator*>(ctx);
+  if (ptr == nullptr) {
+    return pageAlloc(ctx, nbytes);
+  }
+
+  Mapping* mapping = pages->getMapping(ptr);
+  usize    old_len = mapping->len;
+  usize    new_len = pages->mappingLen(nbytes);
+  if (new_len == old_len) {
+    return ptr;
+  }
+
+  // The header moves along with the pages, so it has to be relinked
+  pages->unlink(mapping);
+#if defined(__linux__)
+  void* base = mremap(mapping, old_len, new_len, MREMAP_MAYMOVE);
+  if (base == MAP_FAILED) {
+    pages->link(mapping);
+    return nullptr;
+  }
+#else
+  void* base = mmap(nullptr, new_len, PROT_READ | PROT_WRITE,
+                    MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (base == MAP_FAILED) {
+    pages->link(mapping);
+    return nullptr;
+  }
+  memcpy(base, mapping, old_len < new_len ? old_len : new_len);
+  munmap(mapping, old_len);
+#endif
+
+#if defined(MADV_HUGEPAGE)
+  if (pages->huge_pages) {
+    madvise(base, new_len, MADV_HUGEPAGE);
+  }
+#endif
+
+  mapping      = static_cast<Mapping*>(base);
+  mapping->len = new_len;
+  pages->link(mapping);
+
+  return static_cast<u8*>(base) + pages->page_size;
+}
+
+void* PageAllocator::pageAllocAligned(void* ctx, usize nbytes, usize align) {
+  PageAllocator* pages = static_cast<PageAllocator*>(ctx);
+  if (align > pages->page_size) {
+    return nullptr;
+  }
+  return pageAlloc(ctx, nbytes);
+}
+
+void PageAllocator::pageDeallocAligned(void* ctx, void* ptr, usize /*align*/) {
+  pageDealloc(ctx, ptr);
+}
+
+void* PageAllocator::pageResizeAligned(void* ctx, void* ptr,
+                                       usize /*old_nbytes*/, usize new_nbytes,
+                                       usize align) {
+  PageAllocator* pages = static_cast<PageAllocator*>(ctx);
+  if (align > pages->page_size) {
+    return nullptr;
+  }
+  return pageResize(ctx, ptr, new_nbytes);
+}
+
+void PageAllocator::pageDeallocSized(void* ctx, void* ptr, usize /*nbytes*/,
+                                     usize /*align*/) {
+  pageDealloc(ctx, ptr);
+}
+
+bool PageAllocator::pageExpand(void* ctx, void* ptr, usize /*old_nbytes*/,
+                               usize new_nbytes) {
+  PageAllocator* pages   = static_cast<PageAllocator*>(ctx);
+  Mapping*       mapping = pages->getMapping(ptr);
+  usize          old_len = mapping->len;
+  usize          new_len = pages->mappingLen(new_nbytes);
+  if (new_len == old_len) {
+    return true;
+  }
+
+#if defined(__linux__)
+  // Without `MREMAP_MAYMOVE` the mapping only grows if the pages after it are
+  // free, and shrinking always happens in place
+  std::lock_guard<std::mutex> guard(pages->lock);
+  if (mremap(mapping, old_len, new_len, 0) == MAP_FAILED) {
+    return false;
+  }
+  mapping->len         = new_len;
+  pages->mapped_bytes += new_len;
+  pages->mapped_bytes -= old_len;
+  return true;
+#else
+  return new_len < old_len;
+#endif
+}
+
+} // namespace bl::mem
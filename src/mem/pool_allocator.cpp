@@ -0,0 +1,345 @@
+#include "bl/mem/pool_allocator.h"
+
+#include "bl/error.h"           // BL_THROW, resetError
+#include "bl/mem/allocator.h"   // Allocator
+#include "bl/mem/c_allocator.h" // CAllocator
+#include "bl/primitives.h"      // const_cstr, usize, u8
+
+#include <cstring> // memcpy, memmove
+
+namespace bl::mem {
+
+namespace {
+enum class PoolError {
+  InvalidAllocator,
+  InvalidSlabSize,
+};
+
+const_cstr errMsg(PoolError err) {
+  switch (err) {
+  case PoolError::InvalidAllocator:
+    return "PoolError: Invalid Allocator (the parent allocator was null)";
+  case PoolError::InvalidSlabSize:
+    return "PoolError: Invalid slab size (the slab size must be at least "
+           "`MAX_BLOCK_SIZE`)";
+  }
+
+  return nullptr;
+}
+
+Allocator DEFAULT_C_ALLOCATOR = CAllocator();
+
+/// Returns the index of the smallest size class that fits `nbytes`.
+usize     classIndex(usize nbytes) {
+  usize idx  = 0;
+  usize size = PoolAllocator::MIN_BLOCK_SIZE;
+  while (size < nbytes) {
+    size <<= 1;
+    ++idx;
+  }
+  return idx;
+}
+} // namespace
+
+PoolAllocator::PoolAllocator()
+    : parent(&DEFAULT_C_ALLOCATOR), slab_size(DEFAULT_SLAB_SIZE) {
+  this->ctx            = this;
+  this->alloc          = PoolAllocator::poolAlloc;
+  this->dealloc        = PoolAllocator::poolDealloc;
+  this->resize         = PoolAllocator::poolResize;
+  this->allocAligned   = PoolAllocator::poolAllocAligned;
+  this->deallocAligned = PoolAllocator::poolDeallocAligned;
+  this->resizeAligned  = PoolAllocator::poolResizeAligned;
+  this->deallocSized   = PoolAllocator::poolDeallocSized;
+  this->expand         = PoolAllocator::poolExpand;
+}
+
+PoolAllocator::PoolAllocator(Allocator* parent, usize slab_size)
+    : PoolAllocator() {
+  // Input validation
+  {
+    Error::resetError();
+
+    if (parent == nullptr) {
+      BL_THROW(errMsg(PoolError::InvalidAllocator));
+      return;
+    }
+
+    if (slab_size < MAX_BLOCK_SIZE) {
+      BL_THROW(errMsg(PoolError::InvalidSlabSize));
+      return;
+    }
+  }
+
+  this->parent    = parent;
+  this->slab_size = slab_size;
+}
+
+PoolAllocator::~PoolAllocator() {
+  for (usize i = 0; i < this->num_slabs; i++) {
+    this->parent->deallocAlignedRaw(this->slabs[i].base, MAX_BLOCK_SIZE);
+  }
+  if (this->slabs != nullptr) {
+    this->parent->deallocRaw(this->slabs);
+  }
+}
+
+usize PoolAllocator::getSlabCount(void) const { return this->num_slabs; }
+
+bool  PoolAllocator::addSlab(usize class_idx) {
+  // Make room in the slab table
+  if (this->num_slabs == this->cap_slabs) {
+    usize new_cap = this->cap_slabs == 0 ? 8 : this->cap_slabs * 2;
+    Slab* resized =
+        this->slabs == nullptr
+            ? static_cast<Slab*>(this->parent->allocRaw(new_cap * sizeof(Slab)))
+            : static_cast<Slab*>(this->parent->resizeRaw(
+                  this->slabs, new_cap * sizeof(Slab)));
+    if (resized == nullptr) {
+      return false;
+    }
+    this->slabs     = resized;
+    this->cap_slabs = new_cap;
+  }
+
+  // Aligning the slab aligns every block to its size
+  u8* base = static_cast<u8*>(
+      this->parent->allocAlignedRaw(this->slab_size, MAX_BLOCK_SIZE));
+  if (base == nullptr) {
+    return false;
+  }
+
+  // Keep the table sorted so `findSlab` can binary search it
+  usize pos = this->num_slabs;
+  while (pos > 0 && this->slabs[pos - 1].base > base) {
+    --pos;
+  }
+  memmove(this->slabs + pos + 1, this->slabs + pos,
+          (this->num_slabs - pos) * sizeof(Slab));
+  this->slabs[pos]  = Slab{base, class_idx};
+  this->num_slabs  += 1;
+
+  // Unused blocks at the end of the previous slab are simply dropped
+  usize      block_size = MIN_BLOCK_SIZE << class_idx;
+  SizeClass& sc         = this->classes[class_idx];
+  sc.bump               = base;
+  sc.end                = base + (this->slab_size / block_size) * block_size;
+
+  return true;
+}
+
+PoolAllocator::Slab* PoolAllocator::findSlab(void* ptr) const {
+  u8*   bytes = static_cast<u8*>(ptr);
+
+  // Find the last slab starting at or before `ptr`
+  usize lo    = 0;
+  usize hi    = this->num_slabs;
+  while (lo < hi) {
+    usize mid = lo + (hi - lo) / 2;
+    if (this->slabs[mid].base <= bytes) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+  if (lo == 0) {
+    return nullptr;
+  }
+
+  Slab* slab = &this->slabs[lo - 1];
+  if (bytes >= slab->base + this->slab_size) {
+    return nullptr;
+  }
+  return slab;
+}
+
+void* PoolAllocator::allocBlock(usize class_idx) {
+  SizeClass& sc = this->classes[class_idx];
+
+  // Reuse a freed block if there is one
+  if (sc.free_list != nullptr) {
+    Block* block = sc.free_list;
+    sc.free_list = block->next;
+    return block;
+  }
+
+  // Otherwise carve a new one out of the newest slab
+  if (sc.bump == sc.end) {
+    if (!this->addSlab(class_idx)) {
+      return nullptr;
+    }
+  }
+  void* block  = sc.bump;
+  sc.bump     += MIN_BLOCK_SIZE << class_idx;
+  return block;
+}
+
+void PoolAllocator::freeBlock(usize class_idx, void* ptr) {
+  SizeClass& sc    = this->classes[class_idx];
+  Block*     block = static_cast<Block*>(ptr);
+  block->next      = sc.free_list;
+  sc.free_list     = block;
+}
+
+void* PoolAllocator::poolAlloc(void* ctx, usize nbytes) {
+  PoolAllocator* pool = static_cast<PoolAllocator*>(ctx);
+  if (nbytes > MAX_BLOCK_SIZE) {
+    return pool->parent->allocRaw(nbytes);
+  }
+  return pool->allocBlock(classIndex(nbytes));
+}
+
+void PoolAllocator::poolDealloc(void* ctx, void* ptr) {
+  PoolAllocator* pool = static_cast<PoolAllocator*>(ctx);
+  if (ptr == nullptr) {
+    return;
+  }
+
+  Slab* slab = pool->findSlab(ptr);
+  if (slab == nullptr) {
+    pool->parent->deallocRaw(ptr);
+    return;
+  }
+  pool->freeBlock(slab->class_idx, ptr);
+}
+
+void* PoolAllocator::poolResize(void* ctx, void* ptr, usize nbytes) {
+  PoolAllocator* pool = static_cast<PoolAllocator*>(ctx);
+  if (ptr == nullptr) {
+    return poolAlloc(ctx, nbytes);
+  }
+
+  Slab* slab = pool->findSlab(ptr);
+  if (slab == nullptr) {
+    if (nbytes > MAX_BLOCK_SIZE) {
+      return pool->parent->resizeRaw(ptr, nbytes);
+    }
+
+    // Shrinking an oversized allocation moves it into the pool (the old
+    // allocation was bigger than `nbytes`, so copying `nbytes` is fine)
+    void* resized = pool->allocBlock(classIndex(nbytes));
+    if (resized == nullptr) {
+      return nullptr;
+    }
+    memcpy(resized, ptr, nbytes);
+    pool->parent->deallocRaw(ptr);
+    return resized;
+  }
+
+  // The block is already big enough
+  usize block_size = MIN_BLOCK_SIZE << slab->class_idx;
+  if (nbytes <= block_size) {
+    return ptr;
+  }
+
+  // Move to a bigger size class (or to the parent)
+  usize class_idx = slab->class_idx;
+  void* resized   = poolAlloc(ctx, nbytes);
+  if (resized == nullptr) {
+    return nullptr;
+  }
+  memcpy(resized, ptr, block_size);
+  pool->freeBlock(class_idx, ptr);
+
+  return resized;
+}
+
+void* PoolAllocator::poolAllocAligned(void* ctx, usize nbytes, usize align) {
+  PoolAllocator* pool = static_cast<PoolAllocator*>(ctx);
+  if (nbytes > MAX_BLOCK_SIZE || align > MAX_BLOCK_SIZE) {
+    return pool->parent->allocAlignedRaw(nbytes, align);
+  }
+  return pool->allocBlock(classIndex(nbytes > align ? nbytes : align));
+}
+
+void PoolAllocator::poolDeallocAligned(void* ctx, void* ptr, usize align) {
+  PoolAllocator* pool = static_cast<PoolAllocator*>(ctx);
+  if (ptr == nullptr) {
+    return;
+  }
+
+  Slab* slab = pool->findSlab(ptr);
+  if (slab == nullptr) {
+    pool->parent->deallocAlignedRaw(ptr, align);
+    return;
+  }
+  pool->freeBlock(slab->class_idx, ptr);
+}
+
+void* PoolAllocator::poolResizeAligned(void* ctx, void* ptr, usize old_nbytes,
+                                       usize new_nbytes, usize align) {
+  PoolAllocator* pool = static_cast<PoolAllocator*>(ctx);
+  if (ptr == nullptr) {
+    return poolAllocAligned(ctx, new_nbytes, align);
+  }
+
+  Slab* slab = pool->findSlab(ptr);
+  if (slab == nullptr) {
+    if (new_nbytes > MAX_BLOCK_SIZE || align > MAX_BLOCK_SIZE) {
+      return pool->parent->resizeAlignedRaw(ptr, old_nbytes, new_nbytes,
+                                            align);
+    }
+
+    // Shrinking an oversized allocation moves it into the pool
+    void* resized = poolAllocAligned(ctx, new_nbytes, align);
+    if (resized == nullptr) {
+      return nullptr;
+    }
+    memcpy(resized, ptr, old_nbytes < new_nbytes ? old_nbytes : new_nbytes);
+    pool->parent->deallocSizedRaw(ptr, old_nbytes, align);
+    return resized;
+  }
+
+  // The block is already big enough
+  usize block_size = MIN_BLOCK_SIZE << slab->class_idx;
+  if (new_nbytes <= block_size) {
+    return ptr;
+  }
+
+  // Move to a bigger size class (or to the parent)
+  usize class_idx = slab->class_idx;
+  void* resized   = poolAllocAligned(ctx, new_nbytes, align);
+  if (resized == nullptr) {
+    return nullptr;
+  }
+  memcpy(resized, ptr, old_nbytes < block_size ? old_nbytes : block_size);
+  pool->freeBlock(class_idx, ptr);
+
+  return resized;
+}
+
+void PoolAllocator::poolDeallocSized(void* ctx, void* ptr, usize nbytes,
+                                     usize align) {
+  PoolAllocator* pool = static_cast<PoolAllocator*>(ctx);
+  if (ptr == nullptr) {
+    return;
+  }
+
+  if (nbytes > MAX_BLOCK_SIZE || align > MAX_BLOCK_SIZE) {
+    pool->parent->deallocSizedRaw(ptr, nbytes, align);
+    return;
+  }
+
+  // The block may belong to a bigger size class (blocks aren't moved when
+  // they shrink), which is fine since it's at least as big as this one
+  pool->freeBlock(classIndex(nbytes > align ? nbytes : align), ptr);
+}
+
+bool PoolAllocator::poolExpand(void* ctx, void* ptr, usize old_nbytes,
+                               usize new_nbytes) {
+  PoolAllocator* pool = static_cast<PoolAllocator*>(ctx);
+
+  // Shrinking in place wouldn't give anything back, so the block has to move
+  if (new_nbytes < old_nbytes) {
+    return false;
+  }
+
+  Slab* slab = pool->findSlab(ptr);
+  if (slab == nullptr) {
+    return pool->parent->tryExpandRaw(ptr, old_nbytes, new_nbytes);
+  }
+
+  return new_nbytes <= (MIN_BLOCK_SIZE << slab->class_idx);
+}
+
+} // namespace bl::mem
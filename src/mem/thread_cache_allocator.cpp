@@ -0,0 +1,682 @@
+#include "bl/mem/thread_cache_allocator.h"
+
+#include "bl/error.h"           // BL_THROW, resetError
+#include "bl/mem/allocator.h"   // Allocator
+#include "bl/mem/c_allocator.h" // CAllocator
+#include "bl/primitives.h"      // const_cstr, usize, u64, u8
+
+#include <atomic>     // atomic, memory_order_*
+#include <cstdint>    // uintptr_t
+#include <cstring>    // memcpy
+#include <mutex>      // mutex, lock_guard
+#include <new>        // placement new
+#include <sys/mman.h> // mmap, mprotect, munmap
+
+namespace bl::mem {
+
+namespace {
+enum class ThreadCacheError {
+  InvalidAllocator,
+  InvalidReserve,
+  ReserveFailed,
+};
+
+const_cstr errMsg(ThreadCacheError err) {
+  switch (err) {
+  case ThreadCacheError::InvalidAllocator:
+    return "ThreadCacheError: Invalid Allocator (the parent allocator was "
+           "null)";
+  case ThreadCacheError::InvalidReserve:
+    return "ThreadCacheError: Invalid reserve (the reserve must be at least "
+           "`SEGMENT_SIZE`)";
+  case ThreadCacheError::ReserveFailed:
+    return "ThreadCacheError: Unable to reserve address space for the "
+           "segments";
+  }
+
+  return nullptr;
+}
+
+Allocator             DEFAULT_C_ALLOCATOR = CAllocator();
+
+/// Protects `live_allocators` (and keeps allocators alive while a thread
+/// abandons its heaps).
+std::mutex            registry_lock;
+
+/// All allocators that haven't been destroyed yet.
+ThreadCacheAllocator* live_allocators = nullptr;
+
+/// The id of the next allocator.
+std::atomic<u64>      next_id{1};
+
+/// Returns the index of the smallest size class that fits `nbytes`.
+usize                 classIndex(usize nbytes) {
+  if (nbytes <= ThreadCacheAllocator::MIN_BLOCK_SIZE) {
+    return 0;
+  }
+  // log2(MIN_BLOCK_SIZE) == 4
+  return 64 - static_cast<usize>(__builtin_clzll(nbytes - 1)) - 4;
+}
+
+/// Returns the block size of the given size class.
+usize blockSize(usize class_idx) {
+  return ThreadCacheAllocator::MIN_BLOCK_SIZE << class_idx;
+}
+} // namespace
+
+/// Header placed at the start of every segment; the blocks of a single size
+/// class follow it.
+struct ThreadCacheAllocator::Segment {
+  /// The heap that allocates from this segment.
+  Heap*               owner;
+
+  /// Neighbours in the owner's list for the size class (or in the central
+  /// heap's free list).
+  Segment*            prev;
+  Segment*            next;
+
+  /// Blocks freed by threads other than the owner.
+  std::atomic<Block*> remote_free;
+
+  /// Blocks freed by the owner.
+  Block*              free_list;
+
+  /// The next block that was never handed out.
+  u8*                 bump;
+
+  /// The size class of the blocks.
+  usize               class_idx;
+
+  /// The number of blocks handed out (remote frees only count once they are
+  /// collected).
+  usize               used;
+
+  /// Hands the segment to `owner` for blocks of the given size class.
+  void                init(Heap* owner, usize class_idx) {
+    // Blocks are aligned to their size (segments are aligned to
+    // `SEGMENT_SIZE`)
+    usize size      = blockSize(class_idx);
+    usize start     = (sizeof(Segment) + size - 1) & ~(size - 1);
+
+    this->owner     = owner;
+    this->prev      = nullptr;
+    this->next      = nullptr;
+    this->remote_free.store(nullptr, std::memory_order_relaxed);
+    this->free_list = nullptr;
+    this->bump      = reinterpret_cast<u8*>(this) + start;
+    this->class_idx = class_idx;
+    this->used      = 0;
+  }
+
+  /// Hands out a block, or returns `nullptr` if the segment is full.
+  void* pop(void) {
+    Block* block = this->free_list;
+    if (block != nullptr) {
+      this->free_list  = block->next;
+      this->used      += 1;
+      return block;
+    }
+
+    usize size = blockSize(this->class_idx);
+    if (this->bump + size <= reinterpret_cast<u8*>(this) + SEGMENT_SIZE) {
+      void* ptr   = this->bump;
+      this->bump += size;
+      this->used += 1;
+      return ptr;
+    }
+
+    return nullptr;
+  }
+
+  /// Moves the blocks freed by other threads to the local free list.
+  void collect(void) {
+    Block* block =
+        this->remote_free.exchange(nullptr, std::memory_order_acquire);
+    while (block != nullptr) {
+      Block* next      = block->next;
+      block->next      = this->free_list;
+      this->free_list  = block;
+      this->used      -= 1;
+      block            = next;
+    }
+  }
+
+  /// Returns the segment containing the given block.
+  static Segment* of(const void* ptr) {
+    return reinterpret_cast<Segment*>(reinterpret_cast<uintptr_t>(ptr) &
+                                      ~(SEGMENT_SIZE - 1));
+  }
+};
+
+/// A thread's heap: the segments it allocates from, per size class.
+struct ThreadCacheAllocator::Heap {
+  /// The next heap of the allocator.
+  Heap*    next;
+
+  /// Whether the heap's thread exited (protected by `heaps_lock`).
+  bool     abandoned;
+
+  /// The segments of each size class (the one allocated from first).
+  Segment* segments[NUM_SIZE_CLASSES];
+
+  /// An empty segment per size class that is kept instead of being given back
+  /// to the central heap (so freeing and allocating batches of blocks doesn't
+  /// bounce segments back and forth).
+  Segment* spares[NUM_SIZE_CLASSES];
+
+  /// Adds a segment to the front of its size class' list.
+  void     pushFront(Segment* segment) {
+    Segment*& head = this->segments[segment->class_idx];
+    segment->prev  = nullptr;
+    segment->next  = head;
+    if (head != nullptr) {
+      head->prev = segment;
+    }
+    head = segment;
+  }
+
+  /// Removes a segment from its size class' list.
+  void unlink(Segment* segment) {
+    if (segment->prev != nullptr) {
+      segment->prev->next = segment->next;
+    } else {
+      this->segments[segment->class_idx] = segment->next;
+    }
+    if (segment->next != nullptr) {
+      segment->next->prev = segment->prev;
+    }
+  }
+};
+
+/// The heaps of a thread, one per allocator it used (most recent first).
+struct ThreadCacheAllocator::ThreadHeaps {
+  static const usize NUM_ENTRIES = 4;
+
+  struct Entry {
+    ThreadCacheAllocator* allocator;
+    u64                   id;
+    Heap*                 heap;
+  };
+
+  Entry entries[NUM_ENTRIES] = {};
+
+  /// Abandons the thread's heaps when it exits.
+  ~ThreadHeaps() {
+    // Frees made later during thread exit go through the remote-free lists,
+    // since the heaps may already be adopted by other threads
+    last_id = 0;
+    for (usize i = 0; i < NUM_ENTRIES; i++) {
+      release(this->entries[i]);
+      this->entries[i] = Entry{};
+    }
+  }
+
+  /// Abandons the heap of the given entry, unless its allocator has already
+  /// been destroyed.
+  static void release(const Entry& entry) {
+    if (entry.heap == nullptr) {
+      return;
+    }
+
+    std::lock_guard<std::mutex> guard(registry_lock);
+    for (ThreadCacheAllocator* alloc = live_allocators; alloc != nullptr;
+         alloc                       = alloc->next_live) {
+      if (alloc == entry.allocator && alloc->id == entry.id) {
+        alloc->abandonHeap(entry.heap);
+        return;
+      }
+    }
+  }
+};
+
+thread_local ThreadCacheAllocator::ThreadHeaps
+    ThreadCacheAllocator::thread_heaps;
+
+// The fast path avoids `__tls_get_addr` calls when built as a shared library
+// (the two variables easily fit into the static TLS surplus)
+#if defined(__GNUC__)
+#define BL_TLS_INITIAL_EXEC __attribute__((tls_model("initial-exec")))
+#else
+#define BL_TLS_INITIAL_EXEC
+#endif
+
+thread_local u64 ThreadCacheAllocator::last_id BL_TLS_INITIAL_EXEC = 0;
+
+thread_local ThreadCacheAllocator::Heap*
+    ThreadCacheAllocator::last_heap BL_TLS_INITIAL_EXEC = nullptr;
+
+ThreadCacheAllocator::ThreadCacheAllocator()
+    : ThreadCacheAllocator(&DEFAULT_C_ALLOCATOR) {}
+
+ThreadCacheAllocator::ThreadCacheAllocator(Allocator* parent, usize reserve)
+    : parent(&DEFAULT_C_ALLOCATOR),
+      id(next_id.fetch_add(1, std::memory_order_relaxed)) {
+  this->ctx            = this;
+  this->alloc          = ThreadCacheAllocator::tcAlloc;
+  this->dealloc        = ThreadCacheAllocator::tcDealloc;
+  this->resize         = ThreadCacheAllocator::tcResize;
+  this->allocAligned   = ThreadCacheAllocator::tcAllocAligned;
+  this->deallocAligned = ThreadCacheAllocator::tcDeallocAligned;
+  this->resizeAligned  = ThreadCacheAllocator::tcResizeAligned;
+  this->deallocSized   = ThreadCacheAllocator::tcDeallocSized;
+  this->expand         = ThreadCacheAllocator::tcExpand;
+
+  {
+    std::lock_guard<std::mutex> guard(registry_lock);
+    this->next_live = live_allocators;
+    live_allocators = this;
+  }
+
+  // Input validation
+  {
+    Error::resetError();
+
+    if (parent == nullptr) {
+      BL_THROW(errMsg(ThreadCacheError::InvalidAllocator));
+      return;
+    }
+
+    if (reserve < SEGMENT_SIZE) {
+      BL_THROW(errMsg(ThreadCacheError::InvalidReserve));
+      return;
+    }
+  }
+
+  this->parent = parent;
+
+  // Reserve an extra segment, so the range can be aligned to `SEGMENT_SIZE`
+  // (which is how blocks find their segment)
+  reserve      = (reserve + SEGMENT_SIZE - 1) & ~(SEGMENT_SIZE - 1);
+  usize len    = reserve + SEGMENT_SIZE;
+  void* base   = mmap(nullptr, len, PROT_NONE,
+                      MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+  if (base == MAP_FAILED) {
+    BL_THROW(errMsg(ThreadCacheError::ReserveFailed));
+    return;
+  }
+
+  u8* start = reinterpret_cast<u8*>(
+      (reinterpret_cast<uintptr_t>(base) + SEGMENT_SIZE - 1) &
+      ~(SEGMENT_SIZE - 1));
+  usize head = static_cast<usize>(start - static_cast<u8*>(base));
+  if (head != 0) {
+    munmap(base, head);
+  }
+  if (SEGMENT_SIZE - head != 0) {
+    munmap(start + reserve, SEGMENT_SIZE - head);
+  }
+
+  this->reserved = start;
+  this->reserve  = reserve;
+}
+
+ThreadCacheAllocator::~ThreadCacheAllocator() {
+  {
+    std::lock_guard<std::mutex> guard(registry_lock);
+    ThreadCacheAllocator**      link = &live_allocators;
+    while (*link != this) {
+      link = &(*link)->next_live;
+    }
+    *link = this->next_live;
+  }
+
+  Heap* heap = this->heaps;
+  while (heap != nullptr) {
+    Heap* next = heap->next;
+    this->parent->deallocSizedRaw(heap, sizeof(Heap), alignof(Heap));
+    heap = next;
+  }
+
+  if (this->reserved != nullptr) {
+    munmap(this->reserved, this->reserve);
+  }
+}
+
+ThreadCacheAllocator* ThreadCacheAllocator::getGlobal(void) {
+  // `CAllocator` is trivially destructible, so the parent stays usable after
+  // static destruction as well
+  static CAllocator            c_allocator = CAllocator();
+  static ThreadCacheAllocator* global = new ThreadCacheAllocator(&c_allocator);
+  return global;
+}
+
+bool ThreadCacheAllocator::owns(const void* ptr) const {
+  const u8* bytes = static_cast<const u8*>(ptr);
+  return this->reserved != nullptr && bytes >= this->reserved &&
+         bytes < this->reserved + this->reserve;
+}
+
+usize ThreadCacheAllocator::getSegmentCount(void) const {
+  std::lock_guard<std::mutex> guard(this->central_lock);
+
+  usize                       count   = this->committed / SEGMENT_SIZE;
+  Segment*                    segment = this->free_segments;
+  while (segment != nullptr) {
+    count   -= 1;
+    segment  = segment->next;
+  }
+  return count;
+}
+
+ThreadCacheAllocator::Heap* ThreadCacheAllocator::getHeap(void) {
+  Heap* heap = this->findHeap();
+  if (heap != nullptr) {
+    return heap;
+  }
+
+  heap = this->acquireHeap();
+  if (heap == nullptr) {
+    return nullptr;
+  }
+
+  // Evict the least recently added heap to make room
+  ThreadHeaps&       heaps   = thread_heaps;
+  ThreadHeaps::Entry evicted = heaps.entries[ThreadHeaps::NUM_ENTRIES - 1];
+  for (usize i = ThreadHeaps::NUM_ENTRIES - 1; i > 0; i--) {
+    heaps.entries[i] = heaps.entries[i - 1];
+  }
+  heaps.entries[0] = ThreadHeaps::Entry{this, this->id, heap};
+  last_id          = this->id;
+  last_heap        = heap;
+  ThreadHeaps::release(evicted);
+
+  return heap;
+}
+
+ThreadCacheAllocator::Heap* ThreadCacheAllocator::findHeap(void) {
+  if (last_id == this->id) {
+    return last_heap;
+  }
+
+  ThreadHeaps& heaps = thread_heaps;
+  for (usize i = 0; i < ThreadHeaps::NUM_ENTRIES; i++) {
+    if (heaps.entries[i].id == this->id) {
+      last_id   = this->id;
+      last_heap = heaps.entries[i].heap;
+      return last_heap;
+    }
+  }
+  return nullptr;
+}
+
+ThreadCacheAllocator::Heap* ThreadCacheAllocator::acquireHeap(void) {
+  std::lock_guard<std::mutex> guard(this->heaps_lock);
+
+  for (Heap* heap = this->heaps; heap != nullptr; heap = heap->next) {
+    if (heap->abandoned) {
+      heap->abandoned = false;
+      return heap;
+    }
+  }
+
+  void* mem = this->parent->allocAlignedRaw(sizeof(Heap), alignof(Heap));
+  if (mem == nullptr) {
+    return nullptr;
+  }
+  Heap* heap  = new (mem) Heap{};
+  heap->next  = this->heaps;
+  this->heaps = heap;
+  return heap;
+}
+
+void ThreadCacheAllocator::abandonHeap(Heap* heap) {
+  std::lock_guard<std::mutex> guard(this->heaps_lock);
+  heap->abandoned = true;
+}
+
+ThreadCacheAllocator::Segment* ThreadCacheAllocator::takeSegment(void) {
+  std::lock_guard<std::mutex> guard(this->central_lock);
+
+  Segment*                    segment = this->free_segments;
+  if (segment != nullptr) {
+    this->free_segments = segment->next;
+    return segment;
+  }
+
+  // Commit a fresh segment from the reserved range
+  if (this->reserve - this->committed < SEGMENT_SIZE) {
+    return nullptr;
+  }
+  u8* base = this->reserved + this->committed;
+  if (mprotect(base, SEGMENT_SIZE, PROT_READ | PROT_WRITE) != 0) {
+    return nullptr;
+  }
+  this->committed += SEGMENT_SIZE;
+
+  return new (base) Segment();
+}
+
+void ThreadCacheAllocator::giveSegment(Segment* segment) {
+  std::lock_guard<std::mutex> guard(this->central_lock);
+  segment->next       = this->free_segments;
+  this->free_segments = segment;
+}
+
+void* ThreadCacheAllocator::allocBlock(usize class_idx) {
+  Heap* heap = this->getHeap();
+  if (heap == nullptr) {
+    return nullptr;
+  }
+
+  // Fast path: the current segment has a block left
+  Segment* segment = heap->segments[class_idx];
+  if (segment != nullptr) {
+    void* block = segment->pop();
+    if (block != nullptr) {
+      return block;
+    }
+  }
+
+  // Look for blocks freed by other threads
+  while (segment != nullptr) {
+    Segment* next = segment->next;
+    segment->collect();
+    void* block = segment->pop();
+    if (block != nullptr) {
+      heap->unlink(segment);
+      heap->pushFront(segment);
+      return block;
+    }
+    segment = next;
+  }
+
+  // Refill from the spare segment or the central heap
+  segment = heap->spares[class_idx];
+  if (segment != nullptr) {
+    heap->spares[class_idx] = nullptr;
+  } else {
+    segment = this->takeSegment();
+    if (segment == nullptr) {
+      return nullptr;
+    }
+    segment->init(heap, class_idx);
+  }
+  heap->pushFront(segment);
+
+  return segment->pop();
+}
+
+void ThreadCacheAllocator::freeBlock(void* ptr) {
+  Segment* segment = Segment::of(ptr);
+  Block*   block   = static_cast<Block*>(ptr);
+
+  // Only look the heap up; threads that never allocated don't need one
+  Heap*    heap    = this->findHeap();
+
+  if (segment->owner != heap) {
+    Block* head = segment->remote_free.load(std::memory_order_relaxed);
+    do {
+      block->next = head;
+    } while (!segment->remote_free.compare_exchange_weak(
+        head, block, std::memory_order_release, std::memory_order_relaxed));
+    return;
+  }
+
+  block->next         = segment->free_list;
+  segment->free_list  = block;
+  segment->used      -= 1;
+
+  // Give fully freed segments back (except the current one, which would just
+  // be taken again by the next allocation, and a spare)
+  usize class_idx = segment->class_idx;
+  if (segment->used == 0 && heap->segments[class_idx] != segment) {
+    heap->unlink(segment);
+    if (heap->spares[class_idx] == nullptr) {
+      heap->spares[class_idx] = segment;
+    } else {
+      this->giveSegment(segment);
+    }
+  }
+}
+
+void* ThreadCacheAllocator::tcAlloc(void* ctx, usize nbytes) {
+  ThreadCacheAllocator* self = static_cast<ThreadCacheAllocator*>(ctx);
+  if (nbytes <= MAX_BLOCK_SIZE) {
+    return self->allocBlock(classIndex(nbytes));
+  }
+  return self->parent->allocRaw(nbytes);
+}
+
+void ThreadCacheAllocator::tcDealloc(void* ctx, void* ptr) {
+  ThreadCacheAllocator* self = static_cast<ThreadCacheAllocator*>(ctx);
+  if (ptr == nullptr) {
+    return;
+  }
+
+  if (self->owns(ptr)) {
+    self->freeBlock(ptr);
+    return;
+  }
+  self->parent->deallocRaw(ptr);
+}
+
+void* ThreadCacheAllocator::tcResize(void* ctx, void* ptr, usize nbytes) {
+  ThreadCacheAllocator* self = static_cast<ThreadCacheAllocator*>(ctx);
+  if (ptr == nullptr) {
+    return tcAlloc(ctx, nbytes);
+  }
+
+  if (self->owns(ptr)) {
+    // Resizing within the size class doesn't need to move
+    usize class_idx = Segment::of(ptr)->class_idx;
+    if (nbytes <= MAX_BLOCK_SIZE && classIndex(nbytes) == class_idx) {
+      return ptr;
+    }
+
+    usize block_size = blockSize(class_idx);
+    void* resized    = tcAlloc(ctx, nbytes);
+    if (resized == nullptr) {
+      return nullptr;
+    }
+    memcpy(resized, ptr, block_size < nbytes ? block_size : nbytes);
+    self->freeBlock(ptr);
+    return resized;
+  }
+
+  // Large allocations that shrink enough move to a block (the old allocation
+  // was bigger than `nbytes`, so copying `nbytes` is fine)
+  if (nbytes <= MAX_BLOCK_SIZE) {
+    void* resized = self->allocBlock(classIndex(nbytes));
+    if (resized == nullptr) {
+      return nullptr;
+    }
+    memcpy(resized, ptr, nbytes);
+    self->parent->deallocRaw(ptr);
+    return resized;
+  }
+  return self->parent->resizeRaw(ptr, nbytes);
+}
+
+void* ThreadCacheAllocator::tcAllocAligned(void* ctx, usize nbytes,
+                                           usize align) {
+  ThreadCacheAllocator* self = static_cast<ThreadCacheAllocator*>(ctx);
+
+  // Blocks are aligned to their size
+  usize                 size = nbytes < align ? align : nbytes;
+  if (size <= MAX_BLOCK_SIZE) {
+    return self->allocBlock(classIndex(size));
+  }
+  return self->parent->allocAlignedRaw(nbytes, align);
+}
+
+void ThreadCacheAllocator::tcDeallocAligned(void* ctx, void* ptr,
+                                            usize align) {
+  ThreadCacheAllocator* self = static_cast<ThreadCacheAllocator*>(ctx);
+  if (ptr == nullptr) {
+    return;
+  }
+
+  if (self->owns(ptr)) {
+    self->freeBlock(ptr);
+    return;
+  }
+  self->parent->deallocAlignedRaw(ptr, align);
+}
+
+void* ThreadCacheAllocator::tcResizeAligned(void* ctx, void* ptr,
+                                            usize old_nbytes, usize new_nbytes,
+                                            usize align) {
+  ThreadCacheAllocator* self = static_cast<ThreadCacheAllocator*>(ctx);
+  if (ptr == nullptr) {
+    return tcAllocAligned(ctx, new_nbytes, align);
+  }
+
+  usize size      = new_nbytes < align ? align : new_nbytes;
+  usize copy_size = old_nbytes < new_nbytes ? old_nbytes : new_nbytes;
+  if (self->owns(ptr)) {
+    if (size <= MAX_BLOCK_SIZE &&
+        classIndex(size) == Segment::of(ptr)->class_idx) {
+      return ptr;
+    }
+
+    void* resized = tcAllocAligned(ctx, new_nbytes, align);
+    if (resized == nullptr) {
+      return nullptr;
+    }
+    memcpy(resized, ptr, copy_size);
+    self->freeBlock(ptr);
+    return resized;
+  }
+
+  if (size <= MAX_BLOCK_SIZE) {
+    void* resized = self->allocBlock(classIndex(size));
+    if (resized == nullptr) {
+      return nullptr;
+    }
+    memcpy(resized, ptr, copy_size);
+    self->parent->deallocSizedRaw(ptr, old_nbytes, align);
+    return resized;
+  }
+  return self->parent->resizeAlignedRaw(ptr, old_nbytes, new_nbytes, align);
+}
+
+void ThreadCacheAllocator::tcDeallocSized(void* ctx, void* ptr, usize nbytes,
+                                          usize align) {
+  ThreadCacheAllocator* self = static_cast<ThreadCacheAllocator*>(ctx);
+  if (ptr == nullptr) {
+    return;
+  }
+
+  if (self->owns(ptr)) {
+    self->freeBlock(ptr);
+    return;
+  }
+  self->parent->deallocSizedRaw(ptr, nbytes, align);
+}
+
+bool ThreadCacheAllocator::tcExpand(void* ctx, void* ptr, usize old_nbytes,
+                                    usize new_nbytes) {
+  ThreadCacheAllocator* self = static_cast<ThreadCacheAllocator*>(ctx);
+
+  // Shrinking in place wouldn't give anything back, so the block has to move
+  if (new_nbytes < old_nbytes) {
+    return false;
+  }
+
+  if (self->owns(ptr)) {
+    return new_nbytes <= blockSize(Segment::of(ptr)->class_idx);
+  }
+  return self->parent->tryExpandRaw(ptr, old_nbytes, new_nbytes);
+}
+
+} // namespace bl::mem
@@ -0,0 +1,216 @@
+#include "bl/mem/threshold_allocator.h"
+
+#include "bl/error.h"              // BL_THROW, resetError
+#include "bl/mem/allocator.h"      // Allocator
+#include "bl/mem/c_allocator.h"    // CAllocator
+#include "bl/mem/page_allocator.h" // PageAllocator
+#include "bl/primitives.h"         // const_cstr, usize
+
+#include <cstring> // memcpy
+
+namespace bl::mem {
+
+namespace {
+enum class ThresholdError {
+  InvalidAllocator,
+  InvalidThreshold,
+};
+
+const_cstr errMsg(ThresholdError err) {
+  switch (err) {
+  case ThresholdError::InvalidAllocator:
+    return "ThresholdError: Invalid Allocator (the parent allocator was null)";
+  case ThresholdError::InvalidThreshold:
+    return "ThresholdError: Invalid threshold (the threshold must be "
+           "non-zero)";
+  }
+
+  return nullptr;
+}
+
+Allocator DEFAULT_C_ALLOCATOR = CAllocator();
+} // namespace
+
+ThresholdAllocator::ThresholdAllocator()
+    : ThresholdAllocator(&DEFAULT_C_ALLOCATOR) {}
+
+ThresholdAllocator::ThresholdAllocator(Allocator* parent, usize threshold,
+                                       bool huge_pages)
+    : parent(&DEFAULT_C_ALLOCATOR), pages(huge_pages),
+      threshold(DEFAULT_THRESHOLD) {
+  this->ctx            = this;
+  this->alloc          = ThresholdAllocator::thresholdAlloc;
+  this->dealloc        = ThresholdAllocator::thresholdDealloc;
+  this->resize         = ThresholdAllocator::thresholdResize;
+  this->allocAligned   = ThresholdAllocator::thresholdAllocAligned;
+  this->deallocAligned = ThresholdAllocator::thresholdDeallocAligned;
+  this->resizeAligned  = ThresholdAllocator::thresholdResizeAligned;
+  this->deallocSized   = ThresholdAllocator::thresholdDeallocSized;
+  this->expand         = ThresholdAllocator::thresholdExpand;
+
+  // Input validation
+  {
+    Error::resetError();
+
+    if (parent == nullptr) {
+      BL_THROW(errMsg(ThresholdError::InvalidAllocator));
+      return;
+    }
+
+    if (threshold == 0) {
+      BL_THROW(errMsg(ThresholdError::InvalidThreshold));
+      return;
+    }
+  }
+
+  this->parent    = parent;
+  this->threshold = threshold;
+}
+
+PageAllocator* ThresholdAllocator::getPages(void) { return &this->pages; }
+
+usize ThresholdAllocator::getThreshold(void) const { return this->threshold; }
+
+bool  ThresholdAllocator::isLarge(usize nbytes, usize align) const {
+  return nbytes >= this->threshold && align <= this->pages.getPageSize();
+}
+
+void* ThresholdAllocator::thresholdAlloc(void* ctx, usize nbytes) {
+  ThresholdAllocator* self = static_cast<ThresholdAllocator*>(ctx);
+  if (self->isLarge(nbytes, DEFAULT_ALIGNMENT)) {
+    return self->pages.allocRaw(nbytes);
+  }
+  return self->parent->allocRaw(nbytes);
+}
+
+void ThresholdAllocator::thresholdDealloc(void* ctx, void* ptr) {
+  ThresholdAllocator* self = static_cast<ThresholdAllocator*>(ctx);
+  if (self->pages.owns(ptr)) {
+    self->pages.deallocRaw(ptr);
+    return;
+  }
+  self->parent->deallocRaw(ptr);
+}
+
+void* ThresholdAllocator::thresholdResize(void* ctx, void* ptr, usize nbytes) {
+  ThresholdAllocator* self = static_cast<ThresholdAllocator*>(ctx);
+  if (ptr == nullptr) {
+    return thresholdAlloc(ctx, nbytes);
+  }
+
+  bool from_large = self->pages.owns(ptr);
+  bool to_large   = self->isLarge(nbytes, DEFAULT_ALIGNMENT);
+  if (from_large && to_large) {
+    return self->pages.resizeRaw(ptr, nbytes);
+  }
+  if (!from_large && !to_large) {
+    return self->parent->resizeRaw(ptr, nbytes);
+  }
+
+  // Shrinking below the threshold (the old allocation was bigger than
+  // `nbytes`, so copying `nbytes` is fine)
+  if (from_large) {
+    void* resized = self->parent->allocRaw(nbytes);
+    if (resized == nullptr) {
+      return nullptr;
+    }
+    memcpy(resized, ptr, nbytes);
+    self->pages.deallocRaw(ptr);
+    return resized;
+  }
+
+  // Growing past the threshold: the old size isn't known, so let the parent
+  // grow the allocation first, after which `nbytes` bytes can be copied
+  void* mapped = self->pages.allocRaw(nbytes);
+  if (mapped == nullptr) {
+    return nullptr;
+  }
+  void* grown = self->parent->resizeRaw(ptr, nbytes);
+  if (grown == nullptr) {
+    self->pages.deallocRaw(mapped);
+    return nullptr;
+  }
+  memcpy(mapped, grown, nbytes);
+  self->parent->deallocRaw(grown);
+
+  return mapped;
+}
+
+void* ThresholdAllocator::thresholdAllocAligned(void* ctx, usize nbytes,
+                                                usize align) {
+  ThresholdAllocator* self = static_cast<ThresholdAllocator*>(ctx);
+  if (self->isLarge(nbytes, align)) {
+    return self->pages.allocAlignedRaw(nbytes, align);
+  }
+  return self->parent->allocAlignedRaw(nbytes, align);
+}
+
+void ThresholdAllocator::thresholdDeallocAligned(void* ctx, void* ptr,
+                                                 usize align) {
+  ThresholdAllocator* self = static_cast<ThresholdAllocator*>(ctx);
+  if (self->pages.owns(ptr)) {
+    self->pages.deallocAlignedRaw(ptr, align);
+    return;
+  }
+  self->parent->deallocAlignedRaw(ptr, align);
+}
+
+void* ThresholdAllocator::thresholdResizeAligned(void* ctx, void* ptr,
+                                                 usize old_nbytes,
+                                                 usize new_nbytes,
+                                                 usize align) {
+  ThresholdAllocator* self = static_cast<ThresholdAllocator*>(ctx);
+  if (ptr == nullptr) {
+    return thresholdAllocAligned(ctx, new_nbytes, align);
+  }
+
+  bool from_large = self->isLarge(old_nbytes, align);
+  bool to_large   = self->isLarge(new_nbytes, align);
+  if (from_large && to_large) {
+    return self->pages.resizeAlignedRaw(ptr, old_nbytes, new_nbytes, align);
+  }
+  if (!from_large && !to_large) {
+    return self->parent->resizeAlignedRaw(ptr, old_nbytes, new_nbytes, align);
+  }
+
+  // Move the allocation to the other allocator
+  Allocator* from    = from_large ? static_cast<Allocator*>(&self->pages)
+                                  : self->parent;
+  Allocator* to      = to_large ? static_cast<Allocator*>(&self->pages)
+                                : self->parent;
+  void*      resized = to->allocAlignedRaw(new_nbytes, align);
+  if (resized == nullptr) {
+    return nullptr;
+  }
+  memcpy(resized, ptr, old_nbytes < new_nbytes ? old_nbytes : new_nbytes);
+  from->deallocSizedRaw(ptr, old_nbytes, align);
+
+  return resized;
+}
+
+void ThresholdAllocator::thresholdDeallocSized(void* ctx, void* ptr,
+                                               usize nbytes, usize align) {
+  ThresholdAllocator* self = static_cast<ThresholdAllocator*>(ctx);
+  if (self->isLarge(nbytes, align)) {
+    self->pages.deallocSizedRaw(ptr, nbytes, align);
+    return;
+  }
+  self->parent->deallocSizedRaw(ptr, nbytes, align);
+}
+
+bool ThresholdAllocator::thresholdExpand(void* ctx, void* ptr,
+                                         usize old_nbytes, usize new_nbytes) {
+  ThresholdAllocator* self = static_cast<ThresholdAllocator*>(ctx);
+  if (self->pages.owns(ptr)) {
+    return new_nbytes >= self->threshold &&
+           self->pages.tryExpandRaw(ptr, old_nbytes, new_nbytes);
+  }
+
+  // Allocations crossing the threshold have to move to the page allocator
+  if ((old_nbytes >= self->threshold) != (new_nbytes >= self->threshold)) {
+    return false;
+  }
+  return self->parent->tryExpandRaw(ptr, old_nbytes, new_nbytes);
+}
+
+} // namespace bl::mem
@@ -0,0 +1,276 @@
+#include "bl/mem/tracking_allocator.h"
+
+#include "bl/error.h"           // BL_THROW, resetError
+#include "bl/mem/allocator.h"   // Allocator
+#include "bl/mem/c_allocator.h" // CAllocator
+#include "bl/primitives.h"      // const_cstr, usize, u8
+
+#include <atomic> // atomic, memory_order_relaxed
+#include <cstdio> // FILE, fprintf
+
+namespace bl::mem {
+
+namespace {
+enum class TrackingError {
+  InvalidAllocator,
+};
+
+const_cstr errMsg(TrackingError err) {
+  switch (err) {
+  case TrackingError::InvalidAllocator:
+    return "TrackingError: Invalid Allocator (the parent allocator was null)";
+  }
+
+  return nullptr;
+}
+
+Allocator DEFAULT_C_ALLOCATOR = CAllocator();
+
+/// Returns the alignment the parent allocator is asked for (it has to be
+/// enough for the header too).
+usize     parentAlign(usize align) {
+  return align < Allocator::DEFAULT_ALIGNMENT ? Allocator::DEFAULT_ALIGNMENT
+                                                   : align;
+}
+
+/// Returns the histogram bucket for an allocation of `nbytes`.
+usize bucket(usize nbytes) {
+  if (nbytes <= 1) {
+    return 0;
+  }
+  usize idx = 64 - static_cast<usize>(__builtin_clzll(nbytes - 1));
+  return idx < TrackingAllocator::NUM_BUCKETS
+             ? idx
+             : TrackingAllocator::NUM_BUCKETS - 1;
+}
+} // namespace
+
+/// Header placed right before every allocation.
+struct TrackingAllocator::Header {
+  /// The distance from the start of the parent's allocation to the user's
+  /// pointer.
+  usize offset;
+
+  /// The size of the allocation (as requested by the user).
+  usize nbytes;
+
+  /// Returns the header size used for allocations aligned to `align` bytes.
+  static usize sizeFor(usize align) {
+    align = parentAlign(align);
+    return (sizeof(Header) + align - 1) & ~(align - 1);
+  }
+
+  /// Returns the header of the given allocation.
+  static Header* of(void* ptr) { return static_cast<Header*>(ptr) - 1; }
+
+  /// Writes a header in front of the user's part of `base` and returns the
+  /// user's pointer.
+  static void* init(void* base, usize offset, usize nbytes) {
+    u8*     ptr    = static_cast<u8*>(base) + offset;
+    Header* header = Header::of(ptr);
+    header->offset = offset;
+    header->nbytes = nbytes;
+    return ptr;
+  }
+
+  /// Returns the start of the parent's allocation.
+  u8* getBase(void) { return reinterpret_cast<u8*>(this + 1) - this->offset; }
+};
+
+TrackingAllocator::TrackingAllocator() : parent(&DEFAULT_C_ALLOCATOR) {
+  this->ctx            = this;
+  this->alloc          = TrackingAllocator::trackingAlloc;
+  this->dealloc        = TrackingAllocator::trackingDealloc;
+  this->resize         = TrackingAllocator::trackingResize;
+  this->allocAligned   = TrackingAllocator::trackingAllocAligned;
+  this->deallocAligned = TrackingAllocator::trackingDeallocAligned;
+  this->resizeAligned  = TrackingAllocator::trackingResizeAligned;
+  this->deallocSized   = TrackingAllocator::trackingDeallocSized;
+  this->expand         = TrackingAllocator::trackingExpand;
+}
+
+TrackingAllocator::TrackingAllocator(Allocator* parent) : TrackingAllocator() {
+  // Input validation
+  {
+    Error::resetError();
+
+    if (parent == nullptr) {
+      BL_THROW(errMsg(TrackingError::InvalidAllocator));
+      return;
+    }
+  }
+
+  this->parent = parent;
+}
+
+TrackingAllocator::Stats TrackingAllocator::getStats(void) const {
+  Stats stats;
+  stats.allocs      = this->allocs.load(std::memory_order_relaxed);
+  stats.frees       = this->frees.load(std::memory_order_relaxed);
+  stats.resizes     = this->resizes.load(std::memory_order_relaxed);
+  stats.expands     = this->expands.load(std::memory_order_relaxed);
+  stats.live_bytes  = this->live_bytes.load(std::memory_order_relaxed);
+  stats.peak_bytes  = this->peak_bytes.load(std::memory_order_relaxed);
+  stats.total_bytes = this->total_bytes.load(std::memory_order_relaxed);
+  for (usize i = 0; i < NUM_BUCKETS; i++) {
+    stats.histogram[i] = this->histogram[i].load(std::memory_order_relaxed);
+  }
+  return stats;
+}
+
+void TrackingAllocator::resetStats(void) {
+  this->allocs.store(0, std::memory_order_relaxed);
+  this->frees.store(0, std::memory_order_relaxed);
+  this->resizes.store(0, std::memory_order_relaxed);
+  this->expands.store(0, std::memory_order_relaxed);
+  this->total_bytes.store(0, std::memory_order_relaxed);
+  this->peak_bytes.store(this->live_bytes.load(std::memory_order_relaxed),
+                         std::memory_order_relaxed);
+  for (usize i = 0; i < NUM_BUCKETS; i++) {
+    this->histogram[i].store(0, std::memory_order_relaxed);
+  }
+}
+
+void TrackingAllocator::dump(FILE* file) const {
+  Stats stats = this->getStats();
+  fprintf(file, "TrackingAllocator:\n");
+  fprintf(file, "  allocs:      %zu\n", stats.allocs);
+  fprintf(file, "  frees:       %zu\n", stats.frees);
+  fprintf(file, "  resizes:     %zu (%zu in place)\n", stats.resizes,
+          stats.expands);
+  fprintf(file, "  live bytes:  %zu\n", stats.live_bytes);
+  fprintf(file, "  peak bytes:  %zu\n", stats.peak_bytes);
+  fprintf(file, "  total bytes: %zu\n", stats.total_bytes);
+  fprintf(file, "  sizes:\n");
+  for (usize i = 0; i < NUM_BUCKETS; i++) {
+    if (stats.histogram[i] != 0) {
+      fprintf(file, "    <= 2^%-2zu bytes: %zu\n", i, stats.histogram[i]);
+    }
+  }
+}
+
+void TrackingAllocator::recordAlloc(usize nbytes) {
+  usize live =
+      this->live_bytes.fetch_add(nbytes, std::memory_order_relaxed) + nbytes;
+  usize peak = this->peak_bytes.load(std::memory_order_relaxed);
+  while (live > peak && !this->peak_bytes.compare_exchange_weak(
+                            peak, live, std::memory_order_relaxed)) {
+  }
+
+  this->total_bytes.fetch_add(nbytes, std::memory_order_relaxed);
+  this->histogram[bucket(nbytes)].fetch_add(1, std::memory_order_relaxed);
+}
+
+void TrackingAllocator::recordFree(usize nbytes) {
+  this->live_bytes.fetch_sub(nbytes, std::memory_order_relaxed);
+}
+
+void* TrackingAllocator::trackingAlloc(void* ctx, usize nbytes) {
+  return trackingAllocAligned(ctx, nbytes, DEFAULT_ALIGNMENT);
+}
+
+void TrackingAllocator::trackingDealloc(void* ctx, void* ptr) {
+  trackingDeallocAligned(ctx, ptr, DEFAULT_ALIGNMENT);
+}
+
+void* TrackingAllocator::trackingResize(void* ctx, void* ptr, usize nbytes) {
+  TrackingAllocator* self = static_cast<TrackingAllocator*>(ctx);
+  if (ptr == nullptr) {
+    return trackingAlloc(ctx, nbytes);
+  }
+
+  Header* header     = Header::of(ptr);
+  usize   offset     = header->offset;
+  usize   old_nbytes = header->nbytes;
+  void*   base = self->parent->resizeRaw(header->getBase(), offset + nbytes);
+  if (base == nullptr) {
+    return nullptr;
+  }
+
+  self->resizes.fetch_add(1, std::memory_order_relaxed);
+  self->recordFree(old_nbytes);
+  self->recordAlloc(nbytes);
+  return Header::init(base, offset, nbytes);
+}
+
+void* TrackingAllocator::trackingAllocAligned(void* ctx, usize nbytes,
+                                              usize align) {
+  TrackingAllocator* self   = static_cast<TrackingAllocator*>(ctx);
+
+  usize              offset = Header::sizeFor(align);
+  void*              base   = self->parent->allocAlignedRaw(offset + nbytes,
+                                                            parentAlign(align));
+  if (base == nullptr) {
+    return nullptr;
+  }
+
+  self->allocs.fetch_add(1, std::memory_order_relaxed);
+  self->recordAlloc(nbytes);
+  return Header::init(base, offset, nbytes);
+}
+
+void TrackingAllocator::trackingDeallocAligned(void* ctx, void* ptr,
+                                               usize align) {
+  TrackingAllocator* self = static_cast<TrackingAllocator*>(ctx);
+  if (ptr == nullptr) {
+    return;
+  }
+
+  // The header knows the size, so the parent always gets a sized deallocation
+  Header* header = Header::of(ptr);
+  usize   nbytes = header->nbytes;
+  self->frees.fetch_add(1, std::memory_order_relaxed);
+  self->recordFree(nbytes);
+  self->parent->deallocSizedRaw(header->getBase(), header->offset + nbytes,
+                                parentAlign(align));
+}
+
+void* TrackingAllocator::trackingResizeAligned(void* ctx, void* ptr,
+                                               usize /*old_nbytes*/,
+                                               usize new_nbytes, usize align) {
+  TrackingAllocator* self = static_cast<TrackingAllocator*>(ctx);
+  if (ptr == nullptr) {
+    return trackingAllocAligned(ctx, new_nbytes, align);
+  }
+
+  Header* header     = Header::of(ptr);
+  usize   offset     = header->offset;
+  usize   old_nbytes = header->nbytes;
+  void*   base       = self->parent->resizeAlignedRaw(
+      header->getBase(), offset + old_nbytes, offset + new_nbytes,
+      parentAlign(align));
+  if (base == nullptr) {
+    return nullptr;
+  }
+
+  self->resizes.fetch_add(1, std::memory_order_relaxed);
+  self->recordFree(old_nbytes);
+  self->recordAlloc(new_nbytes);
+  return Header::init(base, offset, new_nbytes);
+}
+
+void TrackingAllocator::trackingDeallocSized(void* ctx, void* ptr,
+                                             usize /*nbytes*/, usize align) {
+  trackingDeallocAligned(ctx, ptr, align);
+}
+
+bool TrackingAllocator::trackingExpand(void* ctx, void* ptr,
+                                       usize /*old_nbytes*/, usize new_nbytes) {
+  TrackingAllocator* self       = static_cast<TrackingAllocator*>(ctx);
+
+  Header*            header     = Header::of(ptr);
+  usize              old_nbytes = header->nbytes;
+  if (!self->parent->tryExpandRaw(header->getBase(), header->offset + old_nbytes,
+                                  header->offset + new_nbytes)) {
+    return false;
+  }
+
+  header->nbytes = new_nbytes;
+  self->resizes.fetch_add(1, std::memory_order_relaxed);
+  self->expands.fetch_add(1, std::memory_order_relaxed);
+  self->recordFree(old_nbytes);
+  self->recordAlloc(new_nbytes);
+  return true;
+}
+
+} // namespace bl::mem
@@ -0,0 +1,20 @@
+#include "bl/par/algorithms.h"
+
+namespace bl::par {
+
+namespace par_internal {
+
+const_cstr errMsg(ParallelError err) {
+  switch (err) {
+  case ParallelError::LengthMismatch:
+    return "ParallelError: The source and destination ranges have different "
+           "lengths";
+  case ParallelError::BufferAllocationFailed:
+    return "ParallelError: Unable to allocate space for the temporary buffer";
+  }
+
+  return nullptr;
+}
+} // namespace par_internal
+
+} // namespace bl::par
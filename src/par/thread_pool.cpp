@@ -0,0 +1,176 @@
+#include "bl/par/thread_pool.h"
+
+#include "bl/error.h"      // BL_THROW, resetError
+#include "bl/primitives.h" // const_cstr, usize
+
+#include <atomic>             // atomic, memory_order_relaxed
+#include <condition_variable> // condition_variable
+#include <mutex>              // mutex, lock_guard, unique_lock
+#include <thread>             // thread, hardware_concurrency
+
+namespace bl::par {
+
+namespace {
+enum class ThreadPoolError {
+  InvalidThreadCount,
+};
+
+const_cstr errMsg(ThreadPoolError err) {
+  switch (err) {
+  case ThreadPoolError::InvalidThreadCount:
+    return "ThreadPoolError: Invalid thread count (must be at least 1)";
+  }
+
+  return nullptr;
+}
+
+/// The pool the current thread is a worker of (used to run nested batches
+/// serially).
+thread_local ThreadPool* current_pool = nullptr;
+} // namespace
+
+ThreadPool::ThreadPool() {
+  usize num_threads = std::thread::hardware_concurrency();
+  this->start(num_threads == 0 ? 0 : num_threads - 1);
+}
+
+ThreadPool::ThreadPool(usize num_threads) {
+  // Input validation
+  {
+    Error::resetError();
+
+    if (num_threads == 0) {
+      BL_THROW(errMsg(ThreadPoolError::InvalidThreadCount));
+      return;
+    }
+  }
+
+  this->start(num_threads - 1);
+}
+
+ThreadPool::~ThreadPool() {
+  {
+    std::lock_guard<std::mutex> guard(this->state_lock);
+    this->stopping = true;
+  }
+  this->wake.notify_all();
+
+  for (std::thread& worker : this->workers) {
+    worker.join();
+  }
+}
+
+ThreadPool* ThreadPool::getGlobal(void) {
+  static ThreadPool* global = new ThreadPool();
+  return global;
+}
+
+usize ThreadPool::getThreadCount(void) const {
+  return this->workers.getLen() + 1;
+}
+
+void ThreadPool::start(usize num_workers) {
+  this->workers.reserve(num_workers);
+  for (usize i = 0; i < num_workers; i++) {
+    this->workers.emplace([this] { this->workerLoop(); });
+  }
+}
+
+void ThreadPool::runRaw(usize num_tasks, TaskFn fn, void* ctx) {
+  if (num_tasks == 0) {
+    return;
+  }
+
+  // Run serially if there's nothing to share (or we're inside a task)
+  if (this->workers.isEmpty() || num_tasks == 1 || current_pool == this) {
+    for (usize task = 0; task < num_tasks; task++) {
+      fn(ctx, task);
+    }
+    return;
+  }
+
+  std::lock_guard<std::mutex> submit(this->submit_lock);
+
+  // Publish the batch
+  {
+    std::lock_guard<std::mutex> guard(this->state_lock);
+    this->task_fn   = fn;
+    this->task_ctx  = ctx;
+    this->num_tasks = num_tasks;
+    this->next_task.store(0, std::memory_order_relaxed);
+    this->finished    = 0;
+    this->generation += 1;
+  }
+  this->wake.notify_all();
+
+  // Help out (running nested batches serially), then wait for the workers to
+  // leave the batch
+  ThreadPool* prev_pool = current_pool;
+  current_pool          = this;
+  usize ran             = this->work(fn, ctx, num_tasks);
+  current_pool          = prev_pool;
+
+  std::unique_lock<std::mutex> guard(this->state_lock);
+  this->finished += ran;
+  this->done.wait(guard, [this] {
+    return this->finished == this->num_tasks && this->active == 0;
+  });
+}
+
+void ThreadPool::workerLoop(void) {
+  current_pool = this;
+
+  u64 seen     = 0;
+  while (true) {
+    TaskFn fn        = nullptr;
+    void*  ctx       = nullptr;
+    usize  num_tasks = 0;
+
+    // Wait for a new batch
+    {
+      std::unique_lock<std::mutex> guard(this->state_lock);
+      this->wake.wait(guard, [&] {
+        return this->stopping || this->generation != seen;
+      });
+      if (this->stopping) {
+        return;
+      }
+
+      // The batch may be over (and its submitter gone) by the time a slow
+      // worker wakes up; joining it would run its function on the next batch
+      seen = this->generation;
+      if (this->finished == this->num_tasks) {
+        continue;
+      }
+
+      fn           = this->task_fn;
+      ctx          = this->task_ctx;
+      num_tasks    = this->num_tasks;
+      this->active += 1;
+    }
+
+    usize ran = this->work(fn, ctx, num_tasks);
+
+    {
+      std::lock_guard<std::mutex> guard(this->state_lock);
+      this->finished += ran;
+      this->active   -= 1;
+    }
+    this->done.notify_all();
+  }
+}
+
+usize ThreadPool::work(TaskFn fn, void* ctx, usize num_tasks) {
+  usize ran = 0;
+  while (true) {
+    usize task = this->next_task.fetch_add(1, std::memory_order_relaxed);
+    if (task >= num_tasks) {
+      return ran;
+    }
+
+    fn(ctx, task);
+    ran++;
+  }
+}
+
+} // namespace bl::par
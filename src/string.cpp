@@ -3,10 +3,14 @@
 #include "bl/error.h"           // BL_THROW, resetError
 #include "bl/mem/allocator.h"   // Allocator
 #include "bl/mem/c_allocator.h" // CAllocator
+#if defined(BL_DEFAULT_THREAD_CACHE_ALLOCATOR)
+#include "bl/mem/thread_cache_allocator.h" // ThreadCacheAllocator
+#endif
 #include "bl/primitives.h"      // const_cstr, cstr, usize, u8
 
 #include <cstdlib> // abort
-#include <cstring> // strncpy, strlen, memmove
+#include <cstring> // memcpy, memmove, strlen, strncmp
+#include <utility> // move
 
 // TODO: Replace raw casts with static_casts
 
@@ -56,9 +60,18 @@ const_cstr errMsg(StringError err) {
 mem::Allocator DEFAULT_C_ALLOCATOR = mem::CAllocator();
 
 const u8       RESIZE_FACTOR       = 2;
+
+/// Returns the allocator used by strings that weren't given one.
+mem::Allocator* defaultAllocator(void) {
+#if defined(BL_DEFAULT_THREAD_CACHE_ALLOCATOR)
+  return mem::ThreadCacheAllocator::getGlobal();
+#else
+  return &DEFAULT_C_ALLOCATOR;
+#endif
+}
 } // namespace
 
-String::String() { this->allocator = &DEFAULT_C_ALLOCATOR; }
+String::String() { this->allocator = defaultAllocator(); }
 
 String::String(mem::Allocator* allocator) {
   // Input validation
@@ -73,27 +86,27 @@ String::String(mem::Allocator* allocator) {
   this->allocator = allocator;
 }
 
-String::String(mem::Allocator* allocator, usize capacity) : cap(capacity) {
+String::String(mem::Allocator* allocator, usize capacity) {
   // Input validation
   {
     Error::resetError();
     if (allocator == nullptr) {
       BL_THROW(errMsg(StringError::InvalidAllocator));
-      this->cap = 0;
       return;
     }
   }
 
   this->allocator = allocator;
 
-  if (capacity != 0) {
+  if (capacity > INLINE_CAP) {
     cstr data = (cstr)allocator->allocRaw(capacity + 1);
     if (data == nullptr) {
       BL_THROW(errMsg(StringError::BufferAllocationFailed));
       return;
     }
-    this->data           = data;
-    this->data[capacity] = '\0';
+    this->data     = data;
+    this->data[0]  = '\0';
+    this->heap_cap = capacity;
   }
 }
 
@@ -112,121 +125,100 @@ String::String(mem::Allocator* allocator, const_cstr str) {
     }
   }
 
-  // Create new string with `len` capacity
-  usize len       = strlen(str);
   this->allocator = allocator;
-  this->cap       = len;
-  this->len       = len;
-  cstr data       = (cstr)allocator->allocRaw(len + 1);
-  if (data == nullptr) {
-    BL_THROW(errMsg(StringError::BufferAllocationFailed));
-    this->cap = 0;
-    this->len = 0;
-    return;
-  }
-  this->data  = data;
-
-  // Copy `str` to string
-  cstr copied = strncpy(this->data, str, len);
-  if (copied == nullptr) {
-    BL_THROW(errMsg(StringError::StrncpyFailed));
-    this->allocator->deallocRaw(this->data);
-    this->data = nullptr;
-    this->len  = 0;
-    this->cap  = 0;
-    return;
-  }
-  copied[len] = '\0';
-  this->data  = copied;
+  this->assign(str, strlen(str));
 }
 
 String::String(const_cstr str) {
   Error::resetError();
+  this->allocator = defaultAllocator();
   if (str == nullptr) {
     BL_THROW(errMsg(StringError::InvalidCString));
     return;
   }
 
-  // Create new string with `len` capacity
-  usize len       = strlen(str);
-  this->allocator = &DEFAULT_C_ALLOCATOR;
-  this->cap       = len;
-  this->len       = len;
-  cstr data       = (cstr)allocator->allocRaw(len + 1);
-  if (data == nullptr) {
-    BL_THROW(errMsg(StringError::BufferAllocationFailed));
-    this->cap = 0;
-    this->len = 0;
-    return;
-  }
-  this->data  = data;
+  this->assign(str, strlen(str));
+}
 
-  // Copy `str` to string
-  cstr copied = strncpy(this->data, str, len);
-  if (copied == nullptr) {
-    BL_THROW(errMsg(StringError::StrncpyFailed));
-    this->allocator->deallocRaw(this->data);
-    this->data = nullptr;
-    this->len  = 0;
-    this->cap  = 0;
-    return;
+String::String(mem::Allocator* allocator, StringView view) {
+  // Input validation
+  {
+    Error::resetError();
+    if (allocator == nullptr) {
+      BL_THROW(errMsg(StringError::InvalidAllocator));
+      return;
+    }
   }
-  copied[len] = '\0';
-  this->data  = copied;
+
+  this->allocator = allocator;
+  this->assign(view.getRaw(), view.getLen());
 }
 
 String::String(const String& other) {
   Error::resetError();
 
   this->allocator = other.allocator;
-  this->len       = other.len;
-  this->cap       = other.len;
+  this->assign(other.data, other.len);
+}
 
-  cstr data       = (cstr)this->allocator->allocRaw(this->len + 1);
-  if (data == nullptr) {
-    BL_THROW(errMsg(StringError::BufferAllocationFailed));
-    return;
-  }
-  this->data  = data;
+String::String(String&& other) : allocator(other.allocator) {
+  this->take(other);
+}
 
-  cstr copied = strncpy(this->data, other.data, this->len);
-  if (copied == nullptr) {
-    BL_THROW(errMsg(StringError::StrncpyFailed));
-    return;
+String::~String() { this->release(); }
+
+String& String::operator=(const String& other) {
+  if (this != &other) {
+    String copy = String(other);
+    *this       = std::move(copy);
   }
-  copied[this->len] = '\0';
-  this->data        = copied;
+  return *this;
 }
 
-String::~String() {
-  if (this->cap != 0) {
-    this->allocator->deallocRaw(this->data);
+String& String::operator=(String&& other) {
+  if (this != &other) {
+    this->release();
+    this->allocator = other.allocator;
+    this->take(other);
   }
+  return *this;
 }
 
 const_cstr String::getRaw(void) const { return this->data; }
 
+StringView String::slice(usize start, usize end) const {
+  // Input validation
+  {
+    Error::resetError();
+    if (start > end || end > this->len) {
+      BL_THROW(errMsg(StringError::IndexOutOfBounds));
+      return StringView();
+    }
+  }
+
+  return StringView(this->data + start, end - start);
+}
+
 usize      String::getLen(void) const { return this->len; }
 
-usize      String::getCap(void) const { return this->cap; }
+usize      String::getCap(void) const {
+  return this->isInline() ? INLINE_CAP : this->heap_cap;
+}
 
-bool       String::isEmpty(void) const { return this->len == 0; }
+bool String::isEmpty(void) const { return this->len == 0; }
 
-void       String::clear(void) {
-  if (this->len != 0) {
-    this->data[0] = '\0';
-    this->len     = 0;
-  }
+void String::clear(void) {
+  this->data[0] = '\0';
+  this->len     = 0;
 }
 
-// FIXME: Allocate on first push!
 void String::push(char chr) {
   Error::resetError();
 
   // Resize if necessary
   usize new_len = this->len + 1;
-  if (new_len > this->cap) {
-    this->resize();
+  if (new_len > this->getCap()) {
+    this->resize(new_len);
     if (Error::isError()) {
       BL_THROW(errMsg(StringError::ResizeFailed));
       return;
@@ -238,7 +230,6 @@ void String::push(char chr) {
   this->len             += 1;
 }
 
-// FIXME: Allocate on first push!
 void String::push(const_cstr str) {
   // Input validation
   {
@@ -250,12 +241,55 @@ void String::push(const_cstr str) {
     }
   }
 
-  usize len = strlen(str);
-  for (usize i = 0; i < len; i++) {
-    this->push(str[i]);
+  this->append(str, strlen(str));
+}
+
+void String::append(const char* src, usize len) {
+  // Input validation
+  {
+    Error::resetError();
+
+    if (src == nullptr && len != 0) {
+      BL_THROW(errMsg(StringError::InvalidCString));
+      return;
+    }
+  }
+
+  // Resize (at most) once, keeping track of `src` if it's in the buffer
+  usize new_len = this->len + len;
+  if (new_len > this->getCap()) {
+    bool  aliased = src >= this->data && src < this->data + this->len;
+    usize offset  = aliased ? static_cast<usize>(src - this->data) : 0;
+    this->resize(new_len);
     if (Error::isError()) {
+      BL_THROW(errMsg(StringError::ResizeFailed));
       return;
     }
+    if (aliased) {
+      src = this->data + offset;
+    }
+  }
+
+  if (len != 0) {
+    memmove(this->data + this->len, src, len);
+  }
+  this->data[new_len] = '\0';
+  this->len           = new_len;
+}
+
+void String::append(StringView view) {
+  this->append(view.getRaw(), view.getLen());
+}
+
+void String::reserve(usize capacity) {
+  Error::resetError();
+  if (capacity <= this->getCap()) {
+    return;
+  }
+
+  this->reallocate(capacity);
+  if (Error::isError()) {
+    BL_THROW(errMsg(StringError::ResizeFailed));
   }
 }
 
@@ -277,48 +311,13 @@ void String::insert(usize idx, char chr) {
   {
     Error::resetError();
 
-    if (idx > this->len - 1) {
+    if (idx > this->len) {
       BL_THROW(errMsg(StringError::IndexOutOfBounds));
       return;
     }
   }
 
-  if (idx == this->len - 1) {
-    this->push(chr);
-    return;
-  }
-
-  // Copy second half of the string
-  const usize split_size = this->len - idx;
-  cstr        split      = (cstr)this->allocator->allocRaw(split_size + 1);
-  cstr        copied     = strncpy(split, this->data + idx, split_size);
-  if (copied == nullptr) {
-    BL_THROW(errMsg(StringError::StrncpyFailed));
-    return;
-  }
-  copied[split_size] = '\0';
-  split              = copied;
-
-  // Resize if necessary
-  usize new_len      = this->len + 1;
-  if (new_len > this->cap) {
-    this->resize();
-    if (Error::isError()) {
-      BL_THROW(errMsg(StringError::ResizeFailed));
-      return;
-    }
-  }
-
-  // Append `chr` then append the rest of the string
-  this->data[idx]   = chr;
-  cstr copied_split = strncpy(this->data + idx + 1, split, split_size);
-  if (copied_split == nullptr) {
-    BL_THROW(errMsg(StringError::StrncpyFailed));
-    return;
-  }
-  this->allocator->deallocRaw(split);
-  this->len             += 1;
-  this->data[this->len]  = '\0';
+  this->replaceChars(idx, idx, &chr, 1);
 }
 
 void String::insert(usize idx, const_cstr str) {
@@ -331,62 +330,20 @@ void String::insert(usize idx, const_cstr str) {
       return;
     }
 
-    if (idx > this->len - 1) {
+    if (idx > this->len) {
       BL_THROW(errMsg(StringError::IndexOutOfBounds));
       return;
     }
   }
 
-  if (idx == this->len - 1) {
-    this->push(str);
-    return;
-  }
-
-  // Copy second half of the string
-  const usize split_size = this->len - idx;
-  cstr        split      = (cstr)this->allocator->allocRaw(split_size + 1);
-  cstr        copied     = strncpy(split, this->data + idx, split_size);
-  if (copied == nullptr) {
-    BL_THROW(errMsg(StringError::StrncpyFailed));
-    return;
-  }
-  copied[split_size] = '\0';
-  split              = copied;
-
-  // FIXME: The resize might not be enough (resize in a while loop)
-  //
-  // Resize if necessary
-  usize len          = strlen(str);
-  usize new_len      = this->len + len;
-  if (new_len > this->cap) {
-    this->resize();
-    if (Error::isError()) {
-      BL_THROW(errMsg(StringError::ResizeFailed));
-      return;
-    }
-  }
-
-  // Append `str` then append the rest of the string
-  cstr copied_str = strncpy(this->data + idx, str, len);
-  if (copied_str == nullptr) {
-    BL_THROW(errMsg(StringError::StrncpyFailed));
-    return;
-  }
-  cstr copied_split = strncpy(this->data + idx + len, split, split_size);
-  if (copied_split == nullptr) {
-    BL_THROW(errMsg(StringError::StrncpyFailed));
-    return;
-  }
-  this->allocator->deallocRaw(split);
-  this->len             += len;
-  this->data[this->len]  = '\0';
+  this->replaceChars(idx, idx, str, strlen(str));
 }
 
 char String::remove(usize idx) {
   // Input validation
   {
     Error::resetError();
-    if (idx > this->len - 1) {
+    if (idx >= this->len) {
       BL_THROW(errMsg(StringError::IndexOutOfBounds));
       return '\0';
     }
@@ -396,89 +353,159 @@ char String::remove(usize idx) {
     return this->pop();
   }
 
-  char  removed   = this->data[idx];
-
-  usize move_size = this->len - idx;
-  cstr moved = (cstr)memmove(this->data + idx, this->data + idx + 1, move_size);
-  if (moved == nullptr) {
-    BL_THROW(errMsg(StringError::StrncpyFailed));
-    return '\0';
-  }
+  // Shift the rest of the string (and the null-terminator) to the left
+  char removed = this->data[idx];
+  memmove(this->data + idx, this->data + idx + 1, this->len - idx);
   this->len -= 1;
 
   return removed;
 }
 
-i32 String::find(const_cstr substr) const {
+void String::replaceRange(usize first, usize last, StringView str) {
   // Input validation
   {
     Error::resetError();
+    if (first > last || last > this->len) {
+      BL_THROW(errMsg(StringError::IndexOutOfBounds));
+      return;
+    }
+  }
 
-    if (substr == nullptr) {
-      BL_THROW(errMsg(StringError::InvalidCString));
-      return -1;
+  this->replaceChars(first, last, str.getRaw(), str.getLen());
+}
+
+void String::eraseRange(usize first, usize last) {
+  // Input validation
+  {
+    Error::resetError();
+    if (first > last || last > this->len) {
+      BL_THROW(errMsg(StringError::IndexOutOfBounds));
+      return;
     }
   }
 
-  cstr found = strstr(this->data, substr);
-  if (found == NULL) {
-    return -1;
+  // Shift the rest of the string (and the null-terminator) to the left
+  memmove(this->data + first, this->data + last, this->len - last + 1);
+  this->len -= last - first;
+}
+
+usize String::replaceAll(StringView needle, StringView replacement) {
+  Error::resetError();
+  if (needle.isEmpty()) {
+    return 0;
   }
 
-  return (i32)(found - this->data);
+  // Count the occurrences so the new length is known up front
+  usize matches = this->count(needle);
+  if (matches == 0) {
+    return 0;
+  }
+
+  usize new_len = this->len - matches * needle.getLen() +
+                  matches * replacement.getLen();
+  bool  aliased = this->overlaps(needle.getRaw(), needle.getLen()) ||
+                 this->overlaps(replacement.getRaw(), replacement.getLen());
+
+  // Edits that fit are done in place, front to back. Growing edits first move
+  // the contents to the end of the buffer, so the write position still never
+  // passes the read position.
+  if (new_len <= this->getCap() && !aliased) {
+    usize shift = new_len > this->len ? new_len - this->len : 0;
+    if (shift != 0) {
+      memmove(this->data + shift, this->data, this->len + 1);
+    }
+    this->writeReplaced(this->data, StringView(this->data + shift, this->len),
+                        needle, replacement);
+    this->len = new_len;
+    return matches;
+  }
+
+  // That would overwrite an aliased needle or replacement, so the result is
+  // assembled in a scratch buffer (or a temporary one) and copied back
+  if (new_len <= this->getCap()) {
+    char scratch[INLINE_CAP + 1];
+    cstr tmp = scratch;
+    if (new_len > INLINE_CAP) {
+      tmp = (cstr)this->allocator->allocRaw(new_len + 1);
+      if (tmp == nullptr) {
+        BL_THROW(errMsg(StringError::ResizeFailed));
+        return 0;
+      }
+    }
+
+    this->writeReplaced(tmp, this->getView(), needle, replacement);
+    memcpy(this->data, tmp, new_len + 1);
+    if (tmp != scratch) {
+      this->allocator->deallocSizedRaw(tmp, new_len + 1);
+    }
+    this->len = new_len;
+    return matches;
+  }
+
+  // Otherwise write into a new buffer
+  usize new_cap = this->grownCap(new_len);
+  cstr  new_buf = (cstr)this->allocator->allocRaw(new_cap + 1);
+  if (new_buf == nullptr) {
+    BL_THROW(errMsg(StringError::ResizeFailed));
+    return 0;
+  }
+
+  this->writeReplaced(new_buf, this->getView(), needle, replacement);
+  if (!this->isInline()) {
+    this->allocator->deallocSizedRaw(this->data, this->heap_cap + 1);
+  }
+  this->data     = new_buf;
+  this->heap_cap = new_cap;
+  this->len      = new_len;
+  return matches;
 }
 
 void String::shrinkToFit(void) {
   Error::resetError();
-  if (this->cap > this->len) {
-    cstr resized = (cstr)this->allocator->resizeRaw(this->data, this->len + 1);
-    if (resized == nullptr) {
-      BL_THROW(errMsg(StringError::InvalidCString));
-      return;
-    }
+  if (this->isInline() || this->heap_cap == this->len) {
+    return;
+  }
 
-    this->data = resized;
-    this->cap  = this->len;
+  // Move short contents back into the inline buffer
+  if (this->len <= INLINE_CAP) {
+    cstr  heap     = this->data;
+    usize heap_cap = this->heap_cap;
+    memcpy(this->small, heap, this->len + 1);
+    this->data = this->small;
+    this->allocator->deallocSizedRaw(heap, heap_cap + 1);
+    return;
+  }
+
+  cstr resized = (cstr)this->allocator->resizeRaw(this->data, this->len + 1);
+  if (resized == nullptr) {
+    BL_THROW(errMsg(StringError::BufferResizeFailed));
+    return;
   }
+
+  this->data     = resized;
+  this->heap_cap = this->len;
 }
 
 String String::split(usize idx) {
   // Input validation
   {
     Error::resetError();
-    if (idx > this->len - 1) {
+    if (idx >= this->len) {
       BL_THROW(errMsg(StringError::IndexOutOfBounds));
       return String();
     }
   }
 
-  if (idx == 0) {
-    String* split = this;
-    this->clear();
-    return *split;
-  }
-
-  if (idx == this->len - 1) {
-    return String(this->allocator);
-  }
-
-  // Create new string with enough capacity to hold the split
-  usize  split_size = this->len - idx;
-  String split      = String(this->allocator, split_size);
-
-  // Copy from original into split
-  cstr   copied     = strncpy(split.data, this->data + idx, split_size);
-  if (copied == nullptr) {
-    BL_THROW(errMsg(StringError::StrncpyFailed));
-    return String();
+  // Copy `[idx, len)` into the new string (inline if it fits)
+  String split = String(this->allocator);
+  split.assign(this->data + idx, this->len - idx);
+  if (Error::isError()) {
+    return split;
   }
-  copied[split_size] = '\0';
-  split.data         = copied;
-  split.len          = split_size;
 
   // Remove split contents from original string
-  this->data[idx]    = '\0';
-  this->len          = idx;
+  this->data[idx] = '\0';
+  this->len       = idx;
 
   return split;
 }
@@ -511,47 +538,180 @@ bool String::isSame(const_cstr other) const {
   return strncmp(this->data, other, this->len) == 0;
 }
 
-char& String::operator[](usize idx) {
-  // Input validation
-  {
+char& String::at(usize idx) {
+  if (idx >= this->len) {
     Error::resetError();
-    if (idx > this->len - 1) {
-      BL_THROW(errMsg(StringError::IndexOutOfBounds));
-      Error::printErrorTrace();
-      abort();
-    }
+    BL_THROW(errMsg(StringError::IndexOutOfBounds));
+    Error::printErrorTrace();
+    abort();
   }
 
   return this->data[idx];
 }
 
-void String::resize(void) {
-  // Create new buffer with increased capacity
-  usize new_cap = this->cap * RESIZE_FACTOR;
-  cstr  new_buf = (cstr)this->allocator->allocRaw(new_cap + 1);
+void String::resize(usize required) {
+  this->reallocate(this->grownCap(required));
+}
+
+usize String::grownCap(usize required) const {
+  usize new_cap = this->getCap() * RESIZE_FACTOR;
+  if (new_cap < required) {
+    new_cap = required;
+  }
+  return new_cap;
+}
+
+void String::reallocate(usize capacity) {
+  // Try to grow the heap buffer in place first, then let the allocator resize
+  // it (`realloc` can often extend the block without copying)
+  if (!this->isInline()) {
+    if (this->allocator->tryExpandRaw(this->data, this->heap_cap + 1,
+                                      capacity + 1)) {
+      this->heap_cap = capacity;
+      return;
+    }
+
+    cstr resized = (cstr)this->allocator->resizeRaw(this->data, capacity + 1);
+    if (resized == nullptr) {
+      BL_THROW(errMsg(StringError::BufferResizeFailed));
+      return;
+    }
+    this->data     = resized;
+    this->heap_cap = capacity;
+    return;
+  }
+
+  // Otherwise move the inline contents to a new buffer
+  cstr new_buf = (cstr)this->allocator->allocRaw(capacity + 1);
   if (new_buf == nullptr) {
     BL_THROW(errMsg(StringError::BufferAllocationFailed));
     return;
   }
 
-  // Copy original data to new buffer
-  cstr copied = strncpy(new_buf, this->data, this->len);
-  if (copied == nullptr) {
-    BL_THROW(errMsg(StringError::StrncpyFailed));
-    this->allocator->deallocRaw(new_buf);
+  // Copy original data (and the null-terminator) to new buffer
+  memcpy(new_buf, this->data, this->len + 1);
+
+  this->data     = new_buf;
+  this->heap_cap = capacity;
+}
+
+bool String::overlaps(const char* src, usize len) const {
+  return len != 0 && src < this->data + this->len && src + len > this->data;
+}
+
+void String::replaceChars(usize first, usize last, const char* src,
+                          usize len) {
+  usize new_len = this->len - (last - first) + len;
+  bool  aliased = this->overlaps(src, len);
+
+  // Shift the rest of the string (and the null-terminator) in place, then
+  // copy the characters into the gap
+  if (new_len <= this->getCap() && !aliased) {
+    memmove(this->data + first + len, this->data + last, this->len - last + 1);
+    if (len != 0) {
+      memcpy(this->data + first, src, len);
+    }
+    this->len = new_len;
     return;
   }
-  copied[this->len] = '\0';
 
-  // Free old buffer
-  this->allocator->deallocRaw(this->data);
-  if (Error::isError()) {
-    BL_THROW(errMsg(StringError::BufferDeallocationFailed));
+  // An aliased source is copied out (to a scratch buffer or a temporary one)
+  // before the string is shifted under it
+  if (new_len <= this->getCap()) {
+    char scratch[INLINE_CAP];
+    cstr tmp = scratch;
+    if (len > INLINE_CAP) {
+      tmp = (cstr)this->allocator->allocRaw(len);
+      if (tmp == nullptr) {
+        BL_THROW(errMsg(StringError::ResizeFailed));
+        return;
+      }
+    }
+
+    memcpy(tmp, src, len);
+    this->replaceChars(first, last, tmp, len);
+    if (tmp != scratch) {
+      this->allocator->deallocSizedRaw(tmp, len);
+    }
     return;
   }
 
-  this->data = copied;
-  this->cap  = new_cap;
+  // Otherwise assemble the result in a new buffer, while the source is still
+  // valid
+  usize new_cap = this->grownCap(new_len);
+  cstr  new_buf = (cstr)this->allocator->allocRaw(new_cap + 1);
+  if (new_buf == nullptr) {
+    BL_THROW(errMsg(StringError::ResizeFailed));
+    return;
+  }
+
+  memcpy(new_buf, this->data, first);
+  memcpy(new_buf + first, src, len);
+  memcpy(new_buf + first + len, this->data + last, this->len - last + 1);
+  this->len = new_len;
+  if (!this->isInline()) {
+    this->allocator->deallocSizedRaw(this->data, this->heap_cap + 1);
+  }
+  this->data     = new_buf;
+  this->heap_cap = new_cap;
+}
+
+void String::writeReplaced(char* dst, StringView src, StringView needle,
+                           StringView replacement) {
+  const char* read  = src.getRaw();
+  const char* end   = src.end();
+  char*       write = dst;
+  for (usize idx : src.findAll(needle)) {
+    // `dst` may trail the matched position, so the gap is moved (not copied)
+    usize gap = static_cast<usize>(src.getRaw() + idx - read);
+    memmove(write, read, gap);
+    write += gap;
+    memcpy(write, replacement.getRaw(), replacement.getLen());
+    write += replacement.getLen();
+    read  = src.getRaw() + idx + needle.getLen();
+  }
+
+  // Copy the rest (and the null-terminator)
+  memmove(write, read, static_cast<usize>(end - read) + 1);
+}
+
+void String::assign(const char* src, usize len) {
+  if (len > INLINE_CAP) {
+    cstr data = (cstr)this->allocator->allocRaw(len + 1);
+    if (data == nullptr) {
+      BL_THROW(errMsg(StringError::BufferAllocationFailed));
+      return;
+    }
+    this->data     = data;
+    this->heap_cap = len;
+  }
+
+  memcpy(this->data, src, len);
+  this->data[len] = '\0';
+  this->len       = len;
+}
+
+void String::release(void) {
+  if (!this->isInline()) {
+    this->allocator->deallocSizedRaw(this->data, this->heap_cap + 1);
+  }
+  this->data     = this->small;
+  this->data[0]  = '\0';
+  this->len      = 0;
+}
+
+void String::take(String& other) {
+  if (other.isInline()) {
+    memcpy(this->small, other.small, other.len + 1);
+    this->data = this->small;
+  } else {
+    this->data     = other.data;
+    this->heap_cap = other.heap_cap;
+    other.data     = other.small;
+  }
+  this->len     = other.len;
+  other.data[0] = '\0';
+  other.len     = 0;
 }
 
 } // namespace bl
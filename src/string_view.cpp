@@ -0,0 +1,189 @@
+#include "bl/string_view.h"
+
+#include "bl/ds/search.h"  // findBytes, rfindBytes, countBytes
+#include "bl/error.h"      // BL_THROW, resetError
+#include "bl/primitives.h" // const_cstr, usize, u8, i32, u64
+
+#include <cstring> // memchr, memcmp, strlen
+
+namespace bl {
+
+namespace string_view_internal {
+
+const_cstr errMsg(StringViewError err) {
+  switch (err) {
+  case StringViewError::InvalidCString:
+    return "StringViewError: Invalid C-string (the provided C-string was null)";
+  case StringViewError::IndexOutOfBounds:
+    return "StringViewError: The specified index was out of the view's bounds";
+  case StringViewError::InvalidRange:
+    return "StringViewError: The specified range was out of the view's bounds";
+  }
+
+  return nullptr;
+}
+} // namespace string_view_internal
+
+namespace {
+using string_view_internal::errMsg;
+using string_view_internal::StringViewError;
+
+const u64 FNV_OFFSET_BASIS = 0xcbf29ce484222325ull;
+const u64 FNV_PRIME        = 0x100000001b3ull;
+
+/// Checks if the character is ASCII whitespace.
+bool      isSpace(char chr) {
+  return chr == ' ' || (chr >= '\t' && chr <= '\r');
+}
+} // namespace
+
+StringView::StringView(const_cstr str) {
+  // Input validation
+  {
+    Error::resetError();
+    if (str == nullptr) {
+      BL_THROW(errMsg(StringViewError::InvalidCString));
+      return;
+    }
+  }
+
+  this->data = str;
+  this->len  = strlen(str);
+}
+
+StringView StringView::slice(usize start, usize end) const {
+  // Input validation
+  {
+    Error::resetError();
+    if (start > end || end > this->len) {
+      BL_THROW(errMsg(StringViewError::InvalidRange));
+      return StringView();
+    }
+  }
+
+  return StringView(this->data + start, end - start);
+}
+
+usize StringView::find(StringView needle) const {
+  return ds::search_internal::findBytes(
+      reinterpret_cast<const u8*>(this->data), this->len,
+      reinterpret_cast<const u8*>(needle.data), needle.len);
+}
+
+usize StringView::find(char chr) const {
+  if (this->len == 0) {
+    return NOT_FOUND;
+  }
+
+  const void* pos = memchr(this->data, chr, this->len);
+  if (pos == nullptr) {
+    return NOT_FOUND;
+  }
+  return static_cast<usize>(static_cast<const char*>(pos) - this->data);
+}
+
+usize StringView::findFrom(StringView needle, usize pos) const {
+  if (pos > this->len) {
+    return NOT_FOUND;
+  }
+
+  usize idx = StringView(this->data + pos, this->len - pos).find(needle);
+  return idx == NOT_FOUND ? NOT_FOUND : pos + idx;
+}
+
+usize StringView::rfind(StringView needle) const {
+  return ds::search_internal::rfindBytes(
+      reinterpret_cast<const u8*>(this->data), this->len,
+      reinterpret_cast<const u8*>(needle.data), needle.len);
+}
+
+usize StringView::count(StringView needle) const {
+  return ds::search_internal::countBytes(
+      reinterpret_cast<const u8*>(this->data), this->len,
+      reinterpret_cast<const u8*>(needle.data), needle.len);
+}
+
+bool StringView::startsWith(StringView prefix) const {
+  return prefix.len <= this->len &&
+         (prefix.len == 0 || memcmp(this->data, prefix.data, prefix.len) == 0);
+}
+
+bool StringView::endsWith(StringView suffix) const {
+  return suffix.len <= this->len &&
+         (suffix.len == 0 || memcmp(this->data + (this->len - suffix.len),
+                                    suffix.data, suffix.len) == 0);
+}
+
+StringView StringView::trim(void) const { return this->trimStart().trimEnd(); }
+
+StringView StringView::trimStart(void) const {
+  usize start = 0;
+  while (start < this->len && isSpace(this->data[start])) {
+    start++;
+  }
+  return StringView(this->data + start, this->len - start);
+}
+
+StringView StringView::trimEnd(void) const {
+  usize end = this->len;
+  while (end > 0 && isSpace(this->data[end - 1])) {
+    end--;
+  }
+  return StringView(this->data, end);
+}
+
+StringView StringView::split(usize idx) {
+  // Input validation
+  {
+    Error::resetError();
+    if (idx > this->len) {
+      BL_THROW(errMsg(StringViewError::IndexOutOfBounds));
+      return StringView();
+    }
+  }
+
+  StringView tail = StringView(this->data + idx, this->len - idx);
+  this->len       = idx;
+  return tail;
+}
+
+StringView StringView::splitOn(char delim) {
+  usize idx = this->find(delim);
+  if (idx == NOT_FOUND) {
+    StringView token = *this;
+    this->data += this->len;
+    this->len = 0;
+    return token;
+  }
+
+  StringView token = StringView(this->data, idx);
+  this->data += idx + 1;
+  this->len -= idx + 1;
+  return token;
+}
+
+i32 StringView::compare(StringView other) const {
+  usize min_len = this->len < other.len ? this->len : other.len;
+  if (min_len != 0) {
+    int cmp = memcmp(this->data, other.data, min_len);
+    if (cmp != 0) {
+      return cmp < 0 ? -1 : 1;
+    }
+  }
+
+  if (this->len == other.len) {
+    return 0;
+  }
+  return this->len < other.len ? -1 : 1;
+}
+
+u64 StringView::getHash(void) const {
+  u64 hash = FNV_OFFSET_BASIS;
+  for (usize i = 0; i < this->len; i++) {
+    hash ^= static_cast<unsigned char>(this->data[i]);
+    hash *= FNV_PRIME;
+  }
+  return hash;
+}
+
+} // namespace bl
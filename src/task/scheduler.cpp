@@ -0,0 +1,469 @@
+#include "bl/task/scheduler.h"
+
+#include "bl/ds/dynamic_array.h"    // DynamicArray, getDefaultAllocator
+#include "bl/error.h"               // BL_THROW, resetError
+#include "bl/mem/allocator.h"       // Allocator
+#include "bl/mem/arena_allocator.h" // ArenaAllocator
+#include "bl/primitives.h"          // const_cstr, usize, u64
+#include "bl/task/work_deque.h"     // WorkDeque
+
+#include <atomic>             // atomic, atomic_thread_fence, memory_order_*
+#include <chrono>             // steady_clock
+#include <condition_variable> // condition_variable
+#include <cstddef>            // max_align_t
+#include <cstdint>            // uintptr_t
+#include <mutex>              // mutex, lock_guard, unique_lock
+#include <new>                // placement new
+#include <thread>             // thread, hardware_concurrency, yield
+
+namespace bl::task {
+
+namespace {
+enum class SchedulerError {
+  InvalidWorkerCount,
+  InvalidAllocator,
+  WorkerAllocationFailed,
+};
+
+const_cstr errMsg(SchedulerError err) {
+  switch (err) {
+  case SchedulerError::InvalidWorkerCount:
+    return "SchedulerError: Invalid worker count (must be at least 1)";
+  case SchedulerError::InvalidAllocator:
+    return "SchedulerError: Invalid Allocator (the allocator was null)";
+  case SchedulerError::WorkerAllocationFailed:
+    return "SchedulerError: Unable to allocate the workers";
+  }
+
+  return nullptr;
+}
+
+/// The number of times an idle worker looks for tasks before going to sleep.
+const usize SPIN_ROUNDS = 64;
+
+/// The worker the current thread runs (of whichever scheduler).
+thread_local void* current_worker = nullptr;
+
+/// State of the xorshift generator used to pick victims on threads that
+/// aren't workers.
+thread_local u64 external_rng = 0;
+
+u64              nextRandom(u64& state) {
+  if (state == 0) {
+    state = static_cast<u64>(reinterpret_cast<uintptr_t>(&state)) | 1;
+  }
+  state ^= state << 13;
+  state ^= state >> 7;
+  state ^= state << 17;
+  return state;
+}
+
+/// Increments a counter only written by its owning thread.
+void bump(std::atomic<u64>& counter, u64 amount = 1) {
+  counter.store(counter.load(std::memory_order_relaxed) + amount,
+                std::memory_order_relaxed);
+}
+
+u64 nanosSince(std::chrono::steady_clock::time_point start) {
+  return static_cast<u64>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                              std::chrono::steady_clock::now() - start)
+                              .count());
+}
+} // namespace
+
+struct Scheduler::Worker {
+  Worker(Scheduler* scheduler, mem::Allocator* allocator)
+      : scheduler(scheduler), deque(allocator), arena(allocator) {}
+
+  /// The scheduler the worker belongs to.
+  Scheduler*          scheduler;
+
+  /// Tasks spawned on the worker.
+  WorkDeque<Task*>    deque;
+
+  /// Arena the worker's task frames are carved out of.
+  mem::ArenaAllocator arena;
+
+  /// Frames that are free to reuse (only touched by the worker).
+  Task*               free_tasks   = nullptr;
+
+  /// Frames freed by other workers.
+  std::atomic<Task*>  remote_tasks = nullptr;
+
+  /// State of the xorshift generator used to pick victims.
+  u64                 rng          = 0;
+
+  /// Counters (only written by the worker).
+  std::atomic<u64>    tasks_run     = 0;
+  std::atomic<u64>    steals        = 0;
+  std::atomic<u64>    failed_steals = 0;
+  std::atomic<u64>    sleeps        = 0;
+  std::atomic<u64>    idle_ns       = 0;
+
+  std::thread         thread;
+};
+
+bool TaskGroup::isDone(void) const {
+  return this->pending.load(std::memory_order_acquire) == 0;
+}
+
+Scheduler::Scheduler()
+    : allocator(ds::dynamic_array_internal::getDefaultAllocator()) {
+  usize num_workers = std::thread::hardware_concurrency();
+  this->start(num_workers == 0 ? 1 : num_workers);
+}
+
+Scheduler::Scheduler(usize num_workers)
+    : Scheduler(num_workers,
+                ds::dynamic_array_internal::getDefaultAllocator()) {}
+
+Scheduler::Scheduler(usize num_workers, mem::Allocator* allocator)
+    : allocator(allocator) {
+  // Input validation
+  {
+    Error::resetError();
+
+    if (num_workers == 0) {
+      BL_THROW(errMsg(SchedulerError::InvalidWorkerCount));
+      return;
+    }
+
+    if (allocator == nullptr) {
+      BL_THROW(errMsg(SchedulerError::InvalidAllocator));
+      return;
+    }
+  }
+
+  this->start(num_workers);
+}
+
+Scheduler::~Scheduler() {
+  {
+    std::lock_guard<std::mutex> guard(this->sleep_lock);
+    this->stopping.store(true, std::memory_order_relaxed);
+  }
+  this->wake.notify_all();
+
+  for (Worker* worker : this->workers) {
+    worker->thread.join();
+  }
+  for (Worker* worker : this->workers) {
+    worker->~Worker();
+    this->allocator->deallocSizedRaw(worker, sizeof(Worker), alignof(Worker));
+  }
+}
+
+Scheduler* Scheduler::getGlobal(void) {
+  static Scheduler* global = new Scheduler();
+  return global;
+}
+
+usize Scheduler::getWorkerCount(void) const { return this->workers.getLen(); }
+
+Scheduler::Stats Scheduler::getStats(void) const {
+  Stats stats         = Stats();
+  stats.tasks_run     = this->external_tasks_run.load(std::memory_order_relaxed);
+  stats.steals        = this->external_steals.load(std::memory_order_relaxed);
+  stats.failed_steals =
+      this->external_failed_steals.load(std::memory_order_relaxed);
+
+  for (Worker* worker : this->workers) {
+    stats.tasks_run     += worker->tasks_run.load(std::memory_order_relaxed);
+    stats.steals        += worker->steals.load(std::memory_order_relaxed);
+    stats.failed_steals +=
+        worker->failed_steals.load(std::memory_order_relaxed);
+    stats.sleeps  += worker->sleeps.load(std::memory_order_relaxed);
+    stats.idle_ns += worker->idle_ns.load(std::memory_order_relaxed);
+  }
+  return stats;
+}
+
+void Scheduler::resetStats(void) {
+  this->external_tasks_run.store(0, std::memory_order_relaxed);
+  this->external_steals.store(0, std::memory_order_relaxed);
+  this->external_failed_steals.store(0, std::memory_order_relaxed);
+
+  for (Worker* worker : this->workers) {
+    worker->tasks_run.store(0, std::memory_order_relaxed);
+    worker->steals.store(0, std::memory_order_relaxed);
+    worker->failed_steals.store(0, std::memory_order_relaxed);
+    worker->sleeps.store(0, std::memory_order_relaxed);
+    worker->idle_ns.store(0, std::memory_order_relaxed);
+  }
+}
+
+void Scheduler::start(usize num_workers) {
+  this->workers.reserve(num_workers);
+  for (usize i = 0; i < num_workers; i++) {
+    Worker* worker = (Worker*)this->allocator->allocAlignedRaw(
+        sizeof(Worker), alignof(Worker));
+    if (worker == nullptr) {
+      BL_THROW(errMsg(SchedulerError::WorkerAllocationFailed));
+      break;
+    }
+    new (worker) Worker(this, this->allocator);
+    worker->rng = i + 1;
+    this->workers.push(worker);
+  }
+
+  // Only start the threads once every worker exists (they steal from each
+  // other)
+  for (Worker* worker : this->workers) {
+    worker->thread = std::thread([this, worker] { this->workerLoop(worker); });
+  }
+}
+
+Scheduler::Worker* Scheduler::getCurrentWorker(void) const {
+  Worker* worker = static_cast<Worker*>(current_worker);
+  return worker != nullptr && worker->scheduler == this ? worker : nullptr;
+}
+
+bool Scheduler::isWorker(void) const {
+  return this->getCurrentWorker() != nullptr;
+}
+
+Scheduler::Task* Scheduler::allocTask(usize closure_nbytes) {
+  usize   nbytes = TASK_HEADER_SIZE + closure_nbytes;
+  Worker* self   = this->getCurrentWorker();
+
+  Task*   task   = nullptr;
+  if (self != nullptr && nbytes <= FRAME_SIZE) {
+    if (self->free_tasks == nullptr) {
+      self->free_tasks =
+          self->remote_tasks.exchange(nullptr, std::memory_order_acquire);
+    }
+
+    if (self->free_tasks != nullptr) {
+      task             = self->free_tasks;
+      self->free_tasks = task->next;
+    } else {
+      task = (Task*)self->arena.allocAlignedRaw(FRAME_SIZE,
+                                                alignof(std::max_align_t));
+    }
+    nbytes = FRAME_SIZE;
+  } else {
+    self = nullptr;
+    task = (Task*)this->allocator->allocAlignedRaw(nbytes,
+                                                   alignof(std::max_align_t));
+  }
+
+  if (task == nullptr) {
+    return nullptr;
+  }
+  task->owner  = self;
+  task->nbytes = nbytes;
+  task->next   = nullptr;
+  return task;
+}
+
+void Scheduler::freeTask(Task* task, Worker* self) {
+  Worker* owner = task->owner;
+  if (owner == nullptr) {
+    this->allocator->deallocSizedRaw(task, task->nbytes,
+                                     alignof(std::max_align_t));
+  } else if (owner == self) {
+    task->next       = self->free_tasks;
+    self->free_tasks = task;
+  } else {
+    Task* head = owner->remote_tasks.load(std::memory_order_relaxed);
+    do {
+      task->next = head;
+    } while (!owner->remote_tasks.compare_exchange_weak(
+        head, task, std::memory_order_release, std::memory_order_relaxed));
+  }
+}
+
+void Scheduler::submit(Task* task) {
+  task->group->pending.fetch_add(1, std::memory_order_relaxed);
+
+  Worker* self = this->getCurrentWorker();
+  if (self != nullptr) {
+    self->deque.push(task);
+    if (Error::isError()) {
+      // The deque couldn't grow; run the task right away instead
+      Error::resetError();
+      this->execute(task, self);
+      return;
+    }
+  } else {
+    std::lock_guard<std::mutex> guard(this->inject_lock);
+    this->injected.push(task);
+    this->num_injected.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  this->wakeWorker();
+}
+
+void Scheduler::execute(Task* task, Worker* self) {
+  TaskGroup* group = task->group;
+  task->run(task);
+  this->freeTask(task, self);
+
+  if (self != nullptr) {
+    bump(self->tasks_run);
+  } else {
+    this->external_tasks_run.fetch_add(1, std::memory_order_relaxed);
+  }
+  group->pending.fetch_sub(1, std::memory_order_release);
+}
+
+void Scheduler::wait(TaskGroup& group) {
+  Worker* self = this->getCurrentWorker();
+  while (!group.isDone()) {
+    Task* task = this->findTask(self);
+    if (task != nullptr) {
+      this->execute(task, self);
+    } else {
+      std::this_thread::yield();
+    }
+  }
+}
+
+Scheduler::Task* Scheduler::findTask(Worker* self) {
+  if (self != nullptr) {
+    Task* task = self->deque.pop();
+    if (task != nullptr) {
+      return task;
+    }
+  }
+
+  Task* task = this->takeInjected();
+  if (task != nullptr) {
+    return task;
+  }
+  return this->steal(self);
+}
+
+Scheduler::Task* Scheduler::takeInjected(void) {
+  if (this->num_injected.load(std::memory_order_relaxed) == 0) {
+    return nullptr;
+  }
+
+  std::lock_guard<std::mutex> guard(this->inject_lock);
+  if (this->inject_head == this->injected.getLen()) {
+    return nullptr;
+  }
+
+  Task* task = this->injected[this->inject_head];
+  this->inject_head++;
+  if (this->inject_head == this->injected.getLen()) {
+    this->injected.clear();
+    this->inject_head = 0;
+  }
+  this->num_injected.fetch_sub(1, std::memory_order_relaxed);
+  return task;
+}
+
+Scheduler::Task* Scheduler::steal(Worker* self) {
+  usize num_workers = this->workers.getLen();
+  usize first = static_cast<usize>(nextRandom(self != nullptr ? self->rng
+                                                              : external_rng));
+
+  for (usize i = 0; i < num_workers; i++) {
+    Worker* victim = this->workers[(first + i) % num_workers];
+    if (victim == self) {
+      continue;
+    }
+
+    Task* task = victim->deque.steal();
+    if (task != nullptr) {
+      if (self != nullptr) {
+        bump(self->steals);
+      } else {
+        this->external_steals.fetch_add(1, std::memory_order_relaxed);
+      }
+      return task;
+    }
+  }
+
+  if (self != nullptr) {
+    bump(self->failed_steals);
+  } else {
+    this->external_failed_steals.fetch_add(1, std::memory_order_relaxed);
+  }
+  return nullptr;
+}
+
+bool Scheduler::hasQueuedTasks(void) const {
+  if (this->num_injected.load(std::memory_order_relaxed) != 0) {
+    return true;
+  }
+  for (Worker* worker : this->workers) {
+    if (!worker->deque.isEmpty()) {
+      return true;
+    }
+  }
+  return false;
+}
+
+void Scheduler::wakeWorker(void) {
+  // Pairs with the fence in `sleep`: either the sleeping worker sees the new
+  // task, or we see that it's (about to go) to sleep
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  if (this->num_sleeping.load(std::memory_order_relaxed) == 0) {
+    return;
+  }
+
+  std::lock_guard<std::mutex> guard(this->sleep_lock);
+  this->wake.notify_one();
+}
+
+void Scheduler::sleep(Worker* self) {
+  std::unique_lock<std::mutex> guard(this->sleep_lock);
+  this->num_sleeping.fetch_add(1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+
+  if (!this->stopping.load(std::memory_order_relaxed) &&
+      !this->hasQueuedTasks()) {
+    bump(self->sleeps);
+    this->wake.wait(guard);
+  }
+  this->num_sleeping.fetch_sub(1, std::memory_order_relaxed);
+}
+
+void Scheduler::workerLoop(Worker* self) {
+  current_worker = self;
+
+  usize idle_rounds = 0;
+  auto  idle_start  = std::chrono::steady_clock::now();
+  while (!this->stopping.load(std::memory_order_relaxed)) {
+    Task* task = this->findTask(self);
+    if (task != nullptr) {
+      if (idle_rounds != 0) {
+        bump(self->idle_ns, nanosSince(idle_start));
+        idle_rounds = 0;
+      }
+      this->execute(task, self);
+      continue;
+    }
+
+    if (idle_rounds == 0) {
+      idle_start = std::chrono::steady_clock::now();
+    }
+    idle_rounds++;
+    if (idle_rounds < SPIN_ROUNDS) {
+      std::this_thread::yield();
+    } else {
+      this->sleep(self);
+    }
+  }
+
+  if (idle_rounds != 0) {
+    bump(self->idle_ns, nanosSince(idle_start));
+  }
+  current_worker = nullptr;
+}
+
+bool Scheduler::shouldSplit(void) const {
+  Worker* self = this->getCurrentWorker();
+  return self == nullptr || self->deque.isEmpty();
+}
+
+usize Scheduler::getGrain(usize len) const {
+  // Aim for ~8 pieces per worker when the whole range gets split
+  usize num_workers = this->workers.isEmpty() ? 1 : this->workers.getLen();
+  usize grain       = len / (8 * num_workers);
+  return grain == 0 ? 1 : grain;
+}
+
+} // namespace bl::task
@@ -0,0 +1,19 @@
+#include "bl/task/work_deque.h"
+
+namespace bl::task {
+
+namespace work_deque_internal {
+
+const_cstr errMsg(WorkDequeError err) {
+  switch (err) {
+  case WorkDequeError::InvalidAllocator:
+    return "WorkDequeError: Invalid Allocator (the allocator was null)";
+  case WorkDequeError::BufferAllocationFailed:
+    return "WorkDequeError: Unable to allocate space for the buffer";
+  }
+
+  return nullptr;
+}
+} // namespace work_deque_internal
+
+} // namespace bl::task
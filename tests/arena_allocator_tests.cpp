@@ -0,0 +1,183 @@
+#include "bl/ds/dynamic_array.h"
+#include "bl/error.h"
+#include "bl/mem/allocator.h"
+#include "bl/mem/arena_allocator.h"
+#include "bl/primitives.h"
+#include "bl/string.h"
+
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+
+using namespace bl;
+using namespace bl::ds;
+
+void allocTest(void) {
+  mem::ArenaAllocator arena = mem::ArenaAllocator();
+  mem::Allocator*     alloc = &arena;
+
+  int*                a     = (int*)alloc->allocRaw(sizeof(int));
+  int*                b     = (int*)alloc->allocRaw(sizeof(int));
+  assert(a != nullptr);
+  assert(b != nullptr);
+  assert(a != b);
+  assert((uintptr_t)a % alignof(std::max_align_t) == 0);
+  assert((uintptr_t)b % alignof(std::max_align_t) == 0);
+
+  *a = 1;
+  *b = 2;
+  alloc->deallocRaw(a);
+  assert(*b == 2);
+  assert(arena.getCap() == mem::ArenaAllocator::DEFAULT_CHUNK_SIZE);
+}
+
+void chunkTest(void) {
+  mem::ArenaAllocator arena = mem::ArenaAllocator(nullptr, 64);
+  assert(Error::isError());
+
+  mem::ArenaAllocator small = mem::ArenaAllocator(&arena, 64);
+  Error::checkError();
+
+  // Allocations bigger than a chunk get their own chunk
+  void* big                 = small.allocRaw(1024);
+  assert(big != nullptr);
+  assert(small.getCap() == 1024);
+
+  void* next = small.allocRaw(32);
+  assert(next != nullptr);
+  assert(small.getCap() == 1024 + 64);
+}
+
+void resizeTest(void) {
+  mem::ArenaAllocator arena = mem::ArenaAllocator();
+
+  // The most recent allocation grows in place
+  char*               a     = (char*)arena.allocRaw(16);
+  strcpy(a, "Hello");
+  char* grown = (char*)arena.resizeRaw(a, 64);
+  assert(grown == a);
+  assert(strcmp(grown, "Hello") == 0);
+  assert(arena.getUsed() == 64);
+
+  // Anything else gets copied
+  char* b     = (char*)arena.allocRaw(16);
+  strcpy(b, "World");
+  char* moved = (char*)arena.resizeRaw(a, 128);
+  assert(moved != a);
+  assert(strcmp(moved, "Hello") == 0);
+  assert(strcmp(b, "World") == 0);
+}
+
+void markTest(void) {
+  mem::ArenaAllocator        arena = mem::ArenaAllocator(nullptr, 128);
+  mem::ArenaAllocator        inner = mem::ArenaAllocator(&arena, 128);
+  mem::ArenaAllocator::Mark  start = inner.mark();
+
+  void*                      a     = inner.allocRaw(32);
+  mem::ArenaAllocator::Mark  mark  = inner.mark();
+  for (int i = 0; i < 16; i++) {
+    inner.allocRaw(32);
+  }
+  assert(inner.getUsed() == 17 * 32);
+  usize cap = inner.getCap();
+
+  inner.rewind(mark);
+  Error::checkError();
+  assert(inner.getUsed() == 32);
+
+  // Freed chunks are reused
+  void* b = inner.allocRaw(32);
+  assert(b == (char*)a + 32);
+  for (int i = 0; i < 15; i++) {
+    inner.allocRaw(32);
+  }
+  assert(inner.getCap() == cap);
+
+  // A mark taken before a rewind can't be used afterwards
+  inner.rewind(start);
+  Error::checkError();
+  assert(inner.getUsed() == 0);
+  inner.rewind(mark);
+  assert(Error::isError());
+
+  inner.reset();
+  assert(inner.getUsed() == 0);
+  assert(inner.allocRaw(32) == a);
+}
+
+void alignedTest(void) {
+  mem::ArenaAllocator arena = mem::ArenaAllocator(nullptr, 128);
+  mem::ArenaAllocator inner = mem::ArenaAllocator(&arena, 128);
+
+  inner.allocRaw(1);
+  char* a = (char*)inner.allocAlignedRaw(10, 64);
+  assert((uintptr_t)a % 64 == 0);
+  strcpy(a, "Hello");
+
+  // The most recent allocation still grows in place
+  assert(inner.resizeAlignedRaw(a, 10, 32, 64) == a);
+
+  // Allocations that don't fit get moved to a fresh chunk
+  char* b = (char*)inner.resizeAlignedRaw(a, 32, 200, 64);
+  assert(b != a);
+  assert((uintptr_t)b % 64 == 0);
+  assert(strcmp(b, "Hello") == 0);
+
+  // Alignments bigger than the chunk data's need padding in the fresh chunk
+  void* c = inner.allocAlignedRaw(100, 256);
+  assert((uintptr_t)c % 256 == 0);
+}
+
+void sizedTest(void) {
+  mem::ArenaAllocator arena = mem::ArenaAllocator();
+
+  void*               a     = arena.allocRaw(16);
+  void*               b     = arena.allocRaw(16);
+
+  // Only the most recent allocation can grow in place
+  assert(!arena.tryExpandRaw(a, 16, 32));
+  assert(arena.tryExpandRaw(a, 16, 8));
+  assert(arena.tryExpandRaw(b, 16, 64));
+  assert(arena.getUsed() == 80);
+
+  // ...or be given back
+  arena.deallocSizedRaw(a, 16);
+  assert(arena.getUsed() == 80);
+  arena.deallocSizedRaw(b, 64);
+  assert(arena.getUsed() == 16);
+  assert(arena.allocRaw(16) == b);
+}
+
+void containerTest(void) {
+  mem::ArenaAllocator arena = mem::ArenaAllocator();
+
+  String str = String(&arena, "Hello, this string is too long to be inline");
+  Error::checkError();
+  const_cstr raw = str.getRaw();
+  str.push(" World!");
+  Error::checkError();
+  assert(str.isSame("Hello, this string is too long to be inline World!"));
+
+  // The string was the last allocation, so it grew in place
+  assert(str.getRaw() == raw);
+
+  DynamicArray<int> arr = DynamicArray<int>(&arena);
+  Error::checkError();
+  for (int i = 0; i < 100; i++) {
+    arr.push(i);
+    Error::checkError();
+  }
+  for (int i = 0; i < 100; i++) {
+    assert(arr[i] == i);
+  }
+}
+
+int main(void) {
+  allocTest();
+  chunkTest();
+  resizeTest();
+  markTest();
+  alignedTest();
+  sizedTest();
+  containerTest();
+}
@@ -6,8 +6,13 @@
 #include "bl/string.h"
 
 #include <cassert>
+#include <csignal>
+#include <cstdint>
 #include <cstdio>
 #include <cstring>
+#include <list>
+#include <sys/wait.h>
+#include <unistd.h>
 
 using namespace bl;
 using namespace bl::ds;
@@ -61,6 +66,13 @@ void indexTest(void) {
   assert(arr[0] == 1);
   assert(arr[1] == 2);
   assert(arr[2] == 3);
+
+  arr.at(0)           = 4;
+  arr.getUnchecked(1) = 5;
+  assert(arr.at(0) == 4 && arr[1] == 5);
+
+  const DynamicArray<int>& ref = arr;
+  assert(ref[0] == 4 && ref.at(1) == 5 && ref.getUnchecked(2) == 3);
 }
 
 void clearTest(void) {
@@ -92,15 +104,54 @@ void insertTest(void) {
   assert(arr[2] == 2);
   assert(arr[3] == 3);
 
-  arr.insert(3, 4);
+  // Inserting before the last element shifts it
+  arr.insert(3, 9);
   Error::checkError();
   assert(arr.getLen() == 5);
   assert(arr.getCap() == 6);
   assert(arr[0] == 1);
   assert(arr[1] == 4);
   assert(arr[2] == 2);
-  assert(arr[3] == 3);
-  assert(arr[4] == 4);
+  assert(arr[3] == 9);
+  assert(arr[4] == 3);
+
+  // Inserting at the length appends
+  arr.insert(5, 5);
+  Error::checkError();
+  assert(arr.getLen() == 6);
+  assert(arr[4] == 3);
+  assert(arr[5] == 5);
+
+  arr.insert(7, 0);
+  assert(Error::isError());
+
+  // Works for empty arrays and non-trivially copyable elements too
+  DynamicArray<String> strs = DynamicArray<String>();
+  strs.insert(0, String("b"));
+  Error::checkError();
+  strs.insert(0, String("a"));
+  Error::checkError();
+  strs.insert(1, String("c"));
+  Error::checkError();
+  strs.insert(3, String("d"));
+  Error::checkError();
+  assert(strs.getLen() == 4);
+  assert(strs[0].isSame("a") && strs[1].isSame("c"));
+  assert(strs[2].isSame("b") && strs[3].isSame("d"));
+}
+
+/// Checks if `fn` aborts (running it in a child process, so the test can keep
+/// going).
+template <typename Fn> bool aborts(Fn fn) {
+  pid_t pid = fork();
+  if (pid == 0) {
+    fn();
+    _exit(0);
+  }
+
+  int status = 0;
+  waitpid(pid, &status, 0);
+  return WIFSIGNALED(status) && WTERMSIG(status) == SIGABRT;
 }
 
 void removeTest(void) {
@@ -121,6 +172,11 @@ void removeTest(void) {
   assert(arr.getLen() == 1);
   assert(arr.getCap() == 3);
   assert(arr[0] == 2);
+
+  // Out of bounds indices abort (even on an empty array)
+  DynamicArray<int> empty = DynamicArray<int>();
+  assert(aborts([&] { empty.remove(0); }));
+  assert(aborts([&] { arr.remove(1); }));
 }
 
 void swapRemoveTest(void) {
@@ -141,6 +197,437 @@ void swapRemoveTest(void) {
   assert(arr.getLen() == 1);
   assert(arr.getCap() == 3);
   assert(arr[0] == 3);
+
+  DynamicArray<int> empty = DynamicArray<int>();
+  assert(aborts([&] { empty.swapRemove(0); }));
+  assert(aborts([&] { arr.swapRemove(1); }));
+}
+
+struct alignas(64) CacheLine {
+  u64 vals[8];
+};
+
+void alignedTest(void) {
+  DynamicArray<f32, 32> floats = DynamicArray<f32, 32>(3);
+  Error::checkError();
+  for (int i = 0; i < 100; i++) {
+    floats.push((f32)i);
+    Error::checkError();
+    assert((uintptr_t)floats.getRaw() % 32 == 0);
+  }
+  assert(floats[99] == 99.0f);
+
+  DynamicArray<CacheLine> lines = DynamicArray<CacheLine>();
+  for (int i = 0; i < 10; i++) {
+    lines.push(CacheLine{{(u64)i}});
+    Error::checkError();
+    assert((uintptr_t)lines.getRaw() % 64 == 0);
+  }
+  assert(lines[9].vals[0] == 9);
+}
+
+void policyTest(void) {
+  typedef DynamicArray<int, alignof(int), mem::StaticCAllocator> StaticArray;
+
+  // Static policies aren't stored in the array
+  static_assert(sizeof(StaticArray) < sizeof(DynamicArray<int>));
+
+  StaticArray arr = StaticArray(2);
+  Error::checkError();
+  for (int i = 0; i < 100; i++) {
+    arr.push(i);
+    Error::checkError();
+  }
+  assert(arr.getLen() == 100);
+  assert(arr[99] == 99);
+  assert(arr.pop() == 99);
+
+  StaticArray copy = arr;
+  Error::checkError();
+  assert(copy.getLen() == 99);
+  assert(copy[50] == 50);
+
+  StaticArray list = StaticArray({1, 2, 3});
+  Error::checkError();
+  assert(list[2] == 3);
+
+  // Runtime policies still reject null allocators
+  DynamicArray<int> invalid = DynamicArray<int>(nullptr);
+  assert(Error::isError());
+}
+
+/// Counts live instances, and how many times they were copied.
+struct Counted {
+  static int live;
+  static int copies;
+  int        val;
+
+  Counted(int val = 0) : val(val) { live++; }
+  Counted(const Counted& other) : val(other.val) {
+    live++;
+    copies++;
+  }
+  Counted(Counted&& other) : val(other.val) {
+    other.val = -1;
+    live++;
+  }
+  Counted& operator=(const Counted& other) {
+    this->val = other.val;
+    copies++;
+    return *this;
+  }
+  Counted& operator=(Counted&& other) {
+    this->val = other.val;
+    other.val = -1;
+    return *this;
+  }
+  ~Counted() { live--; }
+};
+
+int Counted::live   = 0;
+int Counted::copies = 0;
+
+void moveTest(void) {
+  DynamicArray<int> arr = DynamicArray<int>({1, 2, 3});
+  Error::checkError();
+  const int*        raw = arr.getRaw();
+
+  // Moving steals the buffer
+  DynamicArray<int> moved = std::move(arr);
+  assert(moved.getRaw() == raw);
+  assert(moved.getLen() == 3);
+  assert(arr.getLen() == 0 && arr.getCap() == 0);
+
+  // The moved-from array can still be used
+  arr.push(4);
+  Error::checkError();
+  assert(arr[0] == 4);
+
+  arr = std::move(moved);
+  assert(arr.getRaw() == raw);
+  assert(arr.getLen() == 3);
+  assert(moved.getLen() == 0);
+
+  // Copy assignment clones the buffer
+  moved = arr;
+  Error::checkError();
+  assert(moved.getRaw() != raw);
+  assert(moved.getLen() == 3);
+  assert(moved[2] == 3);
+
+  // Cloning an empty array doesn't allocate
+  DynamicArray<int> empty  = DynamicArray<int>();
+  DynamicArray<int> cloned = empty;
+  Error::checkError();
+  assert(cloned.getRaw() == nullptr);
+  assert(cloned.getLen() == 0 && cloned.getCap() == 0);
+  cloned.push(1);
+  Error::checkError();
+  assert(cloned[0] == 1);
+}
+
+void emplaceTest(void) {
+  {
+    DynamicArray<Counted> arr = DynamicArray<Counted>();
+    for (int i = 0; i < 100; i++) {
+      Counted& elem = arr.emplace(i);
+      Error::checkError();
+      assert(elem.val == i);
+    }
+    assert(Counted::live == 100);
+
+    // Pushing an rvalue and growing the buffer only move elements
+    arr.push(Counted(100));
+    Error::checkError();
+    assert(Counted::copies == 0);
+    assert(arr[100].val == 100);
+
+    // Elements are moved out and destroyed
+    Counted out = Counted();
+    arr.pop(out);
+    Error::checkError();
+    assert(out.val == 100);
+    arr.remove(0, out);
+    Error::checkError();
+    assert(out.val == 0);
+    assert(arr[0].val == 1);
+    arr.swapRemove(0, out);
+    Error::checkError();
+    assert(out.val == 1);
+    assert(arr[0].val == 99);
+    arr.insert(1, Counted(-2));
+    Error::checkError();
+    assert(arr[1].val == -2 && arr[2].val == 2);
+    assert(arr.getLen() == 99);
+    assert(Counted::live == 100); // Including `out`
+    assert(Counted::copies == 0);
+
+    DynamicArray<Counted> copy = arr;
+    Error::checkError();
+    assert(Counted::copies == 99);
+    assert(Counted::live == 199);
+
+    arr.clear();
+    assert(Counted::live == 100);
+  }
+
+  // The destructor destroys the remaining elements
+  assert(Counted::live == 0);
+
+  mem::Allocator       alloc = mem::CAllocator();
+  DynamicArray<String> strs  = DynamicArray<String>();
+  strs.emplace("Hello");
+  Error::checkError();
+  strs.emplace(&alloc, "World");
+  Error::checkError();
+  assert(strs[1].isSame("World"));
+}
+
+void extendTest(void) {
+  const int         src[] = {1, 2, 3, 4, 5};
+
+  DynamicArray<int> arr   = DynamicArray<int>(2);
+  arr.push(0);
+  Error::checkError();
+
+  // Grows once, straight to the required capacity
+  arr.extend(src, 5);
+  Error::checkError();
+  assert(arr.getLen() == 6);
+  assert(arr.getCap() == 6);
+  assert(arr[5] == 5);
+
+  // ...or by the resize factor if that's bigger
+  arr.extend(src, 1);
+  Error::checkError();
+  assert(arr.getCap() == 12);
+
+  // Extending from itself
+  arr.extend(arr);
+  Error::checkError();
+  assert(arr.getLen() == 14);
+  assert(arr[7] == 0 && arr[13] == 1);
+
+  arr.extend(nullptr, 1);
+  assert(Error::isError());
+
+  // Iterator ranges
+  std::list<int> list = {7, 8, 9};
+  arr.clear();
+  arr.extend(list.begin(), list.end());
+  Error::checkError();
+  arr.extend(src + 3, src + 5);
+  Error::checkError();
+  assert(arr.getLen() == 5);
+  assert(arr[0] == 7 && arr[2] == 9 && arr[4] == 5);
+
+  DynamicArray<String> strs = DynamicArray<String>();
+  strs.push(String("Hello"));
+  strs.extend(strs.getRaw(), 1);
+  Error::checkError();
+  assert(strs[1].isSame("Hello"));
+}
+
+void resizeToTest(void) {
+  DynamicArray<int> arr = DynamicArray<int>();
+  arr.reserve(10);
+  Error::checkError();
+  assert(arr.getCap() == 10);
+  assert(arr.getLen() == 0);
+
+  // Reserving never shrinks
+  arr.reserve(5);
+  assert(arr.getCap() == 10);
+
+  arr.resizeTo(20, 7);
+  Error::checkError();
+  assert(arr.getLen() == 20);
+  assert(arr.getCap() == 20);
+  assert(arr[0] == 7 && arr[19] == 7);
+
+  arr.resizeTo(3);
+  assert(arr.getLen() == 3);
+  assert(arr.getCap() == 20);
+  arr.resizeTo(5);
+  assert(arr[4] == 0);
+
+  {
+    DynamicArray<Counted> counted = DynamicArray<Counted>();
+    counted.resizeTo(10, Counted(3));
+    Error::checkError();
+    assert(Counted::live == 10);
+    counted.resizeTo(4);
+    assert(Counted::live == 4);
+    assert(counted[3].val == 3);
+  }
+  assert(Counted::live == 0);
+}
+
+void growthTest(void) {
+  typedef DynamicArray<int, alignof(int), mem::RuntimeAllocator, CompactGrowth>
+      CompactArray;
+
+  // The first allocation fills a cache line, then grows by 1.5x
+  const int    src[16] = {};
+  CompactArray arr     = CompactArray();
+  arr.push(1);
+  Error::checkError();
+  assert(arr.getCap() == 16);
+  arr.extend(src, 16);
+  Error::checkError();
+  assert(arr.getCap() == 24);
+
+  // Big buffers are rounded to whole pages
+  assert(CompactGrowth::nextCapacity(1000, 1001, 4) == 2048);
+  assert(CompactGrowth::nextCapacity(1024, 1025, 8) == 1536);
+
+  // The additive step is capped (but never below the required capacity)
+  typedef GeometricGrowth<2, 1, 0, 1024> Capped;
+  assert(Capped::nextCapacity(10, 11, 8) == 20);
+  assert(Capped::nextCapacity(1000, 1001, 8) == 1128);
+  assert(Capped::nextCapacity(1000, 2000, 8) == 2000);
+  assert(Capped::nextCapacity(0, 1, 2048) == 1);
+
+  // The default doubles from a single element
+  assert(DoublingGrowth::nextCapacity(0, 1, 4) == 1);
+  assert(DoublingGrowth::nextCapacity(8, 9, 4) == 16);
+}
+
+/// A policy that (like an arena) lets blocks shrink in place, and counts how
+/// many times a block was moved.
+struct ShrinkablePolicy : mem::StaticCAllocator {
+  static usize moves;
+
+  inline void* resizeAligned(void* ptr, usize old_nbytes, usize new_nbytes,
+                             usize align) {
+    moves++;
+    return mem::StaticCAllocator::resizeAligned(ptr, old_nbytes, new_nbytes,
+                                                align);
+  }
+  inline bool tryExpand(void* /*ptr*/, usize old_nbytes, usize new_nbytes) {
+    return new_nbytes <= old_nbytes;
+  }
+};
+
+usize ShrinkablePolicy::moves = 0;
+
+void shrinkToFitTest(void) {
+  DynamicArray<int> arr = DynamicArray<int>(100);
+  arr.push(1);
+  arr.push(2);
+  arr.shrinkToFit();
+  Error::checkError();
+  assert(arr.getCap() == 2);
+  assert(arr[0] == 1 && arr[1] == 2);
+
+  DynamicArray<String> strs = DynamicArray<String>(10);
+  strs.push(String("Hello"));
+  strs.shrinkToFit();
+  Error::checkError();
+  assert(strs.getCap() == 1);
+  assert(strs[0].isSame("Hello"));
+
+  // Empty arrays release their buffer
+  strs.clear();
+  strs.shrinkToFit();
+  assert(strs.getCap() == 0);
+  assert(strs.getRaw() == nullptr);
+
+  // The block is moved to a smaller one even if the allocator would let it
+  // shrink in place
+  typedef DynamicArray<int, alignof(int), ShrinkablePolicy> ShrinkableArray;
+  ShrinkableArray big = ShrinkableArray(100000);
+  for (int i = 0; i < 100000; i++) {
+    big.push(i);
+  }
+  Error::checkError();
+  big.removeRange(10, 100000);
+  Error::checkError();
+  usize moves = ShrinkablePolicy::moves;
+  big.shrinkToFit();
+  Error::checkError();
+  assert(ShrinkablePolicy::moves == moves + 1);
+  assert(big.getCap() == 10);
+  assert(big[9] == 9);
+}
+
+void rangeTest(void) {
+  const int         src[] = {7, 8, 9};
+
+  DynamicArray<int> arr   = DynamicArray<int>({1, 2, 3});
+  arr.insertRange(1, src, 3);
+  Error::checkError();
+  assert(arr.getLen() == 6);
+  assert(arr[0] == 1 && arr[1] == 7 && arr[3] == 9 && arr[4] == 2);
+
+  // Inserting at the end appends
+  arr.insertRange(6, src, 1);
+  Error::checkError();
+  assert(arr.getLen() == 7 && arr[6] == 7);
+  arr.insertRange(8, src, 1);
+  assert(Error::isError());
+
+  arr.removeRange(1, 4);
+  Error::checkError();
+  assert(arr.getLen() == 4);
+  assert(arr[0] == 1 && arr[1] == 2 && arr[2] == 3 && arr[3] == 7);
+  arr.removeRange(2, 5);
+  assert(Error::isError());
+  arr.removeRange(0, 4);
+  Error::checkError();
+  assert(arr.isEmpty());
+
+  // Non-trivial elements are moved and destroyed
+  {
+    DynamicArray<Counted> counted = DynamicArray<Counted>();
+    for (int i = 0; i < 4; i++) {
+      counted.emplace(i);
+    }
+    const Counted more[] = {Counted(10), Counted(11), Counted(12)};
+    counted.insertRange(3, more, 3);
+    Error::checkError();
+    assert(counted.getLen() == 7);
+    assert(counted[2].val == 2 && counted[3].val == 10);
+    assert(counted[5].val == 12 && counted[6].val == 3);
+    assert(Counted::live == 10);
+
+    counted.removeRange(1, 5);
+    Error::checkError();
+    assert(counted.getLen() == 3);
+    assert(counted[0].val == 0 && counted[1].val == 12 && counted[2].val == 3);
+    assert(Counted::live == 6);
+  }
+  assert(Counted::live == 0);
+}
+
+void retainTest(void) {
+  DynamicArray<int> arr = DynamicArray<int>();
+  for (int i = 0; i < 10; i++) {
+    arr.push(i);
+  }
+
+  assert(arr.retain([](int val) { return val % 2 == 0; }) == 5);
+  assert(arr.getLen() == 5);
+  assert(arr[0] == 0 && arr[1] == 2 && arr[4] == 8);
+
+  assert(arr.removeIf([](int val) { return val > 4; }) == 2);
+  assert(arr.getLen() == 3);
+  assert(arr[2] == 4);
+
+  DynamicArray<int> sorted = DynamicArray<int>({1, 1, 2, 3, 3, 3, 4});
+  assert(sorted.dedupSorted() == 3);
+  assert(sorted.getLen() == 4);
+  for (int i = 0; i < 4; i++) {
+    assert(sorted[i] == i + 1);
+  }
+
+  DynamicArray<String> strs = DynamicArray<String>();
+  strs.emplace("a");
+  strs.emplace("a");
+  strs.emplace("b");
+  assert(strs.removeIf([](const String& str) { return str.isSame("b"); }) ==
+         1);
+  assert(strs.getLen() == 2);
 }
 
 int main(void) {
@@ -151,4 +638,14 @@ int main(void) {
   insertTest();
   removeTest();
   swapRemoveTest();
+  alignedTest();
+  policyTest();
+  moveTest();
+  emplaceTest();
+  extendTest();
+  resizeToTest();
+  growthTest();
+  shrinkToFitTest();
+  rangeTest();
+  retainTest();
 }
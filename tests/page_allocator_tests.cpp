@@ -0,0 +1,104 @@
+#include "bl/ds/dynamic_array.h"
+#include "bl/error.h"
+#include "bl/mem/allocator.h"
+#include "bl/mem/page_allocator.h"
+#include "bl/primitives.h"
+
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+
+using namespace bl;
+using namespace bl::ds;
+
+void allocTest(void) {
+  mem::PageAllocator pages     = mem::PageAllocator();
+  usize              page_size = pages.getPageSize();
+
+  void*              a         = pages.allocRaw(10);
+  void*              b         = pages.allocRaw(page_size + 1);
+  assert(a != nullptr && b != nullptr);
+  assert((uintptr_t)a % page_size == 0);
+  assert((uintptr_t)b % page_size == 0);
+
+  // Every allocation has a header page in front of it
+  assert(pages.getMappedBytes() == 2 * page_size + 3 * page_size);
+  assert(pages.owns(a) && pages.owns(b));
+  assert(!pages.owns((char*)a + 8));
+
+  pages.deallocRaw(a);
+  assert(!pages.owns(a));
+  pages.deallocRaw(b);
+  assert(pages.getMappedBytes() == 0);
+}
+
+void resizeTest(void) {
+  mem::PageAllocator pages = mem::PageAllocator();
+
+  usize              n     = 1 << 20;
+  u64*               data  = (u64*)pages.allocRaw(n * sizeof(u64));
+  for (usize i = 0; i < n; i++) {
+    data[i] = i;
+  }
+
+  // Growing remaps the pages, keeping their contents
+  data = (u64*)pages.resizeRaw(data, 4 * n * sizeof(u64));
+  assert(data != nullptr);
+  for (usize i = 0; i < n; i++) {
+    assert(data[i] == i);
+  }
+  data[4 * n - 1] = 1;
+  assert(pages.owns(data));
+
+  // ...and so does shrinking
+  data = (u64*)pages.resizeRaw(data, 16);
+  assert(data[1] == 1);
+  assert(pages.getMappedBytes() == 2 * pages.getPageSize());
+  pages.deallocRaw(data);
+}
+
+void expandTest(void) {
+  mem::PageAllocator pages     = mem::PageAllocator();
+  usize              page_size = pages.getPageSize();
+
+  // Growing within the last page never touches the mapping
+  char*              a         = (char*)pages.allocRaw(10);
+  assert(pages.tryExpandRaw(a, 10, page_size));
+  memset(a, 'a', page_size);
+
+  // Shrinking always happens in place
+  char* b = (char*)pages.allocRaw(8 * page_size);
+  assert(pages.tryExpandRaw(b, 8 * page_size, page_size));
+  assert(pages.getMappedBytes() == 4 * page_size);
+
+  // Over-aligned requests can't be served
+  assert(pages.allocAlignedRaw(8, 2 * page_size) == nullptr);
+  void* c = pages.allocAlignedRaw(8, page_size);
+  assert((uintptr_t)c % page_size == 0);
+
+  pages.deallocRaw(a);
+  pages.deallocSizedRaw(b, page_size);
+  pages.deallocAlignedRaw(c, page_size);
+  assert(pages.getMappedBytes() == 0);
+}
+
+void containerTest(void) {
+  mem::PageAllocator pages = mem::PageAllocator(true);
+
+  DynamicArray<u64>  arr   = DynamicArray<u64>(&pages);
+  Error::checkError();
+  for (u64 i = 0; i < 100000; i++) {
+    arr.push(i);
+    Error::checkError();
+  }
+  for (u64 i = 0; i < 100000; i++) {
+    assert(arr[i] == i);
+  }
+}
+
+int main(void) {
+  allocTest();
+  resizeTest();
+  expandTest();
+  containerTest();
+}
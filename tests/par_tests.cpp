@@ -0,0 +1,201 @@
+#include "bl/ds/dynamic_array.h"
+#include "bl/ds/span.h"
+#include "bl/error.h"
+#include "bl/par/algorithms.h"
+#include "bl/par/thread_pool.h"
+#include "bl/primitives.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <cstdlib>
+#include <thread>
+
+using namespace bl;
+using namespace bl::ds;
+using namespace bl::par;
+
+/// Returns an array of `len` pseudo-random ints.
+DynamicArray<int> randomArray(usize len) {
+  DynamicArray<int> arr  = DynamicArray<int>(len);
+  u32               seed = 12345;
+  for (usize i = 0; i < len; i++) {
+    seed = seed * 1664525 + 1013904223;
+    arr.push((int)(seed >> 8));
+  }
+  return arr;
+}
+
+void poolTest(void) {
+  ThreadPool bad = ThreadPool(0);
+  assert(Error::isError());
+
+  ThreadPool pool = ThreadPool(4);
+  Error::checkError();
+  assert(pool.getThreadCount() == 4);
+
+  // Every task runs exactly once
+  std::atomic<int> runs[100] = {};
+  for (int batch = 0; batch < 50; batch++) {
+    pool.run(100, [&](usize task) { runs[task]++; });
+  }
+  for (int i = 0; i < 100; i++) {
+    assert(runs[i] == 50);
+  }
+
+  // Many tiny back-to-back batches each run with their own function (workers
+  // that wake up late mustn't run a finished batch's function on the next;
+  // the sleep gives them the chance to)
+  std::atomic<int> evens = 0;
+  std::atomic<int> odds  = 0;
+  for (int batch = 0; batch < 5000; batch++) {
+    if (batch % 2 == 0) {
+      int step = 1;
+      pool.run(16, [&evens, step](usize) { evens += step; });
+    } else {
+      int step = 3;
+      pool.run(16, [&odds, step](usize) { odds += step; });
+    }
+    assert(evens == (batch / 2 + 1) * 16);
+    assert(odds == (batch + 1) / 2 * 48);
+    std::this_thread::sleep_for(std::chrono::microseconds(1));
+  }
+
+  // Nested batches run serially instead of deadlocking
+  std::atomic<int> nested = 0;
+  pool.run(8, [&](usize) { pool.run(8, [&](usize) { nested++; }); });
+  assert(nested == 64);
+
+  ThreadPool single = ThreadPool(1);
+  int        count  = 0;
+  single.run(10, [&](usize) { count++; });
+  assert(count == 10);
+  assert(ThreadPool::getGlobal()->getThreadCount() >= 1);
+}
+
+void sortTest(void) {
+  ThreadPool        pool     = ThreadPool(4);
+
+  DynamicArray<int> arr      = randomArray(200000);
+  DynamicArray<int> expected = arr;
+  std::sort(expected.begin(), expected.end());
+
+  parallelSort(arr, std::less<int>(), &pool);
+  for (usize i = 0; i < arr.getLen(); i++) {
+    assert(arr[i] == expected[i]);
+  }
+
+  // Sub-ranges and custom comparisons
+  parallelSort(arr.getSpan().subspan(0, 100000), std::greater<int>(), &pool);
+  assert(arr[0] == expected[99999] && arr[99999] == expected[0]);
+  assert(arr[100000] == expected[100000]);
+
+  // Elements that own memory
+  DynamicArray<DynamicArray<int>> nested = DynamicArray<DynamicArray<int>>();
+  for (int i = 0; i < 1000; i++) {
+    nested.emplace();
+    nested[(usize)i].push((i * 7) % 1000);
+  }
+  parallelSort(
+      nested,
+      [](const DynamicArray<int>& a, const DynamicArray<int>& b) {
+        return a[0] < b[0];
+      },
+      &pool);
+  for (int i = 0; i < 1000; i++) {
+    assert(nested[(usize)i][0] == i);
+  }
+
+  DynamicArray<int> empty = DynamicArray<int>();
+  parallelSort(empty);
+}
+
+void reduceTest(void) {
+  ThreadPool        four  = ThreadPool(4);
+  ThreadPool        one   = ThreadPool(1);
+
+  DynamicArray<int> arr   = randomArray(100000);
+  i64               total = 0;
+  for (int val : arr) {
+    total += val;
+  }
+  assert(parallelReduce(arr, (i64)0, [](i64 a, i64 b) { return a + b; },
+                        &four) == total);
+
+  // Floating-point sums don't depend on the number of threads
+  DynamicArray<f64> floats = DynamicArray<f64>();
+  for (int val : arr) {
+    floats.push((f64)val * 1e-3);
+  }
+  auto add  = [](f64 a, f64 b) { return a + b; };
+  f64  sum4 = parallelReduce(floats, 0.0, add, &four);
+  f64  sum1 = parallelReduce(floats, 0.0, add, &one);
+  assert(sum4 == sum1);
+  assert(parallelReduce(floats, 0.0, add, &four) == sum4);
+
+  DynamicArray<int> empty = DynamicArray<int>();
+  assert(parallelReduce(empty, 7, add) == 7);
+}
+
+void forEachTransformTest(void) {
+  ThreadPool        pool = ThreadPool(4);
+
+  DynamicArray<int> arr  = DynamicArray<int>();
+  arr.resizeTo(100000, 1);
+  parallelForEach(arr, [](int& val) { val *= 3; }, &pool);
+  for (int val : arr) {
+    assert(val == 3);
+  }
+
+  DynamicArray<f32> out = DynamicArray<f32>();
+  out.resizeTo(arr.getLen());
+  parallelTransform(arr, out, [](int val) { return (f32)val / 2; }, &pool);
+  Error::checkError();
+  for (f32 val : out) {
+    assert(val == 1.5f);
+  }
+
+  out.resizeTo(10);
+  parallelTransform(arr, out, [](int val) { return (f32)val; }, &pool);
+  assert(Error::isError());
+}
+
+void partitionTest(void) {
+  ThreadPool        pool = ThreadPool(4);
+
+  DynamicArray<int> arr  = DynamicArray<int>();
+  for (int i = 0; i < 100000; i++) {
+    arr.push(i);
+  }
+
+  usize num_even =
+      parallelPartition(arr, [](int val) { return val % 2 == 0; }, &pool);
+  Error::checkError();
+  assert(num_even == 50000);
+
+  // Both halves keep their order
+  for (usize i = 0; i < 50000; i++) {
+    assert(arr[i] == (int)(2 * i));
+    assert(arr[50000 + i] == (int)(2 * i + 1));
+  }
+
+  // Elements that own memory
+  DynamicArray<DynamicArray<int>> nested = DynamicArray<DynamicArray<int>>();
+  for (int i = 0; i < 3; i++) {
+    nested.emplace();
+    nested[(usize)i].push(i);
+  }
+  assert(parallelPartition(nested, [](const DynamicArray<int>& arr) {
+           return arr[0] == 1;
+         }) == 1);
+  assert(nested[0][0] == 1 && nested[1][0] == 0 && nested[2][0] == 2);
+}
+
+int main(void) {
+  poolTest();
+  sortTest();
+  reduceTest();
+  forEachTransformTest();
+  partitionTest();
+}
@@ -0,0 +1,183 @@
+#include "bl/ds/dynamic_array.h"
+#include "bl/error.h"
+#include "bl/mem/allocator.h"
+#include "bl/mem/arena_allocator.h"
+#include "bl/mem/pool_allocator.h"
+#include "bl/primitives.h"
+#include "bl/string.h"
+
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+
+using namespace bl;
+using namespace bl::ds;
+
+void allocTest(void) {
+  mem::PoolAllocator pool = mem::PoolAllocator();
+
+  void*              a    = pool.allocRaw(8);
+  void*              b    = pool.allocRaw(16);
+  void*              c    = pool.allocRaw(100);
+  assert(a != nullptr && b != nullptr && c != nullptr);
+  assert((uintptr_t)a % 16 == 0);
+  assert((uintptr_t)c % 16 == 0);
+
+  // 8 and 16 bytes share a size class, 100 bytes gets its own
+  assert((char*)b == (char*)a + 16);
+  assert(pool.getSlabCount() == 2);
+}
+
+void reuseTest(void) {
+  mem::PoolAllocator pool = mem::PoolAllocator();
+
+  void*              a    = pool.allocRaw(32);
+  void*              b    = pool.allocRaw(32);
+  pool.deallocRaw(a);
+  pool.deallocRaw(b);
+
+  // Freed blocks are handed out last-in first-out
+  assert(pool.allocRaw(32) == b);
+  assert(pool.allocRaw(32) == a);
+  assert(pool.getSlabCount() == 1);
+}
+
+void slabTest(void) {
+  mem::PoolAllocator bad = mem::PoolAllocator(nullptr);
+  assert(Error::isError());
+  mem::PoolAllocator small = mem::PoolAllocator(&bad, 64);
+  assert(Error::isError());
+
+  mem::PoolAllocator pool = mem::PoolAllocator(&bad, 1024);
+  Error::checkError();
+
+  // Every slab holds 1024 / 64 = 16 blocks
+  void*              ptrs[40];
+  for (int i = 0; i < 40; i++) {
+    ptrs[i] = pool.allocRaw(64);
+    assert(ptrs[i] != nullptr);
+    memset(ptrs[i], i, 64);
+  }
+  assert(pool.getSlabCount() == 3);
+
+  for (int i = 0; i < 40; i++) {
+    assert(((u8*)ptrs[i])[63] == i);
+    pool.deallocRaw(ptrs[i]);
+  }
+  for (int i = 0; i < 40; i++) {
+    pool.allocRaw(64);
+  }
+  assert(pool.getSlabCount() == 3);
+}
+
+void oversizeTest(void) {
+  mem::ArenaAllocator arena = mem::ArenaAllocator();
+  mem::PoolAllocator  pool  = mem::PoolAllocator(&arena);
+  Error::checkError();
+
+  // Oversized allocations come straight from the parent
+  usize               used  = arena.getUsed();
+  void* big = pool.allocRaw(mem::PoolAllocator::MAX_BLOCK_SIZE + 1);
+  assert(big != nullptr);
+  assert(arena.getUsed() > used);
+  assert(pool.getSlabCount() == 0);
+  pool.deallocRaw(big);
+}
+
+void resizeTest(void) {
+  mem::PoolAllocator pool = mem::PoolAllocator();
+
+  // Resizing within the size class stays in place
+  char*              a    = (char*)pool.allocRaw(4);
+  strcpy(a, "abc");
+  assert(pool.resizeRaw(a, 16) == a);
+
+  // Growing past it moves to the next class
+  char* b = (char*)pool.resizeRaw(a, 17);
+  assert(b != a);
+  assert(strcmp(b, "abc") == 0);
+  assert(pool.allocRaw(16) == a);
+
+  // ...or to the parent
+  char* c = (char*)pool.resizeRaw(b, 4096);
+  assert(strcmp(c, "abc") == 0);
+  c = (char*)pool.resizeRaw(c, 8192);
+  assert(strcmp(c, "abc") == 0);
+  pool.deallocRaw(c);
+}
+
+void alignedTest(void) {
+  mem::PoolAllocator pool = mem::PoolAllocator();
+
+  // Aligned blocks come from a big enough size class
+  void*              a    = pool.allocAlignedRaw(8, 64);
+  assert((uintptr_t)a % 64 == 0);
+  assert(pool.getSlabCount() == 1);
+  pool.deallocAlignedRaw(a, 64);
+  assert(pool.allocRaw(64) == a);
+
+  // ...or from the parent
+  char* b = (char*)pool.allocAlignedRaw(8, 4096);
+  assert((uintptr_t)b % 4096 == 0);
+  assert(pool.getSlabCount() == 1);
+  strcpy(b, "Hello");
+
+  char* c = (char*)pool.resizeAlignedRaw(b, 8, 10000, 4096);
+  assert((uintptr_t)c % 4096 == 0);
+  assert(strcmp(c, "Hello") == 0);
+  pool.deallocAlignedRaw(c, 4096);
+}
+
+void sizedTest(void) {
+  mem::PoolAllocator pool = mem::PoolAllocator();
+
+  // Blocks can grow in place up to their size class
+  void*              a    = pool.allocRaw(20);
+  assert(pool.tryExpandRaw(a, 20, 32));
+  assert(!pool.tryExpandRaw(a, 32, 33));
+
+  // Shrinks have to move (so the block can go to a smaller size class)
+  assert(!pool.tryExpandRaw(a, 32, 8));
+
+  // Sized deallocations go straight to the size class
+  pool.deallocSizedRaw(a, 32);
+  assert(pool.allocRaw(32) == a);
+
+  // Oversized allocations can't shrink into the pool's range in place
+  void* big = pool.allocRaw(4096);
+  assert(!pool.tryExpandRaw(big, 4096, 64));
+  pool.deallocSizedRaw(big, 4096);
+}
+
+void containerTest(void) {
+  mem::PoolAllocator pool = mem::PoolAllocator();
+
+  for (int n = 0; n < 10; n++) {
+    String str = String(&pool, "Hello");
+    Error::checkError();
+    str.push(" World!");
+    Error::checkError();
+    assert(str.isSame("Hello World!"));
+
+    DynamicArray<int> arr = DynamicArray<int>(&pool);
+    Error::checkError();
+    for (int i = 0; i < 200; i++) {
+      arr.push(i);
+      Error::checkError();
+    }
+    for (int i = 0; i < 200; i++) {
+      assert(arr[i] == i);
+    }
+  }
+}
+
+int main(void) {
+  allocTest();
+  reuseTest();
+  slabTest();
+  oversizeTest();
+  resizeTest();
+  alignedTest();
+  sizedTest();
+  containerTest();
+}
@@ -0,0 +1,143 @@
+#include "bl/ds/dynamic_array.h"
+#include "bl/ds/search.h"
+#include "bl/ds/span.h"
+#include "bl/error.h"
+#include "bl/primitives.h"
+
+#include <cassert>
+
+using namespace bl;
+using namespace bl::ds;
+using search_internal::Isa;
+
+/// Instruction sets to run every test with (the unsupported ones are skipped).
+const Isa ISAS[] = {Isa::Scalar, Isa::Sse2, Isa::Avx2};
+
+/// Checks every function against plain loops, for every length up to `len`
+/// and every offset into the (unaligned) array.
+template <typename T> void checkAgainstLoops(const DynamicArray<T>& arr) {
+  for (usize offset = 0; offset < 4; offset++) {
+    for (usize len = 0; offset + len <= arr.getLen(); len++) {
+      Span<const T> span = arr.getSpan().subspan(offset, len);
+
+      T             val  = arr[arr.getLen() / 2];
+      usize         idx  = NOT_FOUND;
+      usize         n    = 0;
+      for (usize i = 0; i < len; i++) {
+        if (span[i] == val) {
+          idx = idx == NOT_FOUND ? i : idx;
+          n++;
+        }
+      }
+      assert(indexOf(span, val) == idx);
+      assert(contains(span, val) == (idx != NOT_FOUND));
+      assert(count(span, val) == n);
+
+      if (len != 0) {
+        T smallest = span[0], biggest = span[0];
+        search_internal::SumType<T> total = 0;
+        for (T elem : span) {
+          smallest  = elem < smallest ? elem : smallest;
+          biggest   = elem > biggest ? elem : biggest;
+          total    += elem;
+        }
+        assert(min(span) == smallest);
+        assert(max(span) == biggest);
+        if constexpr (std::is_integral<T>::value) {
+          assert(sum(span) == total);
+        }
+      }
+    }
+  }
+}
+
+void searchTest(void) {
+  DynamicArray<u8>  bytes  = DynamicArray<u8>();
+  DynamicArray<u32> uints  = DynamicArray<u32>();
+  DynamicArray<i32> ints   = DynamicArray<i32>();
+  DynamicArray<f32> floats = DynamicArray<f32>();
+  u32               seed   = 1;
+  for (usize i = 0; i < 300; i++) {
+    seed = seed * 1664525 + 1013904223;
+    bytes.push((u8)(seed >> 24));
+    uints.push(seed % 7 == 0 ? 0xFFFFFFF0u + seed % 16 : seed >> 8);
+    ints.push((i32)seed % 1000);
+    floats.push((f32)(i32)(seed >> 16) - 30000.0f);
+  }
+
+  for (Isa isa : ISAS) {
+    if (!search_internal::setIsa(isa)) {
+      continue;
+    }
+    checkAgainstLoops(bytes);
+    checkAgainstLoops(uints);
+    checkAgainstLoops(ints);
+    checkAgainstLoops(floats);
+  }
+}
+
+void edgeCaseTest(void) {
+  Isa detected = search_internal::getIsa();
+  for (Isa isa : ISAS) {
+    if (!search_internal::setIsa(isa)) {
+      continue;
+    }
+    assert(search_internal::getIsa() == isa);
+
+    // Matches in the last lane, and only in the tail
+    DynamicArray<u8> bytes = DynamicArray<u8>();
+    bytes.resizeTo(1000, 1);
+    bytes[999] = 2;
+    assert(indexOf(bytes, 2) == 999);
+    bytes[63] = 2;
+    assert(indexOf(bytes, 2) == 63);
+    assert(count(bytes, 1) == 998);
+
+    // Byte counters that would overflow without flushing
+    bytes.resizeTo(100000, 1);
+    assert(count(bytes, 1) == 100000 - 2);
+    assert(sum(bytes) == 100000 + 2);
+
+    // Sums don't overflow the element type
+    DynamicArray<u32> big = DynamicArray<u32>();
+    big.resizeTo(100, 0xFFFFFFFFu);
+    assert(sum(big) == 100 * (u64)0xFFFFFFFFu);
+    DynamicArray<i32> neg = DynamicArray<i32>();
+    neg.resizeTo(100, -2000000000);
+    assert(sum(neg) == -200000000000ll);
+    assert(max(neg) == -2000000000);
+
+    // Floats: -0.0 == 0.0, NaN never matches
+    DynamicArray<f32> floats = DynamicArray<f32>();
+    floats.resizeTo(50, 1.5f);
+    floats[40] = -0.0f;
+    assert(indexOf(floats, 0.0f) == 40);
+    assert(sum(floats) == 1.5f * 49);
+    assert(min(floats) == 0.0f && max(floats) == 1.5f);
+  }
+  assert(search_internal::setIsa(detected));
+}
+
+void genericTest(void) {
+  // Types without vectorized kernels
+  DynamicArray<u64> arr = {5, 3, 9, 3};
+  assert(indexOf(arr, 3) == 1);
+  assert(count(arr, 3) == 2);
+  assert(!contains(arr, 4));
+  assert(min(arr) == 3 && max(arr) == 9);
+  assert(sum(arr) == 20);
+
+  // Empty ranges
+  DynamicArray<f32> empty = DynamicArray<f32>();
+  assert(indexOf(empty, 1.0f) == NOT_FOUND);
+  assert(sum(empty) == 0.0f);
+  Error::checkError();
+  min(empty);
+  assert(Error::isError());
+}
+
+int main(void) {
+  searchTest();
+  edgeCaseTest();
+  genericTest();
+}
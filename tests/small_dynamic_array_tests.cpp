@@ -0,0 +1,151 @@
+#include "bl/ds/small_dynamic_array.h"
+#include "bl/error.h"
+#include "bl/mem/allocator.h"
+#include "bl/mem/tracking_allocator.h"
+#include "bl/primitives.h"
+#include "bl/string.h"
+
+#include <cassert>
+#include <cstdint>
+#include <utility>
+
+using namespace bl;
+using namespace bl::ds;
+
+void pushTest(void) {
+  mem::TrackingAllocator    tracker = mem::TrackingAllocator();
+  SmallDynamicArray<int, 4> arr     = SmallDynamicArray<int, 4>(&tracker);
+  Error::checkError();
+  assert(arr.getCap() == 4);
+
+  // The first `N` elements are stored inline...
+  for (int i = 0; i < 4; i++) {
+    arr.push(i);
+    Error::checkError();
+  }
+  assert(arr.isInline());
+  assert(tracker.getStats().allocs == 0);
+
+  // ...and the rest spill to the allocator
+  arr.push(4);
+  Error::checkError();
+  assert(!arr.isInline());
+  assert(arr.getCap() == 8);
+  assert(tracker.getStats().allocs == 1);
+  for (int i = 0; i < 5; i++) {
+    assert(arr[i] == i);
+  }
+
+  assert(arr.pop() == 4);
+  arr.shrinkToFit();
+  Error::checkError();
+  assert(arr.isInline());
+  assert(arr[3] == 3);
+  assert(tracker.getStats().live_bytes == 0);
+
+  arr.clear();
+  arr.pop();
+  assert(Error::isError());
+
+  SmallDynamicArray<int, 4> invalid = SmallDynamicArray<int, 4>(nullptr);
+  assert(Error::isError());
+}
+
+void insertRemoveTest(void) {
+  SmallDynamicArray<int, 4> arr = SmallDynamicArray<int, 4>({1, 2, 3});
+  Error::checkError();
+
+  arr.insert(1, 4);
+  Error::checkError();
+  arr.insert(4, 5);
+  Error::checkError();
+  assert(arr.getLen() == 5);
+  assert(arr[0] == 1 && arr[1] == 4 && arr[2] == 2 && arr[3] == 3);
+  assert(arr[4] == 5);
+
+  // Inserting before the last element shifts it (like `DynamicArray`)
+  arr.insert(4, 9);
+  Error::checkError();
+  assert(arr.getLen() == 6);
+  assert(arr[3] == 3 && arr[4] == 9 && arr[5] == 5);
+  arr.remove(4);
+
+  arr.insert(6, 0);
+  assert(Error::isError());
+
+  assert(arr.remove(0) == 1);
+  assert(arr[0] == 4 && arr[3] == 5);
+  assert(arr.swapRemove(0) == 4);
+  assert(arr[0] == 5 && arr[1] == 2);
+  assert(arr.getLen() == 3);
+}
+
+void moveTest(void) {
+  // Inline elements are moved one by one...
+  SmallDynamicArray<String, 2> strs = SmallDynamicArray<String, 2>();
+  strs.emplace("Hello");
+  Error::checkError();
+  SmallDynamicArray<String, 2> moved = std::move(strs);
+  assert(moved.isInline());
+  assert(moved[0].isSame("Hello"));
+  assert(strs.isEmpty());
+
+  // ...and spilled buffers are taken over
+  moved.emplace("World");
+  moved.emplace("!");
+  Error::checkError();
+  const String* raw = moved.getRaw();
+  strs              = std::move(moved);
+  assert(strs.getRaw() == raw);
+  assert(strs[2].isSame("!"));
+  assert(moved.isInline() && moved.isEmpty());
+
+  SmallDynamicArray<String, 2> copy = strs;
+  Error::checkError();
+  assert(copy.getLen() == 3);
+  assert(copy[1].isSame("World"));
+
+  // Arrays of small arrays
+  SmallDynamicArray<SmallDynamicArray<int, 2>, 2> nested =
+      SmallDynamicArray<SmallDynamicArray<int, 2>, 2>();
+  for (int i = 0; i < 10; i++) {
+    nested.emplace().push(i);
+    Error::checkError();
+  }
+  for (int i = 0; i < 10; i++) {
+    assert(nested[i].isInline());
+    assert(nested[i][0] == i);
+  }
+}
+
+void extendTest(void) {
+  SmallDynamicArray<int, 4> arr = SmallDynamicArray<int, 4>({1, 2, 3});
+  Error::checkError();
+
+  // Extending from the array itself works across the spill
+  arr.extend(arr.getRaw(), 3);
+  Error::checkError();
+  assert(!arr.isInline());
+  assert(arr.getLen() == 6);
+  for (int i = 0; i < 6; i++) {
+    assert(arr[i] == i % 3 + 1);
+  }
+
+  SmallDynamicArray<String, 2> strs = SmallDynamicArray<String, 2>();
+  strs.emplace("Hello");
+  strs.emplace("World");
+  strs.extend(strs.getRaw(), 2);
+  Error::checkError();
+  assert(strs.getLen() == 4);
+  assert(strs[2].isSame("Hello") && strs[3].isSame("World"));
+
+  arr.extend(nullptr, 1);
+  assert(Error::isError());
+}
+
+int main(void) {
+  pushTest();
+  insertRemoveTest();
+  moveTest();
+  extendTest();
+}
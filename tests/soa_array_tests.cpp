@@ -0,0 +1,145 @@
+#include "bl/ds/soa_array.h"
+#include "bl/error.h"
+#include "bl/mem/tracking_allocator.h"
+#include "bl/primitives.h"
+
+#include <cassert>
+#include <cstdint>
+#include <tuple>
+#include <utility>
+
+using namespace bl;
+using namespace bl::ds;
+
+typedef SoaArray<u64, f32, u8> Records;
+
+void pushTest(void) {
+  mem::TrackingAllocator tracker = mem::TrackingAllocator();
+  {
+    Records arr = Records(&tracker);
+    Error::checkError();
+    assert(arr.isEmpty());
+    assert(tracker.getStats().allocs == 0);
+
+    for (u64 i = 0; i < 100; i++) {
+      arr.push(i, (f32)i / 2, (u8)(i % 3));
+      Error::checkError();
+    }
+    assert(arr.getLen() == 100);
+    assert(arr.getCap() == 128);
+
+    // Every column is a separate, aligned buffer from the same allocator
+    assert(tracker.getStats().live_bytes ==
+           128 * (sizeof(u64) + sizeof(f32) + sizeof(u8)));
+    assert((uintptr_t)arr.getColumn<0>().begin() % 64 == 0);
+    assert((uintptr_t)arr.getColumn<1>().begin() % 64 == 0);
+    assert((uintptr_t)arr.getColumn<2>().begin() % 64 == 0);
+
+    for (usize i = 0; i < 100; i++) {
+      assert(arr.get<0>(i) == i);
+      assert(arr.get<1>(i) == (f32)i / 2);
+      assert(arr.get<2>(i) == i % 3);
+    }
+    assert(arr.getRow(42) == Records::Row(42, 21.0f, 0));
+
+    arr.get<1>(3) = -1.0f;
+    assert(std::get<1>(arr.getRow(3)) == -1.0f);
+
+    // Fields of the array itself can be pushed, even when it grows
+    arr.reserve(arr.getLen());
+    arr.resizeTo(arr.getCap());
+    arr.push(arr.get<0>(5), arr.get<1>(5), arr.get<2>(5));
+    Error::checkError();
+    assert(arr.getRow(128) == Records::Row(5, 2.5f, 2));
+    assert(arr.getRow(127) == Records::Row(0, 0.0f, 0));
+  }
+  assert(tracker.getStats().live_bytes == 0);
+
+  Records invalid = Records(nullptr);
+  assert(Error::isError());
+}
+
+void columnTest(void) {
+  Records arr = Records(1000);
+  Error::checkError();
+  assert(arr.getCap() == 1000);
+  arr.resizeTo(1000);
+  Error::checkError();
+
+  // Columns can be filled and scanned on their own
+  Span<u64> ids = arr.getColumn<0>();
+  for (usize i = 0; i < ids.getLen(); i++) {
+    ids[i] = i;
+  }
+  for (f32& score : arr.getColumn<1>()) {
+    score = 1.5f;
+  }
+
+  const Records& view  = arr;
+  f32            total = 0.0f;
+  for (f32 score : view.getColumn<1>()) {
+    total += score;
+  }
+  assert(total == 1500.0f);
+  assert(view.getColumn<0>()[999] == 999);
+  assert(view.getColumn<2>().getLen() == 1000);
+
+  arr.clear();
+  assert(arr.isEmpty() && arr.getCap() == 1000);
+  assert(arr.getColumn<0>().getLen() == 0);
+}
+
+void swapRemoveTest(void) {
+  SoaArray<int, u16> arr = SoaArray<int, u16>();
+  for (int i = 0; i < 5; i++) {
+    arr.push(i, (u16)(i * 10));
+  }
+
+  // The last row replaces the removed one, in every column
+  arr.swapRemove(1);
+  assert(arr.getLen() == 4);
+  assert(arr.get<0>(1) == 4 && arr.get<1>(1) == 40);
+  assert(arr.get<0>(3) == 3 && arr.get<1>(3) == 30);
+
+  arr.swapRemove(3);
+  assert(arr.getLen() == 3);
+  assert(arr.get<0>(2) == 2 && arr.get<1>(2) == 20);
+}
+
+void copyMoveTest(void) {
+  mem::TrackingAllocator tracker = mem::TrackingAllocator();
+  {
+    Records arr = Records(&tracker);
+    for (u64 i = 0; i < 10; i++) {
+      arr.push(i, (f32)i, (u8)i);
+    }
+
+    Records copy = arr;
+    Error::checkError();
+    assert(copy.getLen() == 10 && copy.getCap() == 10);
+    copy.get<0>(0) = 100;
+    assert(arr.get<0>(0) == 0);
+
+    Records moved = std::move(arr);
+    assert(arr.isEmpty() && arr.getCap() == 0);
+    assert(moved.getLen() == 10 && moved.get<2>(9) == 9);
+
+    arr = moved;
+    assert(arr.getRow(9) == moved.getRow(9));
+    moved = std::move(copy);
+    assert(moved.get<0>(0) == 100);
+    assert(copy.getLen() == 0);
+
+    // Moved-from arrays can be reused
+    copy.push(1, 1.0f, 1);
+    assert(copy.getLen() == 1);
+  }
+  assert(tracker.getStats().live_bytes == 0);
+}
+
+int main(void) {
+  pushTest();
+  columnTest();
+  swapRemoveTest();
+  copyMoveTest();
+}
@@ -0,0 +1,218 @@
+#include "bl/ds/dynamic_array.h"
+#include "bl/ds/sort.h"
+#include "bl/ds/span.h"
+#include "bl/mem/tracking_allocator.h"
+#include "bl/primitives.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+using namespace bl;
+using namespace bl::ds;
+
+/// Returns the next pseudo-random number.
+u64 nextRandom(u64& seed) {
+  seed = seed * 6364136223846793005ull + 1442695040888963407ull;
+  return seed >> 16;
+}
+
+/// Checks `ds::sort` against `std::sort` (by bits, so `-0.0` and `0.0` are
+/// told apart) for several lengths around the radix sort threshold.
+template <typename T> void checkSort(u64 seed) {
+  const usize THRESHOLD = sort_internal::RADIX_THRESHOLD_PER_BYTE * sizeof(T);
+  const usize LENS[]    = {
+      0, 1, 2, 50, THRESHOLD - 1, THRESHOLD, THRESHOLD + 1, 20000};
+  for (usize len : LENS) {
+    DynamicArray<T> arr = DynamicArray<T>();
+    for (usize i = 0; i < len; i++) {
+      u64 bits = nextRandom(seed) * 0x9E3779B97F4A7C15ull;
+      T   elem;
+      if constexpr (std::is_floating_point<T>::value) {
+        elem = (T)((i64)(bits % 2001) - 1000) / 8;
+      } else {
+        memcpy(&elem, &bits, sizeof(T));
+      }
+      arr.push(elem);
+    }
+
+    DynamicArray<T> expected = arr;
+    std::sort(expected.begin(), expected.end(), [](T a, T b) {
+      return sort_internal::toRadix(a) < sort_internal::toRadix(b);
+    });
+    sort(arr);
+    assert(len == 0 ||
+           memcmp(arr.begin(), expected.begin(), len * sizeof(T)) == 0);
+  }
+}
+
+void radixSortTest(void) {
+  checkSort<u8>(1);
+  checkSort<i16>(2);
+  checkSort<u32>(3);
+  checkSort<i32>(4);
+  checkSort<u64>(5);
+  checkSort<i64>(6);
+  checkSort<f32>(7);
+  checkSort<f64>(8);
+
+  // Signed zeros, infinities and extremes
+  DynamicArray<f32> floats = {0.0f, -1.5f, 1e30f, -0.0f, -1e30f, 2.0f};
+  floats.resizeTo(5000, 1.0f);
+  sort(floats);
+  assert(floats[0] == -1e30f && floats[1] == -1.5f);
+  assert(std::signbit(floats[2]) && !std::signbit(floats[3]));
+  assert(floats[4999] == 1e30f && floats[4998] == 2.0f);
+
+  DynamicArray<i64> ints = DynamicArray<i64>();
+  for (i64 i = 0; i < 5000; i++) {
+    ints.push(i % 3 == 0 ? INT64_MIN + i : INT64_MAX - i + 1);
+  }
+  sort(ints);
+  assert(ints[0] == INT64_MIN && ints[4999] == INT64_MAX);
+  assert(std::is_sorted(ints.begin(), ints.end()));
+}
+
+void comparisonSortTest(void) {
+  // Random, sorted, reversed, duplicate-heavy and organ-pipe inputs
+  for (usize pattern = 0; pattern < 5; pattern++) {
+    u64                             seed = pattern + 1;
+    DynamicArray<DynamicArray<int>> arr  = DynamicArray<DynamicArray<int>>();
+    for (usize i = 0; i < 3000; i++) {
+      int val = 0;
+      switch (pattern) {
+      case 0:
+        val = (int)(nextRandom(seed) % 100000);
+        break;
+      case 1:
+        val = (int)i;
+        break;
+      case 2:
+        val = (int)(3000 - i);
+        break;
+      case 3:
+        val = (int)(nextRandom(seed) % 4);
+        break;
+      case 4:
+        val = (int)(i < 1500 ? i : 3000 - i);
+        break;
+      }
+      arr.push(DynamicArray<int>{val, (int)i});
+    }
+
+    // Descending by the first element
+    sort(arr, [](const DynamicArray<int>& a, const DynamicArray<int>& b) {
+      return a[0] > b[0];
+    });
+    for (usize i = 1; i < arr.getLen(); i++) {
+      assert(arr[i - 1][0] >= arr[i][0]);
+      assert(arr[i].getLen() == 2);
+    }
+  }
+
+  // Elements without a radix key use `<`
+  DynamicArray<bool> flags = {true, false, true, false};
+  sort(flags);
+  assert(!flags[0] && !flags[1] && flags[2] && flags[3]);
+
+  // Many bad pivots fall back to heapsort
+  DynamicArray<int> ints = DynamicArray<int>();
+  for (int i = 0; i < 5000; i++) {
+    ints.push(i % 2 == 0 ? i : 5000 - i);
+  }
+  sort(ints, [](int a, int b) { return a < b; });
+  assert(std::is_sorted(ints.begin(), ints.end()));
+}
+
+void sortByKeyTest(void) {
+  struct Pair {
+    u32 key;
+    u32 value;
+  };
+
+  // Short (comparison) and long (radix) arrays are both stable
+  const usize LENS[] = {100, 5000};
+  for (usize len : LENS) {
+    u64                seed  = len;
+    DynamicArray<Pair> pairs = DynamicArray<Pair>();
+    for (usize i = 0; i < len; i++) {
+      pairs.push(Pair{(u32)(nextRandom(seed) % 16), (u32)i});
+    }
+
+    sortByKey(pairs, [](const Pair& pair) { return pair.key; });
+    for (usize i = 1; i < len; i++) {
+      assert(pairs[i - 1].key <= pairs[i].key);
+      if (pairs[i - 1].key == pairs[i].key) {
+        assert(pairs[i - 1].value < pairs[i].value);
+      }
+    }
+  }
+
+  // Floating-point keys
+  DynamicArray<Pair> pairs = DynamicArray<Pair>();
+  for (u32 i = 0; i < 500; i++) {
+    pairs.push(Pair{i, i});
+  }
+  sortByKey(pairs, [](const Pair& pair) { return -(f32)pair.value; });
+  assert(pairs[0].value == 499 && pairs[499].value == 0);
+}
+
+void spanTest(void) {
+  DynamicArray<i32> arr = DynamicArray<i32>();
+  for (i32 i = 0; i < 1000; i++) {
+    arr.push(1000 - i);
+  }
+
+  // Only the subrange is sorted
+  sort(arr.getSpan().subspan(100, 500));
+  assert(arr[0] == 1000 && arr[99] == 901);
+  assert(arr[100] == 401 && arr[599] == 900);
+  assert(arr[600] == 400);
+
+  sort(arr.getSpan().subspan(0, 10), [](i32 a, i32 b) { return a < b; });
+  assert(arr[0] == 991 && arr[9] == 1000);
+
+  sortByKey(arr.getSpan(), [](i32 elem) { return elem; });
+  for (i32 i = 0; i < 1000; i++) {
+    assert(arr[i] == i + 1);
+  }
+}
+
+void allocatorTest(void) {
+  mem::TrackingAllocator tracker = mem::TrackingAllocator();
+  {
+    DynamicArray<u32> arr = DynamicArray<u32>(&tracker);
+    for (u32 i = 0; i < 10000; i++) {
+      arr.push(10000 - i);
+    }
+
+    // The scratch buffer comes from the array's allocator, and is freed
+    mem::TrackingAllocator::Stats before = tracker.getStats();
+    sort(arr);
+    mem::TrackingAllocator::Stats after  = tracker.getStats();
+    assert(after.allocs == before.allocs + 1);
+    assert(after.live_bytes == before.live_bytes);
+    assert(after.peak_bytes >= before.live_bytes + 10000 * sizeof(u32));
+    assert(arr[0] == 1 && arr[9999] == 10000);
+
+    // Sorted and short arrays don't allocate
+    before = tracker.getStats();
+    sort(arr);
+    arr.resizeTo(10, 0);
+    arr[0] = 5;
+    sort(arr);
+    assert(tracker.getStats().allocs == before.allocs);
+    assert(arr[0] == 2 && arr[3] == 5 && arr[4] == 5 && arr[9] == 10);
+  }
+  assert(tracker.getStats().live_bytes == 0);
+}
+
+int main(void) {
+  radixSortTest();
+  comparisonSortTest();
+  sortByKeyTest();
+  spanTest();
+  allocatorTest();
+}
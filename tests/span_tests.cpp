@@ -0,0 +1,106 @@
+#include "bl/ds/dynamic_array.h"
+#include "bl/ds/small_dynamic_array.h"
+#include "bl/ds/span.h"
+#include "bl/error.h"
+#include "bl/primitives.h"
+
+#include <algorithm>
+#include <cassert>
+#include <numeric>
+
+using namespace bl;
+using namespace bl::ds;
+
+/// Sums up the elements of the given span.
+int sum(Span<const int> span) {
+  int total = 0;
+  for (int val : span) {
+    total += val;
+  }
+  return total;
+}
+
+void iteratorTest(void) {
+  DynamicArray<int> arr = DynamicArray<int>({5, 3, 1, 4, 2});
+  Error::checkError();
+
+  int total = 0;
+  for (int val : arr) {
+    total += val;
+  }
+  assert(total == 15);
+
+  // Works with `<algorithm>`
+  std::sort(arr.begin(), arr.end());
+  for (int i = 0; i < 5; i++) {
+    assert(arr[i] == i + 1);
+  }
+  assert(std::accumulate(arr.begin(), arr.end(), 0) == 15);
+
+  const DynamicArray<int>& ref = arr;
+  assert(std::find(ref.begin(), ref.end(), 4) == ref.begin() + 3);
+
+  SmallDynamicArray<int, 4> small = SmallDynamicArray<int, 4>({3, 2, 1});
+  std::sort(small.begin(), small.end());
+  assert(small[0] == 1 && small[2] == 3);
+}
+
+void spanTest(void) {
+  DynamicArray<int> arr  = DynamicArray<int>({1, 2, 3, 4, 5});
+  Span<int>         span = arr.getSpan();
+  assert(span.getLen() == 5);
+  assert(span.getRaw() == arr.getRaw());
+  assert(span.getSizeBytes() == 5 * sizeof(int));
+
+  // Spans write through to the array
+  span[0]              = 10;
+  span.getUnchecked(1) = 20;
+  assert(arr[0] == 10 && arr[1] == 20);
+
+  // Read-only spans can be made from mutable ones and C arrays
+  assert(sum(span) == 42);
+  assert(sum(arr.getSpan()) == 42);
+  int raw[] = {1, 2, 3};
+  assert(sum(raw) == 6);
+  assert(sum(Span<const int>()) == 0);
+}
+
+void sliceTest(void) {
+  int       raw[] = {0, 1, 2, 3, 4, 5, 6, 7};
+  Span<int> span  = Span<int>(raw);
+
+  Span<int> mid   = span.slice(2, 5);
+  Error::checkError();
+  assert(mid.getLen() == 3);
+  assert(mid[0] == 2 && mid[2] == 4);
+
+  Span<int> sub = mid.subspan(1, 2);
+  Error::checkError();
+  assert(sub.getLen() == 2);
+  assert(sub[0] == 3 && sub[1] == 4);
+
+  Span<int> tail = span.subspan(6);
+  Error::checkError();
+  assert(tail.getLen() == 2 && tail[1] == 7);
+
+  assert(span.slice(8, 8).isEmpty());
+  Error::checkError();
+  assert(span.subspan(8).isEmpty());
+  Error::checkError();
+
+  // Out of bounds ranges are errors
+  assert(span.slice(5, 2).isEmpty());
+  assert(Error::isError());
+  assert(span.slice(0, 9).isEmpty());
+  assert(Error::isError());
+  assert(mid.subspan(2, 2).isEmpty());
+  assert(Error::isError());
+  assert(span.subspan(9).isEmpty());
+  assert(Error::isError());
+}
+
+int main(void) {
+  iteratorTest();
+  spanTest();
+  sliceTest();
+}
@@ -1,12 +1,15 @@
 #include "bl/error.h"
 #include "bl/mem/allocator.h"
 #include "bl/mem/c_allocator.h"
+#include "bl/mem/tracking_allocator.h"
 #include "bl/primitives.h"
 #include "bl/string.h"
+#include "bl/string_view.h"
 
 #include <cassert>
 #include <cstdio>
 #include <cstring>
+#include <utility>
 
 using namespace bl;
 
@@ -18,13 +21,13 @@ void pushTest(void) {
   Error::checkError();
   assert(str.isSame("Hello "));
   assert(str.getLen() == 6);
-  assert(str.getCap() == 10);
+  assert(str.getCap() == String::INLINE_CAP);
 
   str.push("World!");
   Error::checkError();
   assert(str.isSame("Hello World!"));
   assert(str.getLen() == 12);
-  assert(str.getCap() == 20);
+  assert(str.getCap() == String::INLINE_CAP);
 }
 
 void popTest(void) {
@@ -47,19 +50,34 @@ void insertTest(void) {
   Error::checkError();
   assert(str.isSame("OHello"));
   assert(str.getLen() == 6);
-  assert(str.getCap() == 10);
+  assert(str.getCap() == String::INLINE_CAP);
 
-  str.insert(5, '!');
+  str.insert(6, '!');
   Error::checkError();
   assert(str.isSame("OHello!"));
   assert(str.getLen() == 7);
-  assert(str.getCap() == 10);
+  assert(str.getCap() == String::INLINE_CAP);
 
   str.insert(1, 'y');
   Error::checkError();
   assert(str.isSame("OyHello!"));
   assert(str.getLen() == 8);
-  assert(str.getCap() == 10);
+  assert(str.getCap() == String::INLINE_CAP);
+
+  // Inserting before the last character shifts it
+  String abc = String("abc");
+  abc.insert(2, 'X');
+  Error::checkError();
+  assert(abc.isSame("abXc"));
+
+  abc.insert(5, 'Y');
+  assert(Error::isError());
+  assert(abc.isSame("abXc"));
+
+  String empty = String();
+  empty.insert(0, 'a');
+  Error::checkError();
+  assert(empty.isSame("a"));
 }
 
 void insertStrTest(void) {
@@ -70,19 +88,38 @@ void insertStrTest(void) {
   Error::checkError();
   assert(str.isSame("Oy Hello"));
   assert(str.getLen() == 8);
-  assert(str.getCap() == 10);
+  assert(str.getCap() == String::INLINE_CAP);
 
-  str.insert(7, " You!");
+  str.insert(8, " You!");
   Error::checkError();
   assert(str.isSame("Oy Hello You!"));
   assert(str.getLen() == 13);
-  assert(str.getCap() == 20);
+  assert(str.getCap() == String::INLINE_CAP);
 
   str.insert(9, "There ");
   Error::checkError();
   assert(str.isSame("Oy Hello There You!"));
   assert(str.getLen() == 19);
-  assert(str.getCap() == 20);
+  assert(str.getCap() == String::INLINE_CAP);
+
+  str.insert(3, "");
+  Error::checkError();
+  assert(str.isSame("Oy Hello There You!"));
+
+  String abc = String("abc");
+  abc.insert(2, "XY");
+  Error::checkError();
+  assert(abc.isSame("abXYc"));
+  abc.insert(6, "Z");
+  assert(Error::isError());
+
+  // Inserting more than the string grows by resizes once, to fit
+  str.insert(3, "Hello Hello Hello Hello Hello Hello Hello Hello Hello ");
+  Error::checkError();
+  assert(str.isSame("Oy Hello Hello Hello Hello Hello Hello Hello Hello Hello "
+                    "Hello There You!"));
+  assert(str.getLen() == 73);
+  assert(str.getCap() == 73);
 }
 
 void removeTest(void) {
@@ -112,7 +149,7 @@ void containsTest(void) {
   String str = String("Hello");
   Error::checkError();
 
-  i32 found = str.find("Hell");
+  usize found = str.find("Hell");
   Error::checkError();
   assert(found == 0);
 
@@ -122,23 +159,47 @@ void containsTest(void) {
 
   found = str.find("Bye");
   Error::checkError();
-  assert(found == -1);
+  assert(found == StringView::NOT_FOUND);
+
+  // Searches don't stop at embedded null characters
+  str.push('\0');
+  str.push("lo");
+  assert(str.find(StringView("\0lo", 3)) == 5);
+  assert(str.findFrom("lo", 4) == 6);
+  assert(str.rfind("lo") == 6);
+  assert(str.count("lo") == 2);
+  usize total = 0;
+  for (usize idx : str.findAll("lo")) {
+    total += idx;
+  }
+  assert(total == 3 + 6);
 }
 
 void shrinkTest(void) {
-  String str = String("Hello");
+  String str = String("Hello, this string is too long to be inline");
   Error::checkError();
-  assert(str.getCap() == 5);
+  assert(str.getCap() == 43);
 
-  str.pop();
-  str.pop();
+  for (int i = 0; i < 10; i++) {
+    str.pop();
+  }
   Error::checkError();
-  assert(str.getCap() == 5);
+  assert(str.getCap() == 43);
 
   str.shrinkToFit();
   Error::checkError();
-  assert(str.getCap() == 3);
-  assert(str.isSame("Hel"));
+  assert(str.getCap() == 33);
+  assert(str.isSame("Hello, this string is too long to"));
+
+  // Short contents move back into the inline buffer
+  for (int i = 0; i < 28; i++) {
+    str.pop();
+  }
+  str.shrinkToFit();
+  Error::checkError();
+  assert(str.isInline());
+  assert(str.getCap() == String::INLINE_CAP);
+  assert(strcmp(str.getRaw(), "Hello") == 0);
 }
 
 void splitTest(void) {
@@ -149,12 +210,32 @@ void splitTest(void) {
   Error::checkError();
 
   assert(str.getLen() == 3);
-  assert(str.getCap() == 5);
+  assert(str.getCap() == String::INLINE_CAP);
   assert(str.isSame("Hel"));
 
   assert(split.getLen() == 2);
-  assert(split.getCap() == 2);
+  assert(split.isInline());
   assert(split.isSame("lo"));
+
+  // Long strings split into heap and inline parts
+  String long_str   = String("abcdefghijklmnopqrstuvwxyz0123456789");
+  String long_split = long_str.split(4);
+  Error::checkError();
+  assert(strcmp(long_str.getRaw(), "abcd") == 0);
+  assert(!long_str.isInline());
+  assert(strcmp(long_split.getRaw(), "efghijklmnopqrstuvwxyz0123456789") == 0);
+  assert(!long_split.isInline());
+
+  String last = long_split.split(long_split.getLen() - 1);
+  assert(strcmp(last.getRaw(), "9") == 0 && last.isInline());
+  assert(long_split.getLen() == 31);
+
+  String all = long_str.split(0);
+  assert(long_str.isEmpty() && strcmp(long_str.getRaw(), "") == 0);
+  assert(strcmp(all.getRaw(), "abcd") == 0);
+
+  long_str.split(0);
+  assert(Error::isError());
 }
 
 void indexTest(void) {
@@ -166,6 +247,275 @@ void indexTest(void) {
   assert(str[2] == 'l');
   assert(str[3] == 'l');
   assert(str[4] == 'o');
+
+  str.at(0)           = 'J';
+  str.getUnchecked(4) = 'y';
+  assert(str.isSame("Jelly"));
+}
+
+void inlineTest(void) {
+  mem::TrackingAllocator tracker = mem::TrackingAllocator();
+  {
+    // Short strings never allocate, and are always null-terminated
+    String str = String(&tracker);
+    assert(str.isInline() && strcmp(str.getRaw(), "") == 0);
+    for (usize i = 0; i < String::INLINE_CAP; i++) {
+      str.push('a');
+      Error::checkError();
+    }
+    assert(str.isInline());
+    assert(strlen(str.getRaw()) == String::INLINE_CAP);
+    assert(tracker.getStats().allocs == 0);
+
+    String copy = str;
+    String key  = String(&tracker, "abc");
+    assert(copy.isInline() && key.isInline());
+    assert(tracker.getStats().allocs == 0);
+
+    // The first character past the inline buffer spills to the allocator
+    str.push('b');
+    Error::checkError();
+    assert(!str.isInline());
+    assert(tracker.getStats().allocs == 1);
+    assert(str.getLen() == String::INLINE_CAP + 1);
+    assert(str.getRaw()[String::INLINE_CAP] == 'b');
+    assert(str.getRaw()[String::INLINE_CAP + 1] == '\0');
+
+    // Inserting past the inline buffer spills too
+    key.insert(1, "0123456789012345678901234");
+    Error::checkError();
+    assert(!key.isInline());
+    assert(strcmp(key.getRaw(), "a0123456789012345678901234bc") == 0);
+    key.remove(0);
+    assert(strcmp(key.getRaw(), "0123456789012345678901234bc") == 0);
+
+    // Pushing a string's own contents
+    copy.push(copy.getRaw());
+    Error::checkError();
+    assert(copy.getLen() == 2 * String::INLINE_CAP);
+    assert(copy.find("aab") == StringView::NOT_FOUND);
+
+    // Moves take over heap buffers, and copy inline contents
+    String moved = std::move(str);
+    assert(str.isEmpty() && str.isInline());
+    assert(moved.getLen() == String::INLINE_CAP + 1 && !moved.isInline());
+    String short_moved = String(&tracker, "short");
+    String target      = String(&tracker, "target");
+    target             = std::move(short_moved);
+    assert(strcmp(target.getRaw(), "short") == 0 && target.isInline());
+    target = moved;
+    assert(target.isSame(&moved) && !target.isInline());
+    str = String(&tracker, "reused");
+    assert(strcmp(str.getRaw(), "reused") == 0);
+  }
+  assert(tracker.getStats().live_bytes == 0);
+}
+
+void appendTest(void) {
+  mem::TrackingAllocator tracker = mem::TrackingAllocator();
+  {
+    String str = String(&tracker);
+    str.append("Hello, World", 5);
+    Error::checkError();
+    assert(str.isSame("Hello"));
+    assert(tracker.getStats().allocs == 0);
+
+    // Long appends grow the buffer once
+    char chunk[1000];
+    memset(chunk, 'x', sizeof(chunk));
+    str.append(chunk, sizeof(chunk));
+    Error::checkError();
+    assert(str.getLen() == 1005);
+    assert(str.getCap() == 1005);
+    assert(str.getRaw()[1005] == '\0');
+    assert(tracker.getStats().allocs == 1);
+
+    str.append(StringView(" and more"));
+    Error::checkError();
+    assert(str.getView().endsWith("xx and more"));
+
+    String other = String(&tracker, "!");
+    str.append(other);
+    Error::checkError();
+    assert(str.getLen() == 1015);
+    assert(str[1014] == '!');
+
+    // The string can be appended to itself
+    String copy = String(&tracker, "abcdefghijklmnopqrstuvw");
+    assert(copy.isInline());
+    copy.append(copy);
+    Error::checkError();
+    assert(copy.isSame("abcdefghijklmnopqrstuvwabcdefghijklmnopqrstuvw"));
+    copy.append(copy.getRaw() + 1, 2);
+    Error::checkError();
+    assert(copy.getView().endsWith("uvwbc"));
+
+    str.append(nullptr, 0);
+    Error::checkError();
+    assert(str.getLen() == 1015);
+    str.append(nullptr, 1);
+    assert(Error::isError());
+    assert(str.getLen() == 1015);
+  }
+  assert(tracker.getStats().live_bytes == 0);
+}
+
+void reserveTest(void) {
+  mem::TrackingAllocator tracker = mem::TrackingAllocator();
+  {
+    String str = String(&tracker, "Hello");
+    str.reserve(10);
+    Error::checkError();
+    assert(str.isInline());
+    assert(tracker.getStats().allocs == 0);
+
+    // Reserving grows to exactly the requested capacity
+    str.reserve(100);
+    Error::checkError();
+    assert(!str.isInline());
+    assert(str.getCap() == 100);
+    assert(str.isSame("Hello"));
+
+    for (usize i = 0; i < 19; i++) {
+      str.append("abcde", 5);
+    }
+    assert(str.getLen() == 100);
+    assert(tracker.getStats().allocs == 1);
+
+    str.reserve(50);
+    Error::checkError();
+    assert(str.getCap() == 100);
+
+    // Heap buffers are resized by the allocator instead of being reallocated
+    // and copied
+    str.append("!", 1);
+    Error::checkError();
+    assert(str.getCap() == 200);
+    assert(str.getView().endsWith("abcde!"));
+    assert(tracker.getStats().allocs == 1);
+    assert(tracker.getStats().resizes == 1);
+  }
+  assert(tracker.getStats().live_bytes == 0);
+}
+
+void replaceRangeTest(void) {
+  mem::TrackingAllocator tracker = mem::TrackingAllocator();
+  {
+    String str = String(&tracker, "Hello {name}!");
+    str.replaceRange(6, 12, "World");
+    Error::checkError();
+    assert(str.isSame("Hello World!"));
+    assert(str.isInline());
+
+    // Growing past the capacity resizes once
+    str.replaceRange(0, 5, "Goodbye, cruel and unforgiving");
+    Error::checkError();
+    assert(str.isSame("Goodbye, cruel and unforgiving World!"));
+    assert(tracker.getStats().allocs == 1);
+
+    str.replaceRange(str.getLen(), str.getLen(), "!!");
+    Error::checkError();
+    assert(str.getView().endsWith("World!!!"));
+
+    // Replacements can come from the string itself
+    str.replaceRange(0, 7, str.slice(31, 36));
+    Error::checkError();
+    assert(str.isSame("World, cruel and unforgiving World!!!"));
+    str.replaceRange(5, 5, str.getView());
+    Error::checkError();
+    assert(str.isSame("WorldWorld, cruel and unforgiving World!!!, cruel and "
+                      "unforgiving World!!!"));
+
+    str.replaceRange(3, 2, "x");
+    assert(Error::isError());
+    str.replaceRange(0, str.getLen() + 1, "x");
+    assert(Error::isError());
+
+    str.eraseRange(5, str.getLen() - 3);
+    Error::checkError();
+    assert(str.isSame("World!!!"));
+    str.eraseRange(0, 0);
+    Error::checkError();
+    assert(str.isSame("World!!!"));
+    str.eraseRange(0, str.getLen());
+    Error::checkError();
+    assert(str.isEmpty() && str.getRaw()[0] == '\0');
+    str.eraseRange(0, 1);
+    assert(Error::isError());
+
+    // Inline strings stay inline
+    String small = String(&tracker, "abcdef");
+    small.replaceRange(1, 3, small.slice(3, 6));
+    Error::checkError();
+    assert(small.isSame("adefdef"));
+    assert(small.isInline());
+  }
+  assert(tracker.getStats().live_bytes == 0);
+}
+
+void replaceAllTest(void) {
+  mem::TrackingAllocator tracker = mem::TrackingAllocator();
+  {
+    String str = String(&tracker, "<p>{x} + {x} = {y}</p>");
+    assert(str.replaceAll("{x}", "1") == 2);
+    Error::checkError();
+    assert(str.isSame("<p>1 + 1 = {y}</p>"));
+    assert(str.replaceAll("{y}", "") == 1);
+    assert(str.isSame("<p>1 + 1 = </p>"));
+    assert(str.replaceAll("{z}", "3") == 0);
+    assert(str.replaceAll("", "3") == 0);
+    Error::checkError();
+
+    // Growing replacements resize once
+    assert(str.replaceAll("1", "one hundred") == 2);
+    Error::checkError();
+    assert(str.isSame("<p>one hundred + one hundred = </p>"));
+    assert(tracker.getStats().allocs == 1);
+
+    // Occurrences don't overlap
+    String repeated = String(&tracker, "aaaaa");
+    assert(repeated.replaceAll("aa", "b") == 2);
+    assert(repeated.isSame("bba"));
+    assert(repeated.replaceAll("b", "bb") == 2);
+    assert(repeated.isSame("bbbba"));
+
+    // Replacements can come from the string itself
+    String self = String(&tracker, "x-y-z");
+    assert(self.replaceAll("-", self.getView()) == 2);
+    Error::checkError();
+    assert(self.isSame("xx-y-zyx-y-zz"));
+    assert(self.replaceAll("x", self.slice(3, 4)) == 3);
+    assert(self.isSame("yy-y-zyy-y-zz"));
+
+    // So can needles (which must not be overwritten while they're searched)
+    String abab = String(&tracker, "abab");
+    assert(abab.replaceAll(abab.slice(0, 2), "x") == 2);
+    Error::checkError();
+    assert(abab.isSame("xx"));
+    String words = String(&tracker, "hello world hello world hello world");
+    assert(words.replaceAll(words.slice(0, 5), "hi") == 3);
+    assert(words.isSame("hi world hi world hi world"));
+
+    // Replacements that fit don't grow the capacity (aliased or not)
+    String grown = String(&tracker, "abracadabra, abracadabra and abracadabra!");
+    assert(grown.replaceAll("a", "aaaa") == 16);
+    assert(grown.replaceAll("aaaa", "aa") == 16);
+    usize cap = grown.getCap();
+    for (int i = 0; i < 12; i++) {
+      assert(grown.replaceAll("aa", "a") == 16);
+      assert(grown.replaceAll("a", "aa") == 16);
+      Error::checkError();
+      grown.replaceRange(0, 4, grown.slice(0, 4));
+      Error::checkError();
+      assert(grown.replaceAll(grown.slice(1, 2), grown.slice(0, 2)) == 32);
+      assert(grown.replaceAll("aaaa", "aa") == 16);
+      Error::checkError();
+    }
+    assert(grown.isSame("aabraacaadaabraa, aabraacaadaabraa aand "
+                        "aabraacaadaabraa!"));
+    assert(grown.getCap() == cap);
+  }
+  assert(tracker.getStats().live_bytes == 0);
 }
 
 int main(void) {
@@ -178,4 +528,9 @@ int main(void) {
   shrinkTest();
   splitTest();
   indexTest();
+  inlineTest();
+  appendTest();
+  reserveTest();
+  replaceRangeTest();
+  replaceAllTest();
 }
@@ -0,0 +1,310 @@
+#include "bl/ds/search.h"
+#include "bl/error.h"
+#include "bl/mem/tracking_allocator.h"
+#include "bl/primitives.h"
+#include "bl/string.h"
+#include "bl/string_view.h"
+
+#include <cassert>
+#include <cstdlib>
+#include <cstring>
+#include <unordered_map>
+
+using namespace bl;
+
+void createTest(void) {
+  StringView empty = StringView();
+  assert(empty.isEmpty() && empty.getLen() == 0);
+
+  StringView view = StringView("Hello World");
+  Error::checkError();
+  assert(view.getLen() == 11);
+  assert(view[0] == 'H' && view.at(10) == 'd');
+
+  usize n = 0;
+  for (char chr : view) {
+    assert(chr == view.getUnchecked(n));
+    n++;
+  }
+  assert(n == 11);
+
+  StringView invalid = StringView(static_cast<const_cstr>(nullptr));
+  assert(Error::isError());
+  assert(invalid.isEmpty());
+}
+
+void sliceTest(void) {
+  const_cstr text  = "GET /index.html HTTP/1.1";
+  StringView view  = StringView(text);
+
+  // Slices point into the original characters
+  StringView path  = view.slice(4, 15);
+  Error::checkError();
+  assert(path == "/index.html");
+  assert(path.getRaw() == text + 4);
+
+  StringView empty = view.slice(24, 24);
+  Error::checkError();
+  assert(empty.isEmpty());
+
+  StringView invalid = view.slice(5, 25);
+  assert(Error::isError());
+  assert(invalid.isEmpty());
+  view.slice(5, 4);
+  assert(Error::isError());
+}
+
+void findTest(void) {
+  StringView view = StringView("abcabcabd");
+  assert(view.find("abd") == 6);
+  assert(view.find("abc") == 0);
+  assert(view.find("bca") == 1);
+  assert(view.find("abe") == StringView::NOT_FOUND);
+  assert(view.find("abcabcabdx") == StringView::NOT_FOUND);
+  assert(view.find("") == 0);
+  assert(view.find('c') == 2);
+  assert(view.find('z') == StringView::NOT_FOUND);
+  assert(StringView().find('a') == StringView::NOT_FOUND);
+
+  // Matches must lie within the view, even if the buffer continues
+  StringView prefix = view.slice(0, 7);
+  assert(prefix.find("abd") == StringView::NOT_FOUND);
+  assert(prefix.find('d') == StringView::NOT_FOUND);
+
+  assert(view.startsWith("abca") && view.startsWith(""));
+  assert(!view.startsWith("abd") && !prefix.startsWith("abcabcabd"));
+  assert(view.endsWith("abd") && view.endsWith(view));
+  assert(!view.endsWith("abc") && !prefix.endsWith("xabcabca"));
+}
+
+/// Returns the index of the first (or last) occurrence of `needle` in `hay`
+/// by comparing at every index.
+usize naiveFind(StringView hay, StringView needle, bool last) {
+  usize found = StringView::NOT_FOUND;
+  for (usize i = 0; i + needle.getLen() <= hay.getLen(); i++) {
+    if (hay.slice(i, i + needle.getLen()) == needle) {
+      found = i;
+      if (!last) {
+        break;
+      }
+    }
+  }
+  return found;
+}
+
+/// Returns the number of non-overlapping occurrences of `needle` in `hay` by
+/// comparing at every index.
+usize naiveCount(StringView hay, StringView needle) {
+  usize n = 0;
+  for (usize i = 0; i + needle.getLen() <= hay.getLen(); i++) {
+    if (hay.slice(i, i + needle.getLen()) == needle) {
+      n++;
+      i += needle.getLen() - 1;
+    }
+  }
+  return n;
+}
+
+void searchTest(void) {
+  using ds::search_internal::Isa;
+
+  // Haystacks over a small alphabet (so there are many partial matches),
+  // with embedded null characters
+  const usize HAY_LEN = 700;
+  char        hay_buf[HAY_LEN];
+  srand(42);
+  for (usize i = 0; i < HAY_LEN; i++) {
+    hay_buf[i] = "ab\0"[rand() % 3];
+  }
+
+  const Isa ISAS[] = {Isa::Scalar, Isa::Sse2, Isa::Avx2};
+  Isa       detected = ds::search_internal::getIsa();
+  for (Isa isa : ISAS) {
+    if (!ds::search_internal::setIsa(isa)) {
+      continue;
+    }
+
+    // Needles cut from the haystack (so they're found), short and long
+    for (usize hay_len : {usize(0), usize(5), usize(40), HAY_LEN}) {
+      StringView hay = StringView(hay_buf, hay_len);
+      for (usize len = 1; len <= 100; len += len < 10 ? 1 : 7) {
+        for (usize start : {usize(3), usize(250), usize(HAY_LEN - len)}) {
+          StringView needle = StringView(hay_buf + start, len);
+          assert(hay.find(needle) == naiveFind(hay, needle, false));
+          assert(hay.rfind(needle) == naiveFind(hay, needle, true));
+          assert(hay.count(needle) == naiveCount(hay, needle));
+        }
+      }
+    }
+
+    // Periodic inputs, where the filter gives up and Two-Way takes over (and
+    // handles periodic needles separately)
+    char periodic[HAY_LEN];
+    for (usize i = 0; i < HAY_LEN; i++) {
+      periodic[i] = i % 97 == 96 ? 'b' : 'a';
+    }
+    StringView hay = StringView(periodic, HAY_LEN);
+    for (usize len : {usize(2), usize(63), usize(64), usize(96), usize(97),
+                      usize(150), usize(300)}) {
+      for (usize start : {usize(0), usize(1), usize(50)}) {
+        StringView needle = StringView(periodic + start, len);
+        assert(hay.find(needle) == naiveFind(hay, needle, false));
+        assert(hay.rfind(needle) == naiveFind(hay, needle, true));
+        assert(hay.count(needle) == naiveCount(hay, needle));
+      }
+    }
+  }
+  ds::search_internal::setIsa(detected);
+
+  StringView view = StringView("abcabcabd");
+  assert(view.findFrom("abc", 0) == 0);
+  assert(view.findFrom("abc", 1) == 3);
+  assert(view.findFrom("abc", 4) == StringView::NOT_FOUND);
+  assert(view.findFrom("", 9) == 9);
+  assert(view.findFrom("", 10) == StringView::NOT_FOUND);
+  assert(view.rfind("abc") == 3);
+  assert(view.rfind("") == 9);
+  assert(view.rfind("abe") == StringView::NOT_FOUND);
+  assert(view.slice(0, 5).rfind("abc") == 0);
+
+  // Occurrences don't overlap
+  StringView repeated = StringView("aaaaa");
+  assert(repeated.count("aa") == 2);
+  assert(repeated.count("a") == 5);
+  assert(repeated.count("b") == 0);
+  assert(repeated.count("") == 0);
+
+  usize expected[] = {0, 2};
+  usize n          = 0;
+  for (usize idx : repeated.findAll("aa")) {
+    assert(idx == expected[n++]);
+  }
+  assert(n == 2);
+  for (usize idx : repeated.findAll("")) {
+    (void)idx;
+    assert(false);
+  }
+
+  // Stopping early
+  StringView::Matches matches = view.findAll("ab");
+  assert(*matches.begin() == 0 && *++matches.begin() == 3);
+  assert(matches.begin() != matches.end());
+  assert(view.findAll("x").begin() == view.findAll("x").end());
+}
+
+void trimTest(void) {
+  StringView view = StringView(" \t key: value \r\n");
+  assert(view.trim() == "key: value");
+  assert(view.trimStart() == "key: value \r\n");
+  assert(view.trimEnd() == " \t key: value");
+
+  assert(StringView("   ").trim().isEmpty());
+  assert(StringView().trim().isEmpty());
+  assert(StringView("x").trim() == "x");
+}
+
+void splitTest(void) {
+  StringView view = StringView("Hello World");
+  StringView tail = view.split(5);
+  Error::checkError();
+  assert(view == "Hello");
+  assert(tail == " World");
+
+  StringView end = view.split(5);
+  Error::checkError();
+  assert(end.isEmpty() && view == "Hello");
+
+  view.split(6);
+  assert(Error::isError());
+  assert(view == "Hello");
+
+  // Tokenizing consumes the view
+  StringView line   = StringView("GET /index.html HTTP/1.1");
+  StringView method = line.splitOn(' ');
+  StringView path   = line.splitOn(' ');
+  StringView proto  = line.splitOn(' ');
+  assert(method == "GET" && path == "/index.html" && proto == "HTTP/1.1");
+  assert(line.isEmpty());
+
+  StringView fields = StringView("a,,b,");
+  assert(fields.splitOn(',') == "a");
+  assert(fields.splitOn(',').isEmpty());
+  assert(fields.splitOn(',') == "b");
+  assert(fields.isEmpty());
+}
+
+void compareTest(void) {
+  assert(StringView("abc") == StringView("abc"));
+  assert(StringView("abc") != StringView("abd"));
+  assert(StringView("abc") < StringView("abd"));
+  assert(StringView("ab") < StringView("abc"));
+  assert(!(StringView("abc") < StringView("ab")));
+  assert(StringView().compare(StringView("")) == 0);
+  assert(StringView("\xff").compare(StringView("a")) > 0);
+
+  // Views of different buffers with the same characters are equal
+  StringView lhs = StringView("key=value").slice(0, 3);
+  StringView rhs = StringView("a key").slice(2, 5);
+  assert(lhs == rhs);
+  assert(lhs.getHash() == rhs.getHash());
+  assert(lhs.getHash() != StringView("kez").getHash());
+
+  std::unordered_map<StringView, int> counts;
+  StringView words = StringView("a b a c a b");
+  while (!words.isEmpty()) {
+    counts[words.splitOn(' ')]++;
+  }
+  assert(counts.size() == 3);
+  assert(counts["a"] == 3 && counts["b"] == 2 && counts["c"] == 1);
+}
+
+void stringTest(void) {
+  mem::TrackingAllocator tracker = mem::TrackingAllocator();
+  {
+    String str = String(&tracker, "Host: example.com, Accept: text/html");
+    Error::checkError();
+    usize allocs = tracker.getStats().allocs;
+
+    // Converting to and slicing views doesn't allocate
+    StringView view = str;
+    assert(view.getRaw() == str.getRaw());
+    assert(view.getLen() == str.getLen());
+    assert(str.getView() == view);
+
+    StringView host = str.slice(6, 17);
+    Error::checkError();
+    assert(host == "example.com");
+    assert(str.getView().find("Accept") == 19);
+    assert(str.getView().endsWith("html"));
+    assert(tracker.getStats().allocs == allocs);
+
+    str.slice(0, 100);
+    assert(Error::isError());
+
+    // Views can be copied into new strings
+    String copy = String(&tracker, host);
+    Error::checkError();
+    assert(copy.isSame("example.com"));
+    assert(copy.isInline());
+
+    String long_copy = String(&tracker, str.getView().slice(0, 30));
+    Error::checkError();
+    assert(long_copy.isSame("Host: example.com, Accept: tex"));
+    assert(tracker.getStats().allocs == allocs + 1);
+
+    String invalid = String(nullptr, host);
+    assert(Error::isError());
+  }
+  assert(tracker.getStats().live_bytes == 0);
+}
+
+int main(void) {
+  createTest();
+  sliceTest();
+  findTest();
+  searchTest();
+  trimTest();
+  splitTest();
+  compareTest();
+  stringTest();
+}
@@ -0,0 +1,195 @@
+#include "bl/error.h"
+#include "bl/mem/tracking_allocator.h"
+#include "bl/primitives.h"
+#include "bl/task/scheduler.h"
+#include "bl/task/work_deque.h"
+
+#include <atomic>
+#include <cassert>
+#include <thread>
+
+using namespace bl;
+using namespace bl::task;
+
+void dequeTest(void) {
+  WorkDeque<int*> bad = WorkDeque<int*>(nullptr);
+  assert(Error::isError());
+
+  int             vals[200];
+  WorkDeque<int*> deque = WorkDeque<int*>();
+  Error::checkError();
+  assert(deque.isEmpty());
+  assert(deque.pop() == nullptr);
+  assert(deque.steal() == nullptr);
+
+  // Grows past the initial capacity
+  for (int i = 0; i < 200; i++) {
+    deque.push(&vals[i]);
+    Error::checkError();
+  }
+  assert(deque.getLen() == 200);
+
+  // The owner pops the newest items, thieves steal the oldest
+  assert(deque.pop() == &vals[199]);
+  assert(deque.steal() == &vals[0]);
+  assert(deque.steal() == &vals[1]);
+  assert(deque.pop() == &vals[198]);
+  assert(deque.getLen() == 196);
+
+  while (deque.pop() != nullptr) {
+  }
+  assert(deque.isEmpty());
+}
+
+void concurrentDequeTest(void) {
+  const int        NUM_ITEMS = 100000;
+  static int       vals[NUM_ITEMS];
+  std::atomic<int> taken[NUM_ITEMS] = {};
+
+  WorkDeque<int*>  deque            = WorkDeque<int*>();
+  std::atomic<int> num_taken        = 0;
+  std::atomic<bool> done            = false;
+
+  // Thieves steal while the owner pushes and pops
+  std::thread thieves[3];
+  for (std::thread& thief : thieves) {
+    thief = std::thread([&] {
+      while (!done.load() || !deque.isEmpty()) {
+        int* val = deque.steal();
+        if (val != nullptr) {
+          taken[val - vals]++;
+          num_taken++;
+        }
+      }
+    });
+  }
+
+  for (int i = 0; i < NUM_ITEMS; i++) {
+    deque.push(&vals[i]);
+    if (i % 3 == 0) {
+      int* val = deque.pop();
+      if (val != nullptr) {
+        taken[val - vals]++;
+        num_taken++;
+      }
+    }
+  }
+  done.store(true);
+  for (std::thread& thief : thieves) {
+    thief.join();
+  }
+  while (int* val = deque.pop()) {
+    taken[val - vals]++;
+    num_taken++;
+  }
+
+  // Every item was taken exactly once
+  assert(num_taken == NUM_ITEMS);
+  for (int i = 0; i < NUM_ITEMS; i++) {
+    assert(taken[i] == 1);
+  }
+}
+
+/// Computes the `n`th Fibonacci number with one task per call.
+u64 fib(Scheduler& scheduler, u64 n) {
+  if (n < 2) {
+    return n;
+  }
+
+  u64       a = 0;
+  TaskGroup group;
+  scheduler.spawn(group, [&] { a = fib(scheduler, n - 1); });
+  u64 b = fib(scheduler, n - 2);
+  scheduler.wait(group);
+  return a + b;
+}
+
+void spawnTest(void) {
+  Scheduler bad = Scheduler(0);
+  assert(Error::isError());
+  Scheduler bad_allocator = Scheduler(2, nullptr);
+  assert(Error::isError());
+
+  Scheduler scheduler = Scheduler(4);
+  Error::checkError();
+  assert(scheduler.getWorkerCount() == 4);
+
+  // Tasks spawned from outside the workers
+  std::atomic<int> count = 0;
+  TaskGroup        group;
+  for (int i = 0; i < 1000; i++) {
+    scheduler.spawn(group, [&] { count++; });
+  }
+  scheduler.wait(group);
+  assert(group.isDone());
+  assert(count == 1000);
+
+  // Nested fork/join
+  assert(fib(scheduler, 20) == 6765);
+
+  // Closures bigger than a recycled frame
+  char      big[Scheduler::FRAME_SIZE * 2] = {1};
+  int       sum                            = 0;
+  TaskGroup big_group;
+  scheduler.spawn(big_group, [&sum, big] {
+    for (char c : big) {
+      sum += c;
+    }
+  });
+  scheduler.wait(big_group);
+  assert(sum == 1);
+
+  Scheduler::Stats stats = scheduler.getStats();
+  assert(stats.tasks_run >= 1000);
+  scheduler.resetStats();
+  assert(scheduler.getStats().tasks_run == 0);
+}
+
+void parallelForTest(void) {
+  mem::TrackingAllocator tracking  = mem::TrackingAllocator();
+  {
+    Scheduler        scheduler = Scheduler(3, &tracking);
+    Error::checkError();
+
+    // Every index is visited exactly once
+    const usize      LEN       = 100000;
+    std::atomic<int> visits[LEN] = {};
+    scheduler.parallelFor(0, LEN, [&](usize start, usize end) {
+      for (usize i = start; i < end; i++) {
+        visits[i]++;
+      }
+    });
+    for (usize i = 0; i < LEN; i++) {
+      assert(visits[i] == 1);
+    }
+
+    // Explicit grain size, nested loops
+    std::atomic<usize> total = 0;
+    scheduler.parallelFor(
+        10, 20,
+        [&](usize start, usize end) {
+          assert(end - start <= 2);
+          for (usize i = start; i < end; i++) {
+            scheduler.parallelFor(0, 100, [&](usize start, usize end) {
+              total += end - start;
+            });
+          }
+        },
+        2);
+    assert(total == 1000);
+
+    scheduler.parallelFor(5, 5, [](usize, usize) { assert(false); });
+  }
+
+  // Everything (task frames included) went back to the allocator
+  assert(tracking.getStats().live_bytes == 0);
+}
+
+int main(void) {
+  dequeTest();
+  concurrentDequeTest();
+  spawnTest();
+  parallelForTest();
+
+  assert(Scheduler::getGlobal()->getWorkerCount() >= 1);
+}
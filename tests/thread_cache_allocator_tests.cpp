@@ -0,0 +1,201 @@
+#include "bl/ds/dynamic_array.h"
+#include "bl/error.h"
+#include "bl/mem/allocator.h"
+#include "bl/mem/thread_cache_allocator.h"
+#include "bl/mem/tracking_allocator.h"
+#include "bl/primitives.h"
+#include "bl/string.h"
+
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <thread>
+
+using namespace bl;
+using namespace bl::ds;
+
+void allocTest(void) {
+  mem::ThreadCacheAllocator bad = mem::ThreadCacheAllocator(nullptr);
+  assert(Error::isError());
+  mem::ThreadCacheAllocator small = mem::ThreadCacheAllocator(&bad, 1024);
+  assert(Error::isError());
+
+  mem::TrackingAllocator    tracker = mem::TrackingAllocator();
+  mem::ThreadCacheAllocator alloc   = mem::ThreadCacheAllocator(&tracker);
+  Error::checkError();
+
+  // Small allocations come from a segment...
+  void* a = alloc.allocRaw(8);
+  void* b = alloc.allocRaw(16);
+  void* c = alloc.allocRaw(100);
+  assert(alloc.owns(a) && alloc.owns(b) && alloc.owns(c));
+  assert((char*)b == (char*)a + 16);
+  assert((uintptr_t)c % 128 == 0);
+  assert(alloc.getSegmentCount() == 2);
+
+  // ...and freed blocks are reused
+  alloc.deallocRaw(a);
+  assert(alloc.allocRaw(16) == a);
+
+  // Large ones go to the parent
+  usize allocs = tracker.getStats().allocs;
+  void* big    = alloc.allocRaw(mem::ThreadCacheAllocator::MAX_BLOCK_SIZE + 1);
+  assert(!alloc.owns(big));
+  assert(tracker.getStats().allocs == allocs + 1);
+  alloc.deallocRaw(big);
+  assert(tracker.getStats().frees == 1);
+}
+
+void resizeTest(void) {
+  mem::ThreadCacheAllocator alloc = mem::ThreadCacheAllocator();
+
+  // Resizing within the size class stays in place
+  char*                     str   = (char*)alloc.allocRaw(4);
+  strcpy(str, "abc");
+  assert(alloc.resizeRaw(str, 16) == str);
+  assert(alloc.tryExpandRaw(str, 16, 16));
+  assert(!alloc.tryExpandRaw(str, 16, 17));
+  assert(!alloc.tryExpandRaw(str, 16, 8));
+
+  // Growing moves to another size class, and then to the parent
+  str = (char*)alloc.resizeRaw(str, 17);
+  assert(strcmp(str, "abc") == 0);
+  str = (char*)alloc.resizeRaw(str, 100000);
+  assert(!alloc.owns(str));
+  assert(strcmp(str, "abc") == 0);
+
+  // ...and back
+  str = (char*)alloc.resizeRaw(str, 8);
+  assert(alloc.owns(str));
+  assert(strcmp(str, "abc") == 0);
+  alloc.deallocRaw(str);
+
+  // Blocks are aligned to their size
+  char* aligned = (char*)alloc.allocAlignedRaw(8, 256);
+  assert(alloc.owns(aligned));
+  assert((uintptr_t)aligned % 256 == 0);
+  strcpy(aligned, "Hello");
+  aligned = (char*)alloc.resizeAlignedRaw(aligned, 8, 8192, 256);
+  assert((uintptr_t)aligned % 256 == 0);
+  assert(strcmp(aligned, "Hello") == 0);
+  alloc.deallocSizedRaw(aligned, 8192, 256);
+}
+
+void remoteTest(void) {
+  mem::ThreadCacheAllocator alloc = mem::ThreadCacheAllocator();
+
+  void*                     ptrs[100];
+  for (int i = 0; i < 100; i++) {
+    ptrs[i] = alloc.allocRaw(64);
+  }
+  usize segments = alloc.getSegmentCount();
+
+  // Blocks freed by another thread go back to the owning heap...
+  std::thread freer([&] {
+    for (int i = 0; i < 100; i++) {
+      alloc.deallocRaw(ptrs[i]);
+    }
+  });
+  freer.join();
+
+  // ...which picks them up once its segments run out
+  for (int i = 0; i < 1000; i++) {
+    alloc.allocRaw(64);
+  }
+  assert(alloc.getSegmentCount() - segments <= 1);
+}
+
+void adoptTest(void) {
+  mem::ThreadCacheAllocator alloc = mem::ThreadCacheAllocator();
+
+  void*                     a     = nullptr;
+  std::thread               first([&] { a = alloc.allocRaw(32); });
+  first.join();
+  assert(alloc.getSegmentCount() == 1);
+
+  // The heap of an exited thread is adopted by the next one
+  void*       b = nullptr;
+  std::thread second([&] {
+    b = alloc.allocRaw(32);
+    alloc.deallocRaw(a);
+  });
+  second.join();
+  assert((char*)b == (char*)a + 32);
+  assert(alloc.getSegmentCount() == 1);
+}
+
+void threadTest(void) {
+  mem::ThreadCacheAllocator alloc = mem::ThreadCacheAllocator();
+
+  const int                 NUM_THREADS = 4;
+  const int                 NUM_BLOCKS  = 2000;
+  static u64*               blocks[NUM_THREADS][NUM_BLOCKS];
+
+  // Every thread allocates its own blocks...
+  std::thread               threads[NUM_THREADS];
+  for (int t = 0; t < NUM_THREADS; t++) {
+    threads[t] = std::thread([&, t] {
+      for (int i = 0; i < NUM_BLOCKS; i++) {
+        usize nbytes  = 8 + (usize)(i % 64) * 8;
+        blocks[t][i]  = (u64*)alloc.allocRaw(nbytes);
+        *blocks[t][i] = (u64)(t * NUM_BLOCKS + i);
+      }
+    });
+  }
+  for (int t = 0; t < NUM_THREADS; t++) {
+    threads[t].join();
+  }
+
+  // ...and frees the ones of its neighbour
+  for (int t = 0; t < NUM_THREADS; t++) {
+    threads[t] = std::thread([&, t] {
+      int other = (t + 1) % NUM_THREADS;
+      for (int i = 0; i < NUM_BLOCKS; i++) {
+        assert(*blocks[other][i] == (u64)(other * NUM_BLOCKS + i));
+        alloc.deallocRaw(blocks[other][i]);
+      }
+      for (int i = 0; i < NUM_BLOCKS; i++) {
+        alloc.deallocRaw(alloc.allocRaw(64));
+      }
+    });
+  }
+  for (int t = 0; t < NUM_THREADS; t++) {
+    threads[t].join();
+  }
+}
+
+void containerTest(void) {
+  mem::ThreadCacheAllocator alloc = mem::ThreadCacheAllocator();
+
+  for (int n = 0; n < 10; n++) {
+    String str = String(&alloc, "Hello");
+    Error::checkError();
+    str.push(" World!");
+    Error::checkError();
+    assert(str.isSame("Hello World!"));
+
+    DynamicArray<int> arr = DynamicArray<int>(&alloc);
+    Error::checkError();
+    for (int i = 0; i < 5000; i++) {
+      arr.push(i);
+      Error::checkError();
+    }
+    for (int i = 0; i < 5000; i++) {
+      assert(arr[i] == i);
+    }
+  }
+
+  // The global instance works as well
+  DynamicArray<int> arr = DynamicArray<int>(mem::ThreadCacheAllocator::getGlobal());
+  arr.push(1);
+  Error::checkError();
+}
+
+int main(void) {
+  allocTest();
+  resizeTest();
+  remoteTest();
+  adoptTest();
+  threadTest();
+  containerTest();
+}
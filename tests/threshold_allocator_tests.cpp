@@ -0,0 +1,100 @@
+#include "bl/ds/dynamic_array.h"
+#include "bl/error.h"
+#include "bl/mem/allocator.h"
+#include "bl/mem/arena_allocator.h"
+#include "bl/mem/threshold_allocator.h"
+#include "bl/primitives.h"
+#include "bl/string.h"
+
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+
+using namespace bl;
+using namespace bl::ds;
+
+void allocTest(void) {
+  mem::ThresholdAllocator bad = mem::ThresholdAllocator(nullptr);
+  assert(Error::isError());
+  mem::ThresholdAllocator zero = mem::ThresholdAllocator(&bad, 0);
+  assert(Error::isError());
+
+  mem::ArenaAllocator     arena = mem::ArenaAllocator();
+  mem::ThresholdAllocator alloc = mem::ThresholdAllocator(&arena, 4096);
+  Error::checkError();
+
+  // Small allocations go to the parent...
+  void*                   small = alloc.allocRaw(100);
+  assert(arena.getUsed() >= 100);
+  assert(!alloc.getPages()->owns(small));
+
+  // ...and large ones are mapped directly
+  usize                   used  = arena.getUsed();
+  void*                   large = alloc.allocRaw(4096);
+  assert(arena.getUsed() == used);
+  assert(alloc.getPages()->owns(large));
+
+  alloc.deallocRaw(large);
+  assert(alloc.getPages()->getMappedBytes() == 0);
+  alloc.deallocRaw(small);
+}
+
+void resizeTest(void) {
+  mem::ThresholdAllocator alloc = mem::ThresholdAllocator();
+  mem::PageAllocator*     pages = alloc.getPages();
+  usize                   limit = alloc.getThreshold();
+
+  // Growing past the threshold moves the allocation to the page allocator
+  char*                   str   = (char*)alloc.allocRaw(16);
+  strcpy(str, "Hello");
+  str = (char*)alloc.resizeRaw(str, limit);
+  assert(pages->owns(str));
+  assert(strcmp(str, "Hello") == 0);
+
+  // ...and shrinking below it moves it back
+  str = (char*)alloc.resizeRaw(str, 16);
+  assert(!pages->owns(str));
+  assert(strcmp(str, "Hello") == 0);
+  alloc.deallocRaw(str);
+
+  // Sized resizes route by size
+  str = (char*)alloc.allocAlignedRaw(16, 64);
+  strcpy(str, "World");
+  str = (char*)alloc.resizeAlignedRaw(str, 16, 2 * limit, 64);
+  assert(pages->owns(str));
+  assert(strcmp(str, "World") == 0);
+  assert(!alloc.tryExpandRaw(str, 2 * limit, 16));
+  str = (char*)alloc.resizeAlignedRaw(str, 2 * limit, 16, 64);
+  assert(!pages->owns(str));
+  assert((uintptr_t)str % 64 == 0);
+  assert(strcmp(str, "World") == 0);
+  alloc.deallocSizedRaw(str, 16, 64);
+  assert(pages->getMappedBytes() == 0);
+}
+
+void containerTest(void) {
+  mem::ThresholdAllocator alloc = mem::ThresholdAllocator();
+
+  DynamicArray<u64>       arr   = DynamicArray<u64>(&alloc);
+  Error::checkError();
+  for (u64 i = 0; i < 1 << 18; i++) {
+    arr.push(i);
+    Error::checkError();
+  }
+  for (u64 i = 0; i < 1 << 18; i++) {
+    assert(arr[i] == i);
+  }
+  assert(alloc.getPages()->getMappedBytes() > alloc.getThreshold());
+
+  String str = String(&alloc, "Hello");
+  Error::checkError();
+  str.push(" World!");
+  Error::checkError();
+  assert(str.isSame("Hello World!"));
+}
+
+int main(void) {
+  allocTest();
+  resizeTest();
+  containerTest();
+}
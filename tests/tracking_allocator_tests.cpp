@@ -0,0 +1,129 @@
+#include "bl/ds/dynamic_array.h"
+#include "bl/error.h"
+#include "bl/mem/allocator.h"
+#include "bl/mem/arena_allocator.h"
+#include "bl/mem/tracking_allocator.h"
+#include "bl/primitives.h"
+#include "bl/string.h"
+
+#include <cassert>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+
+using namespace bl;
+using namespace bl::ds;
+
+void allocTest(void) {
+  mem::TrackingAllocator bad = mem::TrackingAllocator(nullptr);
+  assert(Error::isError());
+
+  // Trackers can be stacked
+  mem::TrackingAllocator tracker = mem::TrackingAllocator(&bad);
+  Error::checkError();
+
+  void* a = tracker.allocRaw(10);
+  void* b = tracker.allocRaw(100);
+  assert((uintptr_t)a % mem::Allocator::DEFAULT_ALIGNMENT == 0);
+  memset(a, 1, 10);
+  memset(b, 2, 100);
+
+  mem::TrackingAllocator::Stats stats = tracker.getStats();
+  assert(stats.allocs == 2);
+  assert(stats.live_bytes == 110);
+  assert(stats.peak_bytes == 110);
+  assert(stats.histogram[4] == 1); // 10 bytes: (8, 16]
+  assert(stats.histogram[7] == 1); // 100 bytes: (64, 128]
+
+  tracker.deallocRaw(a);
+  tracker.deallocSizedRaw(b, 100);
+  stats = tracker.getStats();
+  assert(stats.frees == 2);
+  assert(stats.live_bytes == 0);
+  assert(stats.peak_bytes == 110);
+  assert(stats.total_bytes == 110);
+  assert(bad.getStats().allocs == 2 && bad.getStats().frees == 2);
+
+  tracker.resetStats();
+  stats = tracker.getStats();
+  assert(stats.allocs == 0 && stats.peak_bytes == 0);
+}
+
+void resizeTest(void) {
+  mem::ArenaAllocator    arena   = mem::ArenaAllocator();
+  mem::TrackingAllocator tracker = mem::TrackingAllocator(&arena);
+  Error::checkError();
+
+  // Unsized resizes know the old size from the header
+  char* str = (char*)tracker.allocRaw(6);
+  strcpy(str, "Hello");
+  str = (char*)tracker.resizeRaw(str, 100);
+  assert(strcmp(str, "Hello") == 0);
+
+  mem::TrackingAllocator::Stats stats = tracker.getStats();
+  assert(stats.resizes == 1);
+  assert(stats.live_bytes == 100);
+  assert(stats.peak_bytes == 100);
+
+  // The last arena allocation can grow in place
+  assert(tracker.tryExpandRaw(str, 100, 200));
+  stats = tracker.getStats();
+  assert(stats.resizes == 2 && stats.expands == 1);
+  assert(stats.live_bytes == 200);
+
+  // Aligned allocations keep their alignment
+  char* aligned = (char*)tracker.allocAlignedRaw(10, 64);
+  assert((uintptr_t)aligned % 64 == 0);
+  strcpy(aligned, "World");
+  aligned = (char*)tracker.resizeAlignedRaw(aligned, 10, 1000, 64);
+  assert((uintptr_t)aligned % 64 == 0);
+  assert(strcmp(aligned, "World") == 0);
+  tracker.deallocAlignedRaw(aligned, 64);
+  tracker.deallocRaw(str);
+
+  stats = tracker.getStats();
+  assert(stats.live_bytes == 0);
+  assert(stats.peak_bytes == 1200);
+}
+
+void containerTest(void) {
+  mem::TrackingAllocator tracker = mem::TrackingAllocator();
+
+  {
+    DynamicArray<int> arr = DynamicArray<int>(&tracker);
+    for (int i = 0; i < 100; i++) {
+      arr.push(i);
+      Error::checkError();
+    }
+
+    // The first push allocates a single element, the rest double it
+    mem::TrackingAllocator::Stats stats = tracker.getStats();
+    assert(stats.allocs == 1);
+    assert(stats.histogram[2] == 1);
+    assert(stats.resizes == 7);
+    assert(stats.live_bytes == 128 * sizeof(int));
+
+    // Short strings are stored inline, long ones are allocated
+    String str = String(&tracker, "Hello");
+    Error::checkError();
+    assert(tracker.getStats().allocs == 1);
+    str.push(" World! This no longer fits inline");
+    Error::checkError();
+    assert(tracker.getStats().allocs == 2);
+  }
+
+  mem::TrackingAllocator::Stats stats = tracker.getStats();
+  assert(stats.frees == stats.allocs);
+  assert(stats.live_bytes == 0);
+
+  FILE* file = tmpfile();
+  tracker.dump(file);
+  assert(ftell(file) > 0);
+  fclose(file);
+}
+
+int main(void) {
+  allocTest();
+  resizeTest();
+  containerTest();
+}